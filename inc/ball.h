@@ -23,7 +23,6 @@ public:
    Ball(Ball&& rhs) noexcept;
    Ball& operator=(Ball&& rhs) noexcept;
 
-   void      moveWithinVerticalRange(float deltaTime, float verticalRange);
    void      moveInFreeFall(float deltaTime);
    void      reset();
 
@@ -32,6 +31,9 @@ public:
    float     getRadius() const;
    void      setRadius(float radius);
 
+   float     getSpinAngularVelocityScaledByBounce() const;
+   void      setSpinAngularVelocityScaledByBounce(float spinAngularVelocityScaledByBounce);
+
 private:
 
    glm::vec3 mInitialVelocity;
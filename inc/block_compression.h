@@ -0,0 +1,20 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include "cooked_texture.h"
+
+// Compresses a level of a texture, whose texels are RGBA with 8 bits per channel, into blocks of the given format
+// The blocks on the right and bottom edges of a level whose size isn't a multiple of 4 repeat the last column and row of texels
+// The 16 texels of each block are processed with FloatLanes, so the compressor uses the widest SIMD instructions that it's compiled with
+// blocks must have room for getSizeOfCookedTextureLevel(format, width, height) bytes
+void compressTextureLevel(const unsigned char* rgbaTexels, unsigned int width, unsigned int height, CookedTextureFormat format, unsigned char* blocks);
+
+// Decompresses a level that was compressed into blocks of the given format back into RGBA texels with 8 bits per channel,
+// for drivers that can't sample the format (BC7 blocks are only decoded in the mode that compressTextureLevel writes)
+// rgbaTexels must have room for 4 * width * height bytes
+void decompressTextureLevel(const unsigned char* blocks, unsigned int width, unsigned int height, CookedTextureFormat format, unsigned char* rgbaTexels);
+
+// Replaces the compressed levels of a cooked texture with RGBA8 levels, and does nothing if they already are
+void decompressCookedTexture(CookedTextureContents& contents);
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef COLLIDER_H
+#define COLLIDER_H
+
+#include <array>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+#include "match_state.h"
+
+// Two-dimensional shapes that can be swept against each other
+// Every pair of shape types has its own narrow-phase routine, and the routines are looked up in a table indexed by the types of both shapes
+// Colliders are stored in one contiguous array per shape type, so a query looks up the table once per shape type instead of once per collider
+
+enum class ShapeType : std::uint8_t
+{
+   Circle,
+   AABB,
+   Capsule,
+   OBB,
+   HalfPlane
+};
+
+const std::size_t numberOfShapeTypes = 5;
+
+struct Circle
+{
+   glm::vec2 center;
+   float     radius;
+};
+
+struct AABB
+{
+   glm::vec2 center;
+   glm::vec2 halfExtents;
+};
+
+// A segment with rounded ends
+struct Capsule
+{
+   glm::vec2 start;
+   glm::vec2 end;
+   float     radius;
+};
+
+// A box that is rotated so that its local X axis points along axis, which must have a length of 1
+struct OBB
+{
+   glm::vec2 center;
+   glm::vec2 halfExtents;
+   glm::vec2 axis;
+};
+
+// Everything behind the plane is solid, that is, every point p for which dot(normal, p) < offset
+// The normal must have a length of 1
+struct HalfPlane
+{
+   glm::vec2 normal;
+   float     offset;
+};
+
+template<typename Shape> struct ShapeTraits;
+template<> struct ShapeTraits<Circle>    { static const ShapeType type = ShapeType::Circle; };
+template<> struct ShapeTraits<AABB>      { static const ShapeType type = ShapeType::AABB; };
+template<> struct ShapeTraits<Capsule>   { static const ShapeType type = ShapeType::Capsule; };
+template<> struct ShapeTraits<OBB>       { static const ShapeType type = ShapeType::OBB; };
+template<> struct ShapeTraits<HalfPlane> { static const ShapeType type = ShapeType::HalfPlane; };
+
+struct Contact
+{
+   // Points from the collider towards the shape that was swept against it, which is the direction in which the shape must move to separate them
+   glm::vec2 normal;
+
+   // How much the shapes overlap, which is only greater than 0 if they already overlapped at the start of the sweep
+   float     depth;
+
+   // Fraction of the displacement of the shape at which it first touches the collider, between 0 and 1
+   float     timeOfImpact;
+};
+
+struct ColliderHit
+{
+   std::uint32_t shape;    // Index of the swept shape
+   std::uint32_t collider; // ID returned by ColliderSet::add
+   Contact       contact;
+};
+
+// Sweeps shapes that stand still or move in straight lines against colliders that stand still
+// A shape that overlaps with a collider at the start of a sweep hits it with a time of impact of 0, unless it's moving away from it
+class ColliderSet
+{
+public:
+
+   ColliderSet();
+   ~ColliderSet() = default;
+
+   ColliderSet(const ColliderSet&) = default;
+   ColliderSet& operator=(const ColliderSet&) = default;
+
+   ColliderSet(ColliderSet&&) = default;
+   ColliderSet& operator=(ColliderSet&&) = default;
+
+   // Returns the ID of the collider, which is the number of colliders that were added before it
+   template<typename Shape>
+   std::uint32_t add(const Shape& shape);
+
+   void          clear();
+
+   std::size_t   getNumberOfColliders() const;
+
+   // Appends one hit to hits for every pair of shape and collider that touch while each shape moves by its displacement
+   // Pass displacements of 0 to find the colliders that the shapes overlap with
+   template<typename Shape>
+   void          sweep(const Shape* shapes, const glm::vec2* displacements, std::size_t numberOfShapes, std::vector<ColliderHit>& hits) const;
+
+private:
+
+   void          sweep(ShapeType typeOfShapes, const void* shapes, const glm::vec2* displacements, std::size_t numberOfShapes, std::vector<ColliderHit>& hits) const;
+
+   // The order of the arrays matches the order of ShapeType
+   std::tuple<std::vector<Circle>, std::vector<AABB>, std::vector<Capsule>, std::vector<OBB>, std::vector<HalfPlane>> mShapes;
+   std::array<std::vector<std::uint32_t>, numberOfShapeTypes>                                                        mIDsOfColliders;
+   std::uint32_t                                                                                                     mNumberOfColliders;
+};
+
+template<typename Shape>
+std::uint32_t ColliderSet::add(const Shape& shape)
+{
+   std::get<std::vector<Shape>>(mShapes).push_back(shape);
+   mIDsOfColliders[static_cast<std::size_t>(ShapeTraits<Shape>::type)].push_back(mNumberOfColliders);
+   return mNumberOfColliders++;
+}
+
+template<typename Shape>
+void ColliderSet::sweep(const Shape* shapes, const glm::vec2* displacements, std::size_t numberOfShapes, std::vector<ColliderHit>& hits) const
+{
+   sweep(ShapeTraits<Shape>::type, shapes, displacements, numberOfShapes, hits);
+}
+
+// Returns false if there are no hits
+bool   findEarliestHit(const std::vector<ColliderHit>& hits, ColliderHit& earliestHit);
+
+Circle makeCircle(const BallState& ball);
+AABB   makeAABB(const PaddleState& paddle);
+
+#endif
@@ -1,10 +1,11 @@
 #ifndef COLLISION_H
 #define COLLISION_H
 
-#include "ball.h"
-#include "paddle.h"
+#include "match_state.h"
+#include "numeric_policy.h"
 
-enum class CollisionDirection
+// The values of the directions are also used to encode them as bytes (see CircleAndAABBCollisionSpan)
+enum class CollisionDirection : std::uint8_t
 {
    Up,
    Down,
@@ -12,7 +13,35 @@ enum class CollisionDirection
    Right
 };
 
-bool               circleAndAABBCollided(const Ball& circle, const Paddle& AABB, glm::vec2& vecFromCenterOfCircleToPointOfCollision);
+bool               circleAndAABBCollided(const BallState& circle, const PaddleState& AABB, glm::vec2& vecFromCenterOfCircleToPointOfCollision);
+bool               sweptCircleAndAABBCollided(const BallState&   circle,
+                                              const glm::vec2&   displacementOfCircle,
+                                              const PaddleState& AABB,
+                                              const glm::vec2&   displacementOfAABB,
+                                              float&             timeOfImpact,
+                                              glm::vec2&         vecFromCenterOfCircleToPointOfCollision);
 CollisionDirection determineDirectionOfCollisionBetweenCircleAndAABB(const glm::vec2& vecFromCenterOfCircleToPointOfCollision);
 
+// The functions above calculate with the numbers of FloatNumericPolicy, and the ones below with the numbers of any numeric policy (see numeric_policy.h),
+// so that the rules of a match can use them with fixed-point numbers too
+// The positions and displacements are relative to the AABB, which stands still at the origin
+// They are instantiated for FloatNumericPolicy and FixedPointNumericPolicy in collision.cpp
+
+template<typename NumericPolicy>
+bool               circleAndAABBCollided(NumericVector<typename NumericPolicy::Number>  centerOfCircle,
+                                         typename NumericPolicy::Number                 radius,
+                                         NumericVector<typename NumericPolicy::Number>  halfExtentsOfAABB,
+                                         NumericVector<typename NumericPolicy::Number>& vecFromCenterOfCircleToPointOfCollision);
+
+template<typename NumericPolicy>
+bool               sweptCircleAndAABBCollided(NumericVector<typename NumericPolicy::Number>  startOfCircle,
+                                              typename NumericPolicy::Number                 radius,
+                                              NumericVector<typename NumericPolicy::Number>  displacementOfCircle,
+                                              NumericVector<typename NumericPolicy::Number>  halfExtentsOfAABB,
+                                              typename NumericPolicy::Number&                timeOfImpact,
+                                              NumericVector<typename NumericPolicy::Number>& vecFromCenterOfCircleToPointOfCollision);
+
+template<typename NumericPolicy>
+CollisionDirection determineDirectionOfCollisionBetweenCircleAndAABB(NumericVector<typename NumericPolicy::Number> vecFromCenterOfCircleToPointOfCollision);
+
 #endif
@@ -0,0 +1,57 @@
+#ifndef COLLISION_BATCH_H
+#define COLLISION_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "float_lanes.h"
+
+// Batched version of circleAndAABBCollided and determineDirectionOfCollisionBetweenCircleAndAABB (see collision.h), which tests circle i against AABB i
+// The circles and the AABBs are stored as structures of arrays, so that several pairs can be tested with each SIMD instruction (see float_lanes.h)
+// The single-pair functions test one lane of it, so both give the same results
+// Like MatchBatch, it's kept out of the simulation library and compiled with the SIMD instructions that it should use
+
+struct CircleSpan
+{
+   const float* centersX;
+   const float* centersY;
+   const float* radii;
+};
+
+struct AABBSpan
+{
+   const float* centersX;
+   const float* centersY;
+   const float* halfWidths;
+   const float* halfHeights;
+};
+
+struct CircleAndAABBCollisionSpan
+{
+   std::uint8_t* collided;                                   // 1 if the pair collided and 0 otherwise
+   float*        vecsFromCenterOfCircleToPointOfCollisionX;
+   float*        vecsFromCenterOfCircleToPointOfCollisionY;
+   std::uint8_t* directions;                                 // A CollisionDirection, which is only meaningful for the pairs that collided
+};
+
+// Declared in the namespace of the instruction set that it's compiled with, so that it can be compiled with several of them and linked into the same program
+namespace FLOAT_LANES_NAMESPACE
+{
+
+void circlesAndAABBsCollided(std::size_t numberOfPairs, const CircleSpan& circles, const AABBSpan& AABBs, const CircleAndAABBCollisionSpan& collisions);
+
+}
+
+// On x86-64 built with AVX, teapong_collision_benchmark also links the version compiled without SIMD flags, to compare both widths
+#if defined(FLOAT_LANES_AVX) || defined(FLOAT_LANES_AVX512)
+namespace FloatLanesSSE2
+{
+
+const unsigned int floatLanesWidth = 4;
+
+void circlesAndAABBsCollided(std::size_t numberOfPairs, const CircleSpan& circles, const AABBSpan& AABBs, const CircleAndAABBCollisionSpan& collisions);
+
+}
+#endif
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef COOKED_MESH_H
+#define COOKED_MESH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A .tpmesh file holds the meshes of a model in the layout in which they are given to OpenGL, so loading a model only takes mapping the file into memory
+// and passing pointers into it to glBufferData, without parsing anything
+// It's made of a header, a table with the ranges of each mesh, a table of materials, a table with the names of their textures,
+// a blob with the interleaved vertices of every mesh and a blob with their indices, with every section starting at a multiple of 16 bytes
+// Every number is stored in the byte order of the machine that cooked the file, which is checked with the magic number when the file is opened
+// This file doesn't depend on OpenGL or Assimp, so that models can be cooked by a tool that doesn't open a window
+
+const std::uint32_t cookedMeshMagicNumber = 0x534D5054; // "TPMS"
+const std::uint32_t cookedMeshVersion     = 1;
+
+// Position (3 floats), normal (3 floats) and texture coordinates (2 floats), just like Vertex
+const std::uint32_t sizeOfCookedVertex    = 8 * sizeof(float);
+
+// Marks a material that doesn't have a texture of a given type
+const std::uint32_t noCookedTexture       = 0xFFFFFFFF;
+
+// Same order as MaterialTextureTypes
+enum CookedTextureType
+{
+   CookedAmbientTexture,
+   CookedEmissiveTexture,
+   CookedDiffuseTexture,
+   CookedSpecularTexture,
+   numberOfCookedTextureTypes
+};
+
+struct CookedMeshHeader
+{
+   std::uint32_t magicNumber;
+   std::uint32_t version;
+   std::uint32_t sizeOfVertex;
+   std::uint32_t numberOfMeshes;
+   std::uint32_t numberOfMaterials;
+   std::uint32_t numberOfVertices;
+   std::uint32_t numberOfIndices;
+   std::uint32_t sizeOfTextureNames;
+
+   // Offsets of the sections from the start of the file
+   std::uint64_t offsetOfMeshes;
+   std::uint64_t offsetOfMaterials;
+   std::uint64_t offsetOfTextureNames;
+   std::uint64_t offsetOfVertices;
+   std::uint64_t offsetOfIndices;
+   std::uint64_t sizeOfFile;
+};
+
+// The indices of a mesh start at 0 for the first vertex of the mesh
+struct CookedMeshRange
+{
+   std::uint32_t firstVertex;
+   std::uint32_t numberOfVertices;
+   std::uint32_t firstIndex;
+   std::uint32_t numberOfIndices;
+   std::uint32_t indexOfMaterial;
+};
+
+struct CookedMaterial
+{
+   float         ambientColor[3];
+   float         emissiveColor[3];
+   float         diffuseColor[3];
+   float         specularColor[3];
+   float         shininess;
+
+   // Offset of the null-terminated name of each texture in the table of names, or noCookedTexture
+   std::uint32_t textureNames[numberOfCookedTextureTypes];
+};
+
+// What the cooker fills before writing a file
+struct CookedMeshContents
+{
+   std::vector<CookedMeshRange> meshes;
+   std::vector<CookedMaterial>  materials;
+   std::string                  textureNames;
+   std::vector<float>           vertices;
+   std::vector<std::uint32_t>   indices;
+};
+
+// Appends a texture name to the table of names of the contents and returns its offset
+std::uint32_t addCookedTextureName(CookedMeshContents& contents, const std::string& name);
+
+// The file is written under a temporary name and then renamed, so that a game that is loading it never sees half of it
+bool          writeCookedMeshFile(const std::string& filePath, const CookedMeshContents& contents);
+
+// Returns the path of the .tpmesh file that is cooked from a model (e.g. resources/models/teapot/teapot.tpmesh for resources/models/teapot/teapot.obj)
+std::string   getPathOfCookedMeshFile(const std::string& modelFilePath);
+
+// Returns false if the cooked file doesn't exist or is older than the model it was cooked from
+bool          cookedMeshFileIsUpToDate(const std::string& cookedFilePath, const std::string& modelFilePath);
+
+// A .tpmesh file mapped into memory, whose sections can be read in place until it's closed
+class CookedMeshFile
+{
+public:
+
+   CookedMeshFile();
+   ~CookedMeshFile();
+
+   CookedMeshFile(const CookedMeshFile&) = delete;
+   CookedMeshFile& operator=(const CookedMeshFile&) = delete;
+
+   CookedMeshFile(CookedMeshFile&&) = delete;
+   CookedMeshFile& operator=(CookedMeshFile&&) = delete;
+
+   // Returns false if the file can't be mapped, or if it was cooked by a different version of the cooker or on a machine with a different byte order
+   bool                   open(const std::string& filePath);
+   void                   close();
+
+   std::uint32_t          getNumberOfMeshes() const;
+   const CookedMeshRange& getMesh(std::uint32_t index) const;
+   const CookedMaterial&  getMaterial(std::uint32_t index) const;
+
+   // Returns an empty string if the material doesn't have a texture of the given type
+   std::string            getTextureName(const CookedMaterial& material, CookedTextureType type) const;
+
+   // Interleaved vertices of a mesh, laid out like Vertex
+   const void*            getVertices(const CookedMeshRange& mesh) const;
+   const std::uint32_t*   getIndices(const CookedMeshRange& mesh) const;
+
+private:
+
+   // Returns true if a section starts at a multiple of 16 bytes and its elements end before the end of the file
+   bool                    sectionFitsInFile(std::uint64_t offset, std::uint64_t numberOfElements, std::uint64_t sizeOfElement) const;
+   bool                    validate() const;
+
+   const std::uint8_t*     mBytes;
+   std::uint64_t           mSizeOfFile;
+   const CookedMeshHeader* mHeader;
+
+#ifdef _WIN32
+   void*                   mFileHandle;
+   void*                   mMappingHandle;
+#endif
+};
+
+#endif
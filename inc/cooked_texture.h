@@ -0,0 +1,95 @@
+#ifndef COOKED_TEXTURE_H
+#define COOKED_TEXTURE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A .tptex file holds a texture with its whole mip chain, usually block compressed, so loading it only takes reading the file
+// and passing each level to glCompressedTexImage2D (or glTexImage2D), without decoding the image or generating mipmaps
+// It's made of a header, a table with the size and position of each level, and a blob with the levels, from the biggest to the smallest
+// Every number is stored in the byte order of the machine that cooked the file, which is checked with the magic number when the file is read
+// This file doesn't depend on OpenGL, so that textures can be cooked by a tool that doesn't open a window
+
+const std::uint32_t cookedTextureMagicNumber = 0x58545054; // "TPTX"
+const std::uint32_t cookedTextureVersion     = 1;
+
+enum CookedTextureFormat
+{
+   // 8 bytes per block of 4x4 texels, for textures without alpha
+   CookedTextureBC1 = 1,
+
+   // 16 bytes per block of 4x4 texels, for textures with alpha
+   CookedTextureBC3 = 2,
+
+   // 4 bytes per texel, for drivers that don't support block compression
+   CookedTextureRGBA8 = 3,
+
+   // 16 bytes per block of 4x4 texels, with or without alpha, which is much closer to the texture than BC1 and BC3 but needs BPTC
+   CookedTextureBC7 = 4
+};
+
+struct CookedTextureHeader
+{
+   std::uint32_t magicNumber;
+   std::uint32_t version;
+   std::uint32_t format;
+   std::uint32_t width;
+   std::uint32_t height;
+   std::uint32_t numberOfLevels;
+
+   // Offsets of the sections from the start of the file
+   std::uint64_t offsetOfLevels;
+   std::uint64_t offsetOfData;
+   std::uint64_t sizeOfFile;
+};
+
+struct CookedTextureLevel
+{
+   std::uint32_t width;
+   std::uint32_t height;
+
+   // From the start of the blob with the levels
+   std::uint64_t offset;
+   std::uint64_t size;
+};
+
+// What the cooker fills before writing a file, and what is read back from it
+struct CookedTextureContents
+{
+   CookedTextureContents()
+      : format(0)
+      , width(0)
+      , height(0)
+      , levels()
+      , data()
+   {
+
+   }
+
+   std::uint32_t                   format;
+   std::uint32_t                   width;
+   std::uint32_t                   height;
+   std::vector<CookedTextureLevel> levels;
+   std::vector<std::uint8_t>       data;
+};
+
+// Returns the number of bytes of a level of the given size, which is stored in whole blocks of 4x4 texels when it's compressed
+std::uint64_t getSizeOfCookedTextureLevel(std::uint32_t format, std::uint32_t width, std::uint32_t height);
+
+// Returns the name of a format (e.g. "BC1"), for messages
+const char*   getNameOfCookedTextureFormat(std::uint32_t format);
+
+// The file is written under a temporary name and then renamed, so that a game that is loading it never sees half of it
+bool          writeCookedTextureFile(const std::string& filePath, const CookedTextureContents& contents);
+
+// Returns false if the file can't be read, or if it was cooked by a different version of the cooker or on a machine with a different byte order
+bool          readCookedTextureFile(const std::string& filePath, CookedTextureContents& contents);
+
+// Returns the path of the .tptex file that is cooked from a texture (e.g. resources/models/teapot/teapot_specular.tptex for resources/models/teapot/teapot_specular.jpg)
+std::string   getPathOfCookedTextureFile(const std::string& texFilePath);
+
+// Returns false if the cooked file doesn't exist or is older than the texture it was cooked from
+bool          cookedTextureFileIsUpToDate(const std::string& cookedFilePath, const std::string& texFilePath);
+
+#endif
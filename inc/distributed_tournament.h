@@ -0,0 +1,131 @@
+#ifndef DISTRIBUTED_TOURNAMENT_H
+#define DISTRIBUTED_TOURNAMENT_H
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "tournament.h"
+
+// Spreads the matches of a tournament across worker processes, which can run on this machine or on others
+// The coordinator listens on a Unix domain socket ("unix:/path/to/socket") or on a TCP port ("tcp:host:port"), and every worker connects to it
+// Workers must be started with the same tournament as the coordinator, which they prove by sending a fingerprint of it when they connect
+// The coordinator divides the matches into jobs, keeps a few of them queued on every worker so that they never wait for work,
+// merges the results of every job as soon as they arrive, and gives the jobs of workers that disconnect to the workers that remain
+// A worker that stays connected but stops making progress (e.g. because its machine is overloaded) has its job given to another worker after a deadline,
+// and whichever worker finishes it first provides its results
+// Since every match draws its random numbers from a stream derived from the seed of the tournament and the index of the match,
+// the results are the same for any number of workers and any assignment of jobs
+
+struct CoordinatorSettings
+{
+   std::string   address;
+
+   // Worker processes that are forked by the coordinator, which can be 0 to only use workers that are started separately
+   unsigned int  numberOfLocalWorkers;
+
+   std::uint32_t matchesPerJob;
+
+   // Limits how many jobs are sent to a worker before it returns any results
+   unsigned int  maxJobsInFlightPerWorker;
+
+   // How long a worker can spend on a job before it's also queued for another worker, counted from when the worker starts it
+   // A worker plays its jobs in the order in which they were sent, so it starts a job when it sends the results of the one before it
+   double        secondsBeforeJobIsReassigned;
+};
+
+struct CoordinatorReport
+{
+   std::uint64_t numberOfJobs;
+   std::uint64_t jobsReassigned;
+   std::uint64_t jobsPastTheirDeadline;
+   std::uint64_t jobsPlayedByCoordinator;
+   std::uint64_t workersConnected;
+   std::uint64_t workersLost;
+   std::uint64_t workersRejected;
+   double        secondsSpentRunning;
+};
+
+class TournamentCoordinator
+{
+public:
+
+   TournamentCoordinator(const Tournament& tournament, const CoordinatorSettings& settings);
+   ~TournamentCoordinator();
+
+   TournamentCoordinator(const TournamentCoordinator&) = delete;
+   TournamentCoordinator& operator=(const TournamentCoordinator&) = delete;
+
+   TournamentCoordinator(TournamentCoordinator&&) = delete;
+   TournamentCoordinator& operator=(TournamentCoordinator&&) = delete;
+
+   // Returns false if the coordinator can't listen on its address
+   // When the coordinator has forked local workers and all of them are gone, it plays the jobs that are left itself
+   bool                     run();
+
+   const TournamentResults& getResults() const;
+   const CoordinatorReport& getReport() const;
+
+private:
+
+   struct Job
+   {
+      std::uint32_t index;
+      std::uint32_t begin;
+      std::uint32_t end;
+   };
+
+   struct Connection
+   {
+      int                                   socket;
+      bool                                  isIdentified;
+      std::vector<std::uint8_t>             receivedBytes;
+      std::deque<Job>                       jobsInFlight;
+
+      // The first job in flight is the one that the worker is playing
+      std::chrono::steady_clock::time_point timeWhenFirstJobStarted;
+      bool                                  firstJobIsPastItsDeadline;
+   };
+
+   bool                     listenOnAddress();
+   void                     forkLocalWorkers();
+   void                     acceptConnection();
+   bool                     receiveFromConnection(Connection& connection);
+   bool                     processMessage(Connection& connection, std::uint8_t type, const std::uint8_t* payload, std::size_t sizeOfPayload);
+   void                     sendJobs(Connection& connection);
+   void                     startFirstJob(Connection& connection);
+   void                     queueJobsPastTheirDeadline();
+   void                     queueJobsAgain(const Connection& connection);
+   void                     dropConnection(Connection& connection);
+   void                     completeJob(const Job& job, const TournamentResults& results);
+   bool                     localWorkersAreAlive();
+   void                     shutDown();
+
+   const Tournament&        mTournament;
+   CoordinatorSettings      mSettings;
+   std::uint64_t            mFingerprint;
+
+   int                      mListeningSocket;
+   std::string              mPathOfUnixSocket;
+   std::vector<pid_t>       mLocalWorkers;
+   std::vector<Connection>  mConnections;
+
+   std::deque<Job>          mPendingJobs;
+   std::vector<bool>        mJobIsComplete;
+   std::uint64_t            mNumberOfCompleteJobs;
+
+   TournamentResults        mResults;
+   CoordinatorReport        mReport;
+};
+
+// Connects to a coordinator and plays the jobs that it sends until it says that the tournament is over
+// Returns false if the worker can't connect, if the coordinator rejects it or if the connection is lost before the end of the tournament
+bool          runTournamentWorker(const Tournament& tournament, const std::string& address);
+
+// Identifies the tournament that the coordinator and its workers are playing
+std::uint64_t calculateFingerprintOfTournament(const Tournament& tournament);
+
+#endif
@@ -23,7 +23,7 @@ public:
                                      const std::string&                                        initialStateID);
    void                   processInputInCurrentState(float deltaTime) const;
    void                   updateCurrentState(float deltaTime) const;
-   void                   renderCurrentState() const;
+   void                   renderCurrentState(float interpolationFactor) const;
    void                   changeState(const std::string& newStateID);
 
    std::shared_ptr<State> getPreviousState();
@@ -0,0 +1,184 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+// A signed Q16.16 number: 16 integer bits and 16 fractional bits stored in an int32
+// Every operation is done with integers, so the results are the same on every compiler, optimization level and instruction set
+// Sums and differences wrap around like unsigned integers when they overflow, which never happens with the distances and speeds of a match
+// Products and quotients saturate instead, since squaring a speed or dividing by a tiny number (e.g. to find a time of impact) can leave the range
+// Lengths of vectors must be calculated with sqrtOfSumOfSquares, since the square of a speed above 181 doesn't fit in a Q16.16 number
+
+class FixedPoint
+{
+public:
+
+   static const int          fractionalBits = 16;
+   static const std::int32_t one            = 1 << fractionalBits;
+
+   FixedPoint() = default;
+
+   // Converting a float is exact for every float that is a multiple of 2^-16 within the range, and always rounds the same way otherwise
+   // Only constants and configuration values should be converted, so that nothing that is computed with floats leaks into a simulation
+   static FixedPoint fromFloat(float value)
+   {
+      // Scaling by a power of two is exact, and so is the fraction that is left after truncating, so this rounds like std::llround without converting to a double
+      float scaled = value * static_cast<float>(one);
+      if (!(std::abs(scaled) < 2147483648.0f))
+      {
+         // Numbers that are out of range saturate
+         return fromWideRaw(static_cast<std::int64_t>(std::llround(static_cast<double>(value) * one)));
+      }
+
+      std::int32_t truncated = static_cast<std::int32_t>(scaled);
+      float        fraction  = scaled - static_cast<float>(truncated);
+      return fromRaw(truncated + ((fraction >= 0.5f) ? 1 : 0) - ((fraction <= -0.5f) ? 1 : 0));
+   }
+
+   static FixedPoint fromInt(int value)            { return fromWideRaw(static_cast<std::int64_t>(value) * one); }
+   static FixedPoint fromRaw(std::int32_t raw)     { FixedPoint number; number.mRaw = raw; return number; }
+
+   float             toFloat() const               { return static_cast<float>(mRaw) / one; }
+   std::int32_t      getRaw() const                { return mRaw; }
+
+   FixedPoint        operator-() const             { return fromWrappedRaw(0u - static_cast<std::uint32_t>(mRaw)); }
+
+   FixedPoint&       operator+=(FixedPoint other)  { *this = *this + other; return *this; }
+   FixedPoint&       operator-=(FixedPoint other)  { *this = *this - other; return *this; }
+   FixedPoint&       operator*=(FixedPoint other)  { *this = *this * other; return *this; }
+   FixedPoint&       operator/=(FixedPoint other)  { *this = *this / other; return *this; }
+
+   friend FixedPoint operator+(FixedPoint a, FixedPoint b)  { return fromWrappedRaw(static_cast<std::uint32_t>(a.mRaw) + static_cast<std::uint32_t>(b.mRaw)); }
+   friend FixedPoint operator-(FixedPoint a, FixedPoint b)  { return fromWrappedRaw(static_cast<std::uint32_t>(a.mRaw) - static_cast<std::uint32_t>(b.mRaw)); }
+
+   // Products are rounded to the nearest representable number, with ties rounded up
+   // Right shifts of negative numbers are arithmetic on every compiler that we build with, and they avoid a branch per product
+   friend FixedPoint operator*(FixedPoint a, FixedPoint b)
+   {
+      std::int64_t product = static_cast<std::int64_t>(a.mRaw) * b.mRaw;
+      return fromWideRaw((product + (one / 2)) >> fractionalBits);
+   }
+
+   // Quotients are rounded to the nearest representable number, with ties rounded away from zero
+
+   friend FixedPoint operator/(FixedPoint a, FixedPoint b)
+   {
+      if (b.mRaw == 0)
+      {
+         // Dividing by zero saturates towards the sign of the numerator
+         return fromRaw((a.mRaw < 0) ? std::numeric_limits<std::int32_t>::min() : std::numeric_limits<std::int32_t>::max());
+      }
+
+      std::int64_t numerator   = static_cast<std::int64_t>(a.mRaw) * one;
+      std::int64_t denominator = b.mRaw;
+      std::int64_t half        = (numerator < 0) ? -(std::abs(denominator) / 2) : (std::abs(denominator) / 2);
+      return fromWideRaw((numerator + half) / denominator);
+   }
+
+   friend bool       operator==(FixedPoint a, FixedPoint b) { return a.mRaw == b.mRaw; }
+   friend bool       operator!=(FixedPoint a, FixedPoint b) { return a.mRaw != b.mRaw; }
+   friend bool       operator<(FixedPoint a, FixedPoint b)  { return a.mRaw < b.mRaw; }
+   friend bool       operator<=(FixedPoint a, FixedPoint b) { return a.mRaw <= b.mRaw; }
+   friend bool       operator>(FixedPoint a, FixedPoint b)  { return a.mRaw > b.mRaw; }
+   friend bool       operator>=(FixedPoint a, FixedPoint b) { return a.mRaw >= b.mRaw; }
+
+private:
+
+   // Converting an unsigned integer that doesn't fit into an int32 is implementation-defined before C++20, so the bits are copied instead
+   static FixedPoint fromWrappedRaw(std::uint32_t raw)
+   {
+      std::int32_t signedRaw;
+      std::memcpy(&signedRaw, &raw, sizeof(signedRaw));
+      return fromRaw(signedRaw);
+   }
+
+   static FixedPoint fromWideRaw(std::int64_t raw)
+   {
+      if (raw > std::numeric_limits<std::int32_t>::max()) { return fromRaw(std::numeric_limits<std::int32_t>::max()); }
+      if (raw < std::numeric_limits<std::int32_t>::min()) { return fromRaw(std::numeric_limits<std::int32_t>::min()); }
+      return fromRaw(static_cast<std::int32_t>(raw));
+   }
+
+   std::int32_t mRaw;
+};
+
+inline FixedPoint abs(FixedPoint a)
+{
+   return (a < FixedPoint::fromRaw(0)) ? -a : a;
+}
+
+// Calculates the square root of an integer one bit at a time, rounding down
+inline std::uint64_t calculateIntegerSquareRoot(std::uint64_t value)
+{
+   std::uint64_t remainder = value;
+   std::uint64_t root      = 0;
+   std::uint64_t bit       = std::uint64_t(1) << 62;
+
+   while (bit > remainder)
+   {
+      bit >>= 2;
+   }
+
+   while (bit != 0)
+   {
+      if (remainder >= root + bit)
+      {
+         remainder -= root + bit;
+         root       = (root >> 1) + bit;
+      }
+      else
+      {
+         root >>= 1;
+      }
+
+      bit >>= 2;
+   }
+
+   return root;
+}
+
+// Rounds down to the nearest representable number, and returns 0 for negative numbers
+inline FixedPoint sqrt(FixedPoint a)
+{
+   if (a.getRaw() <= 0)
+   {
+      return FixedPoint::fromRaw(0);
+   }
+
+   // sqrt(raw / 2^16) * 2^16 = sqrt(raw * 2^16)
+   return FixedPoint::fromRaw(static_cast<std::int32_t>(calculateIntegerSquareRoot(static_cast<std::uint64_t>(a.getRaw()) << FixedPoint::fractionalBits)));
+}
+
+// sqrt(a^2 + b^2), with the squares calculated with 64-bit integers so that they can't overflow
+// The squares of the raw numbers have 32 fractional bits, so their square root has 16 like every other number
+// Rounds down to the nearest representable number, and saturates if the result is out of range
+inline FixedPoint sqrtOfSumOfSquares(FixedPoint a, FixedPoint b)
+{
+   std::int64_t  rawA = a.getRaw();
+   std::int64_t  rawB = b.getRaw();
+   std::uint64_t root = calculateIntegerSquareRoot(static_cast<std::uint64_t>(rawA * rawA) + static_cast<std::uint64_t>(rawB * rawB));
+   return FixedPoint::fromRaw(static_cast<std::int32_t>(std::min<std::uint64_t>(root, std::numeric_limits<std::int32_t>::max())));
+}
+
+// sqrt(a^2 - b^2), calculated like sqrtOfSumOfSquares
+// Returns 0 if |b| is larger than |a|
+inline FixedPoint sqrtOfDifferenceOfSquares(FixedPoint a, FixedPoint b)
+{
+   std::int64_t  rawA      = a.getRaw();
+   std::int64_t  rawB      = b.getRaw();
+   std::uint64_t squareOfA = static_cast<std::uint64_t>(rawA * rawA);
+   std::uint64_t squareOfB = static_cast<std::uint64_t>(rawB * rawB);
+   if (squareOfB >= squareOfA)
+   {
+      return FixedPoint::fromRaw(0);
+   }
+
+   return FixedPoint::fromRaw(static_cast<std::int32_t>(std::min<std::uint64_t>(calculateIntegerSquareRoot(squareOfA - squareOfB), std::numeric_limits<std::int32_t>::max())));
+}
+
+#endif
@@ -0,0 +1,277 @@
+#ifndef FLOAT_LANES_H
+#define FLOAT_LANES_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#define FLOAT_LANES_AVX512
+#define FLOAT_LANES_NAMESPACE FloatLanesAVX512
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define FLOAT_LANES_AVX
+#define FLOAT_LANES_NAMESPACE FloatLanesAVX
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FLOAT_LANES_SSE2
+#define FLOAT_LANES_NAMESPACE FloatLanesSSE2
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define FLOAT_LANES_NEON
+#define FLOAT_LANES_NAMESPACE FloatLanesNEON
+#else
+#define FLOAT_LANES_NAMESPACE FloatLanesScalar
+#endif
+
+// A thin wrapper around the widest SIMD registers that the compiler is allowed to use
+// Code written against FloatLanes and MaskLanes processes floatLanesWidth values with each operation, and falls back to plain floats on other architectures
+// Each instruction set has its own inline namespace, so translation units that are compiled with different SIMD flags can be linked into the same program
+// Functions that take or return lanes, or that are compiled once per instruction set, can be declared in FLOAT_LANES_NAMESPACE for the same reason
+
+#if defined(FLOAT_LANES_AVX512)
+
+inline namespace FloatLanesAVX512
+{
+
+const unsigned int floatLanesWidth = 16;
+
+struct FloatLanes { __m512    value; };
+struct MaskLanes  { __mmask16 value; };
+
+inline FloatLanes   loadLanes(const float* src)                     { return {_mm512_loadu_ps(src)}; }
+inline void         storeLanes(float* dst, FloatLanes a)            { _mm512_storeu_ps(dst, a.value); }
+inline FloatLanes   broadcastLanes(float a)                         { return {_mm512_set1_ps(a)}; }
+
+inline FloatLanes   operator+(FloatLanes a, FloatLanes b)           { return {_mm512_add_ps(a.value, b.value)}; }
+inline FloatLanes   operator-(FloatLanes a, FloatLanes b)           { return {_mm512_sub_ps(a.value, b.value)}; }
+inline FloatLanes   operator*(FloatLanes a, FloatLanes b)           { return {_mm512_mul_ps(a.value, b.value)}; }
+inline FloatLanes   operator/(FloatLanes a, FloatLanes b)           { return {_mm512_div_ps(a.value, b.value)}; }
+inline FloatLanes   minLanes(FloatLanes a, FloatLanes b)            { return {_mm512_min_ps(a.value, b.value)}; }
+inline FloatLanes   maxLanes(FloatLanes a, FloatLanes b)            { return {_mm512_max_ps(a.value, b.value)}; }
+inline FloatLanes   sqrtLanes(FloatLanes a)                         { return {_mm512_sqrt_ps(a.value)}; }
+inline FloatLanes   absLanes(FloatLanes a)                          { return {_mm512_abs_ps(a.value)}; }
+
+inline MaskLanes    operator<(FloatLanes a, FloatLanes b)           { return {_mm512_cmp_ps_mask(a.value, b.value, _CMP_LT_OQ)}; }
+inline MaskLanes    operator<=(FloatLanes a, FloatLanes b)          { return {_mm512_cmp_ps_mask(a.value, b.value, _CMP_LE_OQ)}; }
+inline MaskLanes    operator>(FloatLanes a, FloatLanes b)           { return {_mm512_cmp_ps_mask(a.value, b.value, _CMP_GT_OQ)}; }
+inline MaskLanes    operator>=(FloatLanes a, FloatLanes b)          { return {_mm512_cmp_ps_mask(a.value, b.value, _CMP_GE_OQ)}; }
+inline MaskLanes    operator==(FloatLanes a, FloatLanes b)          { return {_mm512_cmp_ps_mask(a.value, b.value, _CMP_EQ_OQ)}; }
+
+inline MaskLanes    operator&(MaskLanes a, MaskLanes b)             { return {static_cast<__mmask16>(a.value & b.value)}; }
+inline MaskLanes    operator|(MaskLanes a, MaskLanes b)             { return {static_cast<__mmask16>(a.value | b.value)}; }
+inline MaskLanes    operator!(MaskLanes a)                          { return {static_cast<__mmask16>(~a.value)}; }
+
+inline FloatLanes   selectLanes(MaskLanes m, FloatLanes a, FloatLanes b) { return {_mm512_mask_blend_ps(m.value, b.value, a.value)}; }
+inline unsigned int maskBits(MaskLanes m)                           { return m.value; }
+
+// Reads one byte per lane, so that flags that are packed into bytes can be turned into masks without going through memory one lane at a time
+inline MaskLanes    testBitOfLanes(const std::uint8_t* bytes, std::uint8_t bit)
+{
+   __m512i lanes = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes)));
+   return {_mm512_test_epi32_mask(lanes, _mm512_set1_epi32(bit))};
+}
+
+}
+
+#elif defined(FLOAT_LANES_AVX)
+
+inline namespace FloatLanesAVX
+{
+
+const unsigned int floatLanesWidth = 8;
+
+struct FloatLanes { __m256 value; };
+struct MaskLanes  { __m256 value; };
+
+inline FloatLanes   loadLanes(const float* src)                     { return {_mm256_loadu_ps(src)}; }
+inline void         storeLanes(float* dst, FloatLanes a)            { _mm256_storeu_ps(dst, a.value); }
+inline FloatLanes   broadcastLanes(float a)                         { return {_mm256_set1_ps(a)}; }
+
+inline FloatLanes   operator+(FloatLanes a, FloatLanes b)           { return {_mm256_add_ps(a.value, b.value)}; }
+inline FloatLanes   operator-(FloatLanes a, FloatLanes b)           { return {_mm256_sub_ps(a.value, b.value)}; }
+inline FloatLanes   operator*(FloatLanes a, FloatLanes b)           { return {_mm256_mul_ps(a.value, b.value)}; }
+inline FloatLanes   operator/(FloatLanes a, FloatLanes b)           { return {_mm256_div_ps(a.value, b.value)}; }
+inline FloatLanes   minLanes(FloatLanes a, FloatLanes b)            { return {_mm256_min_ps(a.value, b.value)}; }
+inline FloatLanes   maxLanes(FloatLanes a, FloatLanes b)            { return {_mm256_max_ps(a.value, b.value)}; }
+inline FloatLanes   sqrtLanes(FloatLanes a)                         { return {_mm256_sqrt_ps(a.value)}; }
+inline FloatLanes   absLanes(FloatLanes a)                          { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.value)}; }
+
+inline MaskLanes    operator<(FloatLanes a, FloatLanes b)           { return {_mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ)}; }
+inline MaskLanes    operator<=(FloatLanes a, FloatLanes b)          { return {_mm256_cmp_ps(a.value, b.value, _CMP_LE_OQ)}; }
+inline MaskLanes    operator>(FloatLanes a, FloatLanes b)           { return {_mm256_cmp_ps(a.value, b.value, _CMP_GT_OQ)}; }
+inline MaskLanes    operator>=(FloatLanes a, FloatLanes b)          { return {_mm256_cmp_ps(a.value, b.value, _CMP_GE_OQ)}; }
+inline MaskLanes    operator==(FloatLanes a, FloatLanes b)          { return {_mm256_cmp_ps(a.value, b.value, _CMP_EQ_OQ)}; }
+
+inline MaskLanes    operator&(MaskLanes a, MaskLanes b)             { return {_mm256_and_ps(a.value, b.value)}; }
+inline MaskLanes    operator|(MaskLanes a, MaskLanes b)             { return {_mm256_or_ps(a.value, b.value)}; }
+inline MaskLanes    operator!(MaskLanes a)                          { return {_mm256_xor_ps(a.value, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))}; }
+
+inline FloatLanes   selectLanes(MaskLanes m, FloatLanes a, FloatLanes b) { return {_mm256_blendv_ps(b.value, a.value, m.value)}; }
+inline unsigned int maskBits(MaskLanes m)                           { return static_cast<unsigned int>(_mm256_movemask_ps(m.value)); }
+
+// Reads one byte per lane, so that flags that are packed into bytes can be turned into masks without going through memory one lane at a time
+// Only the integer instructions of SSE4.1 are used, since AVX without AVX2 can't operate on integers in 256-bit registers
+inline MaskLanes    testBitOfLanes(const std::uint8_t* bytes, std::uint8_t bit)
+{
+   __m128i bitOfEachLane = _mm_set1_epi32(bit);
+   __m128i bytesOfLanes  = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes));
+   __m128i lowerLanes    = _mm_cmpeq_epi32(_mm_and_si128(_mm_cvtepu8_epi32(bytesOfLanes), bitOfEachLane), bitOfEachLane);
+   __m128i upperLanes    = _mm_cmpeq_epi32(_mm_and_si128(_mm_cvtepu8_epi32(_mm_srli_si128(bytesOfLanes, 4)), bitOfEachLane), bitOfEachLane);
+   return {_mm256_insertf128_ps(_mm256_castps128_ps256(_mm_castsi128_ps(lowerLanes)), _mm_castsi128_ps(upperLanes), 1)};
+}
+
+}
+
+#elif defined(FLOAT_LANES_SSE2)
+
+inline namespace FloatLanesSSE2
+{
+
+const unsigned int floatLanesWidth = 4;
+
+struct FloatLanes { __m128 value; };
+struct MaskLanes  { __m128 value; };
+
+inline FloatLanes   loadLanes(const float* src)                     { return {_mm_loadu_ps(src)}; }
+inline void         storeLanes(float* dst, FloatLanes a)            { _mm_storeu_ps(dst, a.value); }
+inline FloatLanes   broadcastLanes(float a)                         { return {_mm_set1_ps(a)}; }
+
+inline FloatLanes   operator+(FloatLanes a, FloatLanes b)           { return {_mm_add_ps(a.value, b.value)}; }
+inline FloatLanes   operator-(FloatLanes a, FloatLanes b)           { return {_mm_sub_ps(a.value, b.value)}; }
+inline FloatLanes   operator*(FloatLanes a, FloatLanes b)           { return {_mm_mul_ps(a.value, b.value)}; }
+inline FloatLanes   operator/(FloatLanes a, FloatLanes b)           { return {_mm_div_ps(a.value, b.value)}; }
+inline FloatLanes   minLanes(FloatLanes a, FloatLanes b)            { return {_mm_min_ps(a.value, b.value)}; }
+inline FloatLanes   maxLanes(FloatLanes a, FloatLanes b)            { return {_mm_max_ps(a.value, b.value)}; }
+inline FloatLanes   sqrtLanes(FloatLanes a)                         { return {_mm_sqrt_ps(a.value)}; }
+inline FloatLanes   absLanes(FloatLanes a)                          { return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.value)}; }
+
+inline MaskLanes    operator<(FloatLanes a, FloatLanes b)           { return {_mm_cmplt_ps(a.value, b.value)}; }
+inline MaskLanes    operator<=(FloatLanes a, FloatLanes b)          { return {_mm_cmple_ps(a.value, b.value)}; }
+inline MaskLanes    operator>(FloatLanes a, FloatLanes b)           { return {_mm_cmpgt_ps(a.value, b.value)}; }
+inline MaskLanes    operator>=(FloatLanes a, FloatLanes b)          { return {_mm_cmpge_ps(a.value, b.value)}; }
+inline MaskLanes    operator==(FloatLanes a, FloatLanes b)          { return {_mm_cmpeq_ps(a.value, b.value)}; }
+
+inline MaskLanes    operator&(MaskLanes a, MaskLanes b)             { return {_mm_and_ps(a.value, b.value)}; }
+inline MaskLanes    operator|(MaskLanes a, MaskLanes b)             { return {_mm_or_ps(a.value, b.value)}; }
+inline MaskLanes    operator!(MaskLanes a)                          { return {_mm_xor_ps(a.value, _mm_castsi128_ps(_mm_set1_epi32(-1)))}; }
+
+inline FloatLanes   selectLanes(MaskLanes m, FloatLanes a, FloatLanes b) { return {_mm_or_ps(_mm_and_ps(m.value, a.value), _mm_andnot_ps(m.value, b.value))}; }
+inline unsigned int maskBits(MaskLanes m)                           { return static_cast<unsigned int>(_mm_movemask_ps(m.value)); }
+
+// Reads one byte per lane, so that flags that are packed into bytes can be turned into masks without going through memory one lane at a time
+inline MaskLanes    testBitOfLanes(const std::uint8_t* bytes, std::uint8_t bit)
+{
+   std::int32_t bytesOfLanes;
+   std::memcpy(&bytesOfLanes, bytes, sizeof(bytesOfLanes));
+
+   __m128i zero          = _mm_setzero_si128();
+   __m128i bitOfEachLane = _mm_set1_epi32(bit);
+   __m128i lanes         = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytesOfLanes), zero), zero);
+   return {_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(lanes, bitOfEachLane), bitOfEachLane))};
+}
+
+}
+
+#elif defined(FLOAT_LANES_NEON)
+
+// Only AArch64 NEON, since 32-bit ARM can't divide, take square roots or add across lanes with a single instruction
+inline namespace FloatLanesNEON
+{
+
+const unsigned int floatLanesWidth = 4;
+
+struct FloatLanes { float32x4_t value; };
+struct MaskLanes  { uint32x4_t  value; };
+
+inline FloatLanes   loadLanes(const float* src)                     { return {vld1q_f32(src)}; }
+inline void         storeLanes(float* dst, FloatLanes a)            { vst1q_f32(dst, a.value); }
+inline FloatLanes   broadcastLanes(float a)                         { return {vdupq_n_f32(a)}; }
+
+inline FloatLanes   operator+(FloatLanes a, FloatLanes b)           { return {vaddq_f32(a.value, b.value)}; }
+inline FloatLanes   operator-(FloatLanes a, FloatLanes b)           { return {vsubq_f32(a.value, b.value)}; }
+inline FloatLanes   operator*(FloatLanes a, FloatLanes b)           { return {vmulq_f32(a.value, b.value)}; }
+inline FloatLanes   operator/(FloatLanes a, FloatLanes b)           { return {vdivq_f32(a.value, b.value)}; }
+inline FloatLanes   minLanes(FloatLanes a, FloatLanes b)            { return {vminq_f32(a.value, b.value)}; }
+inline FloatLanes   maxLanes(FloatLanes a, FloatLanes b)            { return {vmaxq_f32(a.value, b.value)}; }
+inline FloatLanes   sqrtLanes(FloatLanes a)                         { return {vsqrtq_f32(a.value)}; }
+inline FloatLanes   absLanes(FloatLanes a)                          { return {vabsq_f32(a.value)}; }
+
+inline MaskLanes    operator<(FloatLanes a, FloatLanes b)           { return {vcltq_f32(a.value, b.value)}; }
+inline MaskLanes    operator<=(FloatLanes a, FloatLanes b)          { return {vcleq_f32(a.value, b.value)}; }
+inline MaskLanes    operator>(FloatLanes a, FloatLanes b)           { return {vcgtq_f32(a.value, b.value)}; }
+inline MaskLanes    operator>=(FloatLanes a, FloatLanes b)          { return {vcgeq_f32(a.value, b.value)}; }
+inline MaskLanes    operator==(FloatLanes a, FloatLanes b)          { return {vceqq_f32(a.value, b.value)}; }
+
+inline MaskLanes    operator&(MaskLanes a, MaskLanes b)             { return {vandq_u32(a.value, b.value)}; }
+inline MaskLanes    operator|(MaskLanes a, MaskLanes b)             { return {vorrq_u32(a.value, b.value)}; }
+inline MaskLanes    operator!(MaskLanes a)                          { return {vmvnq_u32(a.value)}; }
+
+inline FloatLanes   selectLanes(MaskLanes m, FloatLanes a, FloatLanes b) { return {vbslq_f32(m.value, a.value, b.value)}; }
+
+// NEON has no movemask, so each lane keeps its own bit of the mask and the lanes are added together
+inline unsigned int maskBits(MaskLanes m)
+{
+   const std::uint32_t bitOfEachLane[4] = {1, 2, 4, 8};
+   return vaddvq_u32(vandq_u32(m.value, vld1q_u32(bitOfEachLane)));
+}
+
+// Reads one byte per lane, so that flags that are packed into bytes can be turned into masks without going through memory one lane at a time
+inline MaskLanes    testBitOfLanes(const std::uint8_t* bytes, std::uint8_t bit)
+{
+   std::uint32_t bytesOfLanes;
+   std::memcpy(&bytesOfLanes, bytes, sizeof(bytesOfLanes));
+
+   uint32x4_t lanes = vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(bytesOfLanes)))));
+   return {vtstq_u32(lanes, vdupq_n_u32(bit))};
+}
+
+}
+
+#else
+
+inline namespace FloatLanesScalar
+{
+
+const unsigned int floatLanesWidth = 1;
+
+struct FloatLanes { float value; };
+struct MaskLanes  { bool  value; };
+
+inline FloatLanes   loadLanes(const float* src)                     { return {*src}; }
+inline void         storeLanes(float* dst, FloatLanes a)            { *dst = a.value; }
+inline FloatLanes   broadcastLanes(float a)                         { return {a}; }
+
+inline FloatLanes   operator+(FloatLanes a, FloatLanes b)           { return {a.value + b.value}; }
+inline FloatLanes   operator-(FloatLanes a, FloatLanes b)           { return {a.value - b.value}; }
+inline FloatLanes   operator*(FloatLanes a, FloatLanes b)           { return {a.value * b.value}; }
+inline FloatLanes   operator/(FloatLanes a, FloatLanes b)           { return {a.value / b.value}; }
+inline FloatLanes   minLanes(FloatLanes a, FloatLanes b)            { return {b.value < a.value ? b.value : a.value}; }
+inline FloatLanes   maxLanes(FloatLanes a, FloatLanes b)            { return {b.value > a.value ? b.value : a.value}; }
+inline FloatLanes   sqrtLanes(FloatLanes a)                         { return {std::sqrt(a.value)}; }
+inline FloatLanes   absLanes(FloatLanes a)                          { return {std::fabs(a.value)}; }
+
+inline MaskLanes    operator<(FloatLanes a, FloatLanes b)           { return {a.value < b.value}; }
+inline MaskLanes    operator<=(FloatLanes a, FloatLanes b)          { return {a.value <= b.value}; }
+inline MaskLanes    operator>(FloatLanes a, FloatLanes b)           { return {a.value > b.value}; }
+inline MaskLanes    operator>=(FloatLanes a, FloatLanes b)          { return {a.value >= b.value}; }
+inline MaskLanes    operator==(FloatLanes a, FloatLanes b)          { return {a.value == b.value}; }
+
+inline MaskLanes    operator&(MaskLanes a, MaskLanes b)             { return {a.value && b.value}; }
+inline MaskLanes    operator|(MaskLanes a, MaskLanes b)             { return {a.value || b.value}; }
+inline MaskLanes    operator!(MaskLanes a)                          { return {!a.value}; }
+
+inline FloatLanes   selectLanes(MaskLanes m, FloatLanes a, FloatLanes b) { return {m.value ? a.value : b.value}; }
+inline unsigned int maskBits(MaskLanes m)                           { return m.value ? 1u : 0u; }
+inline MaskLanes    testBitOfLanes(const std::uint8_t* bytes, std::uint8_t bit) { return {(*bytes & bit) != 0}; }
+
+}
+
+#endif
+
+inline FloatLanes   operator-(FloatLanes a)                         { return broadcastLanes(0.0f) - a; }
+inline bool         anyLanes(MaskLanes m)                           { return maskBits(m) != 0; }
+inline FloatLanes   clampLanes(FloatLanes a, FloatLanes minValue, FloatLanes maxValue) { return minLanes(maxLanes(a, minValue), maxValue); }
+
+#endif
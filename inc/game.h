@@ -13,12 +13,16 @@
 #include "window.h"
 #include "state.h"
 #include "finite_state_machine.h"
+#include "shared_state_channel.h"
+#include "texture_streamer.h"
+
+class PlayState;
 
 class Game
 {
 public:
 
-   Game();
+   Game(float updatesPerSecond = 240.0f, unsigned int maxNumberOfUpdatesPerFrame = 60);
    ~Game();
 
    Game(const Game&) = delete;
@@ -32,6 +36,10 @@ public:
 
 private:
 
+   void  loadModels();
+
+   void  publishState();
+
    std::shared_ptr<FiniteStateMachine>     mFSM;
 
    std::shared_ptr<Window>                 mWindow;
@@ -42,6 +50,9 @@ private:
 
    std::shared_ptr<Renderer2D>             mRenderer2D;
 
+   // Uploads the textures of the models over several frames, so that loading them never stalls a frame
+   std::shared_ptr<TextureStreamer>        mTextureStreamer;
+
    ResourceManager<Model>                  mModelManager;
    ResourceManager<Texture>                mTextureManager;
    ResourceManager<Shader>                 mShaderManager;
@@ -54,6 +65,16 @@ private:
    std::shared_ptr<GameObject3D>           mPoint;
    std::shared_ptr<GameObject3D>           mLeftPaddleWins;
    std::shared_ptr<GameObject3D>           mRightPaddleWins;
+
+   // External bots and tools follow the game and control its paddles through this channel
+   std::shared_ptr<SharedStateChannel>     mStateChannel;
+   std::shared_ptr<PlayState>              mPlayState;
+
+   double                                  mFixedDeltaTime;
+   unsigned int                            mMaxNumberOfUpdatesPerFrame;
+
+   // How long the updates of a frame may take in total, which the physics sub-steps of each update are budgeted from
+   double                                  mSimulationBudgetPerFrame;
 };
 
 #endif
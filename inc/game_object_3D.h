@@ -25,18 +25,22 @@ public:
    GameObject3D& operator=(GameObject3D&& rhs) noexcept;
 
    void      render(const Shader& shader) const;
+   void      render(const Shader& shader, float interpolationFactor) const;
 
    glm::vec3 getPosition() const;
    void      setPosition(const glm::vec3& position);
 
    float     getScalingFactor() const;
 
+   glm::mat4 getRotationMatrix() const;
    void      setRotationMatrix(const glm::mat4& rotationMatrix);
 
    void      translate(const glm::vec3& translation);
    void      rotate(float angleOfRotInDeg, const glm::vec3& axisOfRot);
    void      scale(float scalingFactor);
 
+   void      savePreviousTransform();
+
 private:
 
    void      calculateModelMatrix() const;
@@ -49,6 +53,9 @@ private:
 
    mutable glm::mat4      mModelMatrix;
    mutable bool           mCalculateModelMatrix;
+
+   glm::vec3              mPreviousPosition;
+   glm::mat4              mPreviousRotationMatrix;
 };
 
 #endif
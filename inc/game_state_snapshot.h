@@ -0,0 +1,26 @@
+#ifndef GAME_STATE_SNAPSHOT_H
+#define GAME_STATE_SNAPSHOT_H
+
+#include <type_traits>
+
+#include "match_state.h"
+
+// Everything that PlayState needs to continue a match from a given frame
+// Snapshots are plain data, so they can be saved and restored with a single memcpy
+struct GameStateSnapshot
+{
+   // Flags, scores, ball and paddles (including the velocity and spin of the ball) and the state of the random number generator
+   MatchState    match;
+
+   // The rotation of the ball isn't part of the simulation, but it's part of what the player sees
+   glm::mat4     ballRotationMatrix;
+
+   // Used to avoid playing the sound of a collision more than once per second
+   double        timeWhenSoundOfCollisionWasLastPlayed;
+
+   std::uint64_t frameNumber;
+};
+
+static_assert(std::is_trivially_copyable<GameStateSnapshot>::value, "GameStateSnapshot must be trivially copyable");
+
+#endif
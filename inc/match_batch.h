@@ -0,0 +1,83 @@
+#ifndef MATCH_BATCH_H
+#define MATCH_BATCH_H
+
+#include <vector>
+
+#include "match_simulation.h"
+
+// Simulates many independent matches that share the same configuration
+// The state of the matches is stored as a structure of arrays, so that the rules can be applied to several matches with each SIMD instruction (see float_lanes.h)
+
+class MatchBatch
+{
+public:
+
+   MatchBatch(const MatchConfiguration& configuration, std::size_t numberOfMatches, std::uint64_t seed);
+   ~MatchBatch() = default;
+
+   MatchBatch(const MatchBatch&) = default;
+   MatchBatch& operator=(const MatchBatch&) = default;
+
+   MatchBatch(MatchBatch&&) = default;
+   MatchBatch& operator=(MatchBatch&&) = default;
+
+   // Events packed into a single byte per match
+   enum PackedMatchEvent : std::uint8_t
+   {
+      BallWasReleased    = 1 << 0,
+      BallBouncedOffWall = 1 << 1,
+      BallHitLeftPaddle  = 1 << 2,
+      BallHitRightPaddle = 1 << 3,
+      PointWasScored     = 1 << 4,
+      SceneWasReset      = 1 << 5,
+      MatchIsOver        = 1 << 6
+   };
+
+   // Advances every match by deltaTime
+   // Matches that are over are frozen, and groups of floatLanesWidth matches that are all over are skipped, so the cost of a step shrinks as matches finish
+   // packedInputs must contain one byte per match (see PackedMatchInput), and packedEvents, which can be null, receives one byte per match (see PackedMatchEvent)
+   void        step(const std::uint8_t* packedInputs, float deltaTime, std::uint8_t* packedEvents);
+
+   void        startNewMatch(std::size_t index);
+
+   MatchState  getState(std::size_t index) const;
+   void        setState(std::size_t index, const MatchState& state);
+
+   std::size_t getNumberOfMatches() const;
+
+   const MatchConfiguration& getConfiguration() const;
+
+private:
+
+   void        stepLanes(std::size_t first, const std::uint8_t* inputsOfLanes, float deltaTime, std::uint8_t* packedEvents);
+
+   void        resetScene(std::size_t index);
+
+   MatchConfiguration         mConfiguration;
+
+   std::size_t                mNumberOfMatches;
+
+   // The arrays are padded to a multiple of the SIMD width, and the padding is simulated like any other match that is over
+   std::vector<float>         mBallPositionX;
+   std::vector<float>         mBallPositionY;
+   std::vector<float>         mBallPositionZ;
+   std::vector<float>         mBallVelocityX;
+   std::vector<float>         mBallVelocityY;
+   std::vector<float>         mBallVelocityZ;
+   std::vector<float>         mBallRadius;
+   std::vector<float>         mBallSpinAngularVelocityScaledByBounce;
+
+   std::vector<float>         mLeftPaddlePositionY;
+   std::vector<float>         mRightPaddlePositionY;
+
+   // Flags are stored as 0.0f or 1.0f, and scores are stored as whole numbers, so that they can be loaded into the same registers as everything else
+   std::vector<float>         mBallIsInPlay;
+   std::vector<float>         mBallIsFalling;
+   std::vector<float>         mMatchIsOver;
+   std::vector<float>         mPointsScoredByLeftPaddle;
+   std::vector<float>         mPointsScoredByRightPaddle;
+
+   std::vector<std::uint64_t> mRandomNumberGeneratorStates;
+};
+
+#endif
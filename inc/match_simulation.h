@@ -0,0 +1,227 @@
+#ifndef MATCH_SIMULATION_H
+#define MATCH_SIMULATION_H
+
+#include <array>
+
+#include "match_state.h"
+#include "numeric_policy.h"
+
+// The numbers that the rules of a match calculate with (see numeric_policy.h)
+// Fixed-point matches give the same results on every build, which replays and lockstep sessions between different builds need,
+// while floating-point ones are faster but can change with the compiler, its flags and the instruction set
+enum class MatchArithmetic : std::uint8_t
+{
+   FloatingPoint,
+   FixedPoint
+};
+
+struct MatchConfiguration
+{
+   MatchConfiguration();
+   ~MatchConfiguration() = default;
+
+   MatchConfiguration(const MatchConfiguration&) = default;
+   MatchConfiguration& operator=(const MatchConfiguration&) = default;
+
+   MatchConfiguration(MatchConfiguration&&) = default;
+   MatchConfiguration& operator=(MatchConfiguration&&) = default;
+
+   BallState       initialBall;
+   PaddleState     initialLeftPaddle;
+   PaddleState     initialRightPaddle;
+
+   float           verticalRange;
+   float           horizontalRange;
+   float           lengthOfLineTraversedByPaddles;
+
+   float           scaleOfHorizontalVelocityInFreeFall;
+   float           verticalVelocityInFreeFall;
+   float           heightBelowWhichSceneIsReset;
+
+   unsigned int    maxNumberOfContactsPerStep;
+
+   unsigned int    pointsNeededToWin;
+
+   MatchArithmetic arithmetic;
+};
+
+// The rules of a match, written once for any numeric policy
+// The state of the match is always stored as floats so that everything else can use it, but the parts that change during a rally are kept in
+// the numbers of the policy between steps (see Rally), and only converted into floats after every step and back when a state is loaded
+// Every float that a fixed-point match stores is converted back into the same fixed-point number, except for the lowest bit of speeds above 256,
+// which is rounded the same way on every build, so fixed-point matches that are restored from a stored state stay bit-identical on every build,
+// although a match that is restored while its ball is faster than that can differ in that bit from the match that stored it
+// The spin of the ball only affects how it's rendered, but it's simulated with the numbers of the policy too, so that the states of fixed-point matches can be compared bit for bit
+template<typename NumericPolicy>
+class MatchRules
+{
+public:
+
+   using Number = typename NumericPolicy::Number;
+   using Vector = NumericVector<Number>;
+
+   // The parts of the state that change while the ball is in play, in the numbers of the policy
+   struct Rally
+   {
+      Vector positionOfBall;
+      Vector velocityOfBall;
+      Number heightOfBall;
+      Number verticalVelocityOfBall;
+      Number spinAngularVelocityScaledByBounce;
+      Number positionYOfLeftPaddle;
+      Number positionYOfRightPaddle;
+   };
+
+   explicit MatchRules(const MatchConfiguration& configuration);
+   ~MatchRules() = default;
+
+   MatchRules(const MatchRules&) = default;
+   MatchRules& operator=(const MatchRules&) = default;
+
+   MatchRules(MatchRules&&) = default;
+   MatchRules& operator=(MatchRules&&) = default;
+
+   // See MatchSimulation::step
+   // The rally must have been loaded from the state, and it's stored into the state again at the end of the step
+   MatchEvents  step(Rally& rally, MatchState& state, const MatchInputs& inputs, float deltaTime, unsigned int numberOfSubsteps) const;
+
+   Rally        loadRally(const MatchState& state) const;
+   void         storeRally(const Rally& rally, MatchState& state) const;
+
+   // The rules below are shared with the code that simulates balls outside of a match (e.g. MultiBallSimulation)
+
+   static void  bounceBallOffWall(Vector& velocityOfBall, Number& spinAngularVelocityScaledByBounce, Number spinAngularVelocity);
+
+   static void  resolveCollisionBetweenBallAndPaddle(Vector& positionOfBall,
+                                                     Vector& velocityOfBall,
+                                                     Number  radiusOfBall,
+                                                     Number  initialVelocityOfBallY,
+                                                     Number  positionYOfPaddle,
+                                                     Number  halfHeightOfPaddle,
+                                                     Number  velocityYOfPaddle,
+                                                     Vector  vecFromCenterOfCircleToPointOfCollision);
+
+   static Vector calculateServeVelocity(Number speedOfServe, unsigned int serveDirection);
+
+private:
+
+   // The parts of a paddle that never change during a match
+   struct PaddleShape
+   {
+      Number positionX;
+      Number halfWidth;
+      Number halfHeight;
+      Number speed;
+   };
+
+   MatchEvents  stepOnce(Rally& rally, MatchState& state, const MatchInputs& inputs, Number deltaTime) const;
+
+   void         movePaddle(Number& positionY, const PaddleShape& shape, const PaddleInput& input, Number deltaTime) const;
+
+   void         moveBallAcrossTable(Rally& rally, Number positionYOfLeftPaddleAtStart, Number positionYOfRightPaddleAtStart, Number deltaTime, MatchEvents& events) const;
+
+   void         finishMovingPaddle(const Rally& rally, Vector& centerOfPaddle, Vector halfExtentsOfPaddle, Number remainingDisplacement) const;
+
+   static bool  ballIsMovingIntoPaddle(Vector velocityOfBall, Number velocityYOfPaddle, Vector vecFromCenterOfCircleToPointOfCollision);
+
+   unsigned int          mMaxNumberOfContactsPerStep;
+   unsigned int          mPointsNeededToWin;
+
+   // The configuration converted into the numbers of the policy
+   Rally                 mInitialRally;
+   std::array<Vector, 4> mServeVelocities;
+   Number                mRadiusOfBall;
+   Number                mInitialVelocityOfBallY;
+   Number                mSpinAngularVelocity;
+   PaddleShape           mLeftPaddle;
+   PaddleShape           mRightPaddle;
+   Number                mHalfVerticalRange;
+   Number                mHalfHorizontalRange;
+   Number                mHalfLengthOfLineTraversedByPaddles;
+   Number                mScaleOfHorizontalVelocityInFreeFall;
+   Number                mVerticalVelocityInFreeFall;
+   Number                mHeightBelowWhichSceneIsReset;
+};
+
+// Simulates a match with the rules of the numeric policy chosen by its configuration
+class MatchSimulation
+{
+public:
+
+   MatchSimulation(const MatchConfiguration& configuration, std::uint64_t seed);
+   ~MatchSimulation() = default;
+
+   MatchSimulation(const MatchSimulation&) = default;
+   MatchSimulation& operator=(const MatchSimulation&) = default;
+
+   MatchSimulation(MatchSimulation&&) = default;
+   MatchSimulation& operator=(MatchSimulation&&) = default;
+
+   MatchEvents               step(const MatchInputs& inputs, float deltaTime);
+
+   // Splits the tick into sub-steps of equal length, so that fast balls move in smaller increments
+   // The remaining sub-steps are skipped if the scene is reset, so that a ball can't be served in the same tick in which a point was scored
+   MatchEvents               step(const MatchInputs& inputs, float deltaTime, unsigned int numberOfSubsteps);
+
+   void                      startNewMatch();
+   void                      resetScene();
+
+   const MatchState&         getState() const;
+   void                      setState(const MatchState& state);
+
+   const MatchConfiguration& getConfiguration() const;
+
+   // Calculated with the numbers of the rules, so that lockstep sessions between different builds split their ticks in the same way
+   unsigned int              calculateNumberOfSubstepsNeeded(float deltaTime, unsigned int maxNumberOfSubsteps) const;
+
+private:
+
+   // Loads the rally of the arithmetic of the configuration from the state, which must be done whenever anything other than the rules changes the state
+   void                                       loadRally();
+
+   MatchConfiguration                         mConfiguration;
+
+   // Only the rules of the arithmetic of the configuration are used
+   MatchRules<FloatNumericPolicy>             mFloatingPointRules;
+   MatchRules<FixedPointNumericPolicy>        mFixedPointRules;
+
+   MatchState                                 mState;
+
+   // Only the rally of the arithmetic of the configuration is kept in sync with the state
+   MatchRules<FloatNumericPolicy>::Rally      mFloatingPointRally;
+   MatchRules<FixedPointNumericPolicy>::Rally mFixedPointRally;
+};
+
+// The floating-point rules in a form that operates on plain data, so that they can be shared by every piece of code that simulates balls outside of a match
+
+// Bounces the ball off of a top or bottom wall
+void         bounceBallOffWall(BallState& ball);
+// Treats the paddle as if it were standing still
+void         resolveCollisionBetweenBallAndPaddle(BallState& ball, const PaddleState& paddle, const glm::vec2& vecFromCenterOfCircleToPointOfCollision);
+
+// Inputs packed into a single byte, for code that needs to store or stream them compactly
+
+enum PackedMatchInput : std::uint8_t
+{
+   LeftPaddleMovesUp    = 1 << 0,
+   LeftPaddleMovesDown  = 1 << 1,
+   RightPaddleMovesUp   = 1 << 2,
+   RightPaddleMovesDown = 1 << 3,
+   BallIsReleased       = 1 << 4
+};
+
+std::uint8_t packMatchInputs(const MatchInputs& inputs);
+MatchInputs  unpackMatchInputs(std::uint8_t packedInputs);
+
+// The three most significant bits of a packed input store the number of sub-steps in which the tick was simulated minus 1,
+// so inputs that were packed without them are simulated in a single step
+const unsigned int maxNumberOfSubstepsPerTick = 8;
+
+std::uint8_t packNumberOfSubsteps(unsigned int numberOfSubsteps);
+unsigned int unpackNumberOfSubsteps(std::uint8_t packedInputs);
+
+std::uint64_t drawRandomNumber(std::uint64_t& randomNumberGeneratorState);
+unsigned int  drawServeDirection(std::uint64_t& randomNumberGeneratorState);
+glm::vec3     calculateServeVelocity(const BallState& ball, unsigned int serveDirection);
+
+#endif
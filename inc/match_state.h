@@ -0,0 +1,69 @@
+#ifndef MATCH_STATE_H
+#define MATCH_STATE_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+// The structs in this file only contain plain data, so that the state of a match can be copied, stored and simulated without a window, an OpenGL context or a sound engine
+
+struct BallState
+{
+   glm::vec3 position;
+   glm::vec3 velocity;
+   glm::vec3 initialVelocity;
+   float     radius;
+   float     spinAngularVelocity;
+   float     spinAngularVelocityScaledByBounce;
+};
+
+struct PaddleState
+{
+   glm::vec3 position;
+   glm::vec3 velocity;
+   float     width;
+   float     height;
+};
+
+struct MatchState
+{
+   BallState     ball;
+   PaddleState   leftPaddle;
+   PaddleState   rightPaddle;
+
+   bool          ballIsInPlay;
+   bool          ballIsFalling;
+   bool          matchIsOver;
+
+   unsigned int  pointsScoredByLeftPaddle;
+   unsigned int  pointsScoredByRightPaddle;
+
+   std::uint64_t randomNumberGeneratorState;
+};
+
+struct PaddleInput
+{
+   bool moveUp;
+   bool moveDown;
+};
+
+struct MatchInputs
+{
+   PaddleInput leftPaddle;
+   PaddleInput rightPaddle;
+   bool        releaseBall;
+};
+
+struct MatchEvents
+{
+   bool         ballWasReleased;
+   bool         ballBouncedOffWall;
+   bool         ballHitLeftPaddle;
+   bool         ballHitRightPaddle;
+   bool         pointWasScored;
+   bool         sceneWasReset;
+   bool         matchIsOver;
+   unsigned int serveDirection;
+};
+
+#endif
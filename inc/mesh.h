@@ -171,6 +171,13 @@ public:
    Mesh(const std::vector<Vertex>&       vertices,
         const std::vector<unsigned int>& indices,
         const Material&                  material);
+
+   // Creates a mesh from vertices that are laid out like Vertex, such as the ones in a cooked mesh file, without copying them first
+   Mesh(const void*         vertices,
+        unsigned int        numVertices,
+        const unsigned int* indices,
+        unsigned int        numIndices,
+        const Material&     material);
    ~Mesh();
 
    Mesh(const Mesh&) = delete;
@@ -183,7 +190,7 @@ public:
 
 private:
 
-   void configureVAO(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+   void configureVAO(const void* vertices, unsigned int numVertices, const unsigned int* indices, unsigned int numIndices);
 
    void bindMaterialTextures(const Shader& shader) const;
    void setMaterialTextureAvailabilities(const Shader& shader) const;
@@ -0,0 +1,15 @@
+#ifndef MESH_COOKER_H
+#define MESH_COOKER_H
+
+#include <string>
+
+#include "cooked_mesh.h"
+
+// Imports a model with Assimp and writes its meshes into a .tpmesh file, in the same order and with the same vertices as ModelLoader
+// It doesn't depend on OpenGL, so it's shared by the game, which cooks the models whose cooked files are missing or out of date, and by teapong_cooker
+bool cookModel(const std::string& modelFilePath, const std::string& cookedFilePath);
+
+// Imports a model into the contents of a cooked file without writing it, for when the cooked file can't be written
+bool importModel(const std::string& modelFilePath, CookedMeshContents& contents);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef MIP_GENERATOR_H
+#define MIP_GENERATOR_H
+
+#include <vector>
+
+#include "thread_pool.h"
+
+enum class MipFilter
+{
+   // Averages the texels covered by each texel of the next level, which is what glGenerateMipmap does on most drivers
+   box,
+
+   // Windowed sinc, which keeps the mipmaps sharper than the box filter without aliasing
+   kaiser
+};
+
+enum class TextureColorSpace
+{
+   // Colors, whose color channels are filtered in linear space so that the mipmaps don't get darker than the texture
+   sRGB,
+
+   // Data that isn't a color (e.g. the intensity of a specular map), whose channels are filtered as they are
+   linear
+};
+
+// A level of a mip chain, with 4 bytes per texel (RGBA)
+struct MipLevel
+{
+   unsigned int               width;
+   unsigned int               height;
+   std::vector<unsigned char> rgbaTexels;
+};
+
+// Generates every level below the given one, down to 1x1, each one from the level above it
+// The color channels are converted according to the color space of the texture before they are filtered, while alpha is always filtered as it is
+// Each level is filtered vertically and then horizontally with FloatLanes, so the generator uses the widest SIMD instructions that it's compiled with
+// When threads are given, the rows of each level are split across them, so this must not be called from one of their tasks
+std::vector<MipLevel> generateMipChain(const unsigned char* rgbaTexels,
+                                       unsigned int         width,
+                                       unsigned int         height,
+                                       MipFilter            filter,
+                                       TextureColorSpace    colorSpace,
+                                       ThreadPool*          threads = nullptr);
+
+#endif
@@ -1,10 +1,67 @@
 #ifndef MODEL_LOADER_H
 #define MODEL_LOADER_H
 
-#include <unordered_map>
+#include <array>
 
+#include "cooked_mesh.h"
 #include "model.h"
 #include "resource_manager.h"
+#include "texture_loader.h"
+#include "texture_streamer.h"
+
+// A mesh whose vertices and indices are ready to be given to OpenGL
+// They point into the cooked file of the model, or into the contents that were imported when the cooked file couldn't be read
+struct StagedMesh
+{
+   const void*                                         vertices;
+   unsigned int                                        numVertices;
+   const unsigned int*                                 indices;
+   unsigned int                                        numIndices;
+   CookedMaterial                                      material;
+
+   // Empty if the material doesn't have a texture of a given type
+   std::array<std::string, numberOfCookedTextureTypes> texFilenames;
+};
+
+struct StagedTexture
+{
+   std::string    texFilename;
+   std::string    texFilePath;
+   DecodedTexture decodedTexture;
+};
+
+// Everything that is needed to create a model, read and decoded without touching OpenGL
+// Staging can be done on any thread, while the model has to be created on the thread that owns the OpenGL context
+struct StagedModel
+{
+   StagedModel()
+      : wasStaged(false)
+      , wasCooked(false)
+      , secondsSpentStagingMeshes(0.0)
+   {
+
+   }
+
+   ~StagedModel() = default;
+
+   StagedModel(const StagedModel&) = delete;
+   StagedModel& operator=(const StagedModel&) = delete;
+
+   StagedModel(StagedModel&&) = default;
+   StagedModel& operator=(StagedModel&&) = default;
+
+   std::string                     modelFilePath;
+   std::unique_ptr<CookedMeshFile> cookedFile;
+   CookedMeshContents              importedContents;
+   std::vector<StagedMesh>         meshes;
+
+   // One per texture referenced by the meshes, without duplicates
+   std::vector<StagedTexture>      textures;
+
+   bool                            wasStaged;
+   bool                            wasCooked;
+   double                          secondsSpentStagingMeshes;
+};
 
 class ModelLoader
 {
@@ -19,23 +76,28 @@ public:
    ModelLoader(ModelLoader&&) = default;
    ModelLoader& operator=(ModelLoader&&) = default;
 
+   // Stages the model and decodes its textures on the calling thread, and then creates it
    std::shared_ptr<Model>    loadResource(const std::string& modelFilePath) const;
 
-private:
+   // Creates a model that was staged with stageResource and whose textures were decoded with TextureLoader::decodeTexture
+   // Only the uploads to OpenGL are done here, so this is the only part of loading a model that has to be done on the thread that owns the context
+   std::shared_ptr<Model>    loadResource(StagedModel&& stagedModel) const;
 
-   void                      processNodeHierarchyRecursively(const aiNode*             node,
-                                                             const aiScene*            scene,
-                                                             const std::string&        modelDir,
-                                                             ResourceManager<Texture>& texManager,
-                                                             std::vector<Mesh>&        meshes) const;
+   // Same as above, except that the textures are handed to a streamer, so the model shows placeholders until they are uploaded
+   std::shared_ptr<Model>    loadResource(StagedModel&& stagedModel, TextureStreamer& texStreamer) const;
 
-   std::vector<Vertex>       processVertices(const aiMesh* mesh) const;
+   // Maps the cooked .tpmesh file of the model, which is cooked again first if it's missing or older than the model, and lists the textures it needs
+   // The model is only imported with Assimp into memory if the cooked file can't be written or read
+   // The textures are listed but not decoded, so that they can be decoded in parallel with TextureLoader::decodeTexture
+   // Can be called from any thread
+   bool                      stageResource(const std::string& modelFilePath, StagedModel& stagedModel) const;
+
+private:
 
-   std::vector<unsigned int> processIndices(const aiMesh* mesh) const;
+   std::shared_ptr<Model>    createModel(StagedModel& stagedModel, ResourceManager<Texture>&& texManager) const;
 
-   Material                  processMaterial(const aiMaterial*         material,
-                                             const std::string&        modelDir,
-                                             ResourceManager<Texture>& texManager) const;
+   Material                  processStagedMaterial(const StagedMesh&         mesh,
+                                                   ResourceManager<Texture>& texManager) const;
 };
 
 #endif
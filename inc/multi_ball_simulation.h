@@ -0,0 +1,64 @@
+#ifndef MULTI_BALL_SIMULATION_H
+#define MULTI_BALL_SIMULATION_H
+
+#include <vector>
+
+#include "match_simulation.h"
+#include "spatial_hash.h"
+
+// Simulates many balls at once on the table of a match, bouncing off the walls, the paddles and each other
+// The balls are bucketed into a spatial hash on every step, so the cost of a step grows linearly with the number of balls instead of quadratically
+// Balls that leave the table score a point for the paddle on the other side and are served again from the center
+
+struct MultiBallEvents
+{
+   unsigned int numberOfCandidatePairs;
+   unsigned int numberOfContactsBetweenBalls;
+   unsigned int numberOfContactsBetweenBallsAndPaddles;
+   unsigned int pointsScoredByLeftPaddle;
+   unsigned int pointsScoredByRightPaddle;
+};
+
+class MultiBallSimulation
+{
+public:
+
+   MultiBallSimulation(const MatchConfiguration& configuration, float radiusOfBalls, std::uint64_t seed);
+   ~MultiBallSimulation() = default;
+
+   MultiBallSimulation(const MultiBallSimulation&) = default;
+   MultiBallSimulation& operator=(const MultiBallSimulation&) = default;
+
+   MultiBallSimulation(MultiBallSimulation&&) = default;
+   MultiBallSimulation& operator=(MultiBallSimulation&&) = default;
+
+   // Adds balls at random positions on the table, moving in random directions at the speed of a serve
+   void                          spawnBalls(std::size_t numberOfBalls);
+   void                          removeBalls();
+
+   // The paddles are owned by the caller (e.g. by the MatchSimulation of the match that is being played)
+   MultiBallEvents               step(const PaddleState& leftPaddle, const PaddleState& rightPaddle, float deltaTime);
+
+   const std::vector<BallState>& getBalls() const;
+
+private:
+
+   void                          serveBallFromCenter(BallState& ball);
+   void                          placeBall(BallState& ball, const glm::vec2& position, const glm::vec2& direction) const;
+   float                         drawUniform(float minValue, float maxValue);
+
+   void                          bounceBallOffWalls(BallState& ball) const;
+   void                          resolveCollisionBetweenBalls(BallState& a, BallState& b) const;
+
+   MatchConfiguration                                   mConfiguration;
+   float                                                mRadiusOfBalls;
+   float                                                mSpeedOfBalls;
+   std::uint64_t                                        mRandomNumberGeneratorState;
+
+   std::vector<BallState>                               mBalls;
+
+   SpatialHash                                          mBroadPhase;
+   std::vector<std::pair<std::uint32_t, std::uint32_t>> mCandidatePairs;
+};
+
+#endif
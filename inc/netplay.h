@@ -0,0 +1,204 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include "rollback_session.h"
+
+// Plays a RollbackSession against a remote player over UDP
+// Every packet carries all the local inputs that the remote player hasn't acknowledged yet, so a lost packet is covered by the next one
+// and no packet is ever sent again; packets also carry the frame of the sender, which both players use to keep their frames close together,
+// and the checksum of a confirmed state, which detects when the two simulations have diverged
+// The sockets are POSIX sockets, so this is kept out of the simulation library
+
+// Sends and receives whole datagrams without blocking
+class DatagramTransport
+{
+public:
+
+   DatagramTransport() = default;
+   virtual ~DatagramTransport() = default;
+
+   DatagramTransport(const DatagramTransport&) = delete;
+   DatagramTransport& operator=(const DatagramTransport&) = delete;
+
+   DatagramTransport(DatagramTransport&&) = delete;
+   DatagramTransport& operator=(DatagramTransport&&) = delete;
+
+   virtual bool send(const std::uint8_t* bytes, std::size_t numberOfBytes) = 0;
+
+   // Returns false when no datagram is waiting
+   virtual bool receive(std::vector<std::uint8_t>& bytes) = 0;
+};
+
+class UdpTransport : public DatagramTransport
+{
+public:
+
+   UdpTransport();
+   ~UdpTransport();
+
+   UdpTransport(const UdpTransport&) = delete;
+   UdpTransport& operator=(const UdpTransport&) = delete;
+
+   UdpTransport(UdpTransport&&) = delete;
+   UdpTransport& operator=(UdpTransport&&) = delete;
+
+   // Port 0 lets the system choose a free port, which getLocalPort returns
+   bool           open(unsigned short localPort);
+
+   // Datagrams that don't come from the remote address are ignored
+   bool           setRemoteAddress(const std::string& host, unsigned short port);
+
+   unsigned short getLocalPort() const;
+
+   bool           send(const std::uint8_t* bytes, std::size_t numberOfBytes) override;
+   bool           receive(std::vector<std::uint8_t>& bytes) override;
+
+private:
+
+   int              mSocket;
+   sockaddr_storage mRemoteAddress;
+   socklen_t        mSizeOfRemoteAddress;
+};
+
+struct NetworkConditions
+{
+   double latencyInSeconds;
+
+   // Every datagram is delayed by the latency plus a uniformly distributed amount between -jitter and +jitter, so datagrams can arrive out of order
+   double jitterInSeconds;
+
+   // Fraction of the datagrams that are dropped, between 0 and 1
+   double lossRate;
+};
+
+// Delays and drops the datagrams sent through another transport, so that the netplay can be tested on a single machine
+class ImpairedTransport : public DatagramTransport
+{
+public:
+
+   ImpairedTransport(DatagramTransport& transport, const NetworkConditions& conditions, std::uint64_t seed);
+   ~ImpairedTransport() = default;
+
+   ImpairedTransport(const ImpairedTransport&) = delete;
+   ImpairedTransport& operator=(const ImpairedTransport&) = delete;
+
+   ImpairedTransport(ImpairedTransport&&) = delete;
+   ImpairedTransport& operator=(ImpairedTransport&&) = delete;
+
+   // Sends the datagrams whose delay is over
+   void          setTime(double seconds);
+
+   bool          send(const std::uint8_t* bytes, std::size_t numberOfBytes) override;
+   bool          receive(std::vector<std::uint8_t>& bytes) override;
+
+   std::uint64_t getNumberOfDatagramsDropped() const;
+
+private:
+
+   struct DelayedDatagram
+   {
+      double                    timeOfDelivery;
+      std::vector<std::uint8_t> bytes;
+   };
+
+   double                       drawUniformNumber();
+
+   DatagramTransport&           mTransport;
+   NetworkConditions            mConditions;
+   std::uint64_t                mRandomNumberGeneratorState;
+   double                       mTime;
+   std::vector<DelayedDatagram> mDelayedDatagrams;
+   std::uint64_t                mNumberOfDatagramsDropped;
+};
+
+struct NetplayCounters
+{
+   std::uint64_t packetsSent;
+   std::uint64_t packetsReceived;
+   std::uint64_t packetsRejected;
+   std::uint64_t bytesSent;
+   std::uint64_t bytesReceived;
+
+   // Inputs that arrived again because a later packet repeated them
+   std::uint64_t redundantInputsReceived;
+
+   // Frames that the local player waited so that the remote player could catch up
+   std::uint64_t framesWaitedForTimeSync;
+
+   std::uint64_t checksumsCompared;
+};
+
+class NetplayPeer
+{
+public:
+
+   // Both players must use the same session identifier, which keeps packets from other matches out
+   NetplayPeer(RollbackSession& session, DatagramTransport& transport, std::uint32_t sessionIdentifier);
+   ~NetplayPeer() = default;
+
+   NetplayPeer(const NetplayPeer&) = delete;
+   NetplayPeer& operator=(const NetplayPeer&) = delete;
+
+   NetplayPeer(NetplayPeer&&) = delete;
+   NetplayPeer& operator=(NetplayPeer&&) = delete;
+
+   // Passes the remote inputs that have arrived to the session
+   void                   receivePackets();
+
+   // Sends the unacknowledged local inputs, and should be called once per frame, after the frame has been simulated or stalled
+   void                   sendPacket();
+
+   // Called once per frame, before the frame is simulated
+   // Returns true when the local player should skip the frame because it's running ahead of the remote player,
+   // which happens when one player started later or when the clock of one machine runs faster
+   bool                   shouldWaitForRemotePlayer();
+
+   // The local player's frame minus the latest frame received from the remote player, averaged over the last frames
+   float                  getLocalFrameAdvantage() const;
+   float                  getRemoteFrameAdvantage() const;
+
+   bool                   desyncWasDetected() const;
+   std::uint32_t          getFrameOfDesync() const;
+
+   const NetplayCounters& getCounters() const;
+
+private:
+
+   void                   processPacket(const std::vector<std::uint8_t>& bytes);
+   void                   updateChecksums();
+   void                   compareChecksums(std::uint32_t frame, std::uint64_t remoteChecksum);
+
+   RollbackSession&                                   mSession;
+   DatagramTransport&                                 mTransport;
+   std::uint32_t                                      mSessionIdentifier;
+
+   // The remote player has received every local input before this frame
+   std::uint32_t                                      mNumberOfLocalInputsAcknowledged;
+
+   std::uint32_t                                      mLatestRemoteFrame;
+   float                                              mLocalFrameAdvantage;
+   float                                              mRemoteFrameAdvantage;
+   unsigned int                                       mFramesUntilTimeSync;
+   unsigned int                                       mFramesLeftToWait;
+
+   // Checksums of the latest confirmed states, and the latest checksum received that couldn't be compared yet
+   std::deque<std::pair<std::uint32_t, std::uint64_t>> mLocalChecksums;
+   std::uint32_t                                      mNextFrameToChecksum;
+   std::uint32_t                                      mFrameOfPendingRemoteChecksum;
+   std::uint64_t                                      mPendingRemoteChecksum;
+   bool                                               mRemoteChecksumIsPending;
+   std::uint32_t                                      mLatestFrameCompared;
+   bool                                               mDesyncWasDetected;
+   std::uint32_t                                      mFrameOfDesync;
+
+   std::vector<std::uint8_t>                          mPacket;
+   NetplayCounters                                    mCounters;
+};
+
+#endif
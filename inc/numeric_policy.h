@@ -0,0 +1,60 @@
+#ifndef NUMERIC_POLICY_H
+#define NUMERIC_POLICY_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "fixed_point.h"
+
+// Numeric policies choose the type of number that the rules of a match (see MatchRules in match_simulation.h) calculate with
+// A policy provides the type itself, the conversions from and to the floats of the state and the configuration, and the functions that aren't operators
+
+// Fast, but the results can change with the compiler, its flags and the instruction set
+struct FloatNumericPolicy
+{
+   using Number = float;
+
+   static Number fromFloat(float value)                         { return value; }
+   static float  toFloat(Number value)                          { return value; }
+   static Number fromInt(int value)                             { return static_cast<float>(value); }
+   static Number abs(Number value)                              { return std::abs(value); }
+   static Number sqrt(Number value)                             { return std::sqrt(value); }
+   static Number sqrtOfSumOfSquares(Number a, Number b)         { return std::sqrt((a * a) + (b * b)); }
+   static Number sqrtOfDifferenceOfSquares(Number a, Number b)  { return std::sqrt(std::max((a * a) - (b * b), 0.0f)); }
+};
+
+// Bit-identical on every build, which is what replays and lockstep sessions between different builds need
+struct FixedPointNumericPolicy
+{
+   using Number = FixedPoint;
+
+   static Number fromFloat(float value)                         { return FixedPoint::fromFloat(value); }
+   static float  toFloat(Number value)                          { return value.toFloat(); }
+   static Number fromInt(int value)                             { return FixedPoint::fromInt(value); }
+   static Number abs(Number value)                              { return ::abs(value); }
+   static Number sqrt(Number value)                             { return ::sqrt(value); }
+   static Number sqrtOfSumOfSquares(Number a, Number b)         { return ::sqrtOfSumOfSquares(a, b); }
+   static Number sqrtOfDifferenceOfSquares(Number a, Number b)  { return ::sqrtOfDifferenceOfSquares(a, b); }
+};
+
+// A 2D vector of the numbers of a policy, with just the operations that the rules need
+template<typename Number>
+struct NumericVector
+{
+   Number x;
+   Number y;
+};
+
+template<typename Number>
+inline NumericVector<Number> operator+(NumericVector<Number> a, NumericVector<Number> b) { return {a.x + b.x, a.y + b.y}; }
+
+template<typename Number>
+inline NumericVector<Number> operator-(NumericVector<Number> a, NumericVector<Number> b) { return {a.x - b.x, a.y - b.y}; }
+
+template<typename Number>
+inline NumericVector<Number> operator*(NumericVector<Number> a, Number b)                { return {a.x * b, a.y * b}; }
+
+template<typename Number>
+inline Number                dot(NumericVector<Number> a, NumericVector<Number> b)       { return (a.x * b.x) + (a.y * b.y); }
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef OBSERVATION_RASTERIZER_H
+#define OBSERVATION_RASTERIZER_H
+
+#include <cstdint>
+
+#include "match_simulation.h"
+
+// Draws a top-down view of a match into a grayscale image, so that agents can learn from pixels without an OpenGL context
+// The image covers the table, with the top row at the top wall, and every object is drawn as the rectangle that bounds it
+// A pixel is filled if any part of it is covered, so that objects never disappear at low resolutions
+
+const unsigned int observationWidth  = 84;
+const unsigned int observationHeight = 84;
+
+const std::uint8_t intensityOfTable        = 32;
+const std::uint8_t intensityOfLeftPaddle   = 160;
+const std::uint8_t intensityOfRightPaddle  = 208;
+const std::uint8_t intensityOfBallInPlay   = 255;
+const std::uint8_t intensityOfFallingBall  = 96;
+
+// pixels must hold width * height bytes, stored row by row
+void rasterizeObservation(const MatchState& state, const MatchConfiguration& configuration, unsigned int width, unsigned int height, std::uint8_t* pixels);
+
+#endif
@@ -23,14 +23,6 @@ public:
    Paddle(Paddle&& rhs) noexcept;
    Paddle& operator=(Paddle&& rhs) noexcept;
 
-   enum class MovementDirection
-   {
-      Up,
-      Down,
-   };
-
-   void  moveAlongLine(float deltaTime, float lineLength, MovementDirection direction);
-
    float getWidth() const;
    float getHeight() const;
 
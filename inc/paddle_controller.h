@@ -0,0 +1,168 @@
+#ifndef PADDLE_CONTROLLER_H
+#define PADDLE_CONTROLLER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "match_simulation.h"
+
+// Paddle controllers decide how a paddle moves without a keyboard, so that matches can be played by the computer (e.g. in tournaments)
+
+enum class PaddleSide
+{
+   Left,
+   Right
+};
+
+class PaddleController
+{
+public:
+
+   PaddleController() = default;
+   virtual ~PaddleController() = default;
+
+   PaddleController(const PaddleController&) = delete;
+   PaddleController& operator=(const PaddleController&) = delete;
+
+   PaddleController(PaddleController&&) = delete;
+   PaddleController& operator=(PaddleController&&) = delete;
+
+   // Called before every match
+   // The seed is different for every match, so that controllers that make random decisions don't repeat themselves
+   virtual void        reset(PaddleSide side, std::uint64_t seed) = 0;
+
+   // Called once per step, before the step is simulated
+   virtual PaddleInput decide(const MatchState& state, const MatchConfiguration& configuration, float deltaTime) = 0;
+};
+
+// Sweeps the paddle from one end of its line to the other, regardless of where the ball is
+class ScriptedPaddleController : public PaddleController
+{
+public:
+
+   ScriptedPaddleController();
+   ~ScriptedPaddleController() = default;
+
+   ScriptedPaddleController(const ScriptedPaddleController&) = delete;
+   ScriptedPaddleController& operator=(const ScriptedPaddleController&) = delete;
+
+   ScriptedPaddleController(ScriptedPaddleController&&) = delete;
+   ScriptedPaddleController& operator=(ScriptedPaddleController&&) = delete;
+
+   void        reset(PaddleSide side, std::uint64_t seed) override;
+   PaddleInput decide(const MatchState& state, const MatchConfiguration& configuration, float deltaTime) override;
+
+private:
+
+   PaddleSide mSide;
+   bool       mIsMovingUp;
+};
+
+// Moves the paddle towards the ball when the ball approaches it, and back to the center of its line when the ball moves away from it
+// The paddle aims at a random point along its face on every rally, and ignores the ball when it is within the dead zone around that point
+class TrackingPaddleController : public PaddleController
+{
+public:
+
+   explicit TrackingPaddleController(float deadZone);
+   ~TrackingPaddleController() = default;
+
+   TrackingPaddleController(const TrackingPaddleController&) = delete;
+   TrackingPaddleController& operator=(const TrackingPaddleController&) = delete;
+
+   TrackingPaddleController(TrackingPaddleController&&) = delete;
+   TrackingPaddleController& operator=(TrackingPaddleController&&) = delete;
+
+   void        reset(PaddleSide side, std::uint64_t seed) override;
+   PaddleInput decide(const MatchState& state, const MatchConfiguration& configuration, float deltaTime) override;
+
+private:
+
+   PaddleSide    mSide;
+   float         mDeadZone;
+   float         mAimOffset;
+   bool          mBallWasApproaching;
+   std::uint64_t mRandomNumberGeneratorState;
+};
+
+enum class Difficulty
+{
+   Easy,
+   Medium,
+   Hard
+};
+
+// Moves the paddle to the point where the ball will reach it, which is predicted in closed form when the path of the ball changes
+// The planning is incremental: a new plan is only made after a serve, a bounce or a hit, so most steps only compare the velocity of the ball with the one that was last seen
+// The difficulty determines how long the controller takes to react to a new path, and how far from the predicted point it aims
+class ComputerPaddleController : public PaddleController
+{
+public:
+
+   explicit ComputerPaddleController(Difficulty difficulty);
+   ~ComputerPaddleController() = default;
+
+   ComputerPaddleController(const ComputerPaddleController&) = delete;
+   ComputerPaddleController& operator=(const ComputerPaddleController&) = delete;
+
+   ComputerPaddleController(ComputerPaddleController&&) = delete;
+   ComputerPaddleController& operator=(ComputerPaddleController&&) = delete;
+
+   void        reset(PaddleSide side, std::uint64_t seed) override;
+   PaddleInput decide(const MatchState& state, const MatchConfiguration& configuration, float deltaTime) override;
+
+   Difficulty  getDifficulty() const;
+   void        setDifficulty(Difficulty difficulty);
+
+private:
+
+   void        planInterception(const MatchState& state, const MatchConfiguration& configuration);
+
+   PaddleSide    mSide;
+   Difficulty    mDifficulty;
+
+   // Time between a change in the path of the ball and the moment the controller starts moving towards its new plan
+   float         mReactionDelay;
+
+   // Largest distance between the predicted point and the point that the controller aims at, and how much it grows with each bounce off the walls
+   float         mAimError;
+   float         mAimErrorPerBounce;
+
+   // The controller keeps moving towards its current target until it has reacted to the planned one
+   float         mCurrentTargetPositionY;
+   float         mPlannedTargetPositionY;
+   float         mTimeUntilReaction;
+
+   glm::vec2     mLastSeenVelocityOfBall;
+   bool          mBallWasOnTable;
+   std::uint64_t mRandomNumberGeneratorState;
+};
+
+// Plays back inputs that were recorded from a human player, looping when it reaches their end
+class ReplayedPaddleController : public PaddleController
+{
+public:
+
+   explicit ReplayedPaddleController(std::shared_ptr<const std::vector<PaddleInput>> recordedInputs);
+   ~ReplayedPaddleController() = default;
+
+   ReplayedPaddleController(const ReplayedPaddleController&) = delete;
+   ReplayedPaddleController& operator=(const ReplayedPaddleController&) = delete;
+
+   ReplayedPaddleController(ReplayedPaddleController&&) = delete;
+   ReplayedPaddleController& operator=(ReplayedPaddleController&&) = delete;
+
+   void        reset(PaddleSide side, std::uint64_t seed) override;
+   PaddleInput decide(const MatchState& state, const MatchConfiguration& configuration, float deltaTime) override;
+
+private:
+
+   std::shared_ptr<const std::vector<PaddleInput>> mRecordedInputs;
+   std::size_t                                     mIndexOfNextInput;
+};
+
+// Reads a file that contains one PackedMatchInput byte per step, and keeps the inputs of the paddle on the given side
+std::shared_ptr<const std::vector<PaddleInput>> loadRecordedPaddleInputs(const std::string& filePath, PaddleSide recordedSide);
+
+#endif
@@ -29,7 +29,7 @@ public:
    void enter() override;
    void processInput(float deltaTime) override;
    void update(float deltaTime) override;
-   void render() override;
+   void render(float interpolationFactor) override;
    void exit() override;
 
 private:
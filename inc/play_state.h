@@ -4,6 +4,14 @@
 #include <array>
 
 #include "game.h"
+#include "game_state_snapshot.h"
+#include "match_simulation.h"
+#include "multi_ball_simulation.h"
+#include "paddle_controller.h"
+#include "replay.h"
+#include "ring_buffer.h"
+#include "shared_state_channel.h"
+#include "substep_governor.h"
 
 class PlayState : public State
 {
@@ -18,7 +26,8 @@ public:
              const std::shared_ptr<Paddle>&                 leftPaddle,
              const std::shared_ptr<Paddle>&                 rightPaddle,
              const std::shared_ptr<Ball>&                   ball,
-             const std::shared_ptr<GameObject3D>&           point);
+             const std::shared_ptr<GameObject3D>&           point,
+             const std::shared_ptr<SharedStateChannel>&     stateChannel);
    ~PlayState() = default;
 
    PlayState(const PlayState&) = delete;
@@ -30,26 +39,42 @@ public:
    void enter() override;
    void processInput(float deltaTime) override;
    void update(float deltaTime) override;
-   void render() override;
+   void render(float interpolationFactor) override;
    void exit() override;
 
    unsigned int getPointsScoredByLeftPaddle() const;
    unsigned int getPointsScoredByRightPaddle() const;
 
-private:
+   GameStateSnapshot captureSnapshot() const;
+   void              restoreSnapshot(const GameStateSnapshot& snapshot);
+
+   // Everything that external clients see of the match, except for the time and the state of the game, which PlayState doesn't know about
+   PublishedState    createPublishedState() const;
 
-   void calculateInitialDirectionOfBall();
+   // How many physics sub-steps the last updates were split into and how long they took
+   const SubstepCounters& getSubstepCounters() const;
 
-   bool ballIsOutsideOfHorizontalRange();
+   // Must be called by the game loop before each update, so that the updates that catch up after a long frame share the time that is left in it
+   void              setTimeLeftInFrame(double secondsLeftInFrame, unsigned int numberOfUpdatesLeftInFrame);
 
-   void updateScore();
+private:
 
    void resetScene();
 
+   void synchronizeSceneWithSimulation();
+
+   void savePreviousTransformsOfScene();
+
    void resetCamera();
 
    void playSoundOfCollision();
 
+   void addPointsScoredWithExtraBalls(const MultiBallEvents& events, MatchEvents& eventsOfMatch);
+
+   void renderExtraBalls();
+
+   void receivePaddleCommands();
+
    void displayScore();
 
    std::shared_ptr<FiniteStateMachine>     mFSM;
@@ -68,11 +93,41 @@ private:
    std::shared_ptr<Ball>                   mBall;
    std::shared_ptr<GameObject3D>           mPoint;
 
-   bool                                    mBallIsInPlay;
-   bool                                    mBallIsFalling;
-
-   unsigned int                            mPointsScoredByLeftPaddle;
-   unsigned int                            mPointsScoredByRightPaddle;
+   MatchSimulation                         mSimulation;
+   MatchInputs                             mInputs;
+
+   double                                  mTimeWhenSoundOfCollisionWasLastPlayed;
+   std::uint64_t                           mFrameNumber;
+
+   // Snapshots of the last few seconds of the match, which can be rewound by holding Backspace
+   RingBuffer<GameStateSnapshot>           mHistory;
+   bool                                    mRewind;
+
+   // Inputs of every tick of the match, which are saved when the match is over
+   ReplayRecorder                          mRecorder;
+
+   // Splits the updates in which the ball moves fast into sub-steps, as long as they fit in the budget of an update
+   SubstepGovernor                         mSubstepGovernor;
+   double                                  mSecondsLeftInFrame;
+   unsigned int                            mNumberOfUpdatesLeftInFrame;
+
+   // The computer can play on the left paddle, so that the game can be played alone
+   ComputerPaddleController                mComputerOpponent;
+   bool                                    mComputerControlsLeftPaddle;
+
+   // Extra balls can be thrown into the match, and every one of them that leaves the table scores a point just like the teapot
+   // They bounce off of the paddles and each other, but not off of the teapot, and matches played with them can't be rewound or replayed
+   MultiBallSimulation                     mExtraBalls;
+   bool                                    mExtraBallsAreEnabled;
+   bool                                    mMatchWasPlayedWithExtraBalls;
+
+   // External clients can take over either paddle by sending commands through the shared state channel
+   // Their commands take priority over the keyboard and the computer
+   std::shared_ptr<SharedStateChannel>     mStateChannel;
+   MatchInputs                             mCommandedInputs;
+   bool                                    mLeftPaddleIsCommanded;
+   bool                                    mRightPaddleIsCommanded;
+   std::uint64_t                           mSequenceNumberOfLastCommandApplied;
 
    std::array<glm::vec3, 3>                mPositionsOfPointsScoredByLeftPaddle;
    std::array<glm::vec3, 3>                mPositionsOfPointsScoredByRightPaddle;
@@ -0,0 +1,123 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "match_simulation.h"
+
+// A replay stores the inputs of every tick of a match, plus keyframes that contain the full state of the match every few seconds
+// Since the simulation is deterministic, any tick can be reconstructed by restoring the closest keyframe before it and simulating the ticks in between
+
+struct ReplayKeyframe
+{
+   std::uint32_t tick;
+   MatchState    state;
+};
+
+struct ReplayServe
+{
+   std::uint32_t tick;
+   std::uint8_t  direction;
+};
+
+struct Replay
+{
+   float                       deltaTime;
+
+   // The replay is played back with the same rules it was recorded with, regardless of the configuration it's played back with
+   MatchArithmetic             arithmetic;
+   std::uint32_t               ticksPerKeyframe;
+
+   // One PackedMatchInput per tick, combined with the number of sub-steps in which the tick was simulated
+   std::vector<std::uint8_t>   inputs;
+
+   // The serve directions that were drawn during the match
+   // They can be derived from the keyframes, but storing them lets us detect replays that no longer play back correctly, and lets tools look at the serves without simulating the match
+   std::vector<ReplayServe>    serves;
+
+   // The first keyframe is always at tick 0
+   std::vector<ReplayKeyframe> keyframes;
+};
+
+class ReplayRecorder
+{
+public:
+
+   explicit ReplayRecorder(float secondsPerKeyframe);
+   ~ReplayRecorder() = default;
+
+   ReplayRecorder(const ReplayRecorder&) = default;
+   ReplayRecorder& operator=(const ReplayRecorder&) = default;
+
+   ReplayRecorder(ReplayRecorder&&) = default;
+   ReplayRecorder& operator=(ReplayRecorder&&) = default;
+
+   // Discards the ticks that were recorded so far
+   // Replays recorded with MatchArithmetic::FixedPoint play back identically on every build
+   void          start(float deltaTime, MatchArithmetic arithmetic = MatchArithmetic::FloatingPoint);
+
+   // Must be called once per tick, with the state of the match before the tick was simulated and the inputs and events of the tick
+   void          recordTick(const MatchState& stateBeforeTick, const MatchInputs& inputs, const MatchEvents& events, unsigned int numberOfSubsteps = 1);
+
+   // Discards every tick after the given one (e.g. when the match is rewound)
+   void          rewind(std::uint32_t numberOfTicks);
+
+   std::uint32_t getNumberOfTicks() const;
+   const Replay& getReplay() const;
+
+private:
+
+   float  mSecondsPerKeyframe;
+   Replay mReplay;
+};
+
+class ReplayPlayer
+{
+public:
+
+   ReplayPlayer(const MatchConfiguration& configuration, const std::shared_ptr<const Replay>& replay);
+   ~ReplayPlayer() = default;
+
+   ReplayPlayer(const ReplayPlayer&) = default;
+   ReplayPlayer& operator=(const ReplayPlayer&) = default;
+
+   ReplayPlayer(ReplayPlayer&&) = default;
+   ReplayPlayer& operator=(ReplayPlayer&&) = default;
+
+   // Restores the closest keyframe before the tick and simulates the ticks in between, so it never simulates more than ticksPerKeyframe ticks
+   void              seek(std::uint32_t tick);
+
+   // Simulates the next tick
+   MatchEvents       step();
+
+   // Simulates the next numberOfTicks ticks without producing anything that needs to be rendered
+   void              fastForward(std::uint32_t numberOfTicks);
+
+   bool              isAtEnd() const;
+   std::uint32_t     getTick() const;
+   std::uint32_t     getNumberOfTicks() const;
+   const MatchState& getState() const;
+
+   // True if a serve went in a different direction than the recorded one, which means that the rules of the game changed after the replay was recorded
+   bool              hasDiverged() const;
+
+private:
+
+   std::shared_ptr<const Replay> mReplay;
+   MatchSimulation               mSimulation;
+   std::uint32_t                 mTick;
+   std::size_t                   mIndexOfNextServe;
+   bool                          mHasDiverged;
+};
+
+// The binary format packs the inputs into runs of identical inputs, encodes the runs, the serves and the lengths of everything as varints,
+// and only stores the parts of the keyframes that aren't part of the configuration of the match
+std::vector<std::uint8_t> serializeReplay(const Replay& replay);
+bool                      deserializeReplay(const std::vector<std::uint8_t>& bytes, const MatchConfiguration& configuration, Replay& replay);
+
+bool                      saveReplay(const std::string& filePath, const Replay& replay);
+bool                      loadReplay(const std::string& filePath, const MatchConfiguration& configuration, Replay& replay);
+
+#endif
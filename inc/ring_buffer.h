@@ -0,0 +1,114 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Keeps the last N items that were pushed into it, overwriting the oldest item when it's full
+// It's meant to hold snapshots (see game_state_snapshot.h), so the items are copied with memcpy
+template<typename T>
+class RingBuffer
+{
+public:
+
+   static_assert(std::is_trivially_copyable<T>::value, "The items of a ring buffer must be trivially copyable");
+
+   explicit RingBuffer(std::size_t capacity);
+   ~RingBuffer() = default;
+
+   RingBuffer(const RingBuffer&) = default;
+   RingBuffer& operator=(const RingBuffer&) = default;
+
+   RingBuffer(RingBuffer&&) = default;
+   RingBuffer& operator=(RingBuffer&&) = default;
+
+   void        push(const T& item);
+
+   // Removes the newest item and copies it into item
+   // Returns false if the buffer is empty
+   bool        pop(T& item);
+
+   // 0 is the newest item, and size() - 1 is the oldest one
+   const T&    getItem(std::size_t age) const;
+
+   std::size_t size() const;
+   std::size_t capacity() const;
+   bool        empty() const;
+   void        clear();
+
+private:
+
+   std::vector<T> mItems;
+   std::size_t    mIndexOfNextItem;
+   std::size_t    mSize;
+};
+
+template<typename T>
+RingBuffer<T>::RingBuffer(std::size_t capacity)
+   : mItems(capacity > 0 ? capacity : 1)
+   , mIndexOfNextItem(0)
+   , mSize(0)
+{
+
+}
+
+template<typename T>
+void RingBuffer<T>::push(const T& item)
+{
+   std::memcpy(&mItems[mIndexOfNextItem], &item, sizeof(T));
+
+   mIndexOfNextItem = (mIndexOfNextItem + 1) % mItems.size();
+   if (mSize < mItems.size())
+   {
+      ++mSize;
+   }
+}
+
+template<typename T>
+bool RingBuffer<T>::pop(T& item)
+{
+   if (mSize == 0)
+   {
+      return false;
+   }
+
+   mIndexOfNextItem = (mIndexOfNextItem + mItems.size() - 1) % mItems.size();
+   --mSize;
+
+   std::memcpy(&item, &mItems[mIndexOfNextItem], sizeof(T));
+   return true;
+}
+
+template<typename T>
+const T& RingBuffer<T>::getItem(std::size_t age) const
+{
+   return mItems[(mIndexOfNextItem + mItems.size() - 1 - age) % mItems.size()];
+}
+
+template<typename T>
+std::size_t RingBuffer<T>::size() const
+{
+   return mSize;
+}
+
+template<typename T>
+std::size_t RingBuffer<T>::capacity() const
+{
+   return mItems.size();
+}
+
+template<typename T>
+bool RingBuffer<T>::empty() const
+{
+   return mSize == 0;
+}
+
+template<typename T>
+void RingBuffer<T>::clear()
+{
+   mIndexOfNextItem = 0;
+   mSize            = 0;
+}
+
+#endif
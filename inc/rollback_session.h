@@ -0,0 +1,132 @@
+#ifndef ROLLBACK_SESSION_H
+#define ROLLBACK_SESSION_H
+
+#include <vector>
+
+#include "match_simulation.h"
+#include "paddle_controller.h"
+
+// Simulates a match between two players on different machines without waiting for the inputs of the remote player
+// Every frame is simulated as soon as the local inputs are known, with the remote inputs predicted to be the same as the last ones that arrived
+// When the remote inputs of a frame that was already simulated arrive and differ from the prediction, the session restores the state that it saved
+// at the start of that frame and simulates every frame since then again, which is called a rollback
+// Both sessions of a match must be created with the same configuration, seed, input delay and number of frames that can be rolled back,
+// and they stay in sync because the simulation only depends on the inputs (even the number of sub-steps of every frame is derived from the state)
+// The inputs of each player are PackedMatchInput bytes that only contain the bits of their own paddle and BallIsReleased
+
+struct RollbackCounters
+{
+   std::uint64_t numberOfRollbacks;
+   std::uint64_t numberOfFramesSimulatedAgain;
+   unsigned int  maxNumberOfFramesRolledBack;
+
+   // Time spent restoring states and simulating frames again
+   double        secondsSpentRollingBack;
+   double        maxSecondsSpentByARollback;
+
+   // Frames that had to wait because the remote inputs were too far behind
+   std::uint64_t numberOfFramesStalled;
+};
+
+class RollbackSession
+{
+public:
+
+   // The local inputs are applied inputDelay frames after they are set, which gives them time to reach the remote player and makes rollbacks shorter
+   RollbackSession(const MatchConfiguration& configuration,
+                   std::uint64_t             seed,
+                   PaddleSide                localSide,
+                   unsigned int              maxNumberOfFramesRolledBack,
+                   unsigned int              inputDelay);
+   ~RollbackSession() = default;
+
+   RollbackSession(const RollbackSession&) = default;
+   RollbackSession& operator=(const RollbackSession&) = default;
+
+   RollbackSession(RollbackSession&&) = default;
+   RollbackSession& operator=(RollbackSession&&) = default;
+
+   // False when the next frame would be further ahead of the last confirmed frame than a rollback can reach,
+   // in which case the game has to wait for the remote inputs (and should call stallFrame to count it)
+   bool                    canAdvanceFrame() const;
+   void                    stallFrame();
+
+   // Sets the local inputs of the frame that will be simulated inputDelay frames from now
+   // Must be called once before every call to advanceFrame
+   void                    setLocalInput(std::uint8_t packedInput);
+
+   // Remote inputs must arrive in order, so inputs that skip a frame are ignored until the missing ones arrive (the transport sends them again)
+   // Returns true if the inputs were new
+   bool                    addRemoteInput(std::uint32_t frame, std::uint8_t packedInput);
+
+   // Rolls back to the first frame whose prediction was wrong, if any, and then simulates the current frame
+   // Only the events of the current frame are returned, since the events of the frames that were simulated again were already played when they were first simulated
+   MatchEvents             advanceFrame(float deltaTime);
+
+   // Number of frames that have been simulated, which is also the index of the next one
+   std::uint32_t           getCurrentFrame() const;
+
+   // The remote inputs of every frame before this one are known
+   std::uint32_t           getNumberOfConfirmedFrames() const;
+
+   // The local inputs of every frame before this one have been set, which includes the frames covered by the input delay
+   std::uint32_t           getNumberOfLocalInputs() const;
+   std::uint8_t            getLocalInput(std::uint32_t frame) const;
+
+   // States at the start of frames that are both simulated and confirmed never change again, so they can be compared between machines to detect desyncs
+   // Returns false if the frame isn't confirmed yet or was saved too long ago
+   bool                    getConfirmedState(std::uint32_t frame, MatchState& state) const;
+
+   const MatchState&       getState() const;
+   const MatchSimulation&  getSimulation() const;
+   PaddleSide              getLocalSide() const;
+   unsigned int            getInputDelay() const;
+   unsigned int            getMaxNumberOfFramesRolledBack() const;
+
+   const RollbackCounters& getCounters() const;
+
+private:
+
+   struct Frame
+   {
+      // The state at the start of the frame
+      MatchState   state;
+      std::uint8_t localInput;
+      std::uint8_t remoteInput;
+      // The remote inputs that the frame was last simulated with
+      std::uint8_t simulatedRemoteInput;
+   };
+
+   Frame&                  getFrame(std::uint32_t frame);
+   const Frame&            getFrame(std::uint32_t frame) const;
+
+   std::uint8_t            predictRemoteInput(std::uint32_t frame) const;
+   MatchEvents             simulateFrame(std::uint32_t frame, float deltaTime);
+
+   MatchSimulation         mSimulation;
+   PaddleSide              mLocalSide;
+   unsigned int            mMaxNumberOfFramesRolledBack;
+   unsigned int            mInputDelay;
+
+   // A ring of frames that covers every frame from the oldest one that can be rolled back to the newest one with local inputs
+   std::vector<Frame>      mFrames;
+
+   std::uint32_t           mCurrentFrame;
+   std::uint32_t           mNumberOfConfirmedFrames;
+   std::uint32_t           mNumberOfLocalInputs;
+   std::uint32_t           mFirstMispredictedFrame;
+   bool                    mPredictionWasWrong;
+
+   RollbackCounters        mCounters;
+};
+
+// Combines the inputs of both players into the inputs of a frame
+MatchInputs   combineInputsOfPlayers(std::uint8_t packedInputOfLeftPlayer, std::uint8_t packedInputOfRightPlayer);
+
+// Packs the inputs of one player, keeping only the bits of their paddle
+std::uint8_t  packInputOfPlayer(PaddleSide side, const PaddleInput& input, bool releaseBall);
+
+// Hashes the fields of a state one by one, so that padding bytes don't affect the result
+std::uint64_t calculateChecksumOfMatchState(const MatchState& state);
+
+#endif
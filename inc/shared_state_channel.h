@@ -0,0 +1,152 @@
+#ifndef SHARED_STATE_CHANNEL_H
+#define SHARED_STATE_CHANNEL_H
+
+#include <cstdint>
+#include <string>
+
+// Lets external bots and tools follow the game and control its paddles from other processes through POSIX shared memory
+// The game publishes its state at the end of every update into a ring of slots that are each protected by a sequence lock,
+// so readers never block the game and the game never waits for them, and it receives paddle commands through a single-producer, single-consumer queue
+// Once the channel is open, publishing, reading and sending are plain loads and stores on the shared memory, without any system calls
+// The channel is only implemented on POSIX systems, so creating or opening it fails elsewhere
+
+// Values of PublishedState::gameState
+enum PublishedGameState : std::uint32_t
+{
+   GameStateIsMenu    = 0,
+   GameStateIsPlay    = 1,
+   GameStateIsPause   = 2,
+   GameStateIsWin     = 3,
+   GameStateIsUnknown = 4
+};
+
+// Bits of PublishedState::flags
+enum PublishedStateFlag : std::uint32_t
+{
+   BallIsInPlay                      = 1 << 0,
+   BallIsFalling                     = 1 << 1,
+   MatchIsOver                       = 1 << 2,
+   LeftPaddleIsControlledByCommands  = 1 << 3,
+   RightPaddleIsControlledByCommands = 1 << 4
+};
+
+// What the game publishes at the end of every update
+// It only holds fixed-size fields, so that clients that aren't written in C++ or that don't use GLM can read it too
+struct PublishedState
+{
+   // Set by publishState, which counts the states it publishes, so the game publishes exactly one state per update
+   std::uint64_t tick;
+
+   // Read from std::chrono::steady_clock, which all the processes of a machine share
+   std::uint64_t timeWhenPublishedInNanoseconds;
+
+   // Frame of the match in PlayState, which doesn't advance outside of the play state and goes back when the match is rewound
+   std::uint64_t frameOfMatch;
+
+   // The sequence number of the last command that changed the inputs of the paddles, so that clients can measure how long their commands take
+   std::uint64_t sequenceNumberOfLastCommandApplied;
+
+   std::uint32_t gameState;
+   std::uint32_t flags;
+
+   float         ballPosition[3];
+   float         ballVelocity[3];
+   float         leftPaddlePosition[2];
+   float         rightPaddlePosition[2];
+
+   std::uint32_t pointsScoredByLeftPaddle;
+   std::uint32_t pointsScoredByRightPaddle;
+};
+
+static_assert(sizeof(PublishedState) % 8 == 0, "PublishedState must be made of whole 64-bit words");
+
+// Values of PaddleCommand::side
+enum CommandedPaddleSide : std::uint8_t
+{
+   CommandedPaddleIsLeft  = 0,
+   CommandedPaddleIsRight = 1
+};
+
+// The first command for a paddle takes it from the keyboard or the computer, and it keeps moving the way the last command said until a command gives it back
+struct PaddleCommand
+{
+   // Chosen by the client, and echoed in PublishedState::sequenceNumberOfLastCommandApplied once the game has applied the command
+   std::uint64_t sequenceNumber;
+
+   std::uint8_t  side;
+   std::uint8_t  moveUp;
+   std::uint8_t  moveDown;
+   std::uint8_t  releaseBall;
+
+   // Gives the paddle back to the keyboard or the computer
+   std::uint8_t  returnControl;
+};
+
+class SharedStateChannel
+{
+public:
+
+   SharedStateChannel();
+   ~SharedStateChannel();
+
+   SharedStateChannel(const SharedStateChannel&) = delete;
+   SharedStateChannel& operator=(const SharedStateChannel&) = delete;
+
+   SharedStateChannel(SharedStateChannel&&) = delete;
+   SharedStateChannel& operator=(SharedStateChannel&&) = delete;
+
+   // Called by the game, which publishes the state and receives the commands
+   // A channel that was left behind by a game that crashed is replaced, and the channel is removed when its creator is destroyed
+   bool          create(const std::string& name);
+
+   // Called by a client, which reads the state and sends the commands
+   // Only one client should send commands at a time, since the queue only has one producer
+   bool          open(const std::string& name);
+
+   bool          isOpen() const;
+
+   // False once the game that created the channel has been destroyed
+   bool          isPublisherAlive() const;
+
+   // Game side
+
+   void          publishState(const PublishedState& state);
+
+   // Returns false when there are no commands waiting
+   bool          receiveCommand(PaddleCommand& command);
+
+   // Client side
+
+   // Number of states published so far, which is also the tick of the newest one plus one
+   std::uint64_t getNumberOfStatesPublished() const;
+
+   // Returns false when nothing has been published yet
+   // If the game overwrites the newest state while it's being copied, the state that replaced it is read instead
+   bool          readLatestState(PublishedState& state) const;
+
+   // Returns false when the state hasn't been published yet, or when the game has already overwritten it because the client fell too far behind
+   bool          readState(std::uint64_t tick, PublishedState& state) const;
+
+   // Returns false when the queue is full, which happens when the game isn't in the play state and isn't consuming commands
+   bool          sendCommand(const PaddleCommand& command);
+
+private:
+
+   void          close();
+
+   struct Layout;
+
+   Layout*       mLayout;
+   std::string   mName;
+   bool          mIsCreator;
+
+   // Each side keeps its own copy of the index of the other side, and only reads the shared one when its copy says that the queue is full or empty,
+   // which keeps the cache line of the other side's index from bouncing between the cores on every command
+   std::uint64_t mNextTickToPublish;
+   std::uint64_t mNumberOfCommandsSent;
+   std::uint64_t mNumberOfCommandsReceived;
+   std::uint64_t mCachedNumberOfCommandsSent;
+   std::uint64_t mCachedNumberOfCommandsReceived;
+};
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef SNAPSHOT_CODEC_H
+#define SNAPSHOT_CODEC_H
+
+#include <vector>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "game_state_snapshot.h"
+
+// Streams matches to spectators, who only need to see them, so they get a small subset of a GameStateSnapshot at a few snapshots per second
+// Every field is quantized to an integer with a configurable precision, and then encoded as the difference from the same field in the last snapshot
+// that the spectator acknowledged, with a single bit for fields that didn't change and a short code for small differences
+// Snapshots that spectators never acknowledge are simply replaced by newer ones, so the stream can be sent over an unreliable transport
+// The spectators interpolate between the snapshots they receive to render the frames in between
+
+// What a spectator sees
+struct SpectatorSnapshot
+{
+   std::uint32_t frameNumber;
+
+   glm::vec3     ballPosition;
+   glm::vec3     ballVelocity;
+   glm::quat     ballRotation;
+   // In degrees per second, like the spin applied to Ball
+   float         ballSpin;
+
+   glm::vec2     leftPaddlePosition;
+   glm::vec2     rightPaddlePosition;
+
+   unsigned int  pointsScoredByLeftPaddle;
+   unsigned int  pointsScoredByRightPaddle;
+   bool          ballIsInPlay;
+   bool          ballIsFalling;
+   bool          matchIsOver;
+};
+
+SpectatorSnapshot createSpectatorSnapshot(const GameStateSnapshot& snapshot);
+
+// Size of a step of each quantized field, which both ends of a stream must agree on
+// Every field is stored in 16 bits, so the steps also determine the range of values that can be represented (e.g. +/-1024 units for positions by default)
+struct SnapshotPrecision
+{
+   SnapshotPrecision();
+   ~SnapshotPrecision() = default;
+
+   SnapshotPrecision(const SnapshotPrecision&) = default;
+   SnapshotPrecision& operator=(const SnapshotPrecision&) = default;
+
+   SnapshotPrecision(SnapshotPrecision&&) = default;
+   SnapshotPrecision& operator=(SnapshotPrecision&&) = default;
+
+   float        positionStep;
+   float        velocityStep;
+   float        spinStep;
+
+   // The rotation is stored as the three smallest components of its quaternion, with this many bits each (up to 15)
+   unsigned int bitsPerRotationComponent;
+};
+
+enum SnapshotField
+{
+   BallPositionX,
+   BallPositionY,
+   BallPositionZ,
+   BallVelocityX,
+   BallVelocityY,
+   BallVelocityZ,
+   BallRotationLargestComponent,
+   BallRotationA,
+   BallRotationB,
+   BallRotationC,
+   BallSpin,
+   LeftPaddlePositionX,
+   LeftPaddlePositionY,
+   RightPaddlePositionX,
+   RightPaddlePositionY,
+   PointsScoredByLeftPaddle,
+   PointsScoredByRightPaddle,
+   SnapshotFlags,
+   numberOfSnapshotFields
+};
+
+struct QuantizedSnapshot
+{
+   std::uint32_t frameNumber;
+   std::int32_t  fields[numberOfSnapshotFields];
+};
+
+QuantizedSnapshot quantizeSnapshot(const SpectatorSnapshot& snapshot, const SnapshotPrecision& precision);
+SpectatorSnapshot dequantizeSnapshot(const QuantizedSnapshot& snapshot, const SnapshotPrecision& precision);
+
+// Encodes a snapshot as the difference from a baseline, or from a snapshot of zeros when the baseline is null
+void              encodeSnapshot(const QuantizedSnapshot& snapshot, const QuantizedSnapshot* baseline, std::vector<std::uint8_t>& bytes);
+
+// Keeps the latest snapshots of a match and encodes the newest one for every spectator
+class SnapshotEncoder
+{
+public:
+
+   explicit SnapshotEncoder(const SnapshotPrecision& precision);
+   ~SnapshotEncoder() = default;
+
+   SnapshotEncoder(const SnapshotEncoder&) = default;
+   SnapshotEncoder& operator=(const SnapshotEncoder&) = default;
+
+   SnapshotEncoder(SnapshotEncoder&&) = default;
+   SnapshotEncoder& operator=(SnapshotEncoder&&) = default;
+
+   // Frames must increase from one snapshot to the next
+   void                             addSnapshot(const SpectatorSnapshot& snapshot);
+
+   // Encodes the newest snapshot against the one with the given frame, or as a full snapshot if the spectator hasn't acknowledged any
+   // or acknowledged one that is too old to be kept
+   // Spectators that acknowledged the same snapshot receive the same bytes, so each snapshot is only encoded once per baseline
+   const std::vector<std::uint8_t>& encodeForSpectator(bool hasAcknowledgedSnapshot, std::uint32_t frameOfAcknowledgedSnapshot);
+
+   const SnapshotPrecision&         getPrecision() const;
+
+private:
+
+   struct KeptSnapshot
+   {
+      QuantizedSnapshot         snapshot;
+      bool                      isValid;
+
+      // The newest snapshot encoded against this one, which is valid when frameOfEncoding is the frame of the newest snapshot
+      std::vector<std::uint8_t> encoding;
+      bool                      encodingIsValid;
+   };
+
+   SnapshotPrecision         mPrecision;
+   std::vector<KeptSnapshot> mKeptSnapshots;
+   std::size_t               mIndexOfNewestSnapshot;
+   std::uint64_t             mNumberOfSnapshots;
+
+   std::vector<std::uint8_t> mFullEncoding;
+   bool                      mFullEncodingIsValid;
+};
+
+// Decodes the stream of a spectator, keeping the snapshots that later ones can be encoded against
+class SnapshotDecoder
+{
+public:
+
+   explicit SnapshotDecoder(const SnapshotPrecision& precision);
+   ~SnapshotDecoder() = default;
+
+   SnapshotDecoder(const SnapshotDecoder&) = default;
+   SnapshotDecoder& operator=(const SnapshotDecoder&) = default;
+
+   SnapshotDecoder(SnapshotDecoder&&) = default;
+   SnapshotDecoder& operator=(SnapshotDecoder&&) = default;
+
+   // Returns false if the bytes are malformed, if the snapshot is older than the newest one received, or if its baseline is no longer kept
+   // The frame of every snapshot that is decoded should be acknowledged to the encoder
+   bool                     decode(const std::uint8_t* bytes, std::size_t numberOfBytes, SpectatorSnapshot& snapshot);
+
+   bool                     hasReceivedSnapshot() const;
+   std::uint32_t            getFrameOfNewestSnapshot() const;
+
+private:
+
+   SnapshotPrecision              mPrecision;
+   std::vector<QuantizedSnapshot> mKeptSnapshots;
+   std::vector<bool>              mKeptSnapshotIsValid;
+   std::size_t                    mIndexOfNewestSnapshot;
+   bool                           mHasReceivedSnapshot;
+};
+
+// Renders a spectator's view between the snapshots it received
+class SnapshotInterpolator
+{
+public:
+
+   explicit SnapshotInterpolator(float secondsPerFrame);
+   ~SnapshotInterpolator() = default;
+
+   SnapshotInterpolator(const SnapshotInterpolator&) = default;
+   SnapshotInterpolator& operator=(const SnapshotInterpolator&) = default;
+
+   SnapshotInterpolator(SnapshotInterpolator&&) = default;
+   SnapshotInterpolator& operator=(SnapshotInterpolator&&) = default;
+
+   // Snapshots that are older than the newest one are ignored
+   void              addSnapshot(const SpectatorSnapshot& snapshot);
+
+   bool              isEmpty() const;
+
+   // Returns the view at a frame, which can be fractional
+   // Spectators should render a few snapshots behind the newest one, so that there is always a snapshot on each side of the frame
+   // The ball follows a cubic curve that matches the positions and velocities of both snapshots, the paddles move in straight lines and the rotation is slerped,
+   // while the scores and flags come from the older snapshot
+   // Frames outside of the snapshots that are kept are clamped to the oldest or newest one
+   SpectatorSnapshot sample(double frame) const;
+
+private:
+
+   float                          mSecondsPerFrame;
+   std::vector<SpectatorSnapshot> mSnapshots;
+};
+
+#endif
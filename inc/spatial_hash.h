@@ -0,0 +1,66 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// A broad phase that buckets bounding boxes into the cells of a uniform grid, and only tests the boxes that share a cell
+// The grid is unbounded: cells are hashed into a table whose size follows the number of boxes, so the cost of a query is linear in the number of boxes
+// as long as each cell only holds a few of them, which is the case when the cells are about as large as the smallest objects
+
+class SpatialHash
+{
+public:
+
+   explicit SpatialHash(float cellSize);
+   ~SpatialHash() = default;
+
+   SpatialHash(const SpatialHash&) = default;
+   SpatialHash& operator=(const SpatialHash&) = default;
+
+   SpatialHash(SpatialHash&&) = default;
+   SpatialHash& operator=(SpatialHash&&) = default;
+
+   // Removes every box, but keeps the memory that was allocated for them
+   void          clear();
+
+   // Returns the ID of the box, which is the number of boxes that were inserted before it
+   std::uint32_t insert(const glm::vec2& minCorner, const glm::vec2& maxCorner);
+
+   // Replaces the contents of pairs with every pair of boxes that overlap, with the smallest ID first
+   // Each pair is only reported once, even if the boxes share many cells
+   void          findCandidatePairs(std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs);
+
+   std::size_t   getNumberOfBoxes() const;
+   float         getCellSize() const;
+
+private:
+
+   struct Entry
+   {
+      std::int32_t  cellX;
+      std::int32_t  cellY;
+      std::uint32_t box;
+   };
+
+   std::int32_t  calculateCellCoordinate(float coordinate) const;
+   std::uint32_t hashCell(std::int32_t cellX, std::int32_t cellY) const;
+
+   float                      mCellSize;
+   float                      mInverseCellSize;
+
+   std::vector<glm::vec2>     mMinCorners;
+   std::vector<glm::vec2>     mMaxCorners;
+
+   // The entries are sorted by bucket with a counting sort, so building the table never compares two entries
+   std::vector<Entry>         mEntries;
+   std::vector<Entry>         mSortedEntries;
+   std::vector<std::uint32_t> mStartsOfBuckets;
+   std::vector<std::uint32_t> mNextPositionsInBuckets;
+   std::uint32_t              mBucketMask;
+};
+
+#endif
@@ -17,7 +17,7 @@ public:
    virtual void enter() = 0;
    virtual void processInput(float deltaTime) = 0;
    virtual void update(float deltaTime) = 0;
-   virtual void render() = 0;
+   virtual void render(float interpolationFactor) = 0;
    virtual void exit() = 0;
 };
 
@@ -0,0 +1,79 @@
+#ifndef SUBSTEP_GOVERNOR_H
+#define SUBSTEP_GOVERNOR_H
+
+#include <cstdint>
+
+#include "match_state.h"
+#include "numeric_policy.h"
+
+// Returns how many sub-steps a tick must be split into so that, in every sub-step, the ball moves towards a paddle by no more than a fraction
+// of the smaller of its radius and the width of the paddle
+// A ball that isn't moving only needs a single step
+unsigned int calculateNumberOfSubstepsNeeded(const MatchState& state, float deltaTime, unsigned int maxNumberOfSubsteps);
+
+// The same calculation with the numbers of a numeric policy (see MatchSimulation::calculateNumberOfSubstepsNeeded)
+// Instantiated for FloatNumericPolicy and FixedPointNumericPolicy
+template<typename NumericPolicy>
+unsigned int calculateNumberOfSubstepsNeeded(const MatchState& state, float deltaTime, unsigned int maxNumberOfSubsteps);
+
+struct SubstepCounters
+{
+   unsigned int  numberOfSubstepsOfLastUpdate;
+   unsigned int  numberOfSubstepsNeededByLastUpdate;
+   double        secondsSpentByLastUpdate;
+   double        maxSecondsSpentByAnUpdate;
+
+   // Moving average of the time it takes to simulate one sub-step, which is what the governor uses to predict the cost of an update
+   double        averageSecondsPerSubstep;
+
+   std::uint64_t numberOfUpdates;
+   std::uint64_t numberOfSubsteps;
+   double        secondsSpent;
+
+   // Updates that got fewer sub-steps than they needed because they would have gone over the budget
+   std::uint64_t numberOfUpdatesLimitedByBudget;
+};
+
+// Decides how many sub-steps each update can afford
+// When the sub-steps get more expensive than the budget allows, the governor lowers their number instead of letting the update take longer,
+// which makes collisions less precise for a while but never causes a spike in the duration of a frame
+class SubstepGovernor
+{
+public:
+
+   SubstepGovernor(double budgetPerUpdateInSeconds, unsigned int maxNumberOfSubsteps);
+   ~SubstepGovernor() = default;
+
+   SubstepGovernor(const SubstepGovernor&) = default;
+   SubstepGovernor& operator=(const SubstepGovernor&) = default;
+
+   SubstepGovernor(SubstepGovernor&&) = default;
+   SubstepGovernor& operator=(SubstepGovernor&&) = default;
+
+   // Returns a number of sub-steps between 1 and numberOfSubstepsNeeded that is expected to fit in what's left of the budget
+   // A frame can run many updates to catch up, so the budget of an update is also capped by its share of the time that is left in the frame
+   unsigned int           chooseNumberOfSubsteps(unsigned int numberOfSubstepsNeeded,
+                                                 double       secondsAlreadySpentByUpdate,
+                                                 double       secondsLeftInFrame,
+                                                 unsigned int numberOfUpdatesLeftInFrame);
+
+   // Must be called after the sub-steps that were chosen have been simulated
+   void                   recordUpdate(unsigned int numberOfSubstepsNeeded, unsigned int numberOfSubsteps, double secondsSpent);
+
+   void                   resetCounters();
+
+   double                 getBudgetPerUpdate() const;
+   void                   setBudgetPerUpdate(double budgetPerUpdateInSeconds);
+
+   unsigned int           getMaxNumberOfSubsteps() const;
+
+   const SubstepCounters& getCounters() const;
+
+private:
+
+   double          mBudgetPerUpdate;
+   unsigned int    mMaxNumberOfSubsteps;
+   SubstepCounters mCounters;
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef TEXTURE_COOKER_H
+#define TEXTURE_COOKER_H
+
+#include <string>
+
+#include "cooked_texture.h"
+#include "mip_generator.h"
+
+enum class TextureCompression
+{
+   // RGBA8, for drivers that support neither S3TC nor BPTC
+   none,
+
+   // BC3 for textures that have any texel that isn't opaque, and BC1 for the rest, which every desktop driver supports
+   s3tc,
+
+   // BC7, which keeps more of the texture than BC1 and BC3 at the size of BC3, but needs GL_ARB_texture_compression_bptc
+   bptc
+};
+
+// Returns linear for the textures whose names say that they hold data instead of colors (e.g. teapot_specular.jpg or brick_normal.png), and sRGB for the rest
+TextureColorSpace getColorSpaceOfTexture(const std::string& texFilePath);
+
+// Decodes a texture, generates its mip chain and block compresses every level into a .tptex file
+// When threads are given, the mipmaps and the blocks of each level are split across them, so this must not be called from one of their tasks
+// It doesn't depend on OpenGL, so it's shared by the game, which cooks the textures whose cooked files are missing or out of date, and by teapong_cooker
+bool cookTexture(const std::string& texFilePath,
+                 const std::string& cookedFilePath,
+                 TextureColorSpace  colorSpace,
+                 TextureCompression compression = TextureCompression::s3tc,
+                 MipFilter          mipFilter   = MipFilter::kaiser,
+                 ThreadPool*        threads     = nullptr);
+
+// Same as above, without writing the file
+bool bakeTexture(const std::string&     texFilePath,
+                 CookedTextureContents& contents,
+                 TextureColorSpace      colorSpace,
+                 TextureCompression     compression = TextureCompression::s3tc,
+                 MipFilter              mipFilter   = MipFilter::kaiser,
+                 ThreadPool*            threads     = nullptr);
+
+#endif
@@ -4,8 +4,59 @@
 #include <string>
 #include <memory>
 
+#include "cooked_texture.h"
 #include "texture.h"
 
+// From EXT_texture_compression_s3tc, which every desktop driver supports but which isn't part of the core profile that glad was generated for
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// From ARB_texture_compression_bptc, which is core since OpenGL 4.2 but not in the 3.3 core profile that glad was generated for
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM_ARB
+#define GL_COMPRESSED_RGBA_BPTC_UNORM_ARB 0x8E8C
+#endif
+
+class TextureStreamer;
+
+// Pixels of a texture that have been decoded but not given to OpenGL yet
+// Decoding doesn't need an OpenGL context, so it can be done on any thread, while creating the texture has to be done on the thread that owns the context
+// Every level of the mip chain is read from the cooked .tptex file of the texture, or baked in memory when that file can't be read
+struct DecodedTexture
+{
+   DecodedTexture()
+      : secondsSpentDecoding(0.0)
+      , cookedContents()
+   {
+
+   }
+
+   ~DecodedTexture() = default;
+
+   DecodedTexture(const DecodedTexture&) = delete;
+   DecodedTexture& operator=(const DecodedTexture&) = delete;
+
+   DecodedTexture(DecodedTexture&&) = default;
+   DecodedTexture& operator=(DecodedTexture&&) = default;
+
+   bool        hasTexels() const
+   {
+      return !cookedContents.levels.empty();
+   }
+
+   // Number of bytes that are given to OpenGL
+   std::size_t getSizeInBytes() const
+   {
+      return cookedContents.data.size();
+   }
+
+   double                secondsSpentDecoding;
+   CookedTextureContents cookedContents;
+};
+
 class TextureLoader
 {
 public:
@@ -26,17 +77,60 @@ public:
                                          unsigned int       magFilter = GL_LINEAR,
                                          bool               genMipmap = true) const;
 
+   // Creates a texture from pixels that were decoded with decodeTexture, which must be done on the thread that owns the OpenGL context
+   std::shared_ptr<Texture> loadResource(const DecodedTexture& decodedTexture,
+                                         unsigned int          wrapS     = GL_REPEAT,
+                                         unsigned int          wrapT     = GL_REPEAT,
+                                         unsigned int          minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                         unsigned int          magFilter = GL_LINEAR,
+                                         bool                  genMipmap = true) const;
+
+   // Return a texture that shows a placeholder until the streamer has decoded (if needed) and uploaded its pixels
+   std::shared_ptr<Texture> loadResource(const std::string& texFilePath,
+                                         TextureStreamer&   texStreamer,
+                                         unsigned int       wrapS     = GL_REPEAT,
+                                         unsigned int       wrapT     = GL_REPEAT,
+                                         unsigned int       minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                         unsigned int       magFilter = GL_LINEAR,
+                                         bool               genMipmap = true) const;
+
+   std::shared_ptr<Texture> loadResource(DecodedTexture&& decodedTexture,
+                                         TextureStreamer& texStreamer,
+                                         unsigned int     wrapS     = GL_REPEAT,
+                                         unsigned int     wrapT     = GL_REPEAT,
+                                         unsigned int     minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                         unsigned int     magFilter = GL_LINEAR,
+                                         bool              genMipmap = true) const;
+
+   // Reads the cooked .tptex file of the texture, which is cooked again first if it's missing or older than the texture
+   // When the cooked file can't be read, the texture is baked in memory, so its mipmaps never have to be generated by the driver
+   // Can be called from any thread
+   bool                     decodeTexture(const std::string& texFilePath, DecodedTexture& decodedTexture) const;
+
+   // Must be called on the thread that owns the OpenGL context
+   bool                     compressedFormatIsSupported(unsigned int format) const;
+
+   // Returns true if the levels of a cooked texture of the given format can be uploaded as they are, without decompressing them first
+   // Must be called on the thread that owns the OpenGL context
+   bool                     cookedFormatIsSupported(std::uint32_t cookedFormat) const;
+
+   // Returns the OpenGL format of the blocks of a cooked texture, or GL_RGBA8 for an uncompressed one
+   unsigned int             getFormatOfCookedTexture(std::uint32_t cookedFormat) const;
+
+   // Uploads the levels of a cooked texture into the bound texture, reading each one from its offset into texels
+   // texels is null when the levels are read from a bound pixel buffer
+   // When the driver doesn't support the format of the blocks, they are decompressed into RGBA8 levels, which can't be done from a pixel buffer
+   // Only the first level is uploaded when mipmaps aren't wanted, since the others come from the cooker instead of glGenerateMipmap
+   bool                     uploadCookedLevels(const CookedTextureContents& cookedContents, const unsigned char* texels, bool genMipmap) const;
+
 private:
 
-   unsigned int generateTexture(const std::unique_ptr<unsigned char, void(*)(void*)>& texData,
-                                int          width,
-                                int          height,
-                                int          numComponents,
-                                unsigned int wrapS,
-                                unsigned int wrapT,
-                                unsigned int minFilter,
-                                unsigned int magFilter,
-                                bool         genMipmap) const;
+   unsigned int generateTexture(const CookedTextureContents& cookedContents,
+                                unsigned int                 wrapS,
+                                unsigned int                 wrapT,
+                                unsigned int                 minFilter,
+                                unsigned int                 magFilter,
+                                bool                         genMipmap) const;
 };
 
 #endif
@@ -0,0 +1,95 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "texture_loader.h"
+#include "thread_pool.h"
+
+// Loads textures without stalling the thread that owns the OpenGL context, so that they can be loaded in the middle of a game
+// Each texture is returned right away, showing a 1x1 placeholder, while its file is decoded on a worker thread
+// Its pixels are then copied into one of a few pixel buffer objects that are reused from texture to texture, and uploaded from there with glTexSubImage2D,
+// which lets the driver do the transfer in the background instead of copying the pixels before glTexImage2D returns
+// A fence is placed after each upload, and the texture only switches to its cooked mipmaps once it has been signaled, which is also when the pixel buffer can be reused
+// Textures whose blocks the driver can't sample are decompressed into RGBA8 before they are copied into a pixel buffer, so they look like their cooked versions instead of the placeholder
+class TextureStreamer
+{
+public:
+
+   TextureStreamer(unsigned int numberOfPixelBuffers = 4, std::size_t maxBytesUploadedPerUpdate = 8 * 1024 * 1024, unsigned int numberOfDecodingThreads = 1);
+   ~TextureStreamer();
+
+   TextureStreamer(const TextureStreamer&) = delete;
+   TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+   TextureStreamer(TextureStreamer&&) = delete;
+   TextureStreamer& operator=(TextureStreamer&&) = delete;
+
+   // Must be called on the thread that owns the OpenGL context, since the placeholder is created right away
+   std::shared_ptr<Texture> streamTexture(const std::string& texFilePath,
+                                          unsigned int       wrapS     = GL_REPEAT,
+                                          unsigned int       wrapT     = GL_REPEAT,
+                                          unsigned int       minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                          unsigned int       magFilter = GL_LINEAR,
+                                          bool               genMipmap = true);
+
+   // Same as above, for pixels that were already decoded (e.g. by the threads that load the models)
+   std::shared_ptr<Texture> streamTexture(DecodedTexture&& decodedTexture,
+                                          unsigned int     wrapS     = GL_REPEAT,
+                                          unsigned int     wrapT     = GL_REPEAT,
+                                          unsigned int     minFilter = GL_LINEAR_MIPMAP_LINEAR,
+                                          unsigned int     magFilter = GL_LINEAR,
+                                          bool             genMipmap = true);
+
+   // Finishes the uploads whose fences have been signaled and starts the uploads of the textures that have been decoded, up to the byte budget
+   // Must be called once per frame on the thread that owns the OpenGL context
+   void                     update();
+
+   // Textures that are being decoded or uploaded, and are still showing their placeholders
+   unsigned int             getNumberOfTexturesPending() const;
+
+private:
+
+   struct TextureRequest
+   {
+      std::shared_ptr<Texture> texture;
+      DecodedTexture           decodedTexture;
+      unsigned int             minFilter;
+      bool                     genMipmap;
+   };
+
+   struct PixelBuffer
+   {
+      unsigned int                    bufferID;
+      std::size_t                     size;
+      GLsync                          fence;
+      std::shared_ptr<TextureRequest> request;
+   };
+
+   std::shared_ptr<TextureRequest> createRequest(unsigned int wrapS, unsigned int wrapT, unsigned int minFilter, unsigned int magFilter, bool genMipmap);
+
+   // Can be called from the decoding threads, since the formats that the driver supports are only queried by the constructor
+   void                            decompressIfUnsupported(DecodedTexture& decodedTexture) const;
+
+   void                            finishUploads();
+   bool                            startUpload(PixelBuffer& pixelBuffer, const std::shared_ptr<TextureRequest>& request);
+
+   std::vector<PixelBuffer>                     mPixelBuffers;
+   std::size_t                                  mMaxBytesUploadedPerUpdate;
+   std::deque<std::shared_ptr<TextureRequest>>  mRequestsWaitingForUpload;
+   unsigned int                                 mNumberOfTexturesPending;
+   std::vector<std::uint32_t>                   mUnsupportedCookedFormats;
+
+   // Filled by the decoding threads
+   std::vector<std::shared_ptr<TextureRequest>> mDecodedRequests;
+   std::mutex                                   mDecodedRequestsMutex;
+
+   // Declared last so that it's destroyed first, since its threads use the members above
+   ThreadPool                                   mDecodingThreads;
+};
+
+#endif
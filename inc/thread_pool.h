@@ -0,0 +1,47 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs tasks on a fixed number of threads, in the order in which they are submitted
+// Tasks can submit more tasks, which lets a task that discovers more work (e.g. a model that references textures) spread it across the pool
+class ThreadPool
+{
+public:
+
+   // 0 threads means one per core
+   explicit ThreadPool(unsigned int numberOfThreads = 0);
+   ~ThreadPool();
+
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+
+   ThreadPool(ThreadPool&&) = delete;
+   ThreadPool& operator=(ThreadPool&&) = delete;
+
+   void         submit(std::function<void()> task);
+
+   // Waits until every task that was submitted, including the ones submitted by other tasks, is done
+   void         waitUntilIdle();
+
+   unsigned int getNumberOfThreads() const;
+
+private:
+
+   void         work();
+
+   std::vector<std::thread>          mThreads;
+   std::deque<std::function<void()>> mTasks;
+   std::mutex                        mMutex;
+   std::condition_variable           mTaskIsReady;
+   std::condition_variable           mPoolIsIdle;
+   unsigned int                      mNumberOfTasksRunning;
+   bool                              mThreadsShouldStop;
+};
+
+#endif
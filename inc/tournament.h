@@ -0,0 +1,144 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle_controller.h"
+#include "work_stealing_deque.h"
+
+struct TournamentEntrant
+{
+   std::string                                        name;
+
+   // Every worker creates its own controllers, so that controllers never need to be shared between threads
+   std::function<std::unique_ptr<PaddleController>()> createController;
+};
+
+struct PairingResults
+{
+   std::uint64_t winsOfLeftEntrant;
+   std::uint64_t winsOfRightEntrant;
+   std::uint64_t draws;
+};
+
+struct TournamentResults
+{
+   // Rallies with more hits than this are counted in the last bin of the histogram
+   static const unsigned int maxRallyLength = 32;
+
+   explicit TournamentResults(std::size_t numberOfPairings);
+   ~TournamentResults() = default;
+
+   TournamentResults(const TournamentResults&) = default;
+   TournamentResults& operator=(const TournamentResults&) = default;
+
+   TournamentResults(TournamentResults&&) = default;
+   TournamentResults& operator=(TournamentResults&&) = default;
+
+   void merge(const TournamentResults& other);
+
+   std::vector<PairingResults>                   pairings;
+
+   // Number of rallies that ended after the ball hit the paddles N times
+   std::array<std::uint64_t, maxRallyLength + 1> rallyLengths;
+
+   // Number of serves in each direction (see calculateServeVelocity)
+   std::array<std::uint64_t, 4>                  serveDirections;
+
+   std::uint64_t                                 numberOfMatches;
+   std::uint64_t                                 numberOfPoints;
+   std::uint64_t                                 numberOfSteps;
+};
+
+struct WorkerReport
+{
+   std::uint64_t matchesPlayed;
+   std::uint64_t rangesStolen;
+   double        secondsSpentWorking;
+};
+
+// Plays a round-robin tournament in which every entrant plays every other entrant on both sides of the table
+// The matches are divided into ranges that are spread across the workers, and workers that run out of matches steal ranges from the others
+// Every match draws its random numbers from its own stream, which is derived from the seed of the tournament and the index of the match,
+// so the results don't depend on the number of workers or on which worker plays which match
+class Tournament
+{
+public:
+
+   Tournament(const MatchConfiguration&             configuration,
+              const std::vector<TournamentEntrant>& entrants,
+              unsigned int                          matchesPerPairing,
+              float                                 deltaTime,
+              float                                 maxDurationOfMatch,
+              std::uint64_t                         seed);
+   ~Tournament() = default;
+
+   Tournament(const Tournament&) = delete;
+   Tournament& operator=(const Tournament&) = delete;
+
+   Tournament(Tournament&&) = delete;
+   Tournament& operator=(Tournament&&) = delete;
+
+   void                                  run(unsigned int numberOfWorkers);
+
+   // Plays the matches whose indices are in [begin, end) on the calling thread
+   // Every match produces the same results no matter where it's played, so ranges can be played by different processes and merged in any order
+   TournamentResults                     playMatches(std::uint32_t begin, std::uint32_t end) const;
+
+   std::uint32_t                         getNumberOfMatches() const;
+   unsigned int                          getMatchesPerPairing() const;
+   std::uint64_t                         getSeed() const;
+
+   const MatchConfiguration&             getConfiguration() const;
+   float                                 getDeltaTime() const;
+   unsigned int                          getMaxNumberOfStepsPerMatch() const;
+
+   const std::vector<TournamentEntrant>& getEntrants() const;
+   std::size_t                           getNumberOfPairings() const;
+   std::size_t                           getLeftEntrantOfPairing(std::size_t pairingIndex) const;
+   std::size_t                           getRightEntrantOfPairing(std::size_t pairingIndex) const;
+
+   const TournamentResults&              getResults() const;
+   const std::vector<WorkerReport>&      getWorkerReports() const;
+   double                                getSecondsSpentRunning() const;
+
+private:
+
+   struct MatchRange
+   {
+      std::uint32_t begin;
+      std::uint32_t end;
+   };
+
+   void                                  work(unsigned int workerIndex);
+
+   void                                  playMatch(std::uint32_t      matchIndex,
+                                                   PaddleController&  leftController,
+                                                   PaddleController&  rightController,
+                                                   TournamentResults& results) const;
+
+   MatchConfiguration                                         mConfiguration;
+   std::vector<TournamentEntrant>                             mEntrants;
+   std::vector<std::pair<std::size_t, std::size_t>>           mPairings;
+   unsigned int                                               mMatchesPerPairing;
+   float                                                      mDeltaTime;
+   unsigned int                                               mMaxNumberOfStepsPerMatch;
+   std::uint64_t                                              mSeed;
+
+   std::vector<std::unique_ptr<WorkStealingDeque<MatchRange>>> mDeques;
+   std::atomic<std::uint64_t>                                 mNumberOfMatchesLeft;
+
+   // Every worker accumulates its results in its own TournamentResults, and they are merged once all the workers are done
+   std::vector<TournamentResults>                             mResultsOfWorkers;
+   TournamentResults                                          mResults;
+   std::vector<WorkerReport>                                  mWorkerReports;
+   double                                                     mSecondsSpentRunning;
+};
+
+#endif
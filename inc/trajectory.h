@@ -0,0 +1,28 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include "match_state.h"
+
+// While the ball is on the table it moves in straight lines and the walls reflect it like mirrors,
+// so its path can be unfolded into a single straight line and the point where it crosses any vertical line can be calculated without simulating it
+
+struct Interception
+{
+   // False if the ball doesn't move towards the line
+   bool         willIntercept;
+
+   float        timeUntilInterception;
+   float        positionY;
+   float        velocityY;
+   unsigned int numberOfBouncesOffWalls;
+};
+
+// Predicts when and where the center of the ball will cross the vertical line at paddleX, assuming that it isn't hit by anything other than the walls
+// Only the walls are taken into account, so the prediction is meant for balls that are in play and not falling
+Interception predictInterception(const BallState& ball, float paddleX, float verticalRange);
+
+// Same as above, but for the face of the paddle that is turned towards the ball
+// The center of the ball touches that face when it's one radius away from it
+Interception predictInterceptionByPaddle(const BallState& ball, const PaddleState& paddle, float verticalRange);
+
+#endif
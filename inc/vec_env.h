@@ -0,0 +1,145 @@
+#ifndef VEC_ENV_H
+#define VEC_ENV_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "match_batch.h"
+#include "paddle_controller.h"
+
+// A vectorized reinforcement-learning environment that steps many matches in lockstep
+// An agent controls the right paddle of every match, and the left paddle is controlled either by a second agent or by a built-in opponent
+// The matches follow the same rules as the game (see MatchConfiguration), and the ball is served as soon as a rally ends
+// The environments are divided into contiguous shards, and every shard is simulated by its own MatchBatch on its own thread
+
+enum PaddleAction : std::uint8_t
+{
+   PaddleStays     = 0,
+   PaddleMovesUp   = 1,
+   PaddleMovesDown = 2
+};
+
+const unsigned int numberOfPaddleActions = 3;
+
+struct VecEnvSettings
+{
+   VecEnvSettings();
+   ~VecEnvSettings() = default;
+
+   VecEnvSettings(const VecEnvSettings&) = default;
+   VecEnvSettings& operator=(const VecEnvSettings&) = default;
+
+   VecEnvSettings(VecEnvSettings&&) = default;
+   VecEnvSettings& operator=(VecEnvSettings&&) = default;
+
+   // Every step repeats the actions for this many ticks of deltaTime seconds
+   float                                              deltaTime;
+   unsigned int                                       ticksPerStep;
+
+   // Episodes that last longer than this are ended, with 0 meaning that they only end when a match is won
+   unsigned int                                       maxNumberOfStepsPerEpisode;
+
+   // 0 uses every core of the machine
+   unsigned int                                       numberOfThreads;
+
+   // Creates the opponent of each environment, which only plays when no actions are passed for the left paddles
+   std::function<std::unique_ptr<PaddleController>()> createOpponent;
+};
+
+enum EpisodeStatus : std::uint8_t
+{
+   EpisodeContinues = 0,
+   EpisodeWasWon    = 1,
+   EpisodeTimedOut  = 2
+};
+
+class VecEnv
+{
+public:
+
+   VecEnv(const MatchConfiguration& configuration, const VecEnvSettings& settings, std::size_t numberOfEnvironments, std::uint64_t seed);
+   ~VecEnv();
+
+   VecEnv(const VecEnv&) = delete;
+   VecEnv& operator=(const VecEnv&) = delete;
+
+   VecEnv(VecEnv&&) = delete;
+   VecEnv& operator=(VecEnv&&) = delete;
+
+   // Starts a new match in every environment
+   // observations, which can be null, receives one image of observationWidth * observationHeight bytes per environment (see observation_rasterizer.h)
+   void              reset(std::uint8_t* observations);
+
+   // Advances every environment by one step
+   // actionsOfRightPaddles must contain one PaddleAction per environment, and actionsOfLeftPaddles can be null to let the built-in opponents play
+   // rewards receives +1 for every point scored by the right paddle and -1 for every point scored by the left paddle,
+   // and dones receives an EpisodeStatus per environment
+   // Environments that are done start a new match immediately, and their observations show the first frame of that match
+   void              step(const std::uint8_t* actionsOfRightPaddles,
+                          const std::uint8_t* actionsOfLeftPaddles,
+                          float*              rewards,
+                          std::uint8_t*       dones,
+                          std::uint8_t*       observations);
+
+   std::size_t       getNumberOfEnvironments() const;
+   unsigned int      getNumberOfThreads() const;
+   std::size_t       getObservationSize() const;
+
+   MatchState        getState(std::size_t environmentIndex) const;
+
+private:
+
+   struct Shard
+   {
+      std::size_t                                    firstEnvironment;
+      std::size_t                                    numberOfEnvironments;
+      MatchBatch                                     batch;
+      std::vector<std::uint8_t>                      packedInputs;
+      std::vector<std::unique_ptr<PaddleController>> opponents;
+   };
+
+   struct StepArguments
+   {
+      const std::uint8_t* actionsOfRightPaddles;
+      const std::uint8_t* actionsOfLeftPaddles;
+      float*              rewards;
+      std::uint8_t*       dones;
+      std::uint8_t*       observations;
+   };
+
+   void              resetShard(Shard& shard, std::uint8_t* observations);
+   void              stepShard(Shard& shard, const StepArguments& arguments);
+   void              startNewEpisode(Shard& shard, std::size_t indexInShard);
+
+   // Runs the task on every shard, using the calling thread for the first shard, and returns when every shard is done
+   void              runOnEveryShard(const std::function<void(Shard&)>& task);
+   void              work(std::size_t shardIndex);
+
+   MatchConfiguration                  mConfiguration;
+   VecEnvSettings                      mSettings;
+   std::size_t                         mNumberOfEnvironments;
+
+   std::vector<std::unique_ptr<Shard>> mShards;
+
+   // One entry per environment
+   std::vector<std::uint32_t>          mStepsInEpisode;
+   std::vector<std::uint8_t>           mPointsScoredByLeftPaddle;
+   std::vector<std::uint8_t>           mPointsScoredByRightPaddle;
+   std::vector<std::uint64_t>          mRandomNumberGeneratorStates;
+
+   // The workers wait for the generation to change, run the task on their shard, and count down the shards that are left
+   std::vector<std::thread>            mWorkers;
+   std::mutex                          mMutex;
+   std::condition_variable             mTaskIsReady;
+   std::condition_variable             mTaskIsDone;
+   const std::function<void(Shard&)>*  mTask;
+   std::uint64_t                       mGeneration;
+   std::size_t                         mNumberOfShardsLeft;
+   bool                                mWorkersShouldStop;
+};
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+// A fixed-capacity Chase-Lev deque
+// The thread that owns the deque pushes and pops items at its bottom, while other threads steal items from its top
+// None of the operations block, and the owner only competes with thieves when a single item is left
+// T must be small enough to be stored in a lock-free std::atomic (e.g. two 32-bit integers)
+
+template<typename T>
+class WorkStealingDeque
+{
+public:
+
+   static_assert(std::is_trivially_copyable<T>::value, "The items of a work-stealing deque must be trivially copyable");
+
+   // The capacity is rounded up to a power of two
+   explicit WorkStealingDeque(std::size_t capacity);
+   ~WorkStealingDeque() = default;
+
+   WorkStealingDeque(const WorkStealingDeque&) = delete;
+   WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+   WorkStealingDeque(WorkStealingDeque&&) = delete;
+   WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+   // Owner only
+   // Returns false if the deque is full
+   bool push(const T& item);
+
+   // Owner only
+   // Returns false if the deque is empty or if a thief took the last item
+   bool pop(T& item);
+
+   // Any thread
+   // Returns false if the deque is empty or if another thread took the item first
+   bool steal(T& item);
+
+private:
+
+   std::size_t                       mMask;
+   std::unique_ptr<std::atomic<T>[]> mItems;
+
+   // The indices are kept on separate cache lines so that thieves and the owner don't invalidate each other's caches more than necessary
+   std::atomic<std::int64_t>         mTop;
+   char                              mPaddingBetweenTopAndBottom[64];
+   std::atomic<std::int64_t>         mBottom;
+};
+
+template<typename T>
+WorkStealingDeque<T>::WorkStealingDeque(std::size_t capacity)
+   : mMask(0)
+   , mItems()
+   , mTop(0)
+   , mPaddingBetweenTopAndBottom()
+   , mBottom(0)
+{
+   std::size_t roundedCapacity = 1;
+   while (roundedCapacity < capacity)
+   {
+      roundedCapacity *= 2;
+   }
+
+   mMask  = roundedCapacity - 1;
+   mItems = std::unique_ptr<std::atomic<T>[]>(new std::atomic<T>[roundedCapacity]);
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::push(const T& item)
+{
+   std::int64_t bottom = mBottom.load(std::memory_order_relaxed);
+   std::int64_t top    = mTop.load(std::memory_order_acquire);
+
+   if (bottom - top > static_cast<std::int64_t>(mMask))
+   {
+      return false;
+   }
+
+   mItems[bottom & mMask].store(item, std::memory_order_relaxed);
+
+   // Make the item visible before the new bottom
+   std::atomic_thread_fence(std::memory_order_release);
+   mBottom.store(bottom + 1, std::memory_order_relaxed);
+   return true;
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::pop(T& item)
+{
+   // Reserve the bottom item before looking at the top, so that a thief that reads the old bottom can't take the same item
+   std::int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+   mBottom.store(bottom, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   std::int64_t top    = mTop.load(std::memory_order_relaxed);
+
+   if (top > bottom)
+   {
+      // Empty
+      mBottom.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+   }
+
+   item = mItems[bottom & mMask].load(std::memory_order_relaxed);
+   if (top == bottom)
+   {
+      // This is the last item, so we race the thieves for it
+      bool won = mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      mBottom.store(bottom + 1, std::memory_order_relaxed);
+      return won;
+   }
+
+   return true;
+}
+
+template<typename T>
+bool WorkStealingDeque<T>::steal(T& item)
+{
+   std::int64_t top = mTop.load(std::memory_order_acquire);
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+   std::int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+   if (top >= bottom)
+   {
+      return false;
+   }
+
+   item = mItems[top & mMask].load(std::memory_order_relaxed);
+   return mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+#endif
@@ -42,55 +42,6 @@ Ball& Ball::operator=(Ball&& rhs) noexcept
    return *this;
 }
 
-void Ball::moveWithinVerticalRange(float deltaTime, float verticalRange)
-{
-   glm::vec3 currVelocity     = this->getVelocity();
-   glm::vec3 currPos          = this->getPosition() + (currVelocity * deltaTime);
-
-   float topBoundary          =   verticalRange / 2.0f;
-   float bottomBoundary       =  -topBoundary;
-
-   glm::vec3 incidentVelocity = currVelocity;
-   glm::vec3 normalOfCrossedBoundary;
-   bool bounced = false;
-
-   if ((currPos.y + mRadius) >= topBoundary)
-   {
-      // Bounce down
-      currVelocity.y          = -currVelocity.y;
-      currPos.y               = topBoundary - mRadius;
-      normalOfCrossedBoundary = glm::vec3(0.0f, -1.0f, 0.0f);
-      bounced                 = true;
-   }
-   else if ((currPos.y - mRadius) <= bottomBoundary)
-   {
-      // Bounce up
-      currVelocity.y          = -currVelocity.y;
-      currPos.y               = bottomBoundary + mRadius;
-      normalOfCrossedBoundary = glm::vec3(0.0f, 1.0f, 0.0f);
-      bounced                 = true;
-   }
-
-   if (bounced)
-   {
-      // Absolute value of the dot product of:
-      // - The normalized incident velocity
-      // - The normalized normal of the crossed boundary
-      // This value ranges from 0 to 1
-      // It is equal to 0 when the two vectors are perpendicular (tangent collision)
-      // It is equal to 1 when the two vectors are parallel (direct collision)
-      float dotProduct = glm::abs(glm::dot(glm::normalize(incidentVelocity), normalOfCrossedBoundary));
-
-      // The ball spins with its maximum angular velocity when a tangent collision occurs
-      // The ball spins with its minimum angular velocity, that is, it doesn't spin, when a direct collision occurs
-      mSpinAngularVelocityScaledByBounce = mSpinAngularVelocity * (1.0f - dotProduct);
-   }
-
-   this->setVelocity(currVelocity);
-   this->setPosition(currPos);
-   this->rotate(mSpinAngularVelocityScaledByBounce * deltaTime, glm::vec3(0.0f, 0.0f, 1.0f));
-}
-
 void Ball::moveInFreeFall(float deltaTime)
 {
    glm::vec3 currPos     = this->getPosition() + (this->getVelocity() * deltaTime);
@@ -125,3 +76,13 @@ void Ball::setRadius(float radius)
 {
    mRadius = radius;
 }
+
+float Ball::getSpinAngularVelocityScaledByBounce() const
+{
+   return mSpinAngularVelocityScaledByBounce;
+}
+
+void Ball::setSpinAngularVelocityScaledByBounce(float spinAngularVelocityScaledByBounce)
+{
+   mSpinAngularVelocityScaledByBounce = spinAngularVelocityScaledByBounce;
+}
@@ -0,0 +1,130 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "float_lanes.h"
+#include "match_batch.h"
+
+// Plays the same matches to the end with MatchBatch and with one MatchSimulation per match, reports how many steps of unfinished matches each one simulates per second,
+// and checks that both end the matches with the same scores
+// Usage: teapong_batch_benchmark [numberOfMatches] [maxNumberOfSteps]
+
+// The inputs repeat after this many steps, so that they don't take up gigabytes when the matches are long
+const unsigned int numberOfStepsWithDifferentInputs = 1024;
+
+std::uint8_t drawInputs(std::uint64_t& randomNumberGeneratorState)
+{
+   // The ball is always released, and each paddle moves up, moves down or stands still
+   randomNumberGeneratorState = randomNumberGeneratorState * 6364136223846793005ull + 1442695040888963407ull;
+   unsigned int bits = static_cast<unsigned int>(randomNumberGeneratorState >> 60);
+
+   std::uint8_t inputs = BallIsReleased;
+   if ((bits & 3) == 1) { inputs |= LeftPaddleMovesUp; }
+   if ((bits & 3) == 2) { inputs |= LeftPaddleMovesDown; }
+   if ((bits >> 2) == 1) { inputs |= RightPaddleMovesUp; }
+   if ((bits >> 2) == 2) { inputs |= RightPaddleMovesDown; }
+
+   return inputs;
+}
+
+int main(int argc, char* argv[])
+{
+   std::size_t   numberOfMatches  = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 4096;
+   unsigned int  maxNumberOfSteps = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 240000;
+   float         deltaTime        = 1.0f / 240.0f;
+   std::uint64_t seed             = 0x7EA9;
+
+   MatchConfiguration config;
+
+   // Draw the inputs ahead of time so that both simulations receive the same ones and so that drawing them isn't timed
+   std::vector<std::uint8_t> inputs(numberOfMatches * numberOfStepsWithDifferentInputs);
+   std::uint64_t inputState = seed;
+   for (std::uint8_t& input : inputs)
+   {
+      input = drawInputs(inputState);
+   }
+
+   // Batch
+   // A match step is a step of a match that isn't over yet, which is what both simulations are compared on
+   MatchBatch                batch(config, numberOfMatches, seed);
+   std::vector<std::uint8_t> events(numberOfMatches);
+   std::uint64_t             batchMatchSteps = 0;
+   unsigned int              batchSteps      = 0;
+
+   auto start = std::chrono::steady_clock::now();
+   for (std::size_t matchesLeft = numberOfMatches; matchesLeft > 0 && batchSteps < maxNumberOfSteps; ++batchSteps)
+   {
+      batchMatchSteps += matchesLeft;
+      batch.step(&inputs[(batchSteps % numberOfStepsWithDifferentInputs) * numberOfMatches], deltaTime, events.data());
+
+      matchesLeft = 0;
+      for (std::uint8_t eventsOfMatch : events)
+      {
+         matchesLeft += (eventsOfMatch & MatchBatch::MatchIsOver) ? 0 : 1;
+      }
+   }
+   double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   // Scalar, starting from the same states (including the states of the random number generators) as the batch
+   MatchBatch                   initialBatch(config, numberOfMatches, seed);
+   std::vector<MatchSimulation> simulations;
+   simulations.reserve(numberOfMatches);
+   for (std::size_t i = 0; i < numberOfMatches; ++i)
+   {
+      simulations.emplace_back(config, 0);
+      simulations.back().setState(initialBatch.getState(i));
+   }
+
+   std::uint64_t scalarMatchSteps = 0;
+   unsigned int  scalarSteps      = 0;
+
+   start = std::chrono::steady_clock::now();
+   for (std::size_t matchesLeft = numberOfMatches; matchesLeft > 0 && scalarSteps < maxNumberOfSteps; ++scalarSteps)
+   {
+      const std::uint8_t* inputsOfStep = &inputs[(scalarSteps % numberOfStepsWithDifferentInputs) * numberOfMatches];
+
+      matchesLeft = 0;
+      for (std::size_t i = 0; i < numberOfMatches; ++i)
+      {
+         if (!simulations[i].getState().matchIsOver)
+         {
+            ++scalarMatchSteps;
+            matchesLeft += simulations[i].step(unpackMatchInputs(inputsOfStep[i]), deltaTime).matchIsOver ? 0 : 1;
+         }
+      }
+   }
+   double scalarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   // Both simulations apply the same rules, but the batch can round differently (e.g. when the compiler fuses multiplications and additions),
+   // so long rallies can drift apart and end with different scores
+   std::size_t matchesFinishedByBatch  = 0;
+   std::size_t matchesFinishedByScalar = 0;
+   std::size_t matchesWithSameScore    = 0;
+   for (std::size_t i = 0; i < numberOfMatches; ++i)
+   {
+      MatchState        batchState  = batch.getState(i);
+      const MatchState& scalarState = simulations[i].getState();
+
+      matchesFinishedByBatch  += batchState.matchIsOver ? 1 : 0;
+      matchesFinishedByScalar += scalarState.matchIsOver ? 1 : 0;
+      matchesWithSameScore    += (batchState.matchIsOver == scalarState.matchIsOver &&
+                                  batchState.pointsScoredByLeftPaddle == scalarState.pointsScoredByLeftPaddle &&
+                                  batchState.pointsScoredByRightPaddle == scalarState.pointsScoredByRightPaddle) ? 1 : 0;
+   }
+
+   std::cout << "Matches: " << numberOfMatches << ", max steps: " << maxNumberOfSteps << ", SIMD width: " << floatLanesWidth << "\n";
+   std::cout << "Batch:  " << batchSeconds  << " s, " << batchSteps  << " steps, " << (batchMatchSteps / batchSeconds)   << " match steps/s, "
+             << matchesFinishedByBatch  << " matches finished" << "\n";
+   std::cout << "Scalar: " << scalarSeconds << " s, " << scalarSteps << " steps, " << (scalarMatchSteps / scalarSeconds) << " match steps/s, "
+             << matchesFinishedByScalar << " matches finished" << "\n";
+   std::cout << "Speedup: " << ((batchMatchSteps / batchSeconds) / (scalarMatchSteps / scalarSeconds)) << "x" << "\n";
+   std::cout << "Matches with the same final score: " << matchesWithSameScore << " of " << numberOfMatches << "\n";
+
+   if (matchesFinishedByBatch < numberOfMatches || matchesFinishedByScalar < numberOfMatches)
+   {
+      std::cout << "Warning - main - Some matches didn't finish within " << maxNumberOfSteps << " steps" << "\n";
+   }
+
+   return 0;
+}
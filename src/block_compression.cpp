@@ -0,0 +1,904 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "float_lanes.h"
+#include "block_compression.h"
+
+const unsigned int texelsPerBlock = 16;
+
+// The channels of the texels of a block are stored separately, so that each channel can be processed floatLanesWidth texels at a time
+struct BlockTexels
+{
+   float r[texelsPerBlock];
+   float g[texelsPerBlock];
+   float b[texelsPerBlock];
+   float a[texelsPerBlock];
+};
+
+// The colors of a BC1 block are 5:6:5, and they are expanded back to 8 bits by repeating their top bits, just like the GPU does
+struct QuantizedColor
+{
+   std::uint16_t packed;
+   float         r;
+   float         g;
+   float         b;
+};
+
+float sumOfLanes(FloatLanes lanes)
+{
+   float values[floatLanesWidth];
+   storeLanes(values, lanes);
+
+   float sum = 0.0f;
+   for (unsigned int i = 0; i < floatLanesWidth; ++i)
+   {
+      sum += values[i];
+   }
+
+   return sum;
+}
+
+float minOfLanes(FloatLanes lanes)
+{
+   float values[floatLanesWidth];
+   storeLanes(values, lanes);
+   return *std::min_element(values, values + floatLanesWidth);
+}
+
+float maxOfLanes(FloatLanes lanes)
+{
+   float values[floatLanesWidth];
+   storeLanes(values, lanes);
+   return *std::max_element(values, values + floatLanesWidth);
+}
+
+QuantizedColor quantizeColor(const float color[3])
+{
+   unsigned int r5 = static_cast<unsigned int>(std::min(std::max(color[0], 0.0f), 255.0f) * (31.0f / 255.0f) + 0.5f);
+   unsigned int g6 = static_cast<unsigned int>(std::min(std::max(color[1], 0.0f), 255.0f) * (63.0f / 255.0f) + 0.5f);
+   unsigned int b5 = static_cast<unsigned int>(std::min(std::max(color[2], 0.0f), 255.0f) * (31.0f / 255.0f) + 0.5f);
+
+   QuantizedColor quantizedColor;
+   quantizedColor.packed = static_cast<std::uint16_t>((r5 << 11) | (g6 << 5) | b5);
+   quantizedColor.r      = static_cast<float>((r5 << 3) | (r5 >> 2));
+   quantizedColor.g      = static_cast<float>((g6 << 2) | (g6 >> 4));
+   quantizedColor.b      = static_cast<float>((b5 << 3) | (b5 >> 2));
+   return quantizedColor;
+}
+
+// Picks the closest of the 4 colors of the palette for each texel, and returns the sum of the squared errors
+// Index 0 is the first endpoint, index 1 is the second one, and indices 2 and 3 are at a third and two thirds of the way from the first to the second
+float chooseColorIndices(const BlockTexels& texels, const QuantizedColor& c0, const QuantizedColor& c1, unsigned int indices[texelsPerBlock])
+{
+   float palette[4][3] = {{c0.r,                          c0.g,                          c0.b},
+                          {c1.r,                          c1.g,                          c1.b},
+                          {(2.0f * c0.r + c1.r) / 3.0f,   (2.0f * c0.g + c1.g) / 3.0f,   (2.0f * c0.b + c1.b) / 3.0f},
+                          {(c0.r + 2.0f * c1.r) / 3.0f,   (c0.g + 2.0f * c1.g) / 3.0f,   (c0.b + 2.0f * c1.b) / 3.0f}};
+
+   FloatLanes totalError = broadcastLanes(0.0f);
+   for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+   {
+      FloatLanes r = loadLanes(texels.r + i);
+      FloatLanes g = loadLanes(texels.g + i);
+      FloatLanes b = loadLanes(texels.b + i);
+
+      FloatLanes bestError = broadcastLanes(INFINITY);
+      FloatLanes bestIndex = broadcastLanes(0.0f);
+      for (unsigned int k = 0; k < 4; ++k)
+      {
+         FloatLanes dr    = r - broadcastLanes(palette[k][0]);
+         FloatLanes dg    = g - broadcastLanes(palette[k][1]);
+         FloatLanes db    = b - broadcastLanes(palette[k][2]);
+         FloatLanes error = dr * dr + dg * dg + db * db;
+
+         MaskLanes isBetter = error < bestError;
+         bestError          = selectLanes(isBetter, error, bestError);
+         bestIndex          = selectLanes(isBetter, broadcastLanes(static_cast<float>(k)), bestIndex);
+      }
+
+      float bestIndices[floatLanesWidth];
+      storeLanes(bestIndices, bestIndex);
+      for (unsigned int j = 0; j < floatLanesWidth; ++j)
+      {
+         indices[i + j] = static_cast<unsigned int>(bestIndices[j]);
+      }
+
+      totalError = totalError + bestError;
+   }
+
+   return sumOfLanes(totalError);
+}
+
+// Finds the endpoints that minimize the squared error of the texels for the indices that were chosen, by least squares
+// Returns false if every texel uses the same weight, in which case the endpoints can't be solved for
+bool refineColorEndpoints(const BlockTexels& texels, const unsigned int indices[texelsPerBlock], float c0[3], float c1[3])
+{
+   const float weightsOfFirstEndpoint[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+   float alpha2    = 0.0f;
+   float beta2     = 0.0f;
+   float alphaBeta = 0.0f;
+   float alphaX[3] = {0.0f, 0.0f, 0.0f};
+   float betaX[3]  = {0.0f, 0.0f, 0.0f};
+
+   for (unsigned int i = 0; i < texelsPerBlock; ++i)
+   {
+      float alpha = weightsOfFirstEndpoint[indices[i]];
+      float beta  = 1.0f - alpha;
+      float x[3]  = {texels.r[i], texels.g[i], texels.b[i]};
+
+      alpha2    += alpha * alpha;
+      beta2     += beta * beta;
+      alphaBeta += alpha * beta;
+      for (unsigned int c = 0; c < 3; ++c)
+      {
+         alphaX[c] += alpha * x[c];
+         betaX[c]  += beta * x[c];
+      }
+   }
+
+   float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+   if (std::abs(determinant) < 1e-6f)
+   {
+      return false;
+   }
+
+   for (unsigned int c = 0; c < 3; ++c)
+   {
+      c0[c] = (alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant;
+      c1[c] = (betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant;
+   }
+
+   return true;
+}
+
+// The first guess of the endpoints are the extremes of the texels along the principal axis of their colors
+void findColorEndpoints(const BlockTexels& texels, float c0[3], float c1[3])
+{
+   FloatLanes sumR = broadcastLanes(0.0f);
+   FloatLanes sumG = broadcastLanes(0.0f);
+   FloatLanes sumB = broadcastLanes(0.0f);
+   for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+   {
+      sumR = sumR + loadLanes(texels.r + i);
+      sumG = sumG + loadLanes(texels.g + i);
+      sumB = sumB + loadLanes(texels.b + i);
+   }
+
+   float mean[3] = {sumOfLanes(sumR) / texelsPerBlock, sumOfLanes(sumG) / texelsPerBlock, sumOfLanes(sumB) / texelsPerBlock};
+
+   FloatLanes covRR = broadcastLanes(0.0f);
+   FloatLanes covGG = broadcastLanes(0.0f);
+   FloatLanes covBB = broadcastLanes(0.0f);
+   FloatLanes covRG = broadcastLanes(0.0f);
+   FloatLanes covRB = broadcastLanes(0.0f);
+   FloatLanes covGB = broadcastLanes(0.0f);
+   for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+   {
+      FloatLanes r = loadLanes(texels.r + i) - broadcastLanes(mean[0]);
+      FloatLanes g = loadLanes(texels.g + i) - broadcastLanes(mean[1]);
+      FloatLanes b = loadLanes(texels.b + i) - broadcastLanes(mean[2]);
+      covRR = covRR + r * r;
+      covGG = covGG + g * g;
+      covBB = covBB + b * b;
+      covRG = covRG + r * g;
+      covRB = covRB + r * b;
+      covGB = covGB + g * b;
+   }
+
+   float covariance[3][3];
+   covariance[0][0] = sumOfLanes(covRR);
+   covariance[1][1] = sumOfLanes(covGG);
+   covariance[2][2] = sumOfLanes(covBB);
+   covariance[0][1] = covariance[1][0] = sumOfLanes(covRG);
+   covariance[0][2] = covariance[2][0] = sumOfLanes(covRB);
+   covariance[1][2] = covariance[2][1] = sumOfLanes(covGB);
+
+   // A few iterations of the power method are enough to find the principal axis of 16 colors
+   float axis[3] = {1.0f, 1.0f, 1.0f};
+   for (unsigned int iteration = 0; iteration < 8; ++iteration)
+   {
+      float next[3];
+      for (unsigned int row = 0; row < 3; ++row)
+      {
+         next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+      }
+
+      float largest = std::max(std::abs(next[0]), std::max(std::abs(next[1]), std::abs(next[2])));
+      if (largest < 1e-6f)
+      {
+         // Every texel has the same color
+         std::copy(mean, mean + 3, c0);
+         std::copy(mean, mean + 3, c1);
+         return;
+      }
+
+      for (unsigned int c = 0; c < 3; ++c)
+      {
+         axis[c] = next[c] / largest;
+      }
+   }
+
+   float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+   for (unsigned int c = 0; c < 3; ++c)
+   {
+      axis[c] /= length;
+   }
+
+   FloatLanes minProjection = broadcastLanes(INFINITY);
+   FloatLanes maxProjection = broadcastLanes(-INFINITY);
+   for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+   {
+      FloatLanes projection = (loadLanes(texels.r + i) - broadcastLanes(mean[0])) * broadcastLanes(axis[0]) +
+                              (loadLanes(texels.g + i) - broadcastLanes(mean[1])) * broadcastLanes(axis[1]) +
+                              (loadLanes(texels.b + i) - broadcastLanes(mean[2])) * broadcastLanes(axis[2]);
+      minProjection = minLanes(minProjection, projection);
+      maxProjection = maxLanes(maxProjection, projection);
+   }
+
+   float tMin = minOfLanes(minProjection);
+   float tMax = maxOfLanes(maxProjection);
+   for (unsigned int c = 0; c < 3; ++c)
+   {
+      c0[c] = mean[c] + axis[c] * tMax;
+      c1[c] = mean[c] + axis[c] * tMin;
+   }
+}
+
+void compressColorBlock(const BlockTexels& texels, unsigned char* block)
+{
+   float c0[3];
+   float c1[3];
+   findColorEndpoints(texels, c0, c1);
+
+   QuantizedColor quantizedC0 = quantizeColor(c0);
+   QuantizedColor quantizedC1 = quantizeColor(c1);
+   unsigned int   indices[texelsPerBlock];
+   float          error       = chooseColorIndices(texels, quantizedC0, quantizedC1, indices);
+
+   // A single pass of least squares removes most of the error left by the principal axis, which ignores how the texels are spread along it
+   float refinedC0[3];
+   float refinedC1[3];
+   if (refineColorEndpoints(texels, indices, refinedC0, refinedC1))
+   {
+      QuantizedColor refinedQuantizedC0 = quantizeColor(refinedC0);
+      QuantizedColor refinedQuantizedC1 = quantizeColor(refinedC1);
+      unsigned int   refinedIndices[texelsPerBlock];
+      float          refinedError       = chooseColorIndices(texels, refinedQuantizedC0, refinedQuantizedC1, refinedIndices);
+      if (refinedError < error)
+      {
+         quantizedC0 = refinedQuantizedC0;
+         quantizedC1 = refinedQuantizedC1;
+         std::copy(refinedIndices, refinedIndices + texelsPerBlock, indices);
+      }
+   }
+
+   // The palette only has 4 colors when the first endpoint is greater than the second one, so they are swapped if needed,
+   // which swaps the endpoints in the palette too (0 <-> 1 and 2 <-> 3)
+   if (quantizedC0.packed < quantizedC1.packed)
+   {
+      std::swap(quantizedC0, quantizedC1);
+      for (unsigned int& index : indices)
+      {
+         index ^= 1;
+      }
+   }
+   else if (quantizedC0.packed == quantizedC1.packed)
+   {
+      std::fill(indices, indices + texelsPerBlock, 0);
+   }
+
+   std::uint32_t packedIndices = 0;
+   for (unsigned int i = 0; i < texelsPerBlock; ++i)
+   {
+      packedIndices |= static_cast<std::uint32_t>(indices[i]) << (2 * i);
+   }
+
+   block[0] = static_cast<unsigned char>(quantizedC0.packed & 0xFF);
+   block[1] = static_cast<unsigned char>(quantizedC0.packed >> 8);
+   block[2] = static_cast<unsigned char>(quantizedC1.packed & 0xFF);
+   block[3] = static_cast<unsigned char>(quantizedC1.packed >> 8);
+   for (unsigned int i = 0; i < 4; ++i)
+   {
+      block[4 + i] = static_cast<unsigned char>((packedIndices >> (8 * i)) & 0xFF);
+   }
+}
+
+// The alpha endpoints are the extremes of the block, which selects the palette that interpolates 6 values between them
+void compressAlphaBlock(const BlockTexels& texels, unsigned char* block)
+{
+   FloatLanes minAlpha = broadcastLanes(255.0f);
+   FloatLanes maxAlpha = broadcastLanes(0.0f);
+   for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+   {
+      minAlpha = minLanes(minAlpha, loadLanes(texels.a + i));
+      maxAlpha = maxLanes(maxAlpha, loadLanes(texels.a + i));
+   }
+
+   unsigned int a0 = static_cast<unsigned int>(maxOfLanes(maxAlpha));
+   unsigned int a1 = static_cast<unsigned int>(minOfLanes(minAlpha));
+
+   block[0] = static_cast<unsigned char>(a0);
+   block[1] = static_cast<unsigned char>(a1);
+
+   std::uint64_t packedIndices = 0;
+   if (a0 > a1)
+   {
+      // Snap each texel to the nearest of the 8 steps between the endpoints, where 7 is a0 and 0 is a1,
+      // and convert the step into its index in the palette, which starts with a0 and a1 and then goes from a0 to a1
+      FloatLanes scale = broadcastLanes(7.0f / static_cast<float>(a0 - a1));
+      for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+      {
+         FloatLanes steps = (loadLanes(texels.a + i) - broadcastLanes(static_cast<float>(a1))) * scale + broadcastLanes(0.5f);
+
+         float stepsOfTexels[floatLanesWidth];
+         storeLanes(stepsOfTexels, steps);
+         for (unsigned int j = 0; j < floatLanesWidth; ++j)
+         {
+            unsigned int  step  = std::min(static_cast<unsigned int>(stepsOfTexels[j]), 7u);
+            std::uint64_t index = (step == 7) ? 0 : ((step == 0) ? 1 : (8 - step));
+            packedIndices      |= index << (3 * (i + j));
+         }
+      }
+   }
+
+   for (unsigned int i = 0; i < 6; ++i)
+   {
+      block[2 + i] = static_cast<unsigned char>((packedIndices >> (8 * i)) & 0xFF);
+   }
+}
+
+// BC7 has 8 modes, which trade the number of subsets, the precision of the endpoints and the number of indices against each other
+// Only mode 6 is used: a single subset of RGBA endpoints with 7 bits per channel plus a bit shared by the channels of each endpoint, and 16 weights
+// between the endpoints, which is already better than BC1 and BC3 on every texture of the game without searching through partitions
+const unsigned int bc7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// The endpoints of a mode 6 block, as stored (7 bits per channel and a p-bit) and as the GPU expands them (8 bits per channel)
+struct BC7Endpoint
+{
+   unsigned int values[4];
+   unsigned int pBit;
+   float        expanded[4];
+};
+
+BC7Endpoint quantizeBC7Endpoint(const float endpoint[4], unsigned int pBit)
+{
+   BC7Endpoint quantizedEndpoint;
+   quantizedEndpoint.pBit = pBit;
+   for (unsigned int c = 0; c < 4; ++c)
+   {
+      float value = std::min(std::max(endpoint[c], 0.0f), 255.0f);
+      quantizedEndpoint.values[c]   = static_cast<unsigned int>(std::min(std::max((value - pBit) / 2.0f + 0.5f, 0.0f), 127.0f));
+      quantizedEndpoint.expanded[c] = static_cast<float>((quantizedEndpoint.values[c] << 1) | pBit);
+   }
+
+   return quantizedEndpoint;
+}
+
+// Picks the closest of the 16 colors between the endpoints for each texel, and returns the sum of the squared errors
+float chooseBC7Indices(const BlockTexels& texels, const BC7Endpoint& e0, const BC7Endpoint& e1, unsigned int indices[texelsPerBlock])
+{
+   // The colors are interpolated with integers, exactly like the GPU does
+   float palette[16][4];
+   for (unsigned int k = 0; k < 16; ++k)
+   {
+      for (unsigned int c = 0; c < 4; ++c)
+      {
+         unsigned int value0 = static_cast<unsigned int>(e0.expanded[c]);
+         unsigned int value1 = static_cast<unsigned int>(e1.expanded[c]);
+         palette[k][c]       = static_cast<float>(((64 - bc7Weights[k]) * value0 + bc7Weights[k] * value1 + 32) >> 6);
+      }
+   }
+
+   FloatLanes totalError = broadcastLanes(0.0f);
+   for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+   {
+      FloatLanes r = loadLanes(texels.r + i);
+      FloatLanes g = loadLanes(texels.g + i);
+      FloatLanes b = loadLanes(texels.b + i);
+      FloatLanes a = loadLanes(texels.a + i);
+
+      FloatLanes bestError = broadcastLanes(INFINITY);
+      FloatLanes bestIndex = broadcastLanes(0.0f);
+      for (unsigned int k = 0; k < 16; ++k)
+      {
+         FloatLanes dr    = r - broadcastLanes(palette[k][0]);
+         FloatLanes dg    = g - broadcastLanes(palette[k][1]);
+         FloatLanes db    = b - broadcastLanes(palette[k][2]);
+         FloatLanes da    = a - broadcastLanes(palette[k][3]);
+         FloatLanes error = dr * dr + dg * dg + db * db + da * da;
+
+         MaskLanes isBetter = error < bestError;
+         bestError          = selectLanes(isBetter, error, bestError);
+         bestIndex          = selectLanes(isBetter, broadcastLanes(static_cast<float>(k)), bestIndex);
+      }
+
+      float bestIndices[floatLanesWidth];
+      storeLanes(bestIndices, bestIndex);
+      for (unsigned int j = 0; j < floatLanesWidth; ++j)
+      {
+         indices[i + j] = static_cast<unsigned int>(bestIndices[j]);
+      }
+
+      totalError = totalError + bestError;
+   }
+
+   return sumOfLanes(totalError);
+}
+
+// Same as refineColorEndpoints, with the weights of BC7 and with alpha
+bool refineBC7Endpoints(const BlockTexels& texels, const unsigned int indices[texelsPerBlock], float e0[4], float e1[4])
+{
+   float alpha2    = 0.0f;
+   float beta2     = 0.0f;
+   float alphaBeta = 0.0f;
+   float alphaX[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+   float betaX[4]  = {0.0f, 0.0f, 0.0f, 0.0f};
+
+   for (unsigned int i = 0; i < texelsPerBlock; ++i)
+   {
+      float beta  = bc7Weights[indices[i]] / 64.0f;
+      float alpha = 1.0f - beta;
+      float x[4]  = {texels.r[i], texels.g[i], texels.b[i], texels.a[i]};
+
+      alpha2    += alpha * alpha;
+      beta2     += beta * beta;
+      alphaBeta += alpha * beta;
+      for (unsigned int c = 0; c < 4; ++c)
+      {
+         alphaX[c] += alpha * x[c];
+         betaX[c]  += beta * x[c];
+      }
+   }
+
+   float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+   if (std::abs(determinant) < 1e-6f)
+   {
+      return false;
+   }
+
+   for (unsigned int c = 0; c < 4; ++c)
+   {
+      e0[c] = (alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant;
+      e1[c] = (betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant;
+   }
+
+   return true;
+}
+
+// Same as findColorEndpoints, along the principal axis of the colors and the alpha of the texels
+void findBC7Endpoints(const BlockTexels& texels, float e0[4], float e1[4])
+{
+   const float* channels[4] = {texels.r, texels.g, texels.b, texels.a};
+
+   float mean[4];
+   for (unsigned int c = 0; c < 4; ++c)
+   {
+      FloatLanes sum = broadcastLanes(0.0f);
+      for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+      {
+         sum = sum + loadLanes(channels[c] + i);
+      }
+      mean[c] = sumOfLanes(sum) / texelsPerBlock;
+   }
+
+   float covariance[4][4];
+   for (unsigned int row = 0; row < 4; ++row)
+   {
+      for (unsigned int column = row; column < 4; ++column)
+      {
+         FloatLanes sum = broadcastLanes(0.0f);
+         for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+         {
+            sum = sum + (loadLanes(channels[row] + i) - broadcastLanes(mean[row])) * (loadLanes(channels[column] + i) - broadcastLanes(mean[column]));
+         }
+         covariance[row][column] = covariance[column][row] = sumOfLanes(sum);
+      }
+   }
+
+   float axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+   for (unsigned int iteration = 0; iteration < 8; ++iteration)
+   {
+      float next[4];
+      float largest = 0.0f;
+      for (unsigned int row = 0; row < 4; ++row)
+      {
+         next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2] + covariance[row][3] * axis[3];
+         largest   = std::max(largest, std::abs(next[row]));
+      }
+
+      if (largest < 1e-6f)
+      {
+         // Every texel has the same color and alpha
+         std::copy(mean, mean + 4, e0);
+         std::copy(mean, mean + 4, e1);
+         return;
+      }
+
+      for (unsigned int c = 0; c < 4; ++c)
+      {
+         axis[c] = next[c] / largest;
+      }
+   }
+
+   float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3]);
+   for (unsigned int c = 0; c < 4; ++c)
+   {
+      axis[c] /= length;
+   }
+
+   FloatLanes minProjection = broadcastLanes(INFINITY);
+   FloatLanes maxProjection = broadcastLanes(-INFINITY);
+   for (unsigned int i = 0; i < texelsPerBlock; i += floatLanesWidth)
+   {
+      FloatLanes projection = broadcastLanes(0.0f);
+      for (unsigned int c = 0; c < 4; ++c)
+      {
+         projection = projection + (loadLanes(channels[c] + i) - broadcastLanes(mean[c])) * broadcastLanes(axis[c]);
+      }
+      minProjection = minLanes(minProjection, projection);
+      maxProjection = maxLanes(maxProjection, projection);
+   }
+
+   float tMin = minOfLanes(minProjection);
+   float tMax = maxOfLanes(maxProjection);
+   for (unsigned int c = 0; c < 4; ++c)
+   {
+      e0[c] = mean[c] + axis[c] * tMin;
+      e1[c] = mean[c] + axis[c] * tMax;
+   }
+}
+
+// Writes the bits of a block from its least significant bit, which is how BC7 blocks are laid out
+struct BitWriter
+{
+   unsigned char* bytes;
+   unsigned int   position;
+
+   void write(unsigned int value, unsigned int numberOfBits)
+   {
+      for (unsigned int i = 0; i < numberOfBits; ++i, ++position)
+      {
+         bytes[position / 8] |= static_cast<unsigned char>(((value >> i) & 1) << (position % 8));
+      }
+   }
+};
+
+// The best endpoints and indices that compressBC7Block has found so far
+struct BC7Encoding
+{
+   BC7Endpoint  e0;
+   BC7Endpoint  e1;
+   unsigned int indices[texelsPerBlock];
+   float        error;
+};
+
+// Quantizes the endpoints with each pair of p-bits, since the p-bit that rounds one channel best can round another one worst,
+// and keeps the pair if it's closer to the texels than the best encoding so far
+// Opaque blocks only get p-bits of 1, which keep their alpha at 255 instead of trading it for a closer color
+void tryBC7Endpoints(const BlockTexels& texels, const float e0[4], const float e1[4], bool isOpaque, BC7Encoding& best)
+{
+   for (unsigned int pBits = isOpaque ? 3 : 0; pBits < 4; ++pBits)
+   {
+      BC7Encoding candidate;
+      candidate.e0    = quantizeBC7Endpoint(e0, pBits & 1);
+      candidate.e1    = quantizeBC7Endpoint(e1, pBits >> 1);
+      candidate.error = chooseBC7Indices(texels, candidate.e0, candidate.e1, candidate.indices);
+      if (candidate.error < best.error)
+      {
+         best = candidate;
+      }
+   }
+}
+
+void compressBC7Block(const BlockTexels& texels, unsigned char* block)
+{
+   float e0[4];
+   float e1[4];
+   findBC7Endpoints(texels, e0, e1);
+
+   bool isOpaque = true;
+   for (float alpha : texels.a)
+   {
+      isOpaque = isOpaque && (alpha == 255.0f);
+   }
+
+   BC7Encoding best;
+   best.error = INFINITY;
+   tryBC7Endpoints(texels, e0, e1, isOpaque, best);
+
+   float refinedE0[4];
+   float refinedE1[4];
+   if (refineBC7Endpoints(texels, best.indices, refinedE0, refinedE1))
+   {
+      tryBC7Endpoints(texels, refinedE0, refinedE1, isOpaque, best);
+      std::copy(refinedE0, refinedE0 + 4, e0);
+      std::copy(refinedE1, refinedE1 + 4, e1);
+   }
+
+   // A channel whose value falls between two values that the p-bits allow (e.g. an even grey with an opaque alpha) is only reached
+   // by interpolating between endpoints on either side of it, which flat blocks never get, so the endpoints are also tried one step apart
+   for (unsigned int c = 0; c < 4; ++c)
+   {
+      float step = (e0[c] <= e1[c]) ? 1.0f : -1.0f;
+      e0[c]     -= step;
+      e1[c]     += step;
+   }
+   tryBC7Endpoints(texels, e0, e1, isOpaque, best);
+
+   BC7Endpoint  quantizedE0 = best.e0;
+   BC7Endpoint  quantizedE1 = best.e1;
+   unsigned int indices[texelsPerBlock];
+   std::copy(best.indices, best.indices + texelsPerBlock, indices);
+
+   // The index of the first texel is stored without its top bit, which must be 0, so the endpoints are swapped if it isn't
+   if (indices[0] >= 8)
+   {
+      std::swap(quantizedE0, quantizedE1);
+      for (unsigned int& index : indices)
+      {
+         index = 15 - index;
+      }
+   }
+
+   std::fill(block, block + 16, 0);
+   BitWriter writer = {block, 0};
+   writer.write(1 << 6, 7);
+   for (unsigned int c = 0; c < 4; ++c)
+   {
+      writer.write(quantizedE0.values[c], 7);
+      writer.write(quantizedE1.values[c], 7);
+   }
+   writer.write(quantizedE0.pBit, 1);
+   writer.write(quantizedE1.pBit, 1);
+   writer.write(indices[0], 3);
+   for (unsigned int i = 1; i < texelsPerBlock; ++i)
+   {
+      writer.write(indices[i], 4);
+   }
+}
+
+void compressTextureLevel(const unsigned char* rgbaTexels, unsigned int width, unsigned int height, CookedTextureFormat format, unsigned char* blocks)
+{
+   unsigned int   sizeOfBlock = (format == CookedTextureBC1) ? 8 : 16;
+   unsigned char* block       = blocks;
+
+   for (unsigned int blockY = 0; blockY < height; blockY += 4)
+   {
+      for (unsigned int blockX = 0; blockX < width; blockX += 4)
+      {
+         BlockTexels texels;
+         for (unsigned int y = 0; y < 4; ++y)
+         {
+            for (unsigned int x = 0; x < 4; ++x)
+            {
+               const unsigned char* texel = rgbaTexels + 4 * (static_cast<std::size_t>(std::min(blockY + y, height - 1)) * width + std::min(blockX + x, width - 1));
+               texels.r[4 * y + x] = texel[0];
+               texels.g[4 * y + x] = texel[1];
+               texels.b[4 * y + x] = texel[2];
+               texels.a[4 * y + x] = texel[3];
+            }
+         }
+
+         if (format == CookedTextureBC1)
+         {
+            compressColorBlock(texels, block);
+         }
+         else if (format == CookedTextureBC7)
+         {
+            compressBC7Block(texels, block);
+         }
+         else
+         {
+            compressAlphaBlock(texels, block);
+            compressColorBlock(texels, block + 8);
+         }
+
+         block += sizeOfBlock;
+      }
+   }
+}
+
+// The decoders follow the GPU closely enough for a texture to look the same when a driver can't sample its blocks, but they aren't bit exact
+void decompressColorBlock(const unsigned char* block, bool allowTransparentTexels, unsigned char texels[texelsPerBlock][4])
+{
+   unsigned int color0 = block[0] | (block[1] << 8);
+   unsigned int color1 = block[2] | (block[3] << 8);
+
+   unsigned int palette[4][4];
+   for (unsigned int k = 0; k < 2; ++k)
+   {
+      unsigned int color = (k == 0) ? color0 : color1;
+      unsigned int r     = (color >> 11) & 31;
+      unsigned int g     = (color >> 5) & 63;
+      unsigned int b     = color & 31;
+      palette[k][0]      = (r << 3) | (r >> 2);
+      palette[k][1]      = (g << 2) | (g >> 4);
+      palette[k][2]      = (b << 3) | (b >> 2);
+      palette[k][3]      = 255;
+   }
+
+   for (unsigned int c = 0; c < 4; ++c)
+   {
+      if (color0 > color1 || !allowTransparentTexels)
+      {
+         palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+         palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+      }
+      else
+      {
+         // BC1 blocks whose first color isn't the greater one have a single color in between and transparent black
+         palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+         palette[3][c] = 0;
+      }
+   }
+
+   unsigned int indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<unsigned int>(block[7]) << 24);
+   for (unsigned int i = 0; i < texelsPerBlock; ++i)
+   {
+      const unsigned int* color = palette[(indices >> (2 * i)) & 3];
+      for (unsigned int c = 0; c < 4; ++c)
+      {
+         texels[i][c] = static_cast<unsigned char>(color[c]);
+      }
+   }
+}
+
+void decompressAlphaBlock(const unsigned char* block, unsigned char texels[texelsPerBlock][4])
+{
+   unsigned int palette[8];
+   palette[0] = block[0];
+   palette[1] = block[1];
+   if (palette[0] > palette[1])
+   {
+      for (unsigned int k = 1; k < 7; ++k)
+      {
+         palette[k + 1] = ((7 - k) * palette[0] + k * palette[1] + 3) / 7;
+      }
+   }
+   else
+   {
+      for (unsigned int k = 1; k < 5; ++k)
+      {
+         palette[k + 1] = ((5 - k) * palette[0] + k * palette[1] + 2) / 5;
+      }
+      palette[6] = 0;
+      palette[7] = 255;
+   }
+
+   std::uint64_t indices = 0;
+   for (unsigned int i = 0; i < 6; ++i)
+   {
+      indices |= static_cast<std::uint64_t>(block[2 + i]) << (8 * i);
+   }
+
+   for (unsigned int i = 0; i < texelsPerBlock; ++i)
+   {
+      texels[i][3] = static_cast<unsigned char>(palette[(indices >> (3 * i)) & 7]);
+   }
+}
+
+// Reads the bits of a block from its least significant bit, like BitWriter writes them
+struct BitReader
+{
+   const unsigned char* bytes;
+   unsigned int         position;
+
+   unsigned int read(unsigned int numberOfBits)
+   {
+      unsigned int value = 0;
+      for (unsigned int i = 0; i < numberOfBits; ++i, ++position)
+      {
+         value |= ((bytes[position / 8] >> (position % 8)) & 1) << i;
+      }
+      return value;
+   }
+};
+
+void decompressBC7Block(const unsigned char* block, unsigned char texels[texelsPerBlock][4])
+{
+   // Only the mode that compressBC7Block writes is decoded, and blocks of any other mode come out magenta so that they're noticed
+   if ((block[0] & 0x7F) != (1 << 6))
+   {
+      for (unsigned int i = 0; i < texelsPerBlock; ++i)
+      {
+         texels[i][0] = 255;
+         texels[i][1] = 0;
+         texels[i][2] = 255;
+         texels[i][3] = 255;
+      }
+      return;
+   }
+
+   BitReader    reader = {block, 7};
+   unsigned int values[4][2];
+   for (unsigned int c = 0; c < 4; ++c)
+   {
+      values[c][0] = reader.read(7);
+      values[c][1] = reader.read(7);
+   }
+
+   unsigned int pBits[2];
+   pBits[0] = reader.read(1);
+   pBits[1] = reader.read(1);
+
+   for (unsigned int i = 0; i < texelsPerBlock; ++i)
+   {
+      unsigned int weight = bc7Weights[reader.read((i == 0) ? 3 : 4)];
+      for (unsigned int c = 0; c < 4; ++c)
+      {
+         unsigned int value0 = (values[c][0] << 1) | pBits[0];
+         unsigned int value1 = (values[c][1] << 1) | pBits[1];
+         texels[i][c]        = static_cast<unsigned char>(((64 - weight) * value0 + weight * value1 + 32) >> 6);
+      }
+   }
+}
+
+void decompressTextureLevel(const unsigned char* blocks, unsigned int width, unsigned int height, CookedTextureFormat format, unsigned char* rgbaTexels)
+{
+   unsigned int         sizeOfBlock = (format == CookedTextureBC1) ? 8 : 16;
+   const unsigned char* block       = blocks;
+
+   for (unsigned int blockY = 0; blockY < height; blockY += 4)
+   {
+      for (unsigned int blockX = 0; blockX < width; blockX += 4)
+      {
+         unsigned char texels[texelsPerBlock][4];
+         if (format == CookedTextureBC1)
+         {
+            decompressColorBlock(block, true, texels);
+         }
+         else if (format == CookedTextureBC7)
+         {
+            decompressBC7Block(block, texels);
+         }
+         else
+         {
+            decompressColorBlock(block + 8, false, texels);
+            decompressAlphaBlock(block, texels);
+         }
+
+         // The texels of the blocks on the right and bottom edges that are outside of the level are dropped
+         for (unsigned int y = 0; y < 4 && blockY + y < height; ++y)
+         {
+            for (unsigned int x = 0; x < 4 && blockX + x < width; ++x)
+            {
+               unsigned char* texel = rgbaTexels + 4 * (static_cast<std::size_t>(blockY + y) * width + blockX + x);
+               std::copy(texels[4 * y + x], texels[4 * y + x] + 4, texel);
+            }
+         }
+
+         block += sizeOfBlock;
+      }
+   }
+}
+
+void decompressCookedTexture(CookedTextureContents& contents)
+{
+   if (contents.format == CookedTextureRGBA8)
+   {
+      return;
+   }
+
+   std::vector<CookedTextureLevel> levels;
+   std::vector<std::uint8_t>       data;
+   levels.reserve(contents.levels.size());
+
+   for (const CookedTextureLevel& level : contents.levels)
+   {
+      CookedTextureLevel decompressedLevel;
+      decompressedLevel.width  = level.width;
+      decompressedLevel.height = level.height;
+      decompressedLevel.offset = data.size();
+      decompressedLevel.size   = getSizeOfCookedTextureLevel(CookedTextureRGBA8, level.width, level.height);
+
+      data.resize(data.size() + decompressedLevel.size);
+      decompressTextureLevel(&contents.data[level.offset], level.width, level.height, static_cast<CookedTextureFormat>(contents.format), &data[decompressedLevel.offset]);
+      levels.push_back(decompressedLevel);
+   }
+
+   contents.format = CookedTextureRGBA8;
+   contents.levels.swap(levels);
+   contents.data.swap(data);
+}
@@ -0,0 +1,487 @@
+#include <limits>
+
+#include "collider.h"
+#include "collision.h"
+
+// Circles, capsules, AABBs and OBBs are all convex polygons with up to four vertices (their cores) whose edges are pushed out by a radius
+// Pairs that don't have a routine of their own are handled with that representation
+struct RoundedPolygon
+{
+   std::array<glm::vec2, 4> vertices;
+   unsigned int             numberOfVertices;
+   float                    radius;
+};
+
+RoundedPolygon makeRoundedPolygon(const Circle& circle)
+{
+   return RoundedPolygon{{{circle.center}}, 1, circle.radius};
+}
+
+RoundedPolygon makeRoundedPolygon(const Capsule& capsule)
+{
+   return RoundedPolygon{{{capsule.start, capsule.end}}, 2, capsule.radius};
+}
+
+RoundedPolygon makeRoundedPolygon(const AABB& aabb)
+{
+   glm::vec2 min = aabb.center - aabb.halfExtents;
+   glm::vec2 max = aabb.center + aabb.halfExtents;
+   return RoundedPolygon{{{min, glm::vec2(max.x, min.y), max, glm::vec2(min.x, max.y)}}, 4, 0.0f};
+}
+
+RoundedPolygon makeRoundedPolygon(const OBB& obb)
+{
+   glm::vec2 halfAxisX = obb.axis * obb.halfExtents.x;
+   glm::vec2 halfAxisY = glm::vec2(-obb.axis.y, obb.axis.x) * obb.halfExtents.y;
+   return RoundedPolygon{{{obb.center - halfAxisX - halfAxisY,
+                           obb.center + halfAxisX - halfAxisY,
+                           obb.center + halfAxisX + halfAxisY,
+                           obb.center - halfAxisX + halfAxisY}}, 4, 0.0f};
+}
+
+glm::vec2 closestPointOnSegment(const glm::vec2& point, const glm::vec2& start, const glm::vec2& end)
+{
+   glm::vec2 segment       = end - start;
+   float     squaredLength = glm::dot(segment, segment);
+   if (squaredLength == 0.0f)
+   {
+      return start;
+   }
+
+   return start + segment * glm::clamp(glm::dot(point - start, segment) / squaredLength, 0.0f, 1.0f);
+}
+
+// Returns the signed distance between the surfaces of the polygons after a has been moved by offsetOfA, which is negative if they overlap
+// normal receives the direction in which a must move to increase that distance
+float calculateSeparation(const RoundedPolygon& a, const glm::vec2& offsetOfA, const RoundedPolygon& b, glm::vec2& normal)
+{
+   std::array<glm::vec2, 4> verticesOfA;
+   for (unsigned int i = 0; i < a.numberOfVertices; ++i)
+   {
+      verticesOfA[i] = a.vertices[i] + offsetOfA;
+   }
+
+   // Separating axis test between the cores
+   // The opposite edges of a box are parallel, so boxes only contribute two axes, and segments contribute their normal and their direction
+   std::array<glm::vec2, 4> axes;
+   unsigned int             numberOfAxes = 0;
+   for (const RoundedPolygon* polygon : {&a, &b})
+   {
+      if (polygon->numberOfVertices >= 2)
+      {
+         glm::vec2 firstEdge = polygon->vertices[1] - polygon->vertices[0];
+         glm::vec2 secondEdge = (polygon->numberOfVertices == 2) ? glm::vec2(-firstEdge.y, firstEdge.x) : (polygon->vertices[2] - polygon->vertices[1]);
+         for (const glm::vec2& edge : {firstEdge, secondEdge})
+         {
+            float length = glm::length(edge);
+            if (length > 0.0f)
+            {
+               axes[numberOfAxes++] = glm::vec2(-edge.y, edge.x) / length;
+            }
+         }
+      }
+   }
+
+   bool      coresAreSeparated = (numberOfAxes == 0);
+   float     smallestOverlap   = std::numeric_limits<float>::max();
+   glm::vec2 axisOfSmallestOverlap(1.0f, 0.0f);
+   for (unsigned int i = 0; i < numberOfAxes && !coresAreSeparated; ++i)
+   {
+      float minOfA = std::numeric_limits<float>::max();
+      float maxOfA = std::numeric_limits<float>::lowest();
+      float minOfB = std::numeric_limits<float>::max();
+      float maxOfB = std::numeric_limits<float>::lowest();
+      for (unsigned int j = 0; j < a.numberOfVertices; ++j)
+      {
+         float projection = glm::dot(verticesOfA[j], axes[i]);
+         minOfA           = glm::min(minOfA, projection);
+         maxOfA           = glm::max(maxOfA, projection);
+      }
+
+      for (unsigned int j = 0; j < b.numberOfVertices; ++j)
+      {
+         float projection = glm::dot(b.vertices[j], axes[i]);
+         minOfB           = glm::min(minOfB, projection);
+         maxOfB           = glm::max(maxOfB, projection);
+      }
+
+      // a can be pushed out of b towards either end of the axis, and the overlap is how far it must move to get past the nearest one
+      // This isn't the length of the intersection of the projections, which is too short when one of them contains the other (e.g. when a point is inside of a box)
+      float overlapTowardsMax = maxOfB - minOfA;
+      float overlapTowardsMin = maxOfA - minOfB;
+      float overlap           = glm::min(overlapTowardsMax, overlapTowardsMin);
+      if (overlap < 0.0f || overlap < smallestOverlap)
+      {
+         // The axis that separates the cores is kept as the normal of cores that barely touch (see below)
+         coresAreSeparated     = (overlap < 0.0f);
+         smallestOverlap       = overlap;
+         axisOfSmallestOverlap = (overlapTowardsMax < overlapTowardsMin) ? axes[i] : -axes[i];
+      }
+   }
+
+   if (!coresAreSeparated)
+   {
+      normal = axisOfSmallestOverlap;
+      return -smallestOverlap - a.radius - b.radius;
+   }
+
+   // The closest points between two separated convex polygons are always a vertex of one of them and a point on an edge of the other one
+   // Polygons with fewer than three vertices only have one edge, which is degenerate for points
+   float     smallestSquaredDistance = std::numeric_limits<float>::max();
+   glm::vec2 closestPointOnA(0.0f);
+   glm::vec2 closestPointOnB(0.0f);
+   for (int side = 0; side < 2; ++side)
+   {
+      const glm::vec2* vertices         = (side == 0) ? verticesOfA.data() : b.vertices.data();
+      unsigned int     numberOfVertices = (side == 0) ? a.numberOfVertices : b.numberOfVertices;
+      const glm::vec2* edges            = (side == 0) ? b.vertices.data() : verticesOfA.data();
+      unsigned int     numberOfCorners  = (side == 0) ? b.numberOfVertices : a.numberOfVertices;
+      unsigned int     numberOfEdges    = (numberOfCorners >= 3) ? numberOfCorners : 1;
+
+      for (unsigned int i = 0; i < numberOfVertices; ++i)
+      {
+         for (unsigned int j = 0; j < numberOfEdges; ++j)
+         {
+            glm::vec2 pointOnEdge     = closestPointOnSegment(vertices[i], edges[j], edges[(j + 1) % numberOfCorners]);
+            glm::vec2 vecBetween      = vertices[i] - pointOnEdge;
+            float     squaredDistance = glm::dot(vecBetween, vecBetween);
+            if (squaredDistance < smallestSquaredDistance)
+            {
+               smallestSquaredDistance = squaredDistance;
+               closestPointOnA         = (side == 0) ? vertices[i] : pointOnEdge;
+               closestPointOnB         = (side == 0) ? pointOnEdge : vertices[i];
+            }
+         }
+      }
+   }
+
+   // The closest points of cores that barely touch are so close that the direction between them is mostly rounding errors
+   const float minDistanceForNormal = 1e-4f;
+
+   float distance = glm::sqrt(smallestSquaredDistance);
+   normal         = (distance > minDistanceForNormal) ? ((closestPointOnA - closestPointOnB) / distance) : axisOfSmallestOverlap;
+   return distance - a.radius - b.radius;
+}
+
+// Uses conservative advancement: the distance between two convex shapes that move in straight lines is a convex function of time,
+// so stepping to the time at which its tangent reaches 0 never steps past the time of impact
+bool findContactBetweenRoundedPolygons(const RoundedPolygon& a, const RoundedPolygon& b, const glm::vec2& displacementOfA, Contact& contact)
+{
+   const unsigned int maxNumberOfIterations = 32;
+   const float        tolerance             = 1e-4f;
+
+   glm::vec2 normal;
+   float     separation = calculateSeparation(a, glm::vec2(0.0f), b, normal);
+   if (separation < 0.0f)
+   {
+      if (glm::dot(displacementOfA, normal) > 0.0f)
+      {
+         return false;
+      }
+
+      contact = Contact{normal, -separation, 0.0f};
+      return true;
+   }
+
+   float timeOfImpact = 0.0f;
+   for (unsigned int i = 0; i < maxNumberOfIterations; ++i)
+   {
+      // The shapes touch, whichever way the normal points at that distance
+      if (separation <= tolerance)
+      {
+         break;
+      }
+
+      float speedOfApproach = -glm::dot(displacementOfA, normal);
+      if (speedOfApproach <= 0.0f)
+      {
+         return false;
+      }
+
+      timeOfImpact += separation / speedOfApproach;
+      if (timeOfImpact > 1.0f)
+      {
+         return false;
+      }
+
+      separation = calculateSeparation(a, displacementOfA * timeOfImpact, b, normal);
+   }
+
+   // If we ran out of iterations, the shapes are grazing each other, and we report a contact to be safe
+   contact = Contact{normal, 0.0f, timeOfImpact};
+   return true;
+}
+
+// Narrow-phase routines
+// Each one finds the contact between a, which moves by displacementOfA, and b, which stands still
+
+template<typename A, typename B>
+bool findContactBetween(const A& a, const B& b, const glm::vec2& displacementOfA, Contact& contact)
+{
+   return findContactBetweenRoundedPolygons(makeRoundedPolygon(a), makeRoundedPolygon(b), displacementOfA, contact);
+}
+
+bool findContactBetween(const Circle& a, const Circle& b, const glm::vec2& displacementOfA, Contact& contact)
+{
+   glm::vec2 vecBetweenCenters = a.center - b.center;
+   float     sumOfRadii        = a.radius + b.radius;
+   float     c                 = glm::dot(vecBetweenCenters, vecBetweenCenters) - (sumOfRadii * sumOfRadii);
+   float     halfB             = glm::dot(vecBetweenCenters, displacementOfA);
+
+   if (c < 0.0f)
+   {
+      float     distance = glm::sqrt(glm::dot(vecBetweenCenters, vecBetweenCenters));
+      glm::vec2 normal   = (distance > 0.0f) ? (vecBetweenCenters / distance) : glm::vec2(1.0f, 0.0f);
+      if (glm::dot(displacementOfA, normal) > 0.0f)
+      {
+         return false;
+      }
+
+      contact = Contact{normal, sumOfRadii - distance, 0.0f};
+      return true;
+   }
+
+   // Solve |vecBetweenCenters + displacementOfA * t| = sumOfRadii for the smallest t
+   float a2           = glm::dot(displacementOfA, displacementOfA);
+   float discriminant = (halfB * halfB) - (a2 * c);
+   if (halfB >= 0.0f || discriminant < 0.0f)
+   {
+      return false;
+   }
+
+   float timeOfImpact = glm::max((-halfB - glm::sqrt(discriminant)) / a2, 0.0f);
+   if (timeOfImpact > 1.0f)
+   {
+      return false;
+   }
+
+   contact = Contact{glm::normalize(vecBetweenCenters + displacementOfA * timeOfImpact), 0.0f, timeOfImpact};
+   return true;
+}
+
+bool findContactBetween(const Circle& a, const AABB& b, const glm::vec2& displacementOfA, Contact& contact)
+{
+   // The ball and the paddles of a match are circles and AABBs, so this pair reuses the sweep of the match
+   BallState   circle = {};
+   PaddleState aabb   = {};
+   circle.position    = glm::vec3(a.center, 0.0f);
+   circle.radius      = a.radius;
+   aabb.position      = glm::vec3(b.center, 0.0f);
+   aabb.width         = 2.0f * b.halfExtents.x;
+   aabb.height        = 2.0f * b.halfExtents.y;
+
+   glm::vec2 vecFromCenterOfCircleToPointOfCollision;
+   if (circleAndAABBCollided(circle, aabb, vecFromCenterOfCircleToPointOfCollision))
+   {
+      float distance = glm::length(vecFromCenterOfCircleToPointOfCollision);
+      if (distance == 0.0f)
+      {
+         // The center of the circle is inside of the AABB, so the direction in which it must be pushed out can't be derived from the closest point
+         return findContactBetweenRoundedPolygons(makeRoundedPolygon(a), makeRoundedPolygon(b), displacementOfA, contact);
+      }
+
+      glm::vec2 normal = -vecFromCenterOfCircleToPointOfCollision / distance;
+      if (glm::dot(displacementOfA, normal) > 0.0f)
+      {
+         return false;
+      }
+
+      contact = Contact{normal, a.radius - distance, 0.0f};
+      return true;
+   }
+
+   float timeOfImpact;
+   if (!sweptCircleAndAABBCollided(circle, displacementOfA, aabb, glm::vec2(0.0f), timeOfImpact, vecFromCenterOfCircleToPointOfCollision))
+   {
+      return false;
+   }
+
+   contact = Contact{-glm::normalize(vecFromCenterOfCircleToPointOfCollision), 0.0f, timeOfImpact};
+   return true;
+}
+
+bool findContactBetween(const AABB& a, const Circle& b, const glm::vec2& displacementOfA, Contact& contact)
+{
+   if (!findContactBetween(b, a, -displacementOfA, contact))
+   {
+      return false;
+   }
+
+   contact.normal = -contact.normal;
+   return true;
+}
+
+// The distance between a shape and a half-plane changes linearly as the shape moves, so the time of impact can be solved directly
+template<typename A>
+bool findContactBetween(const A& a, const HalfPlane& b, const glm::vec2& displacementOfA, Contact& contact)
+{
+   RoundedPolygon polygon = makeRoundedPolygon(a);
+
+   float lowestProjection = std::numeric_limits<float>::max();
+   for (unsigned int i = 0; i < polygon.numberOfVertices; ++i)
+   {
+      lowestProjection = glm::min(lowestProjection, glm::dot(polygon.vertices[i], b.normal));
+   }
+
+   float separation      = lowestProjection - polygon.radius - b.offset;
+   float speedOfApproach = -glm::dot(displacementOfA, b.normal);
+   if (separation < 0.0f)
+   {
+      if (speedOfApproach < 0.0f)
+      {
+         return false;
+      }
+
+      contact = Contact{b.normal, -separation, 0.0f};
+      return true;
+   }
+
+   if (speedOfApproach <= 0.0f || separation > speedOfApproach)
+   {
+      return false;
+   }
+
+   contact = Contact{b.normal, 0.0f, separation / speedOfApproach};
+   return true;
+}
+
+template<typename B>
+bool findContactBetween(const HalfPlane& a, const B& b, const glm::vec2& displacementOfA, Contact& contact)
+{
+   if (!findContactBetween(b, a, -displacementOfA, contact))
+   {
+      return false;
+   }
+
+   contact.normal = -contact.normal;
+   return true;
+}
+
+bool findContactBetween(const HalfPlane&, const HalfPlane&, const glm::vec2&, Contact&)
+{
+   // Half-planes are only meant to be used as walls, which never collide with each other
+   return false;
+}
+
+// Batched narrow phase
+// Each entry of the table runs the routine of one pair of shape types over every pair of shapes in two contiguous arrays
+
+typedef void (*NarrowPhaseBatch)(const void*          shapesA,
+                                 const glm::vec2*     displacementsOfA,
+                                 std::size_t          numberOfShapesA,
+                                 const void*          shapesB,
+                                 const std::uint32_t* idsOfB,
+                                 std::size_t          numberOfShapesB,
+                                 std::vector<ColliderHit>& hits);
+
+template<typename A, typename B>
+void findContactsBetweenBatches(const void*          shapesA,
+                                const glm::vec2*     displacementsOfA,
+                                std::size_t          numberOfShapesA,
+                                const void*          shapesB,
+                                const std::uint32_t* idsOfB,
+                                std::size_t          numberOfShapesB,
+                                std::vector<ColliderHit>& hits)
+{
+   const A* a = static_cast<const A*>(shapesA);
+   const B* b = static_cast<const B*>(shapesB);
+
+   Contact contact;
+   for (std::size_t i = 0; i < numberOfShapesA; ++i)
+   {
+      for (std::size_t j = 0; j < numberOfShapesB; ++j)
+      {
+         if (findContactBetween(a[i], b[j], displacementsOfA[i], contact))
+         {
+            hits.push_back(ColliderHit{static_cast<std::uint32_t>(i), idsOfB[j], contact});
+         }
+      }
+   }
+}
+
+// The rows and the columns follow the order of ShapeType
+const NarrowPhaseBatch narrowPhaseTable[numberOfShapeTypes][numberOfShapeTypes] =
+{
+   {&findContactsBetweenBatches<Circle, Circle>,    &findContactsBetweenBatches<Circle, AABB>,    &findContactsBetweenBatches<Circle, Capsule>,    &findContactsBetweenBatches<Circle, OBB>,    &findContactsBetweenBatches<Circle, HalfPlane>},
+   {&findContactsBetweenBatches<AABB, Circle>,      &findContactsBetweenBatches<AABB, AABB>,      &findContactsBetweenBatches<AABB, Capsule>,      &findContactsBetweenBatches<AABB, OBB>,      &findContactsBetweenBatches<AABB, HalfPlane>},
+   {&findContactsBetweenBatches<Capsule, Circle>,   &findContactsBetweenBatches<Capsule, AABB>,   &findContactsBetweenBatches<Capsule, Capsule>,   &findContactsBetweenBatches<Capsule, OBB>,   &findContactsBetweenBatches<Capsule, HalfPlane>},
+   {&findContactsBetweenBatches<OBB, Circle>,       &findContactsBetweenBatches<OBB, AABB>,       &findContactsBetweenBatches<OBB, Capsule>,       &findContactsBetweenBatches<OBB, OBB>,       &findContactsBetweenBatches<OBB, HalfPlane>},
+   {&findContactsBetweenBatches<HalfPlane, Circle>, &findContactsBetweenBatches<HalfPlane, AABB>, &findContactsBetweenBatches<HalfPlane, Capsule>, &findContactsBetweenBatches<HalfPlane, OBB>, &findContactsBetweenBatches<HalfPlane, HalfPlane>}
+};
+
+ColliderSet::ColliderSet()
+   : mShapes()
+   , mIDsOfColliders()
+   , mNumberOfColliders(0)
+{
+
+}
+
+void ColliderSet::clear()
+{
+   std::get<std::vector<Circle>>(mShapes).clear();
+   std::get<std::vector<AABB>>(mShapes).clear();
+   std::get<std::vector<Capsule>>(mShapes).clear();
+   std::get<std::vector<OBB>>(mShapes).clear();
+   std::get<std::vector<HalfPlane>>(mShapes).clear();
+
+   for (std::vector<std::uint32_t>& ids : mIDsOfColliders)
+   {
+      ids.clear();
+   }
+
+   mNumberOfColliders = 0;
+}
+
+std::size_t ColliderSet::getNumberOfColliders() const
+{
+   return mNumberOfColliders;
+}
+
+void ColliderSet::sweep(ShapeType typeOfShapes, const void* shapes, const glm::vec2* displacements, std::size_t numberOfShapes, std::vector<ColliderHit>& hits) const
+{
+   const std::array<const void*, numberOfShapeTypes> colliders = {std::get<std::vector<Circle>>(mShapes).data(),
+                                                                  std::get<std::vector<AABB>>(mShapes).data(),
+                                                                  std::get<std::vector<Capsule>>(mShapes).data(),
+                                                                  std::get<std::vector<OBB>>(mShapes).data(),
+                                                                  std::get<std::vector<HalfPlane>>(mShapes).data()};
+
+   const NarrowPhaseBatch* row = narrowPhaseTable[static_cast<std::size_t>(typeOfShapes)];
+   for (std::size_t typeOfColliders = 0; typeOfColliders < numberOfShapeTypes; ++typeOfColliders)
+   {
+      const std::vector<std::uint32_t>& ids = mIDsOfColliders[typeOfColliders];
+      if (!ids.empty())
+      {
+         row[typeOfColliders](shapes, displacements, numberOfShapes, colliders[typeOfColliders], ids.data(), ids.size(), hits);
+      }
+   }
+}
+
+bool findEarliestHit(const std::vector<ColliderHit>& hits, ColliderHit& earliestHit)
+{
+   if (hits.empty())
+   {
+      return false;
+   }
+
+   earliestHit = hits.front();
+   for (const ColliderHit& hit : hits)
+   {
+      if (hit.contact.timeOfImpact < earliestHit.contact.timeOfImpact)
+      {
+         earliestHit = hit;
+      }
+   }
+
+   return true;
+}
+
+Circle makeCircle(const BallState& ball)
+{
+   return Circle{glm::vec2(ball.position), ball.radius};
+}
+
+AABB makeAABB(const PaddleState& paddle)
+{
+   return AABB{glm::vec2(paddle.position), glm::vec2(paddle.width / 2.0f, paddle.height / 2.0f)};
+}
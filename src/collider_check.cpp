@@ -0,0 +1,467 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "collider.h"
+#include "match_simulation.h"
+
+// Sweeps random shapes against random colliders through ColliderSet, for every pair of shape types in its dispatch table,
+// checks the contacts it finds against a reference that measures the distance between the shapes directly, and reports how long each pair takes
+// Usage: teapong_collider_check [--cases N] [--seed N]
+//   --cases  Number of random sweeps checked for each pair of shape types (defaults to 20000)
+//   --seed   Seed of the random shapes (defaults to 1)
+
+enum Check
+{
+   // At the time of impact, the shapes touch
+   ShapesTouchAtTimeOfImpact,
+   // Before the time of impact, or during the whole sweep if there isn't one, the shapes don't overlap
+   NoOverlapBeforeImpact,
+   // The depth of shapes that overlap at the start of the sweep is how much they overlap
+   DepthIsOverlap,
+   // Sweeping the collider against the shape in the opposite direction finds the same contact
+   SweepIsSymmetric,
+   NumberOfChecks
+};
+
+const std::array<const char*, NumberOfChecks> namesOfChecks       = {"touch", "tunneling", "depth", "symmetry"};
+const std::array<const char*, numberOfShapeTypes> namesOfShapeTypes = {"Circle", "AABB", "Capsule", "OBB", "HalfPlane"};
+
+const float        toleranceOfDistance     = 2e-3f;
+const float        toleranceOfTimeOfImpact = 1e-3f;
+const unsigned int numberOfSamplesOfSweep  = 64;
+
+// The reference describes every shape as a convex core, which can be a point, a segment or a polygon, whose surface is pushed out by a radius
+// Half-planes are described by their normal and their offset instead
+struct ReferenceShape
+{
+   std::vector<glm::vec2> core;
+   float                  radius;
+   bool                   isHalfPlane;
+   glm::vec2              normal;
+   float                  offset;
+};
+
+ReferenceShape makeReferenceShape(const Circle& circle)
+{
+   return ReferenceShape{{circle.center}, circle.radius, false, glm::vec2(0.0f), 0.0f};
+}
+
+ReferenceShape makeReferenceShape(const AABB& aabb)
+{
+   glm::vec2 min = aabb.center - aabb.halfExtents;
+   glm::vec2 max = aabb.center + aabb.halfExtents;
+   return ReferenceShape{{min, glm::vec2(max.x, min.y), max, glm::vec2(min.x, max.y)}, 0.0f, false, glm::vec2(0.0f), 0.0f};
+}
+
+ReferenceShape makeReferenceShape(const Capsule& capsule)
+{
+   return ReferenceShape{{capsule.start, capsule.end}, capsule.radius, false, glm::vec2(0.0f), 0.0f};
+}
+
+ReferenceShape makeReferenceShape(const OBB& obb)
+{
+   glm::vec2 axisY(-obb.axis.y, obb.axis.x);
+   std::vector<glm::vec2> core;
+   for (const glm::vec2& corner : {glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f)})
+   {
+      core.push_back(obb.center + obb.axis * (corner.x * obb.halfExtents.x) + axisY * (corner.y * obb.halfExtents.y));
+   }
+   return ReferenceShape{core, 0.0f, false, glm::vec2(0.0f), 0.0f};
+}
+
+ReferenceShape makeReferenceShape(const HalfPlane& halfPlane)
+{
+   return ReferenceShape{{}, 0.0f, true, halfPlane.normal, halfPlane.offset};
+}
+
+ReferenceShape moveReferenceShape(ReferenceShape shape, const glm::vec2& offset)
+{
+   for (glm::vec2& vertex : shape.core)
+   {
+      vertex += offset;
+   }
+   shape.offset += glm::dot(shape.normal, offset);
+   return shape;
+}
+
+float distanceBetweenPointAndSegment(const glm::vec2& point, const glm::vec2& start, const glm::vec2& end)
+{
+   glm::vec2 segment       = end - start;
+   float     squaredLength = glm::dot(segment, segment);
+   float     t             = (squaredLength > 0.0f) ? glm::clamp(glm::dot(point - start, segment) / squaredLength, 0.0f, 1.0f) : 0.0f;
+   return glm::length(point - (start + segment * t));
+}
+
+// The edges of a point are empty, the edge of a segment is the segment itself, and the edges of a polygon wrap around
+std::vector<std::pair<glm::vec2, glm::vec2>> calculateEdges(const std::vector<glm::vec2>& core)
+{
+   std::vector<std::pair<glm::vec2, glm::vec2>> edges;
+   if (core.size() == 2)
+   {
+      edges.emplace_back(core[0], core[1]);
+   }
+   else if (core.size() > 2)
+   {
+      for (std::size_t i = 0; i < core.size(); ++i)
+      {
+         edges.emplace_back(core[i], core[(i + 1) % core.size()]);
+      }
+   }
+   return edges;
+}
+
+// Returns how far the cores must be moved apart along the best axis to stop overlapping, which is 0 or less if they don't overlap
+// When one projection contains the other, the cores must be moved past the nearest end of the larger one, not by the length of the smaller one
+// Every edge normal of both cores is tested, which finds the smallest overlap of two convex polygons exactly
+float calculateOverlapOfCores(const std::vector<glm::vec2>& a, const std::vector<glm::vec2>& b)
+{
+   std::vector<glm::vec2> axes;
+   for (const std::vector<glm::vec2>* core : {&a, &b})
+   {
+      for (const std::pair<glm::vec2, glm::vec2>& edge : calculateEdges(*core))
+      {
+         glm::vec2 direction = edge.second - edge.first;
+         if (glm::length(direction) > 0.0f)
+         {
+            axes.push_back(glm::normalize(glm::vec2(-direction.y, direction.x)));
+            if (core->size() == 2)
+            {
+               axes.push_back(glm::normalize(direction));
+            }
+         }
+      }
+   }
+
+   if (axes.empty())
+   {
+      // Two points only overlap if they are the same point
+      return (a[0] == b[0]) ? 0.0f : -1.0f;
+   }
+
+   float smallestOverlap = std::numeric_limits<float>::max();
+   for (const glm::vec2& axis : axes)
+   {
+      float minOfA = std::numeric_limits<float>::max(), maxOfA = std::numeric_limits<float>::lowest();
+      float minOfB = std::numeric_limits<float>::max(), maxOfB = std::numeric_limits<float>::lowest();
+      for (const glm::vec2& vertex : a) { minOfA = glm::min(minOfA, glm::dot(vertex, axis)); maxOfA = glm::max(maxOfA, glm::dot(vertex, axis)); }
+      for (const glm::vec2& vertex : b) { minOfB = glm::min(minOfB, glm::dot(vertex, axis)); maxOfB = glm::max(maxOfB, glm::dot(vertex, axis)); }
+      smallestOverlap = glm::min(smallestOverlap, glm::min(maxOfA - minOfB, maxOfB - minOfA));
+   }
+   return smallestOverlap;
+}
+
+// Returns the distance between the surfaces of the shapes, which is negative if they overlap
+float calculateReferenceSeparation(const ReferenceShape& a, const ReferenceShape& b)
+{
+   if (a.isHalfPlane || b.isHalfPlane)
+   {
+      const ReferenceShape& halfPlane = a.isHalfPlane ? a : b;
+      const ReferenceShape& other     = a.isHalfPlane ? b : a;
+
+      float lowestProjection = std::numeric_limits<float>::max();
+      for (const glm::vec2& vertex : other.core)
+      {
+         lowestProjection = glm::min(lowestProjection, glm::dot(halfPlane.normal, vertex));
+      }
+      return lowestProjection - other.radius - halfPlane.offset;
+   }
+
+   float overlapOfCores = calculateOverlapOfCores(a.core, b.core);
+   if (overlapOfCores > 0.0f)
+   {
+      return -overlapOfCores - a.radius - b.radius;
+   }
+
+   // The closest points of two separated convex cores are a vertex of one of them and a point on an edge of the other one
+   float distanceBetweenCores = std::numeric_limits<float>::max();
+   for (int side = 0; side < 2; ++side)
+   {
+      const std::vector<glm::vec2>& vertices = (side == 0) ? a.core : b.core;
+      const std::vector<glm::vec2>& other    = (side == 0) ? b.core : a.core;
+      std::vector<std::pair<glm::vec2, glm::vec2>> edges = calculateEdges(other);
+      if (edges.empty())
+      {
+         edges.emplace_back(other[0], other[0]);
+      }
+
+      for (const glm::vec2& vertex : vertices)
+      {
+         for (const std::pair<glm::vec2, glm::vec2>& edge : edges)
+         {
+            distanceBetweenCores = glm::min(distanceBetweenCores, distanceBetweenPointAndSegment(vertex, edge.first, edge.second));
+         }
+      }
+   }
+
+   return distanceBetweenCores - a.radius - b.radius;
+}
+
+struct PairReport
+{
+   std::uint64_t                             numberOfCases;
+   std::uint64_t                             numberOfHits;
+   std::array<std::uint64_t, NumberOfChecks> numberOfFailures;
+   std::array<std::uint64_t, NumberOfChecks> firstFailedCase;
+   double                                    nanosecondsPerSweep;
+};
+
+float drawUniform(std::uint64_t& randomNumberGeneratorState, float minValue, float maxValue)
+{
+   float uniform = static_cast<float>(drawRandomNumber(randomNumberGeneratorState) >> 40) / static_cast<float>(1 << 24);
+   return minValue + uniform * (maxValue - minValue);
+}
+
+glm::vec2 drawPoint(std::uint64_t& randomNumberGeneratorState, float range)
+{
+   return glm::vec2(drawUniform(randomNumberGeneratorState, -range, range), drawUniform(randomNumberGeneratorState, -range, range));
+}
+
+glm::vec2 drawDirection(std::uint64_t& randomNumberGeneratorState)
+{
+   float angle = drawUniform(randomNumberGeneratorState, 0.0f, 6.2831853f);
+   return glm::vec2(std::cos(angle), std::sin(angle));
+}
+
+template<typename Shape> Shape drawShape(std::uint64_t& randomNumberGeneratorState);
+
+template<> Circle drawShape<Circle>(std::uint64_t& state)
+{
+   return Circle{drawPoint(state, 10.0f), drawUniform(state, 0.5f, 4.0f)};
+}
+
+template<> AABB drawShape<AABB>(std::uint64_t& state)
+{
+   return AABB{drawPoint(state, 10.0f), glm::vec2(drawUniform(state, 0.5f, 4.0f), drawUniform(state, 0.5f, 4.0f))};
+}
+
+template<> Capsule drawShape<Capsule>(std::uint64_t& state)
+{
+   glm::vec2 start = drawPoint(state, 10.0f);
+   return Capsule{start, start + drawDirection(state) * drawUniform(state, 0.5f, 6.0f), drawUniform(state, 0.5f, 3.0f)};
+}
+
+template<> OBB drawShape<OBB>(std::uint64_t& state)
+{
+   return OBB{drawPoint(state, 10.0f), glm::vec2(drawUniform(state, 0.5f, 4.0f), drawUniform(state, 0.5f, 4.0f)), drawDirection(state)};
+}
+
+template<> HalfPlane drawShape<HalfPlane>(std::uint64_t& state)
+{
+   glm::vec2 normal = drawDirection(state);
+   return HalfPlane{normal, glm::dot(normal, drawPoint(state, 10.0f))};
+}
+
+void recordFailure(PairReport& report, Check check, std::uint64_t numberOfCase)
+{
+   if (report.numberOfFailures[check]++ == 0)
+   {
+      report.firstFailedCase[check] = numberOfCase;
+   }
+}
+
+// Returns false if the shape doesn't hit the collider
+template<typename Shape>
+bool sweepOneShape(const ColliderSet& colliders, const Shape& shape, const glm::vec2& displacement, std::vector<ColliderHit>& hits, Contact& contact)
+{
+   hits.clear();
+   colliders.sweep(&shape, &displacement, 1, hits);
+
+   ColliderHit earliestHit;
+   if (!findEarliestHit(hits, earliestHit))
+   {
+      return false;
+   }
+
+   contact = earliestHit.contact;
+   return true;
+}
+
+template<typename A, typename B>
+void checkPair(std::uint64_t numberOfCases, std::uint64_t seed, PairReport& report)
+{
+   std::uint64_t            randomNumberGeneratorState = seed;
+   std::vector<ColliderHit> hits;
+   ColliderSet              collidersB;
+   ColliderSet              collidersA;
+
+   for (std::uint64_t i = 0; i < numberOfCases; ++i)
+   {
+      A         a            = drawShape<A>(randomNumberGeneratorState);
+      B         b            = drawShape<B>(randomNumberGeneratorState);
+      glm::vec2 displacement = drawDirection(randomNumberGeneratorState) * drawUniform(randomNumberGeneratorState, 0.0f, 30.0f);
+
+      collidersB.clear();
+      collidersB.add(b);
+      collidersA.clear();
+      collidersA.add(a);
+
+      Contact contact = {};
+      bool    hit = sweepOneShape(collidersB, a, displacement, hits, contact);
+
+      ReferenceShape referenceA      = makeReferenceShape(a);
+      ReferenceShape referenceB      = makeReferenceShape(b);
+      float          startSeparation = calculateReferenceSeparation(referenceA, referenceB);
+
+      ++report.numberOfCases;
+      report.numberOfHits += hit ? 1 : 0;
+
+      if (hit && contact.timeOfImpact > 0.0f)
+      {
+         float separationAtImpact = calculateReferenceSeparation(moveReferenceShape(referenceA, displacement * contact.timeOfImpact), referenceB);
+         if (glm::abs(separationAtImpact) > toleranceOfDistance)
+         {
+            recordFailure(report, ShapesTouchAtTimeOfImpact, i);
+         }
+      }
+
+      // Shapes that start overlapping can move apart, so only the sweeps that start apart must stay apart until the time of impact
+      if (startSeparation > toleranceOfDistance)
+      {
+         float timeOfImpact = hit ? contact.timeOfImpact : 1.0f;
+         for (unsigned int sample = 0; sample < numberOfSamplesOfSweep; ++sample)
+         {
+            float t = timeOfImpact * sample / numberOfSamplesOfSweep;
+            if (calculateReferenceSeparation(moveReferenceShape(referenceA, displacement * t), referenceB) < -toleranceOfDistance)
+            {
+               recordFailure(report, NoOverlapBeforeImpact, i);
+               break;
+            }
+         }
+      }
+
+      if (hit && contact.timeOfImpact == 0.0f && glm::abs(contact.depth + glm::min(startSeparation, 0.0f)) > toleranceOfDistance)
+      {
+         recordFailure(report, DepthIsOverlap, i);
+      }
+
+      Contact reversedContact = {};
+      bool    reversedHit = sweepOneShape(collidersA, b, -displacement, hits, reversedContact);
+      if (hit != reversedHit || (hit && glm::abs(contact.timeOfImpact - reversedContact.timeOfImpact) > toleranceOfTimeOfImpact))
+      {
+         // Sweeps that graze the shapes can go either way
+         bool grazing = glm::abs(startSeparation) <= toleranceOfDistance ||
+                        glm::abs(calculateReferenceSeparation(moveReferenceShape(referenceA, displacement), referenceB)) <= toleranceOfDistance;
+         if (!grazing)
+         {
+            recordFailure(report, SweepIsSymmetric, i);
+         }
+      }
+   }
+
+   // Time the sweeps through the table without checking them, with many shapes against many colliders like the broad phase would produce
+   const std::size_t      numberOfShapes = 256;
+   std::vector<A>         shapes;
+   std::vector<glm::vec2> displacements;
+   collidersB.clear();
+   for (std::size_t i = 0; i < numberOfShapes; ++i)
+   {
+      shapes.push_back(drawShape<A>(randomNumberGeneratorState));
+      displacements.push_back(drawDirection(randomNumberGeneratorState) * drawUniform(randomNumberGeneratorState, 0.0f, 30.0f));
+      collidersB.add(drawShape<B>(randomNumberGeneratorState));
+   }
+
+   hits.clear();
+   hits.reserve(numberOfShapes * numberOfShapes);
+   auto start = std::chrono::steady_clock::now();
+   collidersB.sweep(shapes.data(), displacements.data(), numberOfShapes, hits);
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   report.nanosecondsPerSweep = seconds * 1e9 / (numberOfShapes * numberOfShapes);
+}
+
+template<typename A>
+void checkRow(std::uint64_t numberOfCases, std::uint64_t seed, std::array<PairReport, numberOfShapeTypes>& row)
+{
+   checkPair<A, Circle>(numberOfCases, seed, row[static_cast<std::size_t>(ShapeType::Circle)]);
+   checkPair<A, AABB>(numberOfCases, seed, row[static_cast<std::size_t>(ShapeType::AABB)]);
+   checkPair<A, Capsule>(numberOfCases, seed, row[static_cast<std::size_t>(ShapeType::Capsule)]);
+   checkPair<A, OBB>(numberOfCases, seed, row[static_cast<std::size_t>(ShapeType::OBB)]);
+   checkPair<A, HalfPlane>(numberOfCases, seed, row[static_cast<std::size_t>(ShapeType::HalfPlane)]);
+}
+
+int main(int argc, char* argv[])
+{
+   std::uint64_t numberOfCases = 20000;
+   std::uint64_t seed          = 1;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      bool hasValue = (i + 1 < argc);
+
+      if (std::strcmp(argv[i], "--cases") == 0 && hasValue)
+      {
+         numberOfCases = std::strtoull(argv[++i], nullptr, 10);
+      }
+      else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+      {
+         seed = std::strtoull(argv[++i], nullptr, 10);
+      }
+      else
+      {
+         std::cout << "Error - main - Unknown argument: " << argv[i] << "\n";
+         return -1;
+      }
+   }
+
+   // The rows and the columns follow the order of ShapeType, like the dispatch table of ColliderSet
+   std::array<std::array<PairReport, numberOfShapeTypes>, numberOfShapeTypes> reports = {};
+   checkRow<Circle>(numberOfCases, seed, reports[static_cast<std::size_t>(ShapeType::Circle)]);
+   checkRow<AABB>(numberOfCases, seed, reports[static_cast<std::size_t>(ShapeType::AABB)]);
+   checkRow<Capsule>(numberOfCases, seed, reports[static_cast<std::size_t>(ShapeType::Capsule)]);
+   checkRow<OBB>(numberOfCases, seed, reports[static_cast<std::size_t>(ShapeType::OBB)]);
+   checkRow<HalfPlane>(numberOfCases, seed, reports[static_cast<std::size_t>(ShapeType::HalfPlane)]);
+
+   std::cout << std::fixed;
+   std::cout << "Cases per pair: " << numberOfCases << ", seed: " << seed << "\n";
+   std::cout << std::setw(10) << "shape" << std::setw(11) << "collider" << std::setw(8) << "hits" << std::setw(10) << "ns/sweep";
+   for (const char* name : namesOfChecks)
+   {
+      std::cout << std::setw(11) << name;
+   }
+   std::cout << "\n";
+
+   std::uint64_t totalNumberOfFailures = 0;
+   for (std::size_t a = 0; a < numberOfShapeTypes; ++a)
+   {
+      for (std::size_t b = 0; b < numberOfShapeTypes; ++b)
+      {
+         const PairReport& report = reports[a][b];
+         std::cout << std::setw(10) << namesOfShapeTypes[a] << std::setw(11) << namesOfShapeTypes[b]
+                   << std::setw(7) << std::setprecision(0) << (100.0 * report.numberOfHits / std::max(report.numberOfCases, std::uint64_t(1))) << "%"
+                   << std::setw(10) << std::setprecision(1) << report.nanosecondsPerSweep;
+         for (std::uint64_t numberOfFailures : report.numberOfFailures)
+         {
+            std::cout << std::setw(11) << numberOfFailures;
+            totalNumberOfFailures += numberOfFailures;
+         }
+         std::cout << "\n";
+      }
+   }
+
+   // The first failure of each kind can be reproduced with the same seed, since every pair draws its cases from the same stream
+   if (totalNumberOfFailures != 0)
+   {
+      std::cout << "First failures" << "\n";
+      for (std::size_t a = 0; a < numberOfShapeTypes; ++a)
+      {
+         for (std::size_t b = 0; b < numberOfShapeTypes; ++b)
+         {
+            for (unsigned int check = 0; check < NumberOfChecks; ++check)
+            {
+               if (reports[a][b].numberOfFailures[check] != 0)
+               {
+                  std::cout << "  " << namesOfShapeTypes[a] << " against " << namesOfShapeTypes[b] << ", " << namesOfChecks[check]
+                            << ": case " << reports[a][b].firstFailedCase[check] << "\n";
+               }
+            }
+         }
+      }
+   }
+
+   return (totalNumberOfFailures == 0) ? 0 : -1;
+}
@@ -1,59 +1,211 @@
-#include <array>
+#include <utility>
 
 #include "collision.h"
 
-bool circleAndAABBCollided(const Ball& circle, const Paddle& AABB, glm::vec2& vecFromCenterOfCircleToPointOfCollision)
+template<typename Number>
+inline Number clampNumber(Number value, Number minValue, Number maxValue)
 {
-   glm::vec2 centerOfCircle(circle.getPosition());
+   return (value < minValue) ? minValue : ((value > maxValue) ? maxValue : value);
+}
 
-   glm::vec2 centerOfAABB(AABB.getPosition());
-   glm::vec2 halfExtentsOfAABB(AABB.getWidth() / 2, AABB.getHeight() / 2);
+bool circleAndAABBCollided(const BallState& circle, const PaddleState& AABB, glm::vec2& vecFromCenterOfCircleToPointOfCollision)
+{
+   NumericVector<float> vec;
+   bool                 collided = circleAndAABBCollided<FloatNumericPolicy>({circle.position.x - AABB.position.x, circle.position.y - AABB.position.y},
+                                                                             circle.radius,
+                                                                             {AABB.width / 2, AABB.height / 2},
+                                                                             vec);
 
-   // Calculate the difference vector between both centers and clamp it to the AABB's half-extents
-   glm::vec2 vecFromCenterOfAABBToCenterOfCircle        = centerOfCircle - centerOfAABB;
-   glm::vec2 clampedVecFromCenterOfAABBToCenterOfCircle = glm::clamp(vecFromCenterOfAABBToCenterOfCircle, -halfExtentsOfAABB, halfExtentsOfAABB);
+   vecFromCenterOfCircleToPointOfCollision = glm::vec2(vec.x, vec.y);
+   return collided;
+}
 
-   // Add the clamped difference vector to the AABB's center to get the point on the AABB's edge that is closest to the center of the circle
-   glm::vec2 closest = centerOfAABB + clampedVecFromCenterOfAABBToCenterOfCircle;
+bool sweptCircleAndAABBCollided(const BallState&   circle,
+                                const glm::vec2&   displacementOfCircle,
+                                const PaddleState& AABB,
+                                const glm::vec2&   displacementOfAABB,
+                                float&             timeOfImpact,
+                                glm::vec2&         vecFromCenterOfCircleToPointOfCollision)
+{
+   // Work in the frame of reference of the AABB, where the AABB stands still and the circle moves with the relative displacement
+   glm::vec2            startOfCircle(glm::vec2(circle.position) - glm::vec2(AABB.position));
+   glm::vec2            relativeDisplacement = displacementOfCircle - displacementOfAABB;
+   NumericVector<float> vec;
+   if (!sweptCircleAndAABBCollided<FloatNumericPolicy>({startOfCircle.x, startOfCircle.y},
+                                                       circle.radius,
+                                                       {relativeDisplacement.x, relativeDisplacement.y},
+                                                       {AABB.width / 2, AABB.height / 2},
+                                                       timeOfImpact,
+                                                       vec))
+   {
+      return false;
+   }
 
-   // Calculate the difference vector between the center of the circle and the closest point on the AABB's edge
-   vecFromCenterOfCircleToPointOfCollision = closest - centerOfCircle;
+   vecFromCenterOfCircleToPointOfCollision = glm::vec2(vec.x, vec.y);
+   return true;
+}
+
+CollisionDirection determineDirectionOfCollisionBetweenCircleAndAABB(const glm::vec2& vecFromCenterOfCircleToPointOfCollision)
+{
+   return determineDirectionOfCollisionBetweenCircleAndAABB<FloatNumericPolicy>({vecFromCenterOfCircleToPointOfCollision.x, vecFromCenterOfCircleToPointOfCollision.y});
+}
 
-   // Check if the distance between the center of the circle and the closest point on the AABB's edge is smaller than the radius of the circle, which would indicate a collision
-   // Note that the check is not <= because in that case, a collision would also occur when the circle and the AABB are exactly touching each other,
-   // which is the state in which we leave the circle and the AABB after they collide
-   if (glm::length(vecFromCenterOfCircleToPointOfCollision) < circle.getRadius())
+// Comparing squared lengths is equivalent to comparing lengths, and it saves a square root
+// Note that the check is not <= because in that case, a collision would also occur when the circle and the AABB are exactly touching each other,
+// which is the state in which we leave the circle and the AABB after they collide
+template<typename NumericPolicy>
+bool circleAndAABBCollided(NumericVector<typename NumericPolicy::Number>  centerOfCircle,
+                           typename NumericPolicy::Number                 radius,
+                           NumericVector<typename NumericPolicy::Number>  halfExtentsOfAABB,
+                           NumericVector<typename NumericPolicy::Number>& vecFromCenterOfCircleToPointOfCollision)
+{
+   NumericVector<typename NumericPolicy::Number> closestPoint = {clampNumber(centerOfCircle.x, -halfExtentsOfAABB.x, halfExtentsOfAABB.x),
+                                                                 clampNumber(centerOfCircle.y, -halfExtentsOfAABB.y, halfExtentsOfAABB.y)};
+
+   vecFromCenterOfCircleToPointOfCollision = closestPoint - centerOfCircle;
+   return dot(vecFromCenterOfCircleToPointOfCollision, vecFromCenterOfCircleToPointOfCollision) < radius * radius;
+}
+
+template<typename NumericPolicy>
+bool sweptCircleAndAABBCollided(NumericVector<typename NumericPolicy::Number>  startOfCircle,
+                                typename NumericPolicy::Number                 radius,
+                                NumericVector<typename NumericPolicy::Number>  displacementOfCircle,
+                                NumericVector<typename NumericPolicy::Number>  halfExtentsOfAABB,
+                                typename NumericPolicy::Number&                timeOfImpact,
+                                NumericVector<typename NumericPolicy::Number>& vecFromCenterOfCircleToPointOfCollision)
+{
+   using Number = typename NumericPolicy::Number;
+   using Vector = NumericVector<Number>;
+
+   Number zero = NumericPolicy::fromInt(0);
+   Number one  = NumericPolicy::fromInt(1);
+
+   // Most of the time the circle is nowhere near the AABB, so we reject the sweep with comparisons alone if it stays on one side of the expanded AABB
+   // A circle that touches the AABB is always within the expanded AABB, so this never rejects a collision that the checks below would find
+   Vector expandedHalfExtents = {halfExtentsOfAABB.x + radius, halfExtentsOfAABB.y + radius};
+   Vector endOfCircle         = startOfCircle + displacementOfCircle;
+   if ((startOfCircle.x >  expandedHalfExtents.x && endOfCircle.x >  expandedHalfExtents.x) ||
+       (startOfCircle.x < -expandedHalfExtents.x && endOfCircle.x < -expandedHalfExtents.x) ||
+       (startOfCircle.y >  expandedHalfExtents.y && endOfCircle.y >  expandedHalfExtents.y) ||
+       (startOfCircle.y < -expandedHalfExtents.y && endOfCircle.y < -expandedHalfExtents.y))
    {
-      return true;
+      return false;
    }
-   else
+
+   // If the circle and the AABB already touch or overlap, they collide at the start of the motion, but only if the circle is moving towards the AABB
+   // The second condition prevents a circle that is exactly touching an AABB after a collision from colliding with it again
+   Vector vecToClosestPoint = Vector{clampNumber(startOfCircle.x, -halfExtentsOfAABB.x, halfExtentsOfAABB.x),
+                                     clampNumber(startOfCircle.y, -halfExtentsOfAABB.y, halfExtentsOfAABB.y)} - startOfCircle;
+   if (dot(vecToClosestPoint, vecToClosestPoint) <= radius * radius)
    {
+      if (dot(vecToClosestPoint, displacementOfCircle) > zero)
+      {
+         timeOfImpact                            = zero;
+         vecFromCenterOfCircleToPointOfCollision = vecToClosestPoint;
+         return true;
+      }
+
       return false;
    }
-}
 
-CollisionDirection determineDirectionOfCollisionBetweenCircleAndAABB(const glm::vec2& vecFromCenterOfCircleToPointOfCollision)
-{
-   std::array<glm::vec2, 4> collisionDirections = {glm::vec2(0.0f, 1.0f),  // Up
-                                                   glm::vec2(0.0f, -1.0f), // Down
-                                                   glm::vec2(-1.0f, 0.0f), // Left
-                                                   glm::vec2(1.0f, 0.0f)}; // Right
+   // Sweeping a circle against an AABB is the same as casting a ray from the center of the circle against the AABB with its edges pushed out by the radius and its corners rounded
+   // We start by casting the ray against the expanded AABB without rounding its corners, which is done by intersecting the slabs of both axes
+   Number timeOfEntry = zero;
+   Number timeOfExit  = one;
+   for (int axis = 0; axis < 2; ++axis)
+   {
+      Number start        = (axis == 0) ? startOfCircle.x : startOfCircle.y;
+      Number displacement = (axis == 0) ? displacementOfCircle.x : displacementOfCircle.y;
+      Number halfExtent   = (axis == 0) ? expandedHalfExtents.x : expandedHalfExtents.y;
+
+      if (displacement == zero)
+      {
+         // The ray is parallel to the slab, so it can only hit the AABB if it starts inside the slab
+         if (NumericPolicy::abs(start) > halfExtent)
+         {
+            return false;
+         }
+      }
+      else
+      {
+         Number timeOfEntryIntoSlab = (-halfExtent - start) / displacement;
+         Number timeOfExitFromSlab  = ( halfExtent - start) / displacement;
+         if (timeOfEntryIntoSlab > timeOfExitFromSlab)
+         {
+            std::swap(timeOfEntryIntoSlab, timeOfExitFromSlab);
+         }
 
-   glm::vec2 normalizedVecFromCenterOfCircleToPointOfCollision = glm::normalize(vecFromCenterOfCircleToPointOfCollision);
+         timeOfEntry = (timeOfEntryIntoSlab > timeOfEntry) ? timeOfEntryIntoSlab : timeOfEntry;
+         timeOfExit  = (timeOfExitFromSlab < timeOfExit) ? timeOfExitFromSlab : timeOfExit;
+         if (timeOfEntry > timeOfExit)
+         {
+            return false;
+         }
+      }
+   }
 
-   float        dotProduct                = 0.0f;
-   float        maxDotProduct             = 0.0f;
-   unsigned int closestCollisionDirection = -1;
-   for (unsigned int i = 0; i < 4; i++)
+   // If the ray enters the expanded AABB through one of its corners, the point of entry might be outside of the rounded corner
+   // In that case we cast the ray against the circle that makes up the rounded corner instead
+   Vector pointOfEntry = startOfCircle + displacementOfCircle * timeOfEntry;
+   if (NumericPolicy::abs(pointOfEntry.x) > halfExtentsOfAABB.x && NumericPolicy::abs(pointOfEntry.y) > halfExtentsOfAABB.y)
    {
-      dotProduct = glm::dot(normalizedVecFromCenterOfCircleToPointOfCollision, collisionDirections[i]);
-      if (dotProduct > maxDotProduct)
+      Vector corner = {pointOfEntry.x > zero ? halfExtentsOfAABB.x : -halfExtentsOfAABB.x,
+                       pointOfEntry.y > zero ? halfExtentsOfAABB.y : -halfExtentsOfAABB.y};
+
+      // Solve |startOfCircle + displacementOfCircle * t - corner| = radius for the smallest t
+      // The displacement is normalized first, so that none of the products leave the range of fixed-point numbers
+      Number lengthOfDisplacement = NumericPolicy::sqrtOfSumOfSquares(displacementOfCircle.x, displacementOfCircle.y);
+      if (lengthOfDisplacement == zero)
+      {
+         return false;
+      }
+
+      Vector directionOfDisplacement      = {displacementOfCircle.x / lengthOfDisplacement, displacementOfCircle.y / lengthOfDisplacement};
+      Vector vecFromCornerToStartOfCircle = startOfCircle - corner;
+      Number b                            = dot(vecFromCornerToStartOfCircle, directionOfDisplacement);
+      Number c                            = dot(vecFromCornerToStartOfCircle, vecFromCornerToStartOfCircle) - (radius * radius);
+      Number discriminant                 = (b * b) - c;
+      if (discriminant < zero)
+      {
+         return false;
+      }
+
+      timeOfEntry = (-b - NumericPolicy::sqrt(discriminant)) / lengthOfDisplacement;
+      if (timeOfEntry < zero || timeOfEntry > one)
       {
-         maxDotProduct = dotProduct;
-         closestCollisionDirection = i;
+         return false;
       }
+
+      pointOfEntry = startOfCircle + displacementOfCircle * timeOfEntry;
+   }
+   else if (timeOfExit <= zero)
+   {
+      // The ray leaves the expanded AABB as soon as it starts, which means that the circle is touching the AABB and moving away from it
+      // A ray that enters it at a time that rounds to 0 is a circle that is a rounding error away from the AABB, so it still collides with it
+      return false;
    }
 
-   return static_cast<CollisionDirection>(closestCollisionDirection);
+   timeOfImpact                            = timeOfEntry;
+   vecFromCenterOfCircleToPointOfCollision = Vector{clampNumber(pointOfEntry.x, -halfExtentsOfAABB.x, halfExtentsOfAABB.x),
+                                                    clampNumber(pointOfEntry.y, -halfExtentsOfAABB.y, halfExtentsOfAABB.y)} - pointOfEntry;
+   return true;
+}
+
+// Of the four directions, the one that has the largest dot product with the vector is the one along its largest component
+// Ties go to the vertical directions, and a vector of length 0 is classified as Down
+template<typename NumericPolicy>
+CollisionDirection determineDirectionOfCollisionBetweenCircleAndAABB(NumericVector<typename NumericPolicy::Number> vecFromCenterOfCircleToPointOfCollision)
+{
+   typename NumericPolicy::Number zero = NumericPolicy::fromInt(0);
+
+   bool horizontal                  = NumericPolicy::abs(vecFromCenterOfCircleToPointOfCollision.x) > NumericPolicy::abs(vecFromCenterOfCircleToPointOfCollision.y);
+   bool secondDirectionAlongItsAxis = horizontal ? (vecFromCenterOfCircleToPointOfCollision.x > zero) : !(vecFromCenterOfCircleToPointOfCollision.y > zero);
+   return static_cast<CollisionDirection>((static_cast<unsigned int>(horizontal) << 1) | static_cast<unsigned int>(secondDirectionAlongItsAxis));
 }
 
+template bool               circleAndAABBCollided<FloatNumericPolicy>(NumericVector<float>, float, NumericVector<float>, NumericVector<float>&);
+template bool               circleAndAABBCollided<FixedPointNumericPolicy>(NumericVector<FixedPoint>, FixedPoint, NumericVector<FixedPoint>, NumericVector<FixedPoint>&);
+template bool               sweptCircleAndAABBCollided<FloatNumericPolicy>(NumericVector<float>, float, NumericVector<float>, NumericVector<float>, float&, NumericVector<float>&);
+template bool               sweptCircleAndAABBCollided<FixedPointNumericPolicy>(NumericVector<FixedPoint>, FixedPoint, NumericVector<FixedPoint>, NumericVector<FixedPoint>, FixedPoint&, NumericVector<FixedPoint>&);
+template CollisionDirection determineDirectionOfCollisionBetweenCircleAndAABB<FloatNumericPolicy>(NumericVector<float>);
+template CollisionDirection determineDirectionOfCollisionBetweenCircleAndAABB<FixedPointNumericPolicy>(NumericVector<FixedPoint>);
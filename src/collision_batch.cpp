@@ -0,0 +1,82 @@
+#include <array>
+#include <cstring>
+
+#include "collision.h"
+#include "collision_batch.h"
+
+// Everything in this file is compiled once per instruction set, so it all lives in the namespace of the instruction set
+namespace FLOAT_LANES_NAMESPACE
+{
+
+// Byte i of entry m is bit i of m, in the byte order of the machine
+std::array<std::uint32_t, 16> calculateBytesOfFourLanes()
+{
+   std::array<std::uint32_t, 16> bytesOfFourLanes;
+   for (std::uint32_t mask = 0; mask < 16; ++mask)
+   {
+      std::uint8_t bytes[4] = {static_cast<std::uint8_t>(mask & 1), static_cast<std::uint8_t>((mask >> 1) & 1), static_cast<std::uint8_t>((mask >> 2) & 1), static_cast<std::uint8_t>((mask >> 3) & 1)};
+      std::memcpy(&bytesOfFourLanes[mask], bytes, 4);
+   }
+
+   return bytesOfFourLanes;
+}
+
+const std::array<std::uint32_t, 16> bytesOfFourLanes = calculateBytesOfFourLanes();
+
+void circlesAndAABBsCollided(std::size_t numberOfPairs, const CircleSpan& circles, const AABBSpan& AABBs, const CircleAndAABBCollisionSpan& collisions)
+{
+   // The pairs are tested in groups that fill a whole SIMD register, and the ones that are left over are tested one by one with the same operations
+   FloatLanes  zero = broadcastLanes(0.0f);
+   std::size_t i    = 0;
+   for (; i + floatLanesWidth <= numberOfPairs; i += floatLanesWidth)
+   {
+      FloatLanes centerOfCircleX = loadLanes(circles.centersX + i);
+      FloatLanes centerOfCircleY = loadLanes(circles.centersY + i);
+      FloatLanes radius          = loadLanes(circles.radii + i);
+      FloatLanes centerOfAABBX   = loadLanes(AABBs.centersX + i);
+      FloatLanes centerOfAABBY   = loadLanes(AABBs.centersY + i);
+      FloatLanes halfWidth       = loadLanes(AABBs.halfWidths + i);
+      FloatLanes halfHeight      = loadLanes(AABBs.halfHeights + i);
+
+      FloatLanes centerX  = centerOfCircleX - centerOfAABBX;
+      FloatLanes centerY  = centerOfCircleY - centerOfAABBY;
+      FloatLanes vecX     = clampLanes(centerX, zero - halfWidth, halfWidth) - centerX;
+      FloatLanes vecY     = clampLanes(centerY, zero - halfHeight, halfHeight) - centerY;
+
+      MaskLanes  collided                    = (vecX * vecX + vecY * vecY) < (radius * radius);
+      MaskLanes  horizontal                  = absLanes(vecX) > absLanes(vecY);
+      MaskLanes  secondDirectionAlongItsAxis = (horizontal & (vecX > zero)) | ((!horizontal) & (!(vecY > zero)));
+
+      storeLanes(collisions.vecsFromCenterOfCircleToPointOfCollisionX + i, vecX);
+      storeLanes(collisions.vecsFromCenterOfCircleToPointOfCollisionY + i, vecY);
+
+      unsigned int collidedBits                    = maskBits(collided);
+      unsigned int horizontalBits                  = maskBits(horizontal);
+      unsigned int secondDirectionAlongItsAxisBits = maskBits(secondDirectionAlongItsAxis);
+      for (unsigned int lane = 0; lane < floatLanesWidth; lane += 4)
+      {
+         // Spread the bits of four lanes into four bytes at once
+         std::uint32_t collidedBytes  = bytesOfFourLanes[(collidedBits >> lane) & 15];
+         std::uint32_t directionBytes = (bytesOfFourLanes[(horizontalBits >> lane) & 15] << 1) | bytesOfFourLanes[(secondDirectionAlongItsAxisBits >> lane) & 15];
+         unsigned int  numberOfBytes  = glm::min(floatLanesWidth - lane, 4u);
+         std::memcpy(collisions.collided + i + lane, &collidedBytes, numberOfBytes);
+         std::memcpy(collisions.directions + i + lane, &directionBytes, numberOfBytes);
+      }
+   }
+
+   for (; i < numberOfPairs; ++i)
+   {
+      NumericVector<float> vec;
+      bool                 collided = circleAndAABBCollided<FloatNumericPolicy>({circles.centersX[i] - AABBs.centersX[i], circles.centersY[i] - AABBs.centersY[i]},
+                                                                                circles.radii[i],
+                                                                                {AABBs.halfWidths[i], AABBs.halfHeights[i]},
+                                                                                vec);
+
+      collisions.collided[i]                                  = collided ? 1 : 0;
+      collisions.vecsFromCenterOfCircleToPointOfCollisionX[i] = vec.x;
+      collisions.vecsFromCenterOfCircleToPointOfCollisionY[i] = vec.y;
+      collisions.directions[i]                                = static_cast<std::uint8_t>(determineDirectionOfCollisionBetweenCircleAndAABB<FloatNumericPolicy>(vec));
+   }
+}
+
+}
@@ -0,0 +1,195 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "collision.h"
+#include "collision_batch.h"
+#include "float_lanes.h"
+#include "match_simulation.h"
+
+// Tests the same pairs of circles and AABBs one at a time and in batches, and reports how many nanoseconds each pair takes
+// The batches are tested with the width of the SIMD instructions that the benchmark is compiled with, and also with the width of SSE2 when those are AVX or AVX-512
+// Usage: teapong_collision_benchmark [numberOfPairs] [numberOfRepetitions]
+
+// The functions below are how circleAndAABBCollided and determineDirectionOfCollisionBetweenCircleAndAABB used to be implemented,
+// before they were rewritten to give the same results as circlesAndAABBsCollided
+
+bool circleAndAABBCollidedWithSquareRoot(const BallState& circle, const PaddleState& AABB, glm::vec2& vecFromCenterOfCircleToPointOfCollision)
+{
+   glm::vec2 centerOfCircle(circle.position);
+   glm::vec2 centerOfAABB(AABB.position);
+   glm::vec2 halfExtentsOfAABB(AABB.width / 2, AABB.height / 2);
+
+   glm::vec2 closest = centerOfAABB + glm::clamp(centerOfCircle - centerOfAABB, -halfExtentsOfAABB, halfExtentsOfAABB);
+   vecFromCenterOfCircleToPointOfCollision = closest - centerOfCircle;
+
+   return glm::length(vecFromCenterOfCircleToPointOfCollision) < circle.radius;
+}
+
+CollisionDirection determineDirectionWithDotProducts(const glm::vec2& vecFromCenterOfCircleToPointOfCollision)
+{
+   std::array<glm::vec2, 4> collisionDirections = {glm::vec2(0.0f, 1.0f),  // Up
+                                                   glm::vec2(0.0f, -1.0f), // Down
+                                                   glm::vec2(-1.0f, 0.0f), // Left
+                                                   glm::vec2(1.0f, 0.0f)}; // Right
+
+   glm::vec2 normalizedVec = glm::normalize(vecFromCenterOfCircleToPointOfCollision);
+
+   float        maxDotProduct             = 0.0f;
+   unsigned int closestCollisionDirection = 1;
+   for (unsigned int i = 0; i < 4; i++)
+   {
+      float dotProduct = glm::dot(normalizedVec, collisionDirections[i]);
+      if (dotProduct > maxDotProduct)
+      {
+         maxDotProduct             = dotProduct;
+         closestCollisionDirection = i;
+      }
+   }
+
+   return static_cast<CollisionDirection>(closestCollisionDirection);
+}
+
+float drawUniform(std::uint64_t& randomNumberGeneratorState, float minValue, float maxValue)
+{
+   float uniform = static_cast<float>(drawRandomNumber(randomNumberGeneratorState) >> 40) / static_cast<float>(1 << 24);
+   return minValue + uniform * (maxValue - minValue);
+}
+
+int main(int argc, char* argv[])
+{
+   std::size_t  numberOfPairs       = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 4096;
+   unsigned int numberOfRepetitions = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 2000;
+
+   // Place the circles around the AABBs, so that about half of the pairs collide
+   std::uint64_t            randomNumberGeneratorState = 0xC011;
+   std::vector<BallState>   circles(numberOfPairs, BallState{});
+   std::vector<PaddleState> paddles(numberOfPairs, PaddleState{});
+   for (std::size_t i = 0; i < numberOfPairs; ++i)
+   {
+      paddles[i].position = glm::vec3(drawUniform(randomNumberGeneratorState, -45.0f, 45.0f), drawUniform(randomNumberGeneratorState, -30.0f, 30.0f), 0.0f);
+      paddles[i].width    = drawUniform(randomNumberGeneratorState, 1.0f, 8.0f);
+      paddles[i].height   = drawUniform(randomNumberGeneratorState, 1.0f, 8.0f);
+      circles[i].radius   = drawUniform(randomNumberGeneratorState, 0.5f, 3.0f);
+      circles[i].position = paddles[i].position + glm::vec3(drawUniform(randomNumberGeneratorState, -8.0f, 8.0f), drawUniform(randomNumberGeneratorState, -8.0f, 8.0f), 0.0f);
+   }
+
+   // The batch reads structures of arrays
+   std::vector<float> centersOfCirclesX(numberOfPairs), centersOfCirclesY(numberOfPairs), radii(numberOfPairs);
+   std::vector<float> centersOfAABBsX(numberOfPairs), centersOfAABBsY(numberOfPairs), halfWidths(numberOfPairs), halfHeights(numberOfPairs);
+   for (std::size_t i = 0; i < numberOfPairs; ++i)
+   {
+      centersOfCirclesX[i] = circles[i].position.x;
+      centersOfCirclesY[i] = circles[i].position.y;
+      radii[i]             = circles[i].radius;
+      centersOfAABBsX[i]   = paddles[i].position.x;
+      centersOfAABBsY[i]   = paddles[i].position.y;
+      halfWidths[i]        = paddles[i].width / 2;
+      halfHeights[i]       = paddles[i].height / 2;
+   }
+
+   std::vector<std::uint8_t> collided(numberOfPairs), directions(numberOfPairs);
+   std::vector<float>        vecsX(numberOfPairs), vecsY(numberOfPairs);
+
+   CircleSpan                 circleSpan    = {centersOfCirclesX.data(), centersOfCirclesY.data(), radii.data()};
+   AABBSpan                   aabbSpan      = {centersOfAABBsX.data(), centersOfAABBsY.data(), halfWidths.data(), halfHeights.data()};
+   CircleAndAABBCollisionSpan collisionSpan = {collided.data(), vecsX.data(), vecsY.data(), directions.data()};
+
+   // Every loop sums the directions of the collisions, so that the compiler can't skip any of the work
+   unsigned int checksumOfPairAtATime = 0;
+   unsigned int checksumOfWrappers    = 0;
+   unsigned int checksumOfBatch       = 0;
+
+   auto start = std::chrono::steady_clock::now();
+   for (unsigned int repetition = 0; repetition < numberOfRepetitions; ++repetition)
+   {
+      for (std::size_t i = 0; i < numberOfPairs; ++i)
+      {
+         glm::vec2 vec;
+         if (circleAndAABBCollidedWithSquareRoot(circles[i], paddles[i], vec))
+         {
+            checksumOfPairAtATime += 1 + static_cast<unsigned int>(determineDirectionWithDotProducts(vec));
+         }
+      }
+   }
+   double pairAtATimeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   start = std::chrono::steady_clock::now();
+   for (unsigned int repetition = 0; repetition < numberOfRepetitions; ++repetition)
+   {
+      for (std::size_t i = 0; i < numberOfPairs; ++i)
+      {
+         glm::vec2 vec;
+         if (circleAndAABBCollided(circles[i], paddles[i], vec))
+         {
+            checksumOfWrappers += 1 + static_cast<unsigned int>(determineDirectionOfCollisionBetweenCircleAndAABB(vec));
+         }
+      }
+   }
+   double wrappersSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   start = std::chrono::steady_clock::now();
+   for (unsigned int repetition = 0; repetition < numberOfRepetitions; ++repetition)
+   {
+      circlesAndAABBsCollided(numberOfPairs, circleSpan, aabbSpan, collisionSpan);
+      for (std::size_t i = 0; i < numberOfPairs; ++i)
+      {
+         checksumOfBatch += collided[i] * (1 + directions[i]);
+      }
+   }
+   double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+#if defined(FLOAT_LANES_AVX) || defined(FLOAT_LANES_AVX512)
+   // Same batch, compiled without SIMD flags (see the Makefile)
+   unsigned int              checksumOfSSE2Batch = 0;
+   std::vector<std::uint8_t> collidedBySSE2(numberOfPairs), directionsOfSSE2(numberOfPairs);
+   std::vector<float>        vecsOfSSE2X(numberOfPairs), vecsOfSSE2Y(numberOfPairs);
+   CircleAndAABBCollisionSpan sse2CollisionSpan = {collidedBySSE2.data(), vecsOfSSE2X.data(), vecsOfSSE2Y.data(), directionsOfSSE2.data()};
+
+   start = std::chrono::steady_clock::now();
+   for (unsigned int repetition = 0; repetition < numberOfRepetitions; ++repetition)
+   {
+      FloatLanesSSE2::circlesAndAABBsCollided(numberOfPairs, circleSpan, aabbSpan, sse2CollisionSpan);
+      for (std::size_t i = 0; i < numberOfPairs; ++i)
+      {
+         checksumOfSSE2Batch += collidedBySSE2[i] * (1 + directionsOfSSE2[i]);
+      }
+   }
+   double sse2BatchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+#endif
+
+   // The old test compared lengths instead of squared lengths, so pairs that are within rounding error of touching could disagree
+   std::size_t numberOfDisagreements = 0;
+   for (std::size_t i = 0; i < numberOfPairs; ++i)
+   {
+      glm::vec2 vec;
+      bool      collidedBefore = circleAndAABBCollidedWithSquareRoot(circles[i], paddles[i], vec);
+      if (collidedBefore != (collided[i] != 0) || (collidedBefore && determineDirectionWithDotProducts(vec) != static_cast<CollisionDirection>(directions[i])))
+      {
+         ++numberOfDisagreements;
+      }
+#if defined(FLOAT_LANES_AVX) || defined(FLOAT_LANES_AVX512)
+      else if ((collidedBySSE2[i] != collided[i]) || (directionsOfSSE2[i] != directions[i]))
+      {
+         ++numberOfDisagreements;
+      }
+#endif
+   }
+
+   double tests = static_cast<double>(numberOfPairs) * numberOfRepetitions;
+
+   std::cout << "Pairs: " << numberOfPairs << ", repetitions: " << numberOfRepetitions << "\n";
+   std::cout << "Pair at a time (square root and dot products): " << (pairAtATimeSeconds * 1e9 / tests) << " ns/pair, checksum " << checksumOfPairAtATime << "\n";
+   std::cout << "Pair at a time (wrappers):                     " << (wrappersSeconds * 1e9 / tests)    << " ns/pair, checksum " << checksumOfWrappers << "\n";
+#if defined(FLOAT_LANES_AVX) || defined(FLOAT_LANES_AVX512)
+   std::cout << "Batch (SIMD width " << FloatLanesSSE2::floatLanesWidth << "):                          " << (sse2BatchSeconds * 1e9 / tests) << " ns/pair, checksum " << checksumOfSSE2Batch
+             << ", " << (pairAtATimeSeconds / sse2BatchSeconds) << "x faster than a pair at a time" << "\n";
+#endif
+   std::cout << "Batch (SIMD width " << floatLanesWidth << "):                          " << (batchSeconds * 1e9 / tests) << " ns/pair, checksum " << checksumOfBatch
+             << ", " << (pairAtATimeSeconds / batchSeconds) << "x faster than a pair at a time" << "\n";
+   std::cout << "Pairs that disagree with the old functions: " << numberOfDisagreements << "\n";
+
+   return (numberOfDisagreements == 0) ? 0 : -1;
+}
@@ -0,0 +1,348 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "cooked_mesh.h"
+
+const std::uint64_t alignmentOfSections = 16;
+
+std::uint64_t alignOffset(std::uint64_t offset)
+{
+   return (offset + alignmentOfSections - 1) & ~(alignmentOfSections - 1);
+}
+
+std::uint32_t addCookedTextureName(CookedMeshContents& contents, const std::string& name)
+{
+   std::uint32_t offset = static_cast<std::uint32_t>(contents.textureNames.size());
+   contents.textureNames.append(name);
+   contents.textureNames.push_back('\0');
+   return offset;
+}
+
+bool writeCookedMeshFile(const std::string& filePath, const CookedMeshContents& contents)
+{
+   CookedMeshHeader header     = {};
+   header.magicNumber          = cookedMeshMagicNumber;
+   header.version              = cookedMeshVersion;
+   header.sizeOfVertex         = sizeOfCookedVertex;
+   header.numberOfMeshes       = static_cast<std::uint32_t>(contents.meshes.size());
+   header.numberOfMaterials    = static_cast<std::uint32_t>(contents.materials.size());
+   header.numberOfVertices     = static_cast<std::uint32_t>(contents.vertices.size() * sizeof(float) / sizeOfCookedVertex);
+   header.numberOfIndices      = static_cast<std::uint32_t>(contents.indices.size());
+   header.sizeOfTextureNames   = static_cast<std::uint32_t>(contents.textureNames.size());
+   header.offsetOfMeshes       = alignOffset(sizeof(CookedMeshHeader));
+   header.offsetOfMaterials    = alignOffset(header.offsetOfMeshes + contents.meshes.size() * sizeof(CookedMeshRange));
+   header.offsetOfTextureNames = alignOffset(header.offsetOfMaterials + contents.materials.size() * sizeof(CookedMaterial));
+   header.offsetOfVertices     = alignOffset(header.offsetOfTextureNames + contents.textureNames.size());
+   header.offsetOfIndices      = alignOffset(header.offsetOfVertices + contents.vertices.size() * sizeof(float));
+   header.sizeOfFile           = header.offsetOfIndices + contents.indices.size() * sizeof(std::uint32_t);
+
+   std::vector<std::uint8_t> bytes(header.sizeOfFile, 0);
+   std::memcpy(&bytes[0], &header, sizeof(header));
+
+   if (!contents.meshes.empty())       { std::memcpy(&bytes[header.offsetOfMeshes], contents.meshes.data(), contents.meshes.size() * sizeof(CookedMeshRange)); }
+   if (!contents.materials.empty())    { std::memcpy(&bytes[header.offsetOfMaterials], contents.materials.data(), contents.materials.size() * sizeof(CookedMaterial)); }
+   if (!contents.textureNames.empty()) { std::memcpy(&bytes[header.offsetOfTextureNames], contents.textureNames.data(), contents.textureNames.size()); }
+   if (!contents.vertices.empty())     { std::memcpy(&bytes[header.offsetOfVertices], contents.vertices.data(), contents.vertices.size() * sizeof(float)); }
+   if (!contents.indices.empty())      { std::memcpy(&bytes[header.offsetOfIndices], contents.indices.data(), contents.indices.size() * sizeof(std::uint32_t)); }
+
+   std::string temporaryFilePath = filePath + ".tmp";
+   std::FILE*  file              = std::fopen(temporaryFilePath.c_str(), "wb");
+   if (!file)
+   {
+      std::cout << "Error - writeCookedMeshFile - The following file could not be created: " << temporaryFilePath << "\n";
+      return false;
+   }
+
+   bool allBytesWereWritten = (std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size());
+   allBytesWereWritten      = (std::fclose(file) == 0) && allBytesWereWritten;
+
+#ifdef _WIN32
+   bool fileWasRenamed = allBytesWereWritten && (MoveFileExA(temporaryFilePath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+   bool fileWasRenamed = allBytesWereWritten && (std::rename(temporaryFilePath.c_str(), filePath.c_str()) == 0);
+#endif
+
+   if (!fileWasRenamed)
+   {
+      std::cout << "Error - writeCookedMeshFile - The following file could not be written: " << filePath << "\n";
+      std::remove(temporaryFilePath.c_str());
+      return false;
+   }
+
+   return true;
+}
+
+std::string getPathOfCookedMeshFile(const std::string& modelFilePath)
+{
+   std::size_t positionOfLastSlash = modelFilePath.find_last_of("/\\");
+   std::size_t positionOfLastDot   = modelFilePath.find_last_of('.');
+
+   if ((positionOfLastDot == std::string::npos) || ((positionOfLastSlash != std::string::npos) && (positionOfLastDot < positionOfLastSlash)))
+   {
+      return modelFilePath + ".tpmesh";
+   }
+
+   return modelFilePath.substr(0, positionOfLastDot) + ".tpmesh";
+}
+
+bool cookedMeshFileIsUpToDate(const std::string& cookedFilePath, const std::string& modelFilePath)
+{
+   struct stat statusOfCookedFile;
+   struct stat statusOfModelFile;
+
+   if (stat(cookedFilePath.c_str(), &statusOfCookedFile) != 0)
+   {
+      return false;
+   }
+
+   // A cooked file without its model can still be loaded, which lets a game be shipped with only the cooked files
+   if (stat(modelFilePath.c_str(), &statusOfModelFile) != 0)
+   {
+      return true;
+   }
+
+   return statusOfCookedFile.st_mtime >= statusOfModelFile.st_mtime;
+}
+
+CookedMeshFile::CookedMeshFile()
+   : mBytes(nullptr)
+   , mSizeOfFile(0)
+   , mHeader(nullptr)
+#ifdef _WIN32
+   , mFileHandle(INVALID_HANDLE_VALUE)
+   , mMappingHandle(nullptr)
+#endif
+{
+
+}
+
+CookedMeshFile::~CookedMeshFile()
+{
+   close();
+}
+
+#ifdef _WIN32
+
+bool CookedMeshFile::open(const std::string& filePath)
+{
+   close();
+
+   mFileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (mFileHandle == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   LARGE_INTEGER sizeOfFile;
+   if (!GetFileSizeEx(mFileHandle, &sizeOfFile) || (sizeOfFile.QuadPart < static_cast<LONGLONG>(sizeof(CookedMeshHeader))))
+   {
+      close();
+      return false;
+   }
+
+   mMappingHandle = CreateFileMappingA(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (mMappingHandle == nullptr)
+   {
+      close();
+      return false;
+   }
+
+   mBytes      = static_cast<const std::uint8_t*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+   mSizeOfFile = static_cast<std::uint64_t>(sizeOfFile.QuadPart);
+   mHeader     = reinterpret_cast<const CookedMeshHeader*>(mBytes);
+
+   if ((mBytes == nullptr) || !validate())
+   {
+      close();
+      return false;
+   }
+
+   return true;
+}
+
+void CookedMeshFile::close()
+{
+   if (mBytes != nullptr)
+   {
+      UnmapViewOfFile(mBytes);
+   }
+
+   if (mMappingHandle != nullptr)
+   {
+      CloseHandle(mMappingHandle);
+   }
+
+   if (mFileHandle != INVALID_HANDLE_VALUE)
+   {
+      CloseHandle(mFileHandle);
+   }
+
+   mBytes         = nullptr;
+   mSizeOfFile    = 0;
+   mHeader        = nullptr;
+   mFileHandle    = INVALID_HANDLE_VALUE;
+   mMappingHandle = nullptr;
+}
+
+#else
+
+bool CookedMeshFile::open(const std::string& filePath)
+{
+   close();
+
+   int fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+   if (fileDescriptor == -1)
+   {
+      return false;
+   }
+
+   struct stat status;
+   if ((fstat(fileDescriptor, &status) == -1) || (static_cast<std::uint64_t>(status.st_size) < sizeof(CookedMeshHeader)))
+   {
+      ::close(fileDescriptor);
+      return false;
+   }
+
+   // The mapping stays valid after the file is closed
+   void* memory = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+   ::close(fileDescriptor);
+   if (memory == MAP_FAILED)
+   {
+      return false;
+   }
+
+   mBytes      = static_cast<const std::uint8_t*>(memory);
+   mSizeOfFile = static_cast<std::uint64_t>(status.st_size);
+   mHeader     = reinterpret_cast<const CookedMeshHeader*>(mBytes);
+
+   if (!validate())
+   {
+      close();
+      return false;
+   }
+
+   return true;
+}
+
+void CookedMeshFile::close()
+{
+   if (mBytes != nullptr)
+   {
+      munmap(const_cast<std::uint8_t*>(mBytes), static_cast<std::size_t>(mSizeOfFile));
+   }
+
+   mBytes      = nullptr;
+   mSizeOfFile = 0;
+   mHeader     = nullptr;
+}
+
+#endif
+
+bool CookedMeshFile::sectionFitsInFile(std::uint64_t offset, std::uint64_t numberOfElements, std::uint64_t sizeOfElement) const
+{
+   return ((offset % alignmentOfSections) == 0) && (offset <= mSizeOfFile) && (numberOfElements <= (mSizeOfFile - offset) / sizeOfElement);
+}
+
+bool CookedMeshFile::validate() const
+{
+   if ((mHeader->magicNumber != cookedMeshMagicNumber) ||
+       (mHeader->version != cookedMeshVersion) ||
+       (mHeader->sizeOfVertex != sizeOfCookedVertex) ||
+       (mHeader->sizeOfFile != mSizeOfFile))
+   {
+      return false;
+   }
+
+   // Every section must fit in the file, so that a truncated or corrupted file can't make the game read past the end of the mapping
+   // The offsets are checked before the sizes, and the sizes are compared with what is left of the file after the offsets, so that huge offsets can't wrap around
+   // Every section must also start at a multiple of 16 bytes, like the cooker writes them, since they are read through pointers to their structures
+   if (!sectionFitsInFile(mHeader->offsetOfMeshes, mHeader->numberOfMeshes, sizeof(CookedMeshRange)) ||
+       !sectionFitsInFile(mHeader->offsetOfMaterials, mHeader->numberOfMaterials, sizeof(CookedMaterial)) ||
+       !sectionFitsInFile(mHeader->offsetOfTextureNames, mHeader->sizeOfTextureNames, 1) ||
+       !sectionFitsInFile(mHeader->offsetOfVertices, mHeader->numberOfVertices, sizeOfCookedVertex) ||
+       !sectionFitsInFile(mHeader->offsetOfIndices, mHeader->numberOfIndices, sizeof(std::uint32_t)) ||
+       ((mHeader->sizeOfTextureNames > 0) && (mBytes[mHeader->offsetOfTextureNames + mHeader->sizeOfTextureNames - 1] != '\0')))
+   {
+      return false;
+   }
+
+   for (std::uint32_t i = 0; i < mHeader->numberOfMeshes; ++i)
+   {
+      const CookedMeshRange& mesh = getMesh(i);
+      if ((static_cast<std::uint64_t>(mesh.firstVertex) + mesh.numberOfVertices > mHeader->numberOfVertices) ||
+          (static_cast<std::uint64_t>(mesh.firstIndex) + mesh.numberOfIndices > mHeader->numberOfIndices) ||
+          (mesh.indexOfMaterial >= mHeader->numberOfMaterials))
+      {
+         return false;
+      }
+
+      // The indices of a mesh count from its first vertex, and go straight to glBufferData, so an index past its vertices would make the GPU read past its buffer
+      const std::uint32_t* indices = getIndices(mesh);
+      for (std::uint32_t j = 0; j < mesh.numberOfIndices; ++j)
+      {
+         if (indices[j] >= mesh.numberOfVertices)
+         {
+            return false;
+         }
+      }
+   }
+
+   for (std::uint32_t i = 0; i < mHeader->numberOfMaterials; ++i)
+   {
+      for (std::uint32_t textureName : getMaterial(i).textureNames)
+      {
+         if ((textureName != noCookedTexture) && (textureName >= mHeader->sizeOfTextureNames))
+         {
+            return false;
+         }
+      }
+   }
+
+   return true;
+}
+
+std::uint32_t CookedMeshFile::getNumberOfMeshes() const
+{
+   return mHeader->numberOfMeshes;
+}
+
+const CookedMeshRange& CookedMeshFile::getMesh(std::uint32_t index) const
+{
+   return reinterpret_cast<const CookedMeshRange*>(mBytes + mHeader->offsetOfMeshes)[index];
+}
+
+const CookedMaterial& CookedMeshFile::getMaterial(std::uint32_t index) const
+{
+   return reinterpret_cast<const CookedMaterial*>(mBytes + mHeader->offsetOfMaterials)[index];
+}
+
+std::string CookedMeshFile::getTextureName(const CookedMaterial& material, CookedTextureType type) const
+{
+   if (material.textureNames[type] == noCookedTexture)
+   {
+      return std::string();
+   }
+
+   return std::string(reinterpret_cast<const char*>(mBytes + mHeader->offsetOfTextureNames + material.textureNames[type]));
+}
+
+const void* CookedMeshFile::getVertices(const CookedMeshRange& mesh) const
+{
+   return mBytes + mHeader->offsetOfVertices + static_cast<std::uint64_t>(mesh.firstVertex) * sizeOfCookedVertex;
+}
+
+const std::uint32_t* CookedMeshFile::getIndices(const CookedMeshRange& mesh) const
+{
+   return reinterpret_cast<const std::uint32_t*>(mBytes + mHeader->offsetOfIndices) + mesh.firstIndex;
+}
@@ -0,0 +1,170 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "cooked_texture.h"
+
+std::uint64_t getSizeOfCookedTextureLevel(std::uint32_t format, std::uint32_t width, std::uint32_t height)
+{
+   if (format == CookedTextureRGBA8)
+   {
+      return static_cast<std::uint64_t>(width) * height * 4;
+   }
+
+   std::uint64_t numberOfBlocks = static_cast<std::uint64_t>((width + 3) / 4) * ((height + 3) / 4);
+   return numberOfBlocks * ((format == CookedTextureBC1) ? 8 : 16);
+}
+
+const char* getNameOfCookedTextureFormat(std::uint32_t format)
+{
+   switch (format)
+   {
+   case CookedTextureBC1:
+      return "BC1";
+   case CookedTextureBC3:
+      return "BC3";
+   case CookedTextureRGBA8:
+      return "RGBA8";
+   case CookedTextureBC7:
+      return "BC7";
+   default:
+      return "unknown";
+   }
+}
+
+bool writeCookedTextureFile(const std::string& filePath, const CookedTextureContents& contents)
+{
+   CookedTextureHeader header = {};
+   header.magicNumber         = cookedTextureMagicNumber;
+   header.version             = cookedTextureVersion;
+   header.format              = contents.format;
+   header.width               = contents.width;
+   header.height              = contents.height;
+   header.numberOfLevels      = static_cast<std::uint32_t>(contents.levels.size());
+   header.offsetOfLevels      = sizeof(CookedTextureHeader);
+   header.offsetOfData        = (header.offsetOfLevels + contents.levels.size() * sizeof(CookedTextureLevel) + 15) & ~static_cast<std::uint64_t>(15);
+   header.sizeOfFile          = header.offsetOfData + contents.data.size();
+
+   std::vector<std::uint8_t> bytes(header.sizeOfFile, 0);
+   std::memcpy(&bytes[0], &header, sizeof(header));
+
+   if (!contents.levels.empty()) { std::memcpy(&bytes[header.offsetOfLevels], contents.levels.data(), contents.levels.size() * sizeof(CookedTextureLevel)); }
+   if (!contents.data.empty())   { std::memcpy(&bytes[header.offsetOfData], contents.data.data(), contents.data.size()); }
+
+   std::string temporaryFilePath = filePath + ".tmp";
+   std::FILE*  file              = std::fopen(temporaryFilePath.c_str(), "wb");
+   if (!file)
+   {
+      std::cout << "Error - writeCookedTextureFile - The following file could not be created: " << temporaryFilePath << "\n";
+      return false;
+   }
+
+   bool allBytesWereWritten = (std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size());
+   allBytesWereWritten      = (std::fclose(file) == 0) && allBytesWereWritten;
+
+#ifdef _WIN32
+   bool fileWasRenamed = allBytesWereWritten && (MoveFileExA(temporaryFilePath.c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+   bool fileWasRenamed = allBytesWereWritten && (std::rename(temporaryFilePath.c_str(), filePath.c_str()) == 0);
+#endif
+
+   if (!fileWasRenamed)
+   {
+      std::cout << "Error - writeCookedTextureFile - The following file could not be written: " << filePath << "\n";
+      std::remove(temporaryFilePath.c_str());
+      return false;
+   }
+
+   return true;
+}
+
+bool readCookedTextureFile(const std::string& filePath, CookedTextureContents& contents)
+{
+   // The file is small compared to the decoded image, so it's read in one go instead of being mapped
+   std::FILE* file = std::fopen(filePath.c_str(), "rb");
+   if (!file)
+   {
+      return false;
+   }
+
+   CookedTextureHeader header;
+   bool headerWasRead = (std::fread(&header, sizeof(header), 1, file) == 1);
+   if (!headerWasRead ||
+       (header.magicNumber != cookedTextureMagicNumber) ||
+       (header.version != cookedTextureVersion) ||
+       ((header.format != CookedTextureBC1) && (header.format != CookedTextureBC3) && (header.format != CookedTextureRGBA8) && (header.format != CookedTextureBC7)) ||
+       (header.offsetOfLevels + static_cast<std::uint64_t>(header.numberOfLevels) * sizeof(CookedTextureLevel) > header.offsetOfData) ||
+       (header.offsetOfData > header.sizeOfFile))
+   {
+      std::fclose(file);
+      return false;
+   }
+
+   contents.format = header.format;
+   contents.width  = header.width;
+   contents.height = header.height;
+   contents.levels.resize(header.numberOfLevels);
+   contents.data.resize(static_cast<std::size_t>(header.sizeOfFile - header.offsetOfData));
+
+   bool levelsWereRead = (std::fseek(file, static_cast<long>(header.offsetOfLevels), SEEK_SET) == 0) &&
+                         (std::fread(contents.levels.data(), sizeof(CookedTextureLevel), contents.levels.size(), file) == contents.levels.size());
+   bool dataWasRead    = levelsWereRead &&
+                         (std::fseek(file, static_cast<long>(header.offsetOfData), SEEK_SET) == 0) &&
+                         (std::fread(contents.data.data(), 1, contents.data.size(), file) == contents.data.size());
+   std::fclose(file);
+
+   if (!dataWasRead)
+   {
+      return false;
+   }
+
+   // Every level must fit in the data and have the size of its blocks, so that a corrupted file can't make OpenGL read past the end of the data
+   for (const CookedTextureLevel& level : contents.levels)
+   {
+      if ((level.size != getSizeOfCookedTextureLevel(contents.format, level.width, level.height)) ||
+          (level.offset + level.size > contents.data.size()))
+      {
+         return false;
+      }
+   }
+
+   return !contents.levels.empty();
+}
+
+std::string getPathOfCookedTextureFile(const std::string& texFilePath)
+{
+   std::size_t positionOfLastSlash = texFilePath.find_last_of("/\\");
+   std::size_t positionOfLastDot   = texFilePath.find_last_of('.');
+
+   if ((positionOfLastDot == std::string::npos) || ((positionOfLastSlash != std::string::npos) && (positionOfLastDot < positionOfLastSlash)))
+   {
+      return texFilePath + ".tptex";
+   }
+
+   return texFilePath.substr(0, positionOfLastDot) + ".tptex";
+}
+
+bool cookedTextureFileIsUpToDate(const std::string& cookedFilePath, const std::string& texFilePath)
+{
+   struct stat statusOfCookedFile;
+   struct stat statusOfTexFile;
+
+   if (stat(cookedFilePath.c_str(), &statusOfCookedFile) != 0)
+   {
+      return false;
+   }
+
+   // A cooked file without its texture can still be loaded, just like a cooked mesh file
+   if (stat(texFilePath.c_str(), &statusOfTexFile) != 0)
+   {
+      return true;
+   }
+
+   return statusOfCookedFile.st_mtime >= statusOfTexFile.st_mtime;
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cooked_mesh.h"
+#include "cooked_texture.h"
+#include "mesh_cooker.h"
+#include "texture_cooker.h"
+#include "thread_pool.h"
+
+// Cooks models into .tpmesh files and textures into .tptex files ahead of time, so that the game doesn't need to import them with Assimp
+// or to decode and compress them the first time it loads them
+// Usage: teapong_cooker [--force] [--uncompressed | --bc7] [--box] [--linear | --srgb] FILE...
+//   --force         Cooks the files even if their cooked files are up to date
+//   --uncompressed  Stores the textures as RGBA8 instead of BC1 or BC3
+//   --bc7           Stores the textures as BC7 instead of BC1 or BC3, which is closer to them but needs a driver with BPTC (the game decompresses them otherwise)
+//   --box           Generates the mipmaps of the textures with a box filter instead of a gamma-correct Kaiser filter, which is faster but blurrier
+//   --linear        Filters the mipmaps of every texture as data instead of colors, without converting them from sRGB
+//   --srgb          Filters the mipmaps of every texture as sRGB colors
+// Without --linear or --srgb, the textures whose names say they hold data (e.g. teapot_specular.jpg) are filtered as data, like the game does
+// Files with the extension of an image (.jpg, .jpeg, .png, .tga or .bmp) are cooked as textures, and the rest as models
+// Each cooked file is written next to its source, and then read back to check it and to measure how long the game takes to open it
+// To cook every model and texture of the game: teapong_cooker resources/models/*/*.obj resources/models/*/*.jpg
+
+bool isTexture(const std::string& filePath)
+{
+   std::size_t positionOfLastDot = filePath.find_last_of('.');
+   if (positionOfLastDot == std::string::npos)
+   {
+      return false;
+   }
+
+   std::string extension = filePath.substr(positionOfLastDot + 1);
+   std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+   return (extension == "jpg") || (extension == "jpeg") || (extension == "png") || (extension == "tga") || (extension == "bmp");
+}
+
+int cookTextureFile(const std::string& texFilePath, bool force, TextureCompression compression, MipFilter mipFilter, TextureColorSpace colorSpace, ThreadPool& threads)
+{
+   std::string cookedFilePath = getPathOfCookedTextureFile(texFilePath);
+
+   double cookSeconds = 0.0;
+   if (force || !cookedTextureFileIsUpToDate(cookedFilePath, texFilePath))
+   {
+      auto start = std::chrono::steady_clock::now();
+      if (!cookTexture(texFilePath, cookedFilePath, colorSpace, compression, mipFilter, &threads))
+      {
+         return -1;
+      }
+      cookSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   }
+
+   auto                  start = std::chrono::steady_clock::now();
+   CookedTextureContents contents;
+   if (!readCookedTextureFile(cookedFilePath, contents))
+   {
+      std::cout << "Error - cookTextureFile - The following cooked file is invalid: " << cookedFilePath << "\n";
+      return -1;
+   }
+   double readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   // What glTexImage2D and glGenerateMipmap would have stored, with 4 bytes per texel since most drivers pad RGB textures to RGBA
+   double uncompressedBytes = static_cast<double>(contents.width) * contents.height * 4.0 * 4.0 / 3.0;
+
+   std::cout << cookedFilePath << ": " << contents.width << "x" << contents.height << ", " << getNameOfCookedTextureFormat(contents.format) << ", "
+             << ((colorSpace == TextureColorSpace::linear) ? "linear" : "sRGB") << ", "
+             << contents.levels.size() << " levels, " << contents.data.size() << " bytes (" << (uncompressedBytes / contents.data.size()) << "x smaller than uncompressed), "
+             << ((cookSeconds > 0.0) ? ("cooked in " + std::to_string(cookSeconds * 1e3) + " ms, ") : std::string("up to date, "))
+             << "read in " << (readSeconds * 1e3) << " ms" << "\n";
+   return 0;
+}
+
+int main(int argc, char* argv[])
+{
+   bool                     force              = false;
+   TextureCompression       compression        = TextureCompression::s3tc;
+   MipFilter                mipFilter          = MipFilter::kaiser;
+   TextureColorSpace        colorSpace         = TextureColorSpace::sRGB;
+   bool                     colorSpaceIsForced = false;
+   std::vector<std::string> filePaths;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      if (std::strcmp(argv[i], "--force") == 0)
+      {
+         force = true;
+      }
+      else if (std::strcmp(argv[i], "--uncompressed") == 0)
+      {
+         compression = TextureCompression::none;
+      }
+      else if (std::strcmp(argv[i], "--bc7") == 0)
+      {
+         compression = TextureCompression::bptc;
+      }
+      else if (std::strcmp(argv[i], "--box") == 0)
+      {
+         mipFilter = MipFilter::box;
+      }
+      else if ((std::strcmp(argv[i], "--linear") == 0) || (std::strcmp(argv[i], "--srgb") == 0))
+      {
+         colorSpace         = (std::strcmp(argv[i], "--linear") == 0) ? TextureColorSpace::linear : TextureColorSpace::sRGB;
+         colorSpaceIsForced = true;
+      }
+      else
+      {
+         filePaths.push_back(argv[i]);
+      }
+   }
+
+   if (filePaths.empty())
+   {
+      std::cout << "Usage: teapong_cooker [--force] [--uncompressed | --bc7] [--box] [--linear | --srgb] FILE..." << "\n";
+      return -1;
+   }
+
+   // Textures are cooked one after the other, and the mipmaps and blocks of each one are split across every core
+   ThreadPool threads;
+
+   int result = 0;
+   for (const std::string& modelFilePath : filePaths)
+   {
+      if (isTexture(modelFilePath))
+      {
+         TextureColorSpace colorSpaceOfTexture = colorSpaceIsForced ? colorSpace : getColorSpaceOfTexture(modelFilePath);
+         result = (cookTextureFile(modelFilePath, force, compression, mipFilter, colorSpaceOfTexture, threads) == 0) ? result : -1;
+         continue;
+      }
+
+      std::string cookedFilePath = getPathOfCookedMeshFile(modelFilePath);
+
+      double cookSeconds = 0.0;
+      if (force || !cookedMeshFileIsUpToDate(cookedFilePath, modelFilePath))
+      {
+         auto start = std::chrono::steady_clock::now();
+         if (!cookModel(modelFilePath, cookedFilePath))
+         {
+            result = -1;
+            continue;
+         }
+         cookSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+
+      auto           start = std::chrono::steady_clock::now();
+      CookedMeshFile cookedFile;
+      if (!cookedFile.open(cookedFilePath))
+      {
+         std::cout << "Error - main - The following cooked file is invalid: " << cookedFilePath << "\n";
+         result = -1;
+         continue;
+      }
+      double openSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      std::uint64_t numberOfVertices = 0;
+      std::uint64_t numberOfIndices  = 0;
+      for (std::uint32_t i = 0; i < cookedFile.getNumberOfMeshes(); ++i)
+      {
+         numberOfVertices += cookedFile.getMesh(i).numberOfVertices;
+         numberOfIndices  += cookedFile.getMesh(i).numberOfIndices;
+      }
+
+      std::cout << cookedFilePath << ": " << cookedFile.getNumberOfMeshes() << " meshes, " << numberOfVertices << " vertices, " << numberOfIndices << " indices, "
+                << ((cookSeconds > 0.0) ? ("cooked in " + std::to_string(cookSeconds * 1e3) + " ms, ") : std::string("up to date, "))
+                << "opened in " << (openSeconds * 1e3) << " ms" << "\n";
+   }
+
+   return result;
+}
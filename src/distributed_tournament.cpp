@@ -0,0 +1,875 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "distributed_tournament.h"
+
+// Every message is framed as a 32-bit length, a byte with its type and a payload of that length, with every number stored in little-endian order
+enum class MessageType : std::uint8_t
+{
+   Hello    = 1, // Worker to coordinator: magic number, version of the protocol and fingerprint of the tournament
+   Job      = 2, // Coordinator to worker: index of the job, and first and last match of the job
+   Results  = 3, // Worker to coordinator: index of the job and its results
+   Shutdown = 4, // Coordinator to worker: the tournament is over
+   Rejected = 5  // Coordinator to worker: the worker is playing a different tournament
+};
+
+const std::uint32_t workerMagicNumber = 0x57545054; // "TPTW"
+const std::uint32_t protocolVersion   = 1;
+const std::uint32_t maxSizeOfPayload  = 1 << 20;
+const std::size_t   sizeOfHeader      = 5;
+
+// Workers that are started at the same time as the coordinator might try to connect before it listens
+const unsigned int  maxNumberOfConnectionAttempts         = 50;
+const int           millisecondsBetweenConnectionAttempts = 100;
+
+void appendUint32(std::vector<std::uint8_t>& bytes, std::uint32_t value)
+{
+   for (int i = 0; i < 4; ++i)
+   {
+      bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+   }
+}
+
+void appendUint64(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+{
+   for (int i = 0; i < 8; ++i)
+   {
+      bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+   }
+}
+
+bool readUint32(const std::uint8_t*& cursor, const std::uint8_t* end, std::uint32_t& value)
+{
+   if (end - cursor < 4)
+   {
+      return false;
+   }
+
+   value = 0;
+   for (int i = 0; i < 4; ++i)
+   {
+      value |= static_cast<std::uint32_t>(cursor[i]) << (8 * i);
+   }
+
+   cursor += 4;
+   return true;
+}
+
+bool readUint64(const std::uint8_t*& cursor, const std::uint8_t* end, std::uint64_t& value)
+{
+   if (end - cursor < 8)
+   {
+      return false;
+   }
+
+   value = 0;
+   for (int i = 0; i < 8; ++i)
+   {
+      value |= static_cast<std::uint64_t>(cursor[i]) << (8 * i);
+   }
+
+   cursor += 8;
+   return true;
+}
+
+void appendTournamentResults(std::vector<std::uint8_t>& bytes, const TournamentResults& results)
+{
+   appendUint32(bytes, static_cast<std::uint32_t>(results.pairings.size()));
+   for (const PairingResults& pairing : results.pairings)
+   {
+      appendUint64(bytes, pairing.winsOfLeftEntrant);
+      appendUint64(bytes, pairing.winsOfRightEntrant);
+      appendUint64(bytes, pairing.draws);
+   }
+
+   for (std::uint64_t numberOfRallies : results.rallyLengths)
+   {
+      appendUint64(bytes, numberOfRallies);
+   }
+
+   for (std::uint64_t numberOfServes : results.serveDirections)
+   {
+      appendUint64(bytes, numberOfServes);
+   }
+
+   appendUint64(bytes, results.numberOfMatches);
+   appendUint64(bytes, results.numberOfPoints);
+   appendUint64(bytes, results.numberOfSteps);
+}
+
+bool readTournamentResults(const std::uint8_t*& cursor, const std::uint8_t* end, TournamentResults& results)
+{
+   std::uint32_t numberOfPairings;
+   if (!readUint32(cursor, end, numberOfPairings) || numberOfPairings != results.pairings.size())
+   {
+      return false;
+   }
+
+   bool succeeded = true;
+   for (PairingResults& pairing : results.pairings)
+   {
+      succeeded = succeeded && readUint64(cursor, end, pairing.winsOfLeftEntrant);
+      succeeded = succeeded && readUint64(cursor, end, pairing.winsOfRightEntrant);
+      succeeded = succeeded && readUint64(cursor, end, pairing.draws);
+   }
+
+   for (std::uint64_t& numberOfRallies : results.rallyLengths)
+   {
+      succeeded = succeeded && readUint64(cursor, end, numberOfRallies);
+   }
+
+   for (std::uint64_t& numberOfServes : results.serveDirections)
+   {
+      succeeded = succeeded && readUint64(cursor, end, numberOfServes);
+   }
+
+   succeeded = succeeded && readUint64(cursor, end, results.numberOfMatches);
+   succeeded = succeeded && readUint64(cursor, end, results.numberOfPoints);
+   succeeded = succeeded && readUint64(cursor, end, results.numberOfSteps);
+
+   return succeeded;
+}
+
+bool writeAllBytes(int socket, const std::uint8_t* bytes, std::size_t numberOfBytes)
+{
+   while (numberOfBytes > 0)
+   {
+      ssize_t numberOfBytesWritten = write(socket, bytes, numberOfBytes);
+      if (numberOfBytesWritten < 0 && errno == EINTR)
+      {
+         continue;
+      }
+
+      if (numberOfBytesWritten <= 0)
+      {
+         return false;
+      }
+
+      bytes         += numberOfBytesWritten;
+      numberOfBytes -= static_cast<std::size_t>(numberOfBytesWritten);
+   }
+
+   return true;
+}
+
+bool readAllBytes(int socket, std::uint8_t* bytes, std::size_t numberOfBytes)
+{
+   while (numberOfBytes > 0)
+   {
+      ssize_t numberOfBytesRead = read(socket, bytes, numberOfBytes);
+      if (numberOfBytesRead < 0 && errno == EINTR)
+      {
+         continue;
+      }
+
+      if (numberOfBytesRead <= 0)
+      {
+         return false;
+      }
+
+      bytes         += numberOfBytesRead;
+      numberOfBytes -= static_cast<std::size_t>(numberOfBytesRead);
+   }
+
+   return true;
+}
+
+bool sendMessage(int socket, MessageType type, const std::vector<std::uint8_t>& payload)
+{
+   std::vector<std::uint8_t> bytes;
+   bytes.reserve(sizeOfHeader + payload.size());
+   appendUint32(bytes, static_cast<std::uint32_t>(payload.size()));
+   bytes.push_back(static_cast<std::uint8_t>(type));
+   bytes.insert(bytes.end(), payload.begin(), payload.end());
+
+   return writeAllBytes(socket, bytes.data(), bytes.size());
+}
+
+// Blocks until a whole message has been received
+bool receiveMessage(int socket, MessageType& type, std::vector<std::uint8_t>& payload)
+{
+   std::uint8_t header[sizeOfHeader];
+   if (!readAllBytes(socket, header, sizeOfHeader))
+   {
+      return false;
+   }
+
+   const std::uint8_t* cursor = header;
+   std::uint32_t       sizeOfPayload;
+   readUint32(cursor, header + sizeOfHeader, sizeOfPayload);
+   if (sizeOfPayload > maxSizeOfPayload)
+   {
+      return false;
+   }
+
+   type = static_cast<MessageType>(header[4]);
+   payload.resize(sizeOfPayload);
+   return readAllBytes(socket, payload.data(), sizeOfPayload);
+}
+
+// Creates a socket for an address of the form "unix:/path/to/socket" or "tcp:host:port"
+// Listening sockets accept connections from any host when the host is empty or "*"
+int createSocketForAddress(const std::string& address, bool listen, std::string& pathOfUnixSocket)
+{
+   if (address.compare(0, 5, "unix:") == 0)
+   {
+      sockaddr_un socketAddress;
+      std::memset(&socketAddress, 0, sizeof(socketAddress));
+      socketAddress.sun_family = AF_UNIX;
+
+      pathOfUnixSocket = address.substr(5);
+      if (pathOfUnixSocket.empty() || pathOfUnixSocket.size() >= sizeof(socketAddress.sun_path))
+      {
+         std::cout << "Error - createSocketForAddress - Invalid path of Unix domain socket: " << pathOfUnixSocket << "\n";
+         return -1;
+      }
+      std::memcpy(socketAddress.sun_path, pathOfUnixSocket.c_str(), pathOfUnixSocket.size() + 1);
+
+      int unixSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+      if (unixSocket < 0)
+      {
+         return -1;
+      }
+
+      if (listen)
+      {
+         // Remove the socket of a coordinator that didn't shut down cleanly
+         unlink(pathOfUnixSocket.c_str());
+      }
+
+      int result = listen ? bind(unixSocket, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress))
+                          : connect(unixSocket, reinterpret_cast<sockaddr*>(&socketAddress), sizeof(socketAddress));
+      if (result != 0)
+      {
+         close(unixSocket);
+         return -1;
+      }
+
+      return unixSocket;
+   }
+
+   if (address.compare(0, 4, "tcp:") == 0)
+   {
+      std::size_t separator = address.rfind(':');
+      std::string host      = address.substr(4, (separator > 4) ? separator - 4 : 0);
+      std::string port      = address.substr(separator + 1);
+
+      addrinfo hints;
+      std::memset(&hints, 0, sizeof(hints));
+      hints.ai_family   = AF_UNSPEC;
+      hints.ai_socktype = SOCK_STREAM;
+      hints.ai_flags    = listen ? AI_PASSIVE : 0;
+
+      bool      hostIsAny = host.empty() || host == "*";
+      addrinfo* addresses = nullptr;
+      if (separator <= 4 || getaddrinfo(hostIsAny ? nullptr : host.c_str(), port.c_str(), &hints, &addresses) != 0)
+      {
+         std::cout << "Error - createSocketForAddress - Invalid TCP address: " << address << "\n";
+         return -1;
+      }
+
+      int tcpSocket = -1;
+      for (addrinfo* candidate = addresses; candidate != nullptr && tcpSocket < 0; candidate = candidate->ai_next)
+      {
+         tcpSocket = socket(candidate->ai_family, candidate->ai_socktype, candidate->ai_protocol);
+         if (tcpSocket < 0)
+         {
+            continue;
+         }
+
+         int enable = 1;
+         setsockopt(tcpSocket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+         // Jobs and results are small messages, so they shouldn't wait for more bytes to be written before they are sent
+         setsockopt(tcpSocket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+         int result = listen ? bind(tcpSocket, candidate->ai_addr, candidate->ai_addrlen) : connect(tcpSocket, candidate->ai_addr, candidate->ai_addrlen);
+         if (result != 0)
+         {
+            close(tcpSocket);
+            tcpSocket = -1;
+         }
+      }
+
+      freeaddrinfo(addresses);
+      return tcpSocket;
+   }
+
+   std::cout << "Error - createSocketForAddress - Addresses must start with unix: or tcp:, got " << address << "\n";
+   return -1;
+}
+
+std::uint64_t calculateFingerprintOfTournament(const Tournament& tournament)
+{
+   // FNV-1a over everything that decides which matches are played and how
+   std::uint64_t fingerprint = 0xCBF29CE484222325ull;
+   auto          addBytes    = [&fingerprint](const void* bytes, std::size_t numberOfBytes)
+   {
+      for (std::size_t i = 0; i < numberOfBytes; ++i)
+      {
+         fingerprint = (fingerprint ^ static_cast<const std::uint8_t*>(bytes)[i]) * 0x100000001B3ull;
+      }
+   };
+
+   std::uint64_t seed                     = tournament.getSeed();
+   std::uint32_t matchesPerPairing        = tournament.getMatchesPerPairing();
+   std::uint32_t numberOfMatches          = tournament.getNumberOfMatches();
+   float         deltaTime                = tournament.getDeltaTime();
+   std::uint32_t maxNumberOfStepsPerMatch = tournament.getMaxNumberOfStepsPerMatch();
+   addBytes(&seed, sizeof(seed));
+   addBytes(&matchesPerPairing, sizeof(matchesPerPairing));
+   addBytes(&numberOfMatches, sizeof(numberOfMatches));
+   addBytes(&deltaTime, sizeof(deltaTime));
+   addBytes(&maxNumberOfStepsPerMatch, sizeof(maxNumberOfStepsPerMatch));
+
+   // The configuration is added one member at a time, so that the padding between its members, which can hold anything, isn't added
+   const MatchConfiguration& configuration = tournament.getConfiguration();
+   addBytes(&configuration.initialBall.position, sizeof(configuration.initialBall.position));
+   addBytes(&configuration.initialBall.velocity, sizeof(configuration.initialBall.velocity));
+   addBytes(&configuration.initialBall.initialVelocity, sizeof(configuration.initialBall.initialVelocity));
+   addBytes(&configuration.initialBall.radius, sizeof(configuration.initialBall.radius));
+   addBytes(&configuration.initialBall.spinAngularVelocity, sizeof(configuration.initialBall.spinAngularVelocity));
+   addBytes(&configuration.initialBall.spinAngularVelocityScaledByBounce, sizeof(configuration.initialBall.spinAngularVelocityScaledByBounce));
+   for (const PaddleState* paddle : {&configuration.initialLeftPaddle, &configuration.initialRightPaddle})
+   {
+      addBytes(&paddle->position, sizeof(paddle->position));
+      addBytes(&paddle->velocity, sizeof(paddle->velocity));
+      addBytes(&paddle->width, sizeof(paddle->width));
+      addBytes(&paddle->height, sizeof(paddle->height));
+   }
+   addBytes(&configuration.verticalRange, sizeof(configuration.verticalRange));
+   addBytes(&configuration.horizontalRange, sizeof(configuration.horizontalRange));
+   addBytes(&configuration.lengthOfLineTraversedByPaddles, sizeof(configuration.lengthOfLineTraversedByPaddles));
+   addBytes(&configuration.scaleOfHorizontalVelocityInFreeFall, sizeof(configuration.scaleOfHorizontalVelocityInFreeFall));
+   addBytes(&configuration.verticalVelocityInFreeFall, sizeof(configuration.verticalVelocityInFreeFall));
+   addBytes(&configuration.heightBelowWhichSceneIsReset, sizeof(configuration.heightBelowWhichSceneIsReset));
+   addBytes(&configuration.maxNumberOfContactsPerStep, sizeof(configuration.maxNumberOfContactsPerStep));
+   addBytes(&configuration.pointsNeededToWin, sizeof(configuration.pointsNeededToWin));
+   addBytes(&configuration.arithmetic, sizeof(configuration.arithmetic));
+
+   for (const TournamentEntrant& entrant : tournament.getEntrants())
+   {
+      addBytes(entrant.name.c_str(), entrant.name.size() + 1);
+   }
+
+   return fingerprint;
+}
+
+TournamentCoordinator::TournamentCoordinator(const Tournament& tournament, const CoordinatorSettings& settings)
+   : mTournament(tournament)
+   , mSettings(settings)
+   , mFingerprint(calculateFingerprintOfTournament(tournament))
+   , mListeningSocket(-1)
+   , mPathOfUnixSocket()
+   , mLocalWorkers()
+   , mConnections()
+   , mPendingJobs()
+   , mJobIsComplete()
+   , mNumberOfCompleteJobs(0)
+   , mResults(tournament.getNumberOfPairings())
+   , mReport()
+{
+   mSettings.matchesPerJob            = std::max(mSettings.matchesPerJob, 1u);
+   mSettings.maxJobsInFlightPerWorker = std::max(mSettings.maxJobsInFlightPerWorker, 1u);
+}
+
+TournamentCoordinator::~TournamentCoordinator()
+{
+   shutDown();
+}
+
+bool TournamentCoordinator::run()
+{
+   // Writing to a worker that has died must return an error instead of killing the coordinator
+   std::signal(SIGPIPE, SIG_IGN);
+
+   if (!listenOnAddress())
+   {
+      return false;
+   }
+
+   mResults = TournamentResults(mTournament.getNumberOfPairings());
+   mReport  = CoordinatorReport();
+   mPendingJobs.clear();
+
+   std::uint32_t numberOfMatches = mTournament.getNumberOfMatches();
+   for (std::uint32_t begin = 0; begin < numberOfMatches; begin += mSettings.matchesPerJob)
+   {
+      std::uint32_t end = std::min(numberOfMatches, begin + mSettings.matchesPerJob);
+      mPendingJobs.push_back(Job{static_cast<std::uint32_t>(mPendingJobs.size()), begin, end});
+   }
+
+   mReport.numberOfJobs  = mPendingJobs.size();
+   mJobIsComplete.assign(mPendingJobs.size(), false);
+   mNumberOfCompleteJobs = 0;
+
+   auto start = std::chrono::steady_clock::now();
+
+   forkLocalWorkers();
+
+   while (mNumberOfCompleteJobs < mReport.numberOfJobs)
+   {
+      queueJobsPastTheirDeadline();
+
+      for (Connection& connection : mConnections)
+      {
+         sendJobs(connection);
+      }
+
+      // When every local worker is gone and nobody else is connected, nobody else is going to play the jobs that are left
+      if (mSettings.numberOfLocalWorkers > 0 && mConnections.empty() && !localWorkersAreAlive())
+      {
+         while (!mPendingJobs.empty())
+         {
+            Job job = mPendingJobs.front();
+            mPendingJobs.pop_front();
+            if (!mJobIsComplete[job.index])
+            {
+               completeJob(job, mTournament.playMatches(job.begin, job.end));
+               ++mReport.jobsPlayedByCoordinator;
+            }
+         }
+
+         continue;
+      }
+
+      std::vector<pollfd> sockets;
+      sockets.push_back(pollfd{mListeningSocket, POLLIN, 0});
+      for (const Connection& connection : mConnections)
+      {
+         sockets.push_back(pollfd{connection.socket, POLLIN, 0});
+      }
+
+      if (poll(sockets.data(), sockets.size(), 100) < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+
+         std::cout << "Error - TournamentCoordinator::run - Failed to poll the sockets of the workers" << "\n";
+         return false;
+      }
+
+      for (std::size_t i = 0; i < mConnections.size(); ++i)
+      {
+         if ((sockets[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) != 0 && !receiveFromConnection(mConnections[i]))
+         {
+            dropConnection(mConnections[i]);
+         }
+      }
+
+      mConnections.erase(std::remove_if(mConnections.begin(), mConnections.end(), [](const Connection& connection) { return connection.socket < 0; }),
+                         mConnections.end());
+
+      if ((sockets[0].revents & POLLIN) != 0)
+      {
+         acceptConnection();
+      }
+   }
+
+   mReport.secondsSpentRunning = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   shutDown();
+   return true;
+}
+
+const TournamentResults& TournamentCoordinator::getResults() const
+{
+   return mResults;
+}
+
+const CoordinatorReport& TournamentCoordinator::getReport() const
+{
+   return mReport;
+}
+
+bool TournamentCoordinator::listenOnAddress()
+{
+   mListeningSocket = createSocketForAddress(mSettings.address, true, mPathOfUnixSocket);
+   if (mListeningSocket < 0 || listen(mListeningSocket, SOMAXCONN) != 0)
+   {
+      std::cout << "Error - TournamentCoordinator::listenOnAddress - Failed to listen on " << mSettings.address << "\n";
+      return false;
+   }
+
+   return true;
+}
+
+void TournamentCoordinator::forkLocalWorkers()
+{
+   // Anything that is still buffered would be written once by the coordinator and once by every worker
+   std::cout.flush();
+
+   for (unsigned int i = 0; i < mSettings.numberOfLocalWorkers; ++i)
+   {
+      pid_t processID = fork();
+      if (processID == 0)
+      {
+         close(mListeningSocket);
+         bool succeeded = runTournamentWorker(mTournament, mSettings.address);
+         _exit(succeeded ? 0 : 1);
+      }
+
+      if (processID < 0)
+      {
+         std::cout << "Error - TournamentCoordinator::forkLocalWorkers - Failed to fork worker " << i << "\n";
+         continue;
+      }
+
+      mLocalWorkers.push_back(processID);
+   }
+}
+
+void TournamentCoordinator::acceptConnection()
+{
+   int workerSocket = accept(mListeningSocket, nullptr, nullptr);
+   if (workerSocket < 0)
+   {
+      return;
+   }
+
+   mConnections.push_back(Connection{workerSocket, false, std::vector<std::uint8_t>(), std::deque<Job>(), std::chrono::steady_clock::now(), false});
+}
+
+bool TournamentCoordinator::receiveFromConnection(Connection& connection)
+{
+   std::uint8_t buffer[65536];
+   ssize_t      numberOfBytesRead = read(connection.socket, buffer, sizeof(buffer));
+   if (numberOfBytesRead < 0 && errno == EINTR)
+   {
+      return true;
+   }
+
+   if (numberOfBytesRead <= 0)
+   {
+      return false;
+   }
+
+   connection.receivedBytes.insert(connection.receivedBytes.end(), buffer, buffer + numberOfBytesRead);
+
+   // Process every message that has been received completely, and keep the rest for later
+   std::size_t offset = 0;
+   while (connection.receivedBytes.size() - offset >= sizeOfHeader)
+   {
+      const std::uint8_t* cursor = connection.receivedBytes.data() + offset;
+      std::uint32_t       sizeOfPayload;
+      readUint32(cursor, cursor + 4, sizeOfPayload);
+
+      if (sizeOfPayload > maxSizeOfPayload)
+      {
+         return false;
+      }
+
+      if (connection.receivedBytes.size() - offset < sizeOfHeader + sizeOfPayload)
+      {
+         break;
+      }
+
+      std::uint8_t type = connection.receivedBytes[offset + 4];
+      if (!processMessage(connection, type, connection.receivedBytes.data() + offset + sizeOfHeader, sizeOfPayload))
+      {
+         return false;
+      }
+
+      offset += sizeOfHeader + sizeOfPayload;
+   }
+
+   connection.receivedBytes.erase(connection.receivedBytes.begin(), connection.receivedBytes.begin() + offset);
+   return true;
+}
+
+bool TournamentCoordinator::processMessage(Connection& connection, std::uint8_t type, const std::uint8_t* payload, std::size_t sizeOfPayload)
+{
+   const std::uint8_t* cursor = payload;
+   const std::uint8_t* end    = payload + sizeOfPayload;
+
+   if (type == static_cast<std::uint8_t>(MessageType::Hello) && !connection.isIdentified)
+   {
+      std::uint32_t magicNumber;
+      std::uint32_t version;
+      std::uint64_t fingerprint;
+      if (!readUint32(cursor, end, magicNumber) || !readUint32(cursor, end, version) || !readUint64(cursor, end, fingerprint) ||
+          magicNumber != workerMagicNumber || version != protocolVersion || fingerprint != mFingerprint)
+      {
+         sendMessage(connection.socket, MessageType::Rejected, std::vector<std::uint8_t>());
+         ++mReport.workersRejected;
+         return false;
+      }
+
+      connection.isIdentified = true;
+      ++mReport.workersConnected;
+      sendJobs(connection);
+      return true;
+   }
+
+   if (type == static_cast<std::uint8_t>(MessageType::Results) && connection.isIdentified)
+   {
+      std::uint32_t jobIndex;
+      if (!readUint32(cursor, end, jobIndex))
+      {
+         return false;
+      }
+
+      auto job = std::find_if(connection.jobsInFlight.begin(), connection.jobsInFlight.end(), [jobIndex](const Job& jobInFlight) { return jobInFlight.index == jobIndex; });
+      TournamentResults results(mTournament.getNumberOfPairings());
+      if (job == connection.jobsInFlight.end() || !readTournamentResults(cursor, end, results))
+      {
+         return false;
+      }
+
+      completeJob(*job, results);
+      bool jobWasFirst = (job == connection.jobsInFlight.begin());
+      connection.jobsInFlight.erase(job);
+      if (jobWasFirst)
+      {
+         startFirstJob(connection);
+      }
+
+      // Refill the queue of the worker right away, so that it never runs out of work
+      sendJobs(connection);
+      return true;
+   }
+
+   return false;
+}
+
+void TournamentCoordinator::sendJobs(Connection& connection)
+{
+   if (!connection.isIdentified || connection.socket < 0)
+   {
+      return;
+   }
+
+   auto pendingJob = mPendingJobs.begin();
+   while (connection.jobsInFlight.size() < mSettings.maxJobsInFlightPerWorker && pendingJob != mPendingJobs.end())
+   {
+      Job job = *pendingJob;
+
+      // A job that was queued again after its deadline can be finished by its first worker before anyone else starts it
+      if (mJobIsComplete[job.index])
+      {
+         pendingJob = mPendingJobs.erase(pendingJob);
+         continue;
+      }
+
+      // A job that was queued again after its deadline must be played by a different worker than the one that is late
+      if (std::any_of(connection.jobsInFlight.begin(), connection.jobsInFlight.end(), [&job](const Job& jobInFlight) { return jobInFlight.index == job.index; }))
+      {
+         ++pendingJob;
+         continue;
+      }
+
+      std::vector<std::uint8_t> payload;
+      appendUint32(payload, job.index);
+      appendUint32(payload, job.begin);
+      appendUint32(payload, job.end);
+
+      // If the job can't be sent, it stays pending, and the connection is dropped the next time it's polled
+      if (!sendMessage(connection.socket, MessageType::Job, payload))
+      {
+         return;
+      }
+
+      pendingJob = mPendingJobs.erase(pendingJob);
+      connection.jobsInFlight.push_back(job);
+      if (connection.jobsInFlight.size() == 1)
+      {
+         startFirstJob(connection);
+      }
+   }
+}
+
+void TournamentCoordinator::startFirstJob(Connection& connection)
+{
+   connection.timeWhenFirstJobStarted   = std::chrono::steady_clock::now();
+   connection.firstJobIsPastItsDeadline = false;
+}
+
+void TournamentCoordinator::queueJobsPastTheirDeadline()
+{
+   if (mSettings.secondsBeforeJobIsReassigned <= 0.0)
+   {
+      return;
+   }
+
+   auto now = std::chrono::steady_clock::now();
+   for (Connection& connection : mConnections)
+   {
+      if (connection.jobsInFlight.empty() || connection.firstJobIsPastItsDeadline ||
+          std::chrono::duration<double>(now - connection.timeWhenFirstJobStarted).count() < mSettings.secondsBeforeJobIsReassigned)
+      {
+         continue;
+      }
+
+      // The late worker keeps its jobs, since it might still finish them first, but they go ahead of the ones that no one has started
+      // The jobs that are queued behind the late one can't start until it's done, so they are queued again too
+      // This only happens once each time the worker starts a job, so a worker that hangs doesn't flood the queue with copies of its jobs
+      queueJobsAgain(connection);
+      connection.firstJobIsPastItsDeadline = true;
+      mReport.jobsPastTheirDeadline += connection.jobsInFlight.size();
+   }
+}
+
+void TournamentCoordinator::queueJobsAgain(const Connection& connection)
+{
+   // Give the jobs of the worker back to the queue in their original order, ahead of the jobs that no one has started
+   // Jobs that are already queued (e.g. because they were past their deadline) aren't queued twice
+   for (auto job = connection.jobsInFlight.rbegin(); job != connection.jobsInFlight.rend(); ++job)
+   {
+      std::uint32_t jobIndex = job->index;
+      if (std::none_of(mPendingJobs.begin(), mPendingJobs.end(), [jobIndex](const Job& pendingJob) { return pendingJob.index == jobIndex; }))
+      {
+         mPendingJobs.push_front(*job);
+      }
+   }
+}
+
+void TournamentCoordinator::dropConnection(Connection& connection)
+{
+   queueJobsAgain(connection);
+
+   mReport.jobsReassigned += connection.jobsInFlight.size();
+   if (connection.isIdentified)
+   {
+      ++mReport.workersLost;
+   }
+
+   connection.jobsInFlight.clear();
+   close(connection.socket);
+   connection.socket = -1;
+}
+
+void TournamentCoordinator::completeJob(const Job& job, const TournamentResults& results)
+{
+   // A job that was past its deadline can be finished by two workers, but its results are only merged once
+   if (mJobIsComplete[job.index])
+   {
+      return;
+   }
+
+   mResults.merge(results);
+   mJobIsComplete[job.index] = true;
+   ++mNumberOfCompleteJobs;
+}
+
+bool TournamentCoordinator::localWorkersAreAlive()
+{
+   mLocalWorkers.erase(std::remove_if(mLocalWorkers.begin(), mLocalWorkers.end(), [](pid_t processID) { return waitpid(processID, nullptr, WNOHANG) != 0; }),
+                       mLocalWorkers.end());
+
+   return !mLocalWorkers.empty();
+}
+
+void TournamentCoordinator::shutDown()
+{
+   for (Connection& connection : mConnections)
+   {
+      sendMessage(connection.socket, MessageType::Shutdown, std::vector<std::uint8_t>());
+      close(connection.socket);
+   }
+   mConnections.clear();
+
+   // Local workers that haven't connected yet give up once they can't connect
+   if (mListeningSocket >= 0)
+   {
+      close(mListeningSocket);
+      mListeningSocket = -1;
+   }
+
+   if (!mPathOfUnixSocket.empty())
+   {
+      unlink(mPathOfUnixSocket.c_str());
+      mPathOfUnixSocket.clear();
+   }
+
+   // A local worker that is still playing a job that was past its deadline would only read the message to shut down once it's done, if ever
+   for (pid_t processID : mLocalWorkers)
+   {
+      kill(processID, SIGTERM);
+      waitpid(processID, nullptr, 0);
+   }
+   mLocalWorkers.clear();
+}
+
+bool runTournamentWorker(const Tournament& tournament, const std::string& address)
+{
+   std::signal(SIGPIPE, SIG_IGN);
+
+   std::string pathOfUnixSocket;
+   int         coordinatorSocket = -1;
+   for (unsigned int attempt = 0; attempt < maxNumberOfConnectionAttempts && coordinatorSocket < 0; ++attempt)
+   {
+      if (attempt > 0)
+      {
+         std::this_thread::sleep_for(std::chrono::milliseconds(millisecondsBetweenConnectionAttempts));
+      }
+
+      coordinatorSocket = createSocketForAddress(address, false, pathOfUnixSocket);
+   }
+
+   if (coordinatorSocket < 0)
+   {
+      std::cout << "Error - runTournamentWorker - Failed to connect to " << address << "\n";
+      return false;
+   }
+
+   std::vector<std::uint8_t> payload;
+   appendUint32(payload, workerMagicNumber);
+   appendUint32(payload, protocolVersion);
+   appendUint64(payload, calculateFingerprintOfTournament(tournament));
+
+   bool succeeded = sendMessage(coordinatorSocket, MessageType::Hello, payload);
+   while (succeeded)
+   {
+      MessageType type;
+      if (!receiveMessage(coordinatorSocket, type, payload))
+      {
+         succeeded = false;
+         break;
+      }
+
+      if (type == MessageType::Shutdown)
+      {
+         break;
+      }
+
+      if (type == MessageType::Rejected)
+      {
+         std::cout << "Error - runTournamentWorker - The coordinator is playing a different tournament" << "\n";
+         succeeded = false;
+         break;
+      }
+
+      const std::uint8_t* cursor = payload.data();
+      const std::uint8_t* end    = payload.data() + payload.size();
+      std::uint32_t       jobIndex, begin, endOfJob;
+      if (type != MessageType::Job || !readUint32(cursor, end, jobIndex) || !readUint32(cursor, end, begin) || !readUint32(cursor, end, endOfJob))
+      {
+         succeeded = false;
+         break;
+      }
+
+      std::vector<std::uint8_t> results;
+      appendUint32(results, jobIndex);
+      appendTournamentResults(results, tournament.playMatches(begin, endOfJob));
+      succeeded = sendMessage(coordinatorSocket, MessageType::Results, results);
+   }
+
+   close(coordinatorSocket);
+   return succeeded;
+}
@@ -32,9 +32,9 @@ void FiniteStateMachine::updateCurrentState(float deltaTime) const
    mCurrentState->update(deltaTime);
 }
 
-void FiniteStateMachine::renderCurrentState() const
+void FiniteStateMachine::renderCurrentState(float interpolationFactor) const
 {
-   mCurrentState->render();
+   mCurrentState->render(interpolationFactor);
 }
 
 void FiniteStateMachine::changeState(const std::string& newStateID)
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include "match_simulation.h"
+
+// Plays the same matches with the floating-point and the fixed-point rules of MatchSimulation, and reports how long each one takes per step
+// It also prints a checksum of the fixed-point matches, which must be the same for every build of this program (e.g. with -O0, -O3 or -ffast-math)
+// Usage: teapong_fixed_point_benchmark [numberOfMatches] [maxNumberOfStepsPerMatch]
+
+// Both paddles follow the ball while it approaches them
+// Every float that a fixed-point match stores is a fixed-point number, so these comparisons are exact and the fixed-point matches don't depend on the build either
+MatchInputs decideInputs(const MatchState& state, float deadZone)
+{
+   MatchInputs inputs = {};
+
+   inputs.releaseBall = !state.ballIsInPlay;
+
+   if (state.ball.velocity.x < 0.0f)
+   {
+      inputs.leftPaddle.moveUp   = state.ball.position.y > state.leftPaddle.position.y + deadZone;
+      inputs.leftPaddle.moveDown = state.ball.position.y < state.leftPaddle.position.y - deadZone;
+   }
+   else
+   {
+      inputs.rightPaddle.moveUp   = state.ball.position.y > state.rightPaddle.position.y + deadZone;
+      inputs.rightPaddle.moveDown = state.ball.position.y < state.rightPaddle.position.y - deadZone;
+   }
+
+   return inputs;
+}
+
+struct BenchmarkResults
+{
+   double        seconds;
+   std::uint64_t numberOfSteps;
+   std::uint64_t pointsScored;
+   std::uint64_t checksum;
+};
+
+void addToChecksum(std::uint64_t& checksum, std::uint64_t value)
+{
+   // FNV-1a, one byte at a time
+   for (int i = 0; i < 8; ++i)
+   {
+      checksum ^= (value >> (i * 8)) & 0xFF;
+      checksum *= 0x100000001B3ull;
+   }
+}
+
+void addToChecksum(std::uint64_t& checksum, float value)
+{
+   addToChecksum(checksum, static_cast<std::uint64_t>(static_cast<std::uint32_t>(FixedPoint::fromFloat(value).getRaw())));
+}
+
+BenchmarkResults playMatches(const MatchConfiguration& config, unsigned int numberOfMatches, unsigned int maxNumberOfStepsPerMatch)
+{
+   float            deltaTime = 1.0f / 240.0f;
+   BenchmarkResults results   = {0.0, 0, 0, 0xCBF29CE484222325ull};
+
+   auto start = std::chrono::steady_clock::now();
+   for (unsigned int match = 0; match < numberOfMatches; ++match)
+   {
+      MatchSimulation   simulation(config, match);
+      const MatchState& state = simulation.getState();
+
+      unsigned int step = 0;
+      for (; step < maxNumberOfStepsPerMatch && !state.matchIsOver; ++step)
+      {
+         simulation.step(decideInputs(state, 0.5f), deltaTime);
+      }
+
+      results.numberOfSteps += step;
+      results.pointsScored  += state.pointsScoredByLeftPaddle + state.pointsScoredByRightPaddle;
+
+      addToChecksum(results.checksum, static_cast<std::uint64_t>(step));
+      addToChecksum(results.checksum, static_cast<std::uint64_t>(state.pointsScoredByLeftPaddle));
+      addToChecksum(results.checksum, static_cast<std::uint64_t>(state.pointsScoredByRightPaddle));
+      addToChecksum(results.checksum, state.ball.position.x);
+      addToChecksum(results.checksum, state.ball.position.y);
+      addToChecksum(results.checksum, state.ball.velocity.x);
+      addToChecksum(results.checksum, state.ball.velocity.y);
+      addToChecksum(results.checksum, state.leftPaddle.position.y);
+      addToChecksum(results.checksum, state.rightPaddle.position.y);
+   }
+   results.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   return results;
+}
+
+void printResults(const char* name, const BenchmarkResults& results)
+{
+   std::cout << std::setw(30) << std::left << name
+             << std::setw(12) << std::right << results.numberOfSteps << " steps"
+             << std::setw(10) << results.pointsScored << " points"
+             << std::setw(10) << std::fixed << std::setprecision(1) << (results.seconds * 1e9 / results.numberOfSteps) << " ns/step" << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int numberOfMatches          = (argc > 1) ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 2000;
+   unsigned int maxNumberOfStepsPerMatch = (argc > 2) ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 240 * 120;
+
+   MatchConfiguration floatConfig;
+   MatchConfiguration fixedPointConfig;
+   fixedPointConfig.arithmetic = MatchArithmetic::FixedPoint;
+
+   BenchmarkResults floatResults      = playMatches(floatConfig, numberOfMatches, maxNumberOfStepsPerMatch);
+   BenchmarkResults fixedPointResults = playMatches(fixedPointConfig, numberOfMatches, maxNumberOfStepsPerMatch);
+
+   printResults("MatchSimulation (float)", floatResults);
+   printResults("MatchSimulation (fixed point)", fixedPointResults);
+
+   std::cout << "Fixed-point checksum: " << std::hex << std::setw(16) << std::setfill('0') << fixedPointResults.checksum << "\n";
+   return 0;
+}
@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
+#include "thread_pool.h"
 #include "shader_loader.h"
 #include "texture_loader.h"
 #include "model_loader.h"
@@ -9,12 +13,13 @@
 #include "win_state.h"
 #include "game.h"
 
-Game::Game()
+Game::Game(float updatesPerSecond, unsigned int maxNumberOfUpdatesPerFrame)
    : mFSM()
    , mWindow()
    , mSoundEngine(irrklang::createIrrKlangDevice(), [=](irrklang::ISoundEngine* soundEngine){soundEngine->drop();})
    , mCamera()
    , mRenderer2D()
+   , mTextureStreamer()
    , mModelManager()
    , mTextureManager()
    , mShaderManager()
@@ -26,6 +31,11 @@ Game::Game()
    , mPoint()
    , mLeftPaddleWins()
    , mRightPaddleWins()
+   , mStateChannel()
+   , mPlayState()
+   , mFixedDeltaTime(1.0 / updatesPerSecond)
+   , mMaxNumberOfUpdatesPerFrame(maxNumberOfUpdatesPerFrame)
+   , mSimulationBudgetPerFrame(1.0 / updatesPerSecond) // As long as a single update, so that catching up never delays a frame by much more than that
 {
 
 }
@@ -104,14 +114,8 @@ bool Game::initialize(const std::string& title)
    gameObj3DExplosiveShader->setInt("numPointLightsInScene", 1);
 
    // Load the models
-   mModelManager.loadResource<ModelLoader>("title", "resources/models/title/title.obj");
-   mModelManager.loadResource<ModelLoader>("table", "resources/models/table/table.obj");
-   mModelManager.loadResource<ModelLoader>("left_paddle", "resources/models/left_paddle/paddle.obj");
-   mModelManager.loadResource<ModelLoader>("right_paddle", "resources/models/right_paddle/paddle.obj");
-   mModelManager.loadResource<ModelLoader>("teapot", "resources/models/teapot/teapot.obj");
-   mModelManager.loadResource<ModelLoader>("point", "resources/models/point/point.obj");
-   mModelManager.loadResource<ModelLoader>("left_paddle_wins", "resources/models/left_paddle_wins/left_paddle_wins.obj");
-   mModelManager.loadResource<ModelLoader>("right_paddle_wins", "resources/models/right_paddle_wins/right_paddle_wins.obj");
+   mTextureStreamer = std::make_shared<TextureStreamer>();
+   loadModels();
 
    mTitle = std::make_shared<GameObject3D>(mModelManager.getResource("title"),
                                            glm::vec3(0.0f, 0.0f, 13.75f),
@@ -186,16 +190,23 @@ bool Game::initialize(const std::string& title)
                                                  mRightPaddle,
                                                  mBall);
 
-   mStates["play"] = std::make_shared<PlayState>(mFSM,
-                                                 mWindow,
-                                                 mSoundEngine,
-                                                 mCamera,
-                                                 gameObj3DShader,
-                                                 mTable,
-                                                 mLeftPaddle,
-                                                 mRightPaddle,
-                                                 mBall,
-                                                 mPoint);
+   // The game can still be played if the channel can't be created, it just can't be followed by other processes
+   mStateChannel = std::make_shared<SharedStateChannel>();
+   mStateChannel->create("/teapong");
+
+   mPlayState = std::make_shared<PlayState>(mFSM,
+                                            mWindow,
+                                            mSoundEngine,
+                                            mCamera,
+                                            gameObj3DShader,
+                                            mTable,
+                                            mLeftPaddle,
+                                            mRightPaddle,
+                                            mBall,
+                                            mPoint,
+                                            mStateChannel);
+
+   mStates["play"] = mPlayState;
 
    mStates["pause"] = std::make_shared<PauseState>(mFSM,
                                                    mWindow,
@@ -226,9 +237,10 @@ bool Game::initialize(const std::string& title)
 
 void Game::executeGameLoop()
 {
-   double currentFrame = 0.0;
-   double lastFrame    = 0.0;
-   float  deltaTime    = 0.0f;
+   double currentFrame    = glfwGetTime();
+   double lastFrame       = currentFrame;
+   float  deltaTime       = 0.0f;
+   double accumulatedTime = 0.0;
 
    while (!mWindow->shouldClose())
    {
@@ -236,8 +248,131 @@ void Game::executeGameLoop()
       deltaTime    = static_cast<float>(currentFrame - lastFrame);
       lastFrame    = currentFrame;
 
+      mTextureStreamer->update();
+
       mFSM->processInputInCurrentState(deltaTime);
-      mFSM->updateCurrentState(deltaTime);
-      mFSM->renderCurrentState();
+
+      // Update the current state in fixed increments of time, so that the simulation behaves the same way regardless of the frame rate
+      accumulatedTime += deltaTime;
+
+      unsigned int numberOfUpdates        = 0;
+      double       timeWhenUpdatesStarted = glfwGetTime();
+      while (accumulatedTime >= mFixedDeltaTime && numberOfUpdates < mMaxNumberOfUpdatesPerFrame)
+      {
+         // The updates that are left in the frame share what's left of its budget, so that catching up after a long frame doesn't make the next one long too
+         unsigned int numberOfUpdatesLeft = std::min(static_cast<unsigned int>(accumulatedTime / mFixedDeltaTime), mMaxNumberOfUpdatesPerFrame - numberOfUpdates);
+         mPlayState->setTimeLeftInFrame(mSimulationBudgetPerFrame - (glfwGetTime() - timeWhenUpdatesStarted), numberOfUpdatesLeft);
+
+         mFSM->updateCurrentState(static_cast<float>(mFixedDeltaTime));
+         publishState();
+         accumulatedTime -= mFixedDeltaTime;
+         ++numberOfUpdates;
+      }
+
+      // If a frame took so long that we couldn't catch up (e.g. because the window was made full screen), we drop the time that we couldn't simulate
+      // Letting it accumulate would make every subsequent frame try to catch up too, which would slow the game down even more
+      if (accumulatedTime >= mFixedDeltaTime)
+      {
+         accumulatedTime = std::fmod(accumulatedTime, mFixedDeltaTime);
+      }
+
+      // Render the current state between its last two updates, based on how much time is left in the accumulator
+      mFSM->renderCurrentState(static_cast<float>(accumulatedTime / mFixedDeltaTime));
+   }
+}
+
+void Game::publishState()
+{
+   if (!mStateChannel->isOpen())
+   {
+      return;
+   }
+
+   PublishedState state                 = mPlayState->createPublishedState();
+   state.timeWhenPublishedInNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+   std::string currentStateID = mFSM->getCurrentStateID();
+   if (currentStateID == "menu")       { state.gameState = GameStateIsMenu; }
+   else if (currentStateID == "play")  { state.gameState = GameStateIsPlay; }
+   else if (currentStateID == "pause") { state.gameState = GameStateIsPause; }
+   else if (currentStateID == "win")   { state.gameState = GameStateIsWin; }
+
+   mStateChannel->publishState(state);
+}
+
+void Game::loadModels()
+{
+   // ID and file of each model
+   std::vector<std::pair<std::string, std::string>> models = {{"title",             "resources/models/title/title.obj"},
+                                                              {"table",             "resources/models/table/table.obj"},
+                                                              {"left_paddle",       "resources/models/left_paddle/paddle.obj"},
+                                                              {"right_paddle",      "resources/models/right_paddle/paddle.obj"},
+                                                              {"teapot",            "resources/models/teapot/teapot.obj"},
+                                                              {"point",             "resources/models/point/point.obj"},
+                                                              {"left_paddle_wins",  "resources/models/left_paddle_wins/left_paddle_wins.obj"},
+                                                              {"right_paddle_wins", "resources/models/right_paddle_wins/right_paddle_wins.obj"}};
+
+   auto start = std::chrono::steady_clock::now();
+
+   // Staging a model (cooking it if needed and mapping its cooked file) and decoding each of its textures are independent tasks that don't touch OpenGL,
+   // so they are spread across a pool of threads, and each model submits a task for each of its textures as soon as it knows which ones it needs
+   std::vector<StagedModel> stagedModels(models.size());
+   unsigned int             numberOfThreads;
+   {
+      ThreadPool pool;
+      for (std::size_t i = 0; i < models.size(); ++i)
+      {
+         pool.submit([&pool, &models, &stagedModels, i]()
+         {
+            StagedModel& stagedModel = stagedModels[i];
+            if (!ModelLoader{}.stageResource(models[i].second, stagedModel))
+            {
+               return;
+            }
+
+            // The list of textures doesn't change after this point, so the tasks can hold references to its elements
+            for (StagedTexture& stagedTexture : stagedModel.textures)
+            {
+               pool.submit([&stagedTexture]()
+               {
+                  TextureLoader{}.decodeTexture(stagedTexture.texFilePath, stagedTexture.decodedTexture);
+               });
+            }
+         });
+      }
+
+      pool.waitUntilIdle();
+      numberOfThreads = pool.getNumberOfThreads();
+   }
+
+   double secondsSpentStaging = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   // Only the uploads are left, and they have to be done on this thread because it owns the OpenGL context
+   // The meshes are uploaded right away, while the textures are handed to the streamer, which uploads them during the first frames
+   double secondsSpentUploading = 0.0;
+   for (std::size_t i = 0; i < models.size(); ++i)
+   {
+      const StagedModel& stagedModel = stagedModels[i];
+
+      double secondsSpentDecoding = 0.0;
+      for (const StagedTexture& stagedTexture : stagedModel.textures)
+      {
+         secondsSpentDecoding += stagedTexture.decodedTexture.secondsSpentDecoding;
+      }
+
+      std::string meshSummary = stagedModel.wasCooked ? "cooked and mapped" : "mapped";
+      double      meshSeconds = stagedModel.secondsSpentStagingMeshes;
+      std::size_t numTextures = stagedModel.textures.size();
+
+      auto uploadStart = std::chrono::steady_clock::now();
+      mModelManager.loadResource<ModelLoader>(models[i].first, std::move(stagedModels[i]), *mTextureStreamer);
+      double uploadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - uploadStart).count();
+      secondsSpentUploading += uploadSeconds;
+
+      std::cout << "Model " << models[i].first << ": meshes " << meshSummary << " in " << (meshSeconds * 1e3) << " ms, "
+                << numTextures << " textures read in " << (secondsSpentDecoding * 1e3) << " ms, meshes uploaded in " << (uploadSeconds * 1e3) << " ms" << "\n";
    }
+
+   std::cout << "Models loaded in " << ((secondsSpentStaging + secondsSpentUploading) * 1e3) << " ms: " << (secondsSpentStaging * 1e3) << " ms staging and decoding on "
+             << numberOfThreads << " threads, " << (secondsSpentUploading * 1e3) << " ms uploading" << "\n";
 }
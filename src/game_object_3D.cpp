@@ -1,4 +1,5 @@
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 #include "game_object_3D.h"
 
@@ -13,6 +14,8 @@ GameObject3D::GameObject3D(const std::shared_ptr<Model>& model,
    , mScalingFactor(scalingFactor != 0.0f ? scalingFactor : 1.0f)
    , mModelMatrix(1.0f)
    , mCalculateModelMatrix(true)
+   , mPreviousPosition(mPosition)
+   , mPreviousRotationMatrix(mRotationMatrix)
 {
    calculateModelMatrix();
 }
@@ -24,18 +27,22 @@ GameObject3D::GameObject3D(GameObject3D&& rhs) noexcept
    , mScalingFactor(std::exchange(rhs.mScalingFactor, 1.0f))
    , mModelMatrix(std::exchange(rhs.mModelMatrix, glm::mat4(1.0f)))
    , mCalculateModelMatrix(std::exchange(rhs.mCalculateModelMatrix, true))
+   , mPreviousPosition(std::exchange(rhs.mPreviousPosition, glm::vec3(0.0f)))
+   , mPreviousRotationMatrix(std::exchange(rhs.mPreviousRotationMatrix, glm::mat4(1.0f)))
 {
 
 }
 
 GameObject3D& GameObject3D::operator=(GameObject3D&& rhs) noexcept
 {
-   mModel                = std::move(rhs.mModel);
-   mPosition             = std::exchange(rhs.mPosition, glm::vec3(0.0f));
-   mRotationMatrix       = std::exchange(rhs.mRotationMatrix, glm::mat4(1.0f));
-   mScalingFactor        = std::exchange(rhs.mScalingFactor, 1.0f);
-   mModelMatrix          = std::exchange(rhs.mModelMatrix, glm::mat4(1.0f));
-   mCalculateModelMatrix = std::exchange(rhs.mCalculateModelMatrix, true);
+   mModel                  = std::move(rhs.mModel);
+   mPosition               = std::exchange(rhs.mPosition, glm::vec3(0.0f));
+   mRotationMatrix         = std::exchange(rhs.mRotationMatrix, glm::mat4(1.0f));
+   mScalingFactor          = std::exchange(rhs.mScalingFactor, 1.0f);
+   mModelMatrix            = std::exchange(rhs.mModelMatrix, glm::mat4(1.0f));
+   mCalculateModelMatrix   = std::exchange(rhs.mCalculateModelMatrix, true);
+   mPreviousPosition       = std::exchange(rhs.mPreviousPosition, glm::vec3(0.0f));
+   mPreviousRotationMatrix = std::exchange(rhs.mPreviousRotationMatrix, glm::mat4(1.0f));
    return *this;
 }
 
@@ -51,6 +58,27 @@ void GameObject3D::render(const Shader& shader) const
    mModel->render(shader);
 }
 
+void GameObject3D::render(const Shader& shader, float interpolationFactor) const
+{
+   // Blend the transform that the object had before the last update with the one it has now,
+   // so that its motion looks smooth even when the display and the simulation run at different rates
+   glm::vec3 interpolatedPosition = glm::mix(mPreviousPosition, mPosition, interpolationFactor);
+   glm::quat interpolatedRotation = glm::slerp(glm::quat_cast(mPreviousRotationMatrix), glm::quat_cast(mRotationMatrix), interpolationFactor);
+
+   // 3) Translate the model
+   glm::mat4 interpolatedModelMatrix = glm::translate(glm::mat4(1.0f), interpolatedPosition);
+
+   // 2) Rotate the model
+   interpolatedModelMatrix *= glm::mat4_cast(interpolatedRotation);
+
+   // 1) Scale the model
+   interpolatedModelMatrix = glm::scale(interpolatedModelMatrix, glm::vec3(mScalingFactor));
+
+   shader.setMat4("model", interpolatedModelMatrix);
+
+   mModel->render(shader);
+}
+
 glm::vec3 GameObject3D::getPosition() const
 {
    return mPosition;
@@ -67,6 +95,11 @@ float GameObject3D::getScalingFactor() const
    return mScalingFactor;
 }
 
+glm::mat4 GameObject3D::getRotationMatrix() const
+{
+   return mRotationMatrix;
+}
+
 void GameObject3D::setRotationMatrix(const glm::mat4& rotationMatrix)
 {
    mRotationMatrix = rotationMatrix;
@@ -97,6 +130,12 @@ void GameObject3D::scale(float scalingFactor)
    }
 }
 
+void GameObject3D::savePreviousTransform()
+{
+   mPreviousPosition       = mPosition;
+   mPreviousRotationMatrix = mRotationMatrix;
+}
+
 void GameObject3D::calculateModelMatrix() const
 {
    // 3) Translate the model
@@ -0,0 +1,697 @@
+#include <algorithm>
+
+#include "float_lanes.h"
+#include "match_batch.h"
+
+MaskLanes sweptCircleAndAABBCollidedLanes(FloatLanes  centerOfCircleX,
+                                          FloatLanes  centerOfCircleY,
+                                          FloatLanes  radius,
+                                          FloatLanes  displacementOfCircleX,
+                                          FloatLanes  displacementOfCircleY,
+                                          FloatLanes  centerOfAABBX,
+                                          FloatLanes  centerOfAABBY,
+                                          FloatLanes  displacementOfAABBY,
+                                          FloatLanes  halfWidthOfAABB,
+                                          FloatLanes  halfHeightOfAABB,
+                                          FloatLanes& timeOfImpact,
+                                          FloatLanes& vecFromCenterOfCircleToPointOfCollisionX,
+                                          FloatLanes& vecFromCenterOfCircleToPointOfCollisionY);
+
+MaskLanes circleAndAABBCollidedLanes(FloatLanes  centerOfCircleX,
+                                     FloatLanes  centerOfCircleY,
+                                     FloatLanes  radius,
+                                     FloatLanes  centerOfAABBX,
+                                     FloatLanes  centerOfAABBY,
+                                     FloatLanes  halfWidthOfAABB,
+                                     FloatLanes  halfHeightOfAABB,
+                                     FloatLanes& vecFromCenterOfCircleToPointOfCollisionX,
+                                     FloatLanes& vecFromCenterOfCircleToPointOfCollisionY);
+
+void resolveCollisionBetweenBallAndPaddleLanes(MaskLanes   collided,
+                                               FloatLanes& ballPositionX,
+                                               FloatLanes& ballPositionY,
+                                               FloatLanes& ballVelocityX,
+                                               FloatLanes& ballVelocityY,
+                                               FloatLanes  ballRadius,
+                                               FloatLanes  initialBallVelocityY,
+                                               FloatLanes  paddlePositionY,
+                                               FloatLanes  halfHeightOfPaddle,
+                                               FloatLanes  paddleVelocityY,
+                                               FloatLanes  vecFromCenterOfCircleToPointOfCollisionX,
+                                               FloatLanes  vecFromCenterOfCircleToPointOfCollisionY);
+
+FloatLanes finishMovingPaddleLanes(MaskLanes  finishing,
+                                   FloatLanes ballPositionX,
+                                   FloatLanes ballPositionY,
+                                   FloatLanes ballRadius,
+                                   FloatLanes paddlePositionX,
+                                   FloatLanes paddlePositionY,
+                                   FloatLanes remainingDisplacementOfPaddle,
+                                   FloatLanes halfWidthOfPaddle,
+                                   FloatLanes halfHeightOfPaddle);
+
+MatchBatch::MatchBatch(const MatchConfiguration& configuration, std::size_t numberOfMatches, std::uint64_t seed)
+   : mConfiguration(configuration)
+   , mNumberOfMatches(numberOfMatches)
+{
+   std::size_t paddedNumberOfMatches = ((numberOfMatches + floatLanesWidth - 1) / floatLanesWidth) * floatLanesWidth;
+
+   for (std::vector<float>* array : {&mBallPositionX, &mBallPositionY, &mBallPositionZ,
+                                     &mBallVelocityX, &mBallVelocityY, &mBallVelocityZ,
+                                     &mBallRadius, &mBallSpinAngularVelocityScaledByBounce,
+                                     &mLeftPaddlePositionY, &mRightPaddlePositionY,
+                                     &mBallIsInPlay, &mBallIsFalling, &mMatchIsOver,
+                                     &mPointsScoredByLeftPaddle, &mPointsScoredByRightPaddle})
+   {
+      array->resize(paddedNumberOfMatches, 0.0f);
+   }
+
+   mRandomNumberGeneratorStates.resize(paddedNumberOfMatches);
+
+   for (std::size_t i = 0; i < paddedNumberOfMatches; ++i)
+   {
+      // Give each match its own stream of serves
+      mRandomNumberGeneratorStates[i] = seed + (i * 0xD1B54A32D192ED03ull);
+      startNewMatch(i);
+   }
+
+   // The padding is over from the start, so that it never keeps the last group of lanes from being skipped
+   for (std::size_t i = numberOfMatches; i < paddedNumberOfMatches; ++i)
+   {
+      mMatchIsOver[i] = 1.0f;
+   }
+}
+
+void MatchBatch::step(const std::uint8_t* packedInputs, float deltaTime, std::uint8_t* packedEvents)
+{
+   FloatLanes one = broadcastLanes(1.0f);
+
+   for (std::size_t first = 0; first < mBallPositionX.size(); first += floatLanesWidth)
+   {
+      // Matches that are over are frozen, so groups of lanes in which every match is over are skipped
+      // The padding counts as over (see the constructor)
+      if (anyLanes(!(loadLanes(&mMatchIsOver[first]) == one)))
+      {
+         // The inputs are loaded a whole group at a time, so the last group reads them from a copy in which the padding has no inputs
+         const std::uint8_t* inputsOfLanes = &packedInputs[first];
+         std::uint8_t        inputsOfLastLanes[floatLanesWidth] = {};
+         if (first + floatLanesWidth > mNumberOfMatches)
+         {
+            std::copy(packedInputs + first, packedInputs + mNumberOfMatches, inputsOfLastLanes);
+            inputsOfLanes = inputsOfLastLanes;
+         }
+
+         stepLanes(first, inputsOfLanes, deltaTime, packedEvents);
+      }
+      else if (packedEvents != nullptr)
+      {
+         for (std::size_t index = first; index < first + floatLanesWidth && index < mNumberOfMatches; ++index)
+         {
+            packedEvents[index] = MatchIsOver;
+         }
+      }
+   }
+}
+
+void MatchBatch::startNewMatch(std::size_t index)
+{
+   resetScene(index);
+   mMatchIsOver[index]               = 0.0f;
+   mPointsScoredByLeftPaddle[index]  = 0.0f;
+   mPointsScoredByRightPaddle[index] = 0.0f;
+}
+
+MatchState MatchBatch::getState(std::size_t index) const
+{
+   MatchState state;
+
+   state.ball                                   = mConfiguration.initialBall;
+   state.ball.position                          = glm::vec3(mBallPositionX[index], mBallPositionY[index], mBallPositionZ[index]);
+   state.ball.velocity                          = glm::vec3(mBallVelocityX[index], mBallVelocityY[index], mBallVelocityZ[index]);
+   state.ball.radius                            = mBallRadius[index];
+   state.ball.spinAngularVelocityScaledByBounce = mBallSpinAngularVelocityScaledByBounce[index];
+
+   state.leftPaddle                             = mConfiguration.initialLeftPaddle;
+   state.leftPaddle.position.y                  = mLeftPaddlePositionY[index];
+   state.rightPaddle                            = mConfiguration.initialRightPaddle;
+   state.rightPaddle.position.y                 = mRightPaddlePositionY[index];
+
+   state.ballIsInPlay                           = mBallIsInPlay[index] != 0.0f;
+   state.ballIsFalling                          = mBallIsFalling[index] != 0.0f;
+   state.matchIsOver                            = mMatchIsOver[index] != 0.0f;
+   state.pointsScoredByLeftPaddle               = static_cast<unsigned int>(mPointsScoredByLeftPaddle[index]);
+   state.pointsScoredByRightPaddle              = static_cast<unsigned int>(mPointsScoredByRightPaddle[index]);
+   state.randomNumberGeneratorState             = mRandomNumberGeneratorStates[index];
+
+   return state;
+}
+
+void MatchBatch::setState(std::size_t index, const MatchState& state)
+{
+   mBallPositionX[index]                         = state.ball.position.x;
+   mBallPositionY[index]                         = state.ball.position.y;
+   mBallPositionZ[index]                         = state.ball.position.z;
+   mBallVelocityX[index]                         = state.ball.velocity.x;
+   mBallVelocityY[index]                         = state.ball.velocity.y;
+   mBallVelocityZ[index]                         = state.ball.velocity.z;
+   mBallRadius[index]                            = state.ball.radius;
+   mBallSpinAngularVelocityScaledByBounce[index] = state.ball.spinAngularVelocityScaledByBounce;
+
+   mLeftPaddlePositionY[index]                   = state.leftPaddle.position.y;
+   mRightPaddlePositionY[index]                  = state.rightPaddle.position.y;
+
+   mBallIsInPlay[index]                          = state.ballIsInPlay ? 1.0f : 0.0f;
+   mBallIsFalling[index]                         = state.ballIsFalling ? 1.0f : 0.0f;
+   mMatchIsOver[index]                           = state.matchIsOver ? 1.0f : 0.0f;
+   mPointsScoredByLeftPaddle[index]              = static_cast<float>(state.pointsScoredByLeftPaddle);
+   mPointsScoredByRightPaddle[index]             = static_cast<float>(state.pointsScoredByRightPaddle);
+   mRandomNumberGeneratorStates[index]           = state.randomNumberGeneratorState;
+}
+
+std::size_t MatchBatch::getNumberOfMatches() const
+{
+   return mNumberOfMatches;
+}
+
+const MatchConfiguration& MatchBatch::getConfiguration() const
+{
+   return mConfiguration;
+}
+
+void MatchBatch::stepLanes(std::size_t first, const std::uint8_t* inputsOfLanes, float deltaTime, std::uint8_t* packedEvents)
+{
+   // This function applies the same rules as MatchRules<FloatNumericPolicy>::step, but to floatLanesWidth matches at once
+   // Instead of branching on the state of each match, we compute the outcome of every rule for every match and then use masks to keep the outcomes that apply
+
+   const MatchConfiguration& config = mConfiguration;
+
+   FloatLanes zero = broadcastLanes(0.0f);
+   FloatLanes one  = broadcastLanes(1.0f);
+
+   // Unpack the inputs straight into masks, since writing them out one lane at a time and loading them back as a vector stalls on store forwarding
+   MaskLanes releaseBall          = testBitOfLanes(inputsOfLanes, BallIsReleased);
+   MaskLanes leftPaddleMovesUp    = testBitOfLanes(inputsOfLanes, LeftPaddleMovesUp);
+   MaskLanes leftPaddleMovesDown  = testBitOfLanes(inputsOfLanes, LeftPaddleMovesDown);
+   MaskLanes rightPaddleMovesUp   = testBitOfLanes(inputsOfLanes, RightPaddleMovesUp);
+   MaskLanes rightPaddleMovesDown = testBitOfLanes(inputsOfLanes, RightPaddleMovesDown);
+
+   MaskLanes ballIsInPlay  = loadLanes(&mBallIsInPlay[first]) == one;
+   MaskLanes ballIsFalling = loadLanes(&mBallIsFalling[first]) == one;
+   MaskLanes matchIsOver   = loadLanes(&mMatchIsOver[first]) == one;
+
+   // Release the ball
+   // Serves are rare and require 64-bit integer math, so the lanes that serve are handled one at a time
+   MaskLanes    serve     = releaseBall & !ballIsInPlay & !matchIsOver;
+   unsigned int serveBits = maskBits(serve);
+   for (unsigned int lane = 0; serveBits >> lane != 0; ++lane)
+   {
+      if (serveBits & (1u << lane))
+      {
+         std::size_t index    = first + lane;
+         BallState   ball     = config.initialBall;
+         ball.velocity        = glm::vec3(mBallVelocityX[index], mBallVelocityY[index], mBallVelocityZ[index]);
+         glm::vec3   velocity = calculateServeVelocity(ball, drawServeDirection(mRandomNumberGeneratorStates[index]));
+
+         mBallVelocityX[index] = velocity.x;
+         mBallVelocityY[index] = velocity.y;
+         mBallVelocityZ[index] = velocity.z;
+      }
+   }
+   ballIsInPlay = ballIsInPlay | serve;
+
+   // Move the paddles
+   FloatLanes halfLineLength             = broadcastLanes(config.lengthOfLineTraversedByPaddles / 2.0f);
+   FloatLanes halfHeightOfLeftPaddle     = broadcastLanes(config.initialLeftPaddle.height / 2.0f);
+   FloatLanes halfHeightOfRightPaddle    = broadcastLanes(config.initialRightPaddle.height / 2.0f);
+   FloatLanes leftPaddleStep             = broadcastLanes(config.initialLeftPaddle.velocity.y * deltaTime);
+   FloatLanes rightPaddleStep            = broadcastLanes(config.initialRightPaddle.velocity.y * deltaTime);
+
+   FloatLanes leftPaddlePositionY        = loadLanes(&mLeftPaddlePositionY[first]);
+   FloatLanes rightPaddlePositionY       = loadLanes(&mRightPaddlePositionY[first]);
+   FloatLanes leftPaddlePositionYAtStart = leftPaddlePositionY;
+   FloatLanes rightPaddlePositionYAtStart = rightPaddlePositionY;
+
+   // Matches that are over are frozen
+   MaskLanes  canMove   = !matchIsOver;
+   MaskLanes  move;
+   move                 = canMove & leftPaddleMovesUp & (leftPaddlePositionY + halfHeightOfLeftPaddle < halfLineLength);
+   leftPaddlePositionY  = selectLanes(move, leftPaddlePositionY + leftPaddleStep, leftPaddlePositionY);
+   move                 = canMove & leftPaddleMovesDown & (leftPaddlePositionY - halfHeightOfLeftPaddle > -halfLineLength);
+   leftPaddlePositionY  = selectLanes(move, leftPaddlePositionY - leftPaddleStep, leftPaddlePositionY);
+   move                 = canMove & rightPaddleMovesUp & (rightPaddlePositionY + halfHeightOfRightPaddle < halfLineLength);
+   rightPaddlePositionY = selectLanes(move, rightPaddlePositionY + rightPaddleStep, rightPaddlePositionY);
+   move                 = canMove & rightPaddleMovesDown & (rightPaddlePositionY - halfHeightOfRightPaddle > -halfLineLength);
+   rightPaddlePositionY = selectLanes(move, rightPaddlePositionY - rightPaddleStep, rightPaddlePositionY);
+
+   storeLanes(&mLeftPaddlePositionY[first], leftPaddlePositionY);
+   storeLanes(&mRightPaddlePositionY[first], rightPaddlePositionY);
+
+   MaskLanes    active          = ballIsInPlay & !matchIsOver;
+   unsigned int wallBits        = 0;
+   unsigned int leftPaddleBits  = 0;
+   unsigned int rightPaddleBits = 0;
+   unsigned int pointBits       = 0;
+   unsigned int resetBits       = 0;
+
+   if (anyLanes(active))
+   {
+      FloatLanes ballPositionX             = loadLanes(&mBallPositionX[first]);
+      FloatLanes ballPositionY             = loadLanes(&mBallPositionY[first]);
+      FloatLanes ballPositionZ             = loadLanes(&mBallPositionZ[first]);
+      FloatLanes ballVelocityX             = loadLanes(&mBallVelocityX[first]);
+      FloatLanes ballVelocityY             = loadLanes(&mBallVelocityY[first]);
+      FloatLanes ballVelocityZ             = loadLanes(&mBallVelocityZ[first]);
+      FloatLanes ballRadius                = loadLanes(&mBallRadius[first]);
+      FloatLanes ballSpin                  = loadLanes(&mBallSpinAngularVelocityScaledByBounce[first]);
+      FloatLanes pointsScoredByLeftPaddle  = loadLanes(&mPointsScoredByLeftPaddle[first]);
+      FloatLanes pointsScoredByRightPaddle = loadLanes(&mPointsScoredByRightPaddle[first]);
+
+      // Score a point when the ball leaves the table, and make it fall
+      FloatLanes halfHorizontalRange = broadcastLanes(config.horizontalRange / 2.0f);
+      MaskLanes  outside             = active & !ballIsFalling & ((ballPositionX + ballRadius < -halfHorizontalRange) | (ballPositionX - ballRadius > halfHorizontalRange));
+      MaskLanes  onRightSide         = ballPositionX > zero;
+      FloatLanes freeFallScale       = broadcastLanes(config.scaleOfHorizontalVelocityInFreeFall);
+
+      pointsScoredByLeftPaddle  = selectLanes(outside & onRightSide, pointsScoredByLeftPaddle + one, pointsScoredByLeftPaddle);
+      pointsScoredByRightPaddle = selectLanes(outside & !onRightSide, pointsScoredByRightPaddle + one, pointsScoredByRightPaddle);
+      ballVelocityX             = selectLanes(outside, ballVelocityX * freeFallScale, ballVelocityX);
+      ballVelocityY             = selectLanes(outside, ballVelocityY * freeFallScale, ballVelocityY);
+      ballVelocityZ             = selectLanes(outside, broadcastLanes(config.verticalVelocityInFreeFall), ballVelocityZ);
+      ballIsFalling             = ballIsFalling | outside;
+      pointBits                 = maskBits(outside);
+
+      // Move the falling balls, and end the rally or the match when they are low enough
+      FloatLanes deltaTimeLanes = broadcastLanes(deltaTime);
+      MaskLanes  falling        = active & ballIsFalling;
+
+      ballPositionX = selectLanes(falling, ballPositionX + ballVelocityX * deltaTimeLanes, ballPositionX);
+      ballPositionY = selectLanes(falling, ballPositionY + ballVelocityY * deltaTimeLanes, ballPositionY);
+      ballPositionZ = selectLanes(falling, ballPositionZ + ballVelocityZ * deltaTimeLanes, ballPositionZ);
+
+      FloatLanes pointsNeededToWin = broadcastLanes(static_cast<float>(config.pointsNeededToWin));
+      MaskLanes  landed            = falling & (ballPositionZ < broadcastLanes(config.heightBelowWhichSceneIsReset));
+      MaskLanes  won               = landed & ((pointsScoredByLeftPaddle == pointsNeededToWin) | (pointsScoredByRightPaddle == pointsNeededToWin));
+      matchIsOver                  = matchIsOver | won;
+      resetBits                    = maskBits(landed & !won);
+
+      // Sweep the balls that are on the table against the walls and the paddles (see MatchRules::moveBallAcrossTable)
+      MaskLanes rallying = active & !ballIsFalling;
+      if (anyLanes(rallying))
+      {
+         FloatLanes topBoundary                   = broadcastLanes(config.verticalRange / 2.0f);
+         FloatLanes bottomBoundary                = broadcastLanes(-config.verticalRange / 2.0f);
+         FloatLanes leftPaddlePositionX           = broadcastLanes(config.initialLeftPaddle.position.x);
+         FloatLanes rightPaddlePositionX          = broadcastLanes(config.initialRightPaddle.position.x);
+         FloatLanes halfWidthOfLeftPaddle         = broadcastLanes(config.initialLeftPaddle.width / 2.0f);
+         FloatLanes halfWidthOfRightPaddle        = broadcastLanes(config.initialRightPaddle.width / 2.0f);
+         FloatLanes initialBallVelocityY          = broadcastLanes(config.initialBall.initialVelocity.y);
+         FloatLanes spinAngularVelocity           = broadcastLanes(config.initialBall.spinAngularVelocity);
+
+         FloatLanes displacementOfLeftPaddle      = leftPaddlePositionY - leftPaddlePositionYAtStart;
+         FloatLanes displacementOfRightPaddle     = rightPaddlePositionY - rightPaddlePositionYAtStart;
+         FloatLanes velocityOfLeftPaddle          = selectLanes(displacementOfLeftPaddle == zero, zero, displacementOfLeftPaddle / deltaTimeLanes);
+         FloatLanes velocityOfRightPaddle         = selectLanes(displacementOfRightPaddle == zero, zero, displacementOfRightPaddle / deltaTimeLanes);
+         FloatLanes sweptLeftPaddlePositionY      = leftPaddlePositionYAtStart;
+         FloatLanes sweptRightPaddlePositionY     = rightPaddlePositionYAtStart;
+
+         FloatLanes fractionOfStepLeft            = one;
+         MaskLanes  sweeping                      = rallying;
+         MaskLanes  pushedByLeftPaddle            = zero > zero; // No ball is pushed at the start of the step
+         MaskLanes  pushedByRightPaddle           = zero > zero;
+
+         for (unsigned int i = 0; i < config.maxNumberOfContactsPerStep && anyLanes(sweeping); ++i)
+         {
+            FloatLanes displacementOfBallX                = ballVelocityX * (deltaTimeLanes * fractionOfStepLeft);
+            FloatLanes displacementOfBallY                = ballVelocityY * (deltaTimeLanes * fractionOfStepLeft);
+            FloatLanes remainingDisplacementOfLeftPaddle  = displacementOfLeftPaddle * fractionOfStepLeft;
+            FloatLanes remainingDisplacementOfRightPaddle = displacementOfRightPaddle * fractionOfStepLeft;
+
+            // The balls that are pushed by a paddle move vertically with it
+            displacementOfBallY = selectLanes(pushedByLeftPaddle, remainingDisplacementOfLeftPaddle, displacementOfBallY);
+            displacementOfBallY = selectLanes(pushedByRightPaddle, remainingDisplacementOfRightPaddle, displacementOfBallY);
+
+            FloatLanes timeOfContact = one;
+
+            // Walls
+            FloatLanes timeOfImpactWithTopWall    = (topBoundary - (ballPositionY + ballRadius)) / displacementOfBallY;
+            MaskLanes  hitTopWall                 = (displacementOfBallY > zero) & (timeOfImpactWithTopWall <= timeOfContact);
+            timeOfContact                         = selectLanes(hitTopWall, maxLanes(timeOfImpactWithTopWall, zero), timeOfContact);
+
+            FloatLanes timeOfImpactWithBottomWall = (bottomBoundary - (ballPositionY - ballRadius)) / displacementOfBallY;
+            MaskLanes  hitBottomWall              = (displacementOfBallY < zero) & (timeOfImpactWithBottomWall <= timeOfContact);
+            timeOfContact                         = selectLanes(hitBottomWall, maxLanes(timeOfImpactWithBottomWall, zero), timeOfContact);
+
+            // Paddles
+            FloatLanes timeOfImpactWithLeftPaddle, vecToLeftPaddleX, vecToLeftPaddleY;
+            MaskLanes  hitLeftPaddle = sweptCircleAndAABBCollidedLanes(ballPositionX, ballPositionY, ballRadius,
+                                                                       displacementOfBallX, displacementOfBallY,
+                                                                       leftPaddlePositionX, sweptLeftPaddlePositionY, remainingDisplacementOfLeftPaddle,
+                                                                       halfWidthOfLeftPaddle, halfHeightOfLeftPaddle,
+                                                                       timeOfImpactWithLeftPaddle, vecToLeftPaddleX, vecToLeftPaddleY);
+            hitLeftPaddle            = hitLeftPaddle & (timeOfImpactWithLeftPaddle < timeOfContact);
+            timeOfContact            = selectLanes(hitLeftPaddle, timeOfImpactWithLeftPaddle, timeOfContact);
+
+            FloatLanes timeOfImpactWithRightPaddle, vecToRightPaddleX, vecToRightPaddleY;
+            MaskLanes  hitRightPaddle = sweptCircleAndAABBCollidedLanes(ballPositionX, ballPositionY, ballRadius,
+                                                                        displacementOfBallX, displacementOfBallY,
+                                                                        rightPaddlePositionX, sweptRightPaddlePositionY, remainingDisplacementOfRightPaddle,
+                                                                        halfWidthOfRightPaddle, halfHeightOfRightPaddle,
+                                                                        timeOfImpactWithRightPaddle, vecToRightPaddleX, vecToRightPaddleY);
+            hitRightPaddle            = hitRightPaddle & (timeOfImpactWithRightPaddle < timeOfContact);
+            timeOfContact             = selectLanes(hitRightPaddle, timeOfImpactWithRightPaddle, timeOfContact);
+
+            // Only the earliest contact counts
+            hitLeftPaddle  = hitLeftPaddle & !hitRightPaddle;
+            hitTopWall     = hitTopWall & !hitLeftPaddle & !hitRightPaddle;
+            hitBottomWall  = hitBottomWall & !hitLeftPaddle & !hitRightPaddle;
+
+            hitTopWall     = hitTopWall & sweeping;
+            hitBottomWall  = hitBottomWall & sweeping;
+            hitLeftPaddle  = hitLeftPaddle & sweeping;
+            hitRightPaddle = hitRightPaddle & sweeping;
+
+            // Advance everything to the moment of contact, or to the end of the step if there isn't one
+            timeOfContact             = selectLanes(sweeping, timeOfContact, zero);
+            ballPositionX             = ballPositionX + displacementOfBallX * timeOfContact;
+            ballPositionY             = ballPositionY + displacementOfBallY * timeOfContact;
+            sweptLeftPaddlePositionY  = sweptLeftPaddlePositionY + remainingDisplacementOfLeftPaddle * timeOfContact;
+            sweptRightPaddlePositionY = sweptRightPaddlePositionY + remainingDisplacementOfRightPaddle * timeOfContact;
+            fractionOfStepLeft        = selectLanes(sweeping, fractionOfStepLeft * (one - timeOfContact), fractionOfStepLeft);
+
+            // Bounce off of the walls, unless a paddle pushes the ball into them, in which case the ball and the paddle stay where they are for the rest of the step
+            MaskLanes  hitWall       = hitTopWall | hitBottomWall;
+            MaskLanes  pinned        = hitWall & (pushedByLeftPaddle | pushedByRightPaddle);
+            MaskLanes  bounce        = hitWall & !pinned;
+            FloatLanes speed         = sqrtLanes(ballVelocityX * ballVelocityX + ballVelocityY * ballVelocityY);
+            ballPositionY            = selectLanes(hitTopWall, topBoundary - ballRadius, ballPositionY);
+            ballPositionY            = selectLanes(hitBottomWall, bottomBoundary + ballRadius, ballPositionY);
+            ballSpin                 = selectLanes(bounce, spinAngularVelocity * (one - absLanes(ballVelocityY) / speed), ballSpin);
+            ballVelocityY            = selectLanes(bounce, -ballVelocityY, ballVelocityY);
+            displacementOfLeftPaddle  = selectLanes(pinned & pushedByLeftPaddle, zero, displacementOfLeftPaddle);
+            displacementOfRightPaddle = selectLanes(pinned & pushedByRightPaddle, zero, displacementOfRightPaddle);
+
+            // Bounce off of the paddles where the balls touch them, without pushing the balls out of them
+            FloatLanes positionXAfterPushOut = ballPositionX;
+            FloatLanes positionYAfterPushOut = ballPositionY;
+            resolveCollisionBetweenBallAndPaddleLanes(hitLeftPaddle,
+                                                      positionXAfterPushOut, positionYAfterPushOut,
+                                                      ballVelocityX, ballVelocityY,
+                                                      ballRadius, initialBallVelocityY,
+                                                      sweptLeftPaddlePositionY, halfHeightOfLeftPaddle, velocityOfLeftPaddle,
+                                                      vecToLeftPaddleX, vecToLeftPaddleY);
+            resolveCollisionBetweenBallAndPaddleLanes(hitRightPaddle,
+                                                      positionXAfterPushOut, positionYAfterPushOut,
+                                                      ballVelocityX, ballVelocityY,
+                                                      ballRadius, initialBallVelocityY,
+                                                      sweptRightPaddlePositionY, halfHeightOfRightPaddle, velocityOfRightPaddle,
+                                                      vecToRightPaddleX, vecToRightPaddleY);
+
+            // A paddle that still moves into the ball after the bounce pushes it (see MatchRules::ballIsMovingIntoPaddle)
+            MaskLanes  movingIntoLeftPaddle  = (ballVelocityX * vecToLeftPaddleX + (ballVelocityY - velocityOfLeftPaddle) * vecToLeftPaddleY) > zero;
+            MaskLanes  movingIntoRightPaddle = (ballVelocityX * vecToRightPaddleX + (ballVelocityY - velocityOfRightPaddle) * vecToRightPaddleY) > zero;
+            MaskLanes  keepsBeingPushed      = !(hitWall | hitLeftPaddle | hitRightPaddle);
+            pushedByLeftPaddle               = (hitLeftPaddle & movingIntoLeftPaddle) | (pushedByLeftPaddle & keepsBeingPushed);
+            pushedByRightPaddle              = (hitRightPaddle & movingIntoRightPaddle) | (pushedByRightPaddle & keepsBeingPushed);
+
+            wallBits        |= maskBits(bounce);
+            leftPaddleBits  |= maskBits(hitLeftPaddle);
+            rightPaddleBits |= maskBits(hitRightPaddle);
+
+            sweeping = sweeping & !pinned & (hitWall | hitLeftPaddle | hitRightPaddle) & (fractionOfStepLeft > zero);
+         }
+
+         // The balls that stopped before the end of the step let each paddle finish its motion, unless that would move it into them (see MatchRules::finishMovingPaddle)
+         MaskLanes finishing  = rallying & (fractionOfStepLeft > zero);
+         sweptLeftPaddlePositionY  = finishMovingPaddleLanes(finishing, ballPositionX, ballPositionY, ballRadius,
+                                                             leftPaddlePositionX, sweptLeftPaddlePositionY, displacementOfLeftPaddle * fractionOfStepLeft,
+                                                             halfWidthOfLeftPaddle, halfHeightOfLeftPaddle);
+         sweptRightPaddlePositionY = finishMovingPaddleLanes(finishing, ballPositionX, ballPositionY, ballRadius,
+                                                             rightPaddlePositionX, sweptRightPaddlePositionY, displacementOfRightPaddle * fractionOfStepLeft,
+                                                             halfWidthOfRightPaddle, halfHeightOfRightPaddle);
+         leftPaddlePositionY  = selectLanes(rallying, sweptLeftPaddlePositionY, leftPaddlePositionY);
+         rightPaddlePositionY = selectLanes(rallying, sweptRightPaddlePositionY, rightPaddlePositionY);
+         storeLanes(&mLeftPaddlePositionY[first], leftPaddlePositionY);
+         storeLanes(&mRightPaddlePositionY[first], rightPaddlePositionY);
+      }
+
+      storeLanes(&mBallPositionX[first], ballPositionX);
+      storeLanes(&mBallPositionY[first], ballPositionY);
+      storeLanes(&mBallPositionZ[first], ballPositionZ);
+      storeLanes(&mBallVelocityX[first], ballVelocityX);
+      storeLanes(&mBallVelocityY[first], ballVelocityY);
+      storeLanes(&mBallVelocityZ[first], ballVelocityZ);
+      storeLanes(&mBallSpinAngularVelocityScaledByBounce[first], ballSpin);
+      storeLanes(&mPointsScoredByLeftPaddle[first], pointsScoredByLeftPaddle);
+      storeLanes(&mPointsScoredByRightPaddle[first], pointsScoredByRightPaddle);
+   }
+
+   storeLanes(&mBallIsInPlay[first], selectLanes(ballIsInPlay, one, zero));
+   storeLanes(&mBallIsFalling[first], selectLanes(ballIsFalling, one, zero));
+   storeLanes(&mMatchIsOver[first], selectLanes(matchIsOver, one, zero));
+
+   // Rallies that ended are reset one match at a time, just like serves
+   for (unsigned int lane = 0; resetBits >> lane != 0; ++lane)
+   {
+      if (resetBits & (1u << lane))
+      {
+         resetScene(first + lane);
+      }
+   }
+
+   if (packedEvents != nullptr)
+   {
+      unsigned int overBits = maskBits(matchIsOver);
+      for (unsigned int lane = 0; lane < floatLanesWidth && first + lane < mNumberOfMatches; ++lane)
+      {
+         packedEvents[first + lane] = static_cast<std::uint8_t>((((serveBits       >> lane) & 1u) * BallWasReleased)
+                                                              | (((wallBits        >> lane) & 1u) * BallBouncedOffWall)
+                                                              | (((leftPaddleBits  >> lane) & 1u) * BallHitLeftPaddle)
+                                                              | (((rightPaddleBits >> lane) & 1u) * BallHitRightPaddle)
+                                                              | (((pointBits       >> lane) & 1u) * PointWasScored)
+                                                              | (((resetBits       >> lane) & 1u) * SceneWasReset)
+                                                              | (((overBits        >> lane) & 1u) * MatchIsOver));
+      }
+   }
+}
+
+void MatchBatch::resetScene(std::size_t index)
+{
+   const BallState& ball = mConfiguration.initialBall;
+
+   mBallPositionX[index]                         = ball.position.x;
+   mBallPositionY[index]                         = ball.position.y;
+   mBallPositionZ[index]                         = ball.position.z;
+   mBallVelocityX[index]                         = ball.velocity.x;
+   mBallVelocityY[index]                         = ball.velocity.y;
+   mBallVelocityZ[index]                         = ball.velocity.z;
+   mBallRadius[index]                            = ball.radius;
+   mBallSpinAngularVelocityScaledByBounce[index] = ball.spinAngularVelocityScaledByBounce;
+
+   mLeftPaddlePositionY[index]                   = mConfiguration.initialLeftPaddle.position.y;
+   mRightPaddlePositionY[index]                  = mConfiguration.initialRightPaddle.position.y;
+
+   mBallIsInPlay[index]                          = 0.0f;
+   mBallIsFalling[index]                         = 0.0f;
+}
+
+MaskLanes sweptCircleAndAABBCollidedLanes(FloatLanes  centerOfCircleX,
+                                          FloatLanes  centerOfCircleY,
+                                          FloatLanes  radius,
+                                          FloatLanes  displacementOfCircleX,
+                                          FloatLanes  displacementOfCircleY,
+                                          FloatLanes  centerOfAABBX,
+                                          FloatLanes  centerOfAABBY,
+                                          FloatLanes  displacementOfAABBY,
+                                          FloatLanes  halfWidthOfAABB,
+                                          FloatLanes  halfHeightOfAABB,
+                                          FloatLanes& timeOfImpact,
+                                          FloatLanes& vecFromCenterOfCircleToPointOfCollisionX,
+                                          FloatLanes& vecFromCenterOfCircleToPointOfCollisionY)
+{
+   // This is a branch-free version of sweptCircleAndAABBCollided (see collision.cpp), where the AABBs only move vertically
+
+   FloatLanes zero     = broadcastLanes(0.0f);
+   FloatLanes one      = broadcastLanes(1.0f);
+   FloatLanes infinity = broadcastLanes(1e30f);
+
+   FloatLanes startX = centerOfCircleX - centerOfAABBX;
+   FloatLanes startY = centerOfCircleY - centerOfAABBY;
+   FloatLanes relativeDisplacementX = displacementOfCircleX;
+   FloatLanes relativeDisplacementY = displacementOfCircleY - displacementOfAABBY;
+
+   // Touching or overlapping at the start of the motion
+   FloatLanes vecToClosestPointX = clampLanes(startX, -halfWidthOfAABB, halfWidthOfAABB) - startX;
+   FloatLanes vecToClosestPointY = clampLanes(startY, -halfHeightOfAABB, halfHeightOfAABB) - startY;
+   MaskLanes  overlapping        = (vecToClosestPointX * vecToClosestPointX + vecToClosestPointY * vecToClosestPointY) <= (radius * radius);
+   MaskLanes  approaching        = (vecToClosestPointX * relativeDisplacementX + vecToClosestPointY * relativeDisplacementY) > zero;
+   MaskLanes  hitAtStart         = overlapping & approaching;
+
+   // Slabs of the expanded AABB
+   FloatLanes expandedHalfWidth  = halfWidthOfAABB + radius;
+   FloatLanes expandedHalfHeight = halfHeightOfAABB + radius;
+
+   MaskLanes  parallelToX        = relativeDisplacementX == zero;
+   MaskLanes  outsideOfSlabX     = absLanes(startX) > expandedHalfWidth;
+   FloatLanes timeOfSlabX1       = (-expandedHalfWidth - startX) / relativeDisplacementX;
+   FloatLanes timeOfSlabX2       = ( expandedHalfWidth - startX) / relativeDisplacementX;
+   FloatLanes timeOfEntryX       = selectLanes(parallelToX, -infinity, minLanes(timeOfSlabX1, timeOfSlabX2));
+   FloatLanes timeOfExitX        = selectLanes(parallelToX,  infinity, maxLanes(timeOfSlabX1, timeOfSlabX2));
+
+   MaskLanes  parallelToY        = relativeDisplacementY == zero;
+   MaskLanes  outsideOfSlabY     = absLanes(startY) > expandedHalfHeight;
+   FloatLanes timeOfSlabY1       = (-expandedHalfHeight - startY) / relativeDisplacementY;
+   FloatLanes timeOfSlabY2       = ( expandedHalfHeight - startY) / relativeDisplacementY;
+   FloatLanes timeOfEntryY       = selectLanes(parallelToY, -infinity, minLanes(timeOfSlabY1, timeOfSlabY2));
+   FloatLanes timeOfExitY        = selectLanes(parallelToY,  infinity, maxLanes(timeOfSlabY1, timeOfSlabY2));
+
+   FloatLanes timeOfEntry        = maxLanes(zero, maxLanes(timeOfEntryX, timeOfEntryY));
+   FloatLanes timeOfExit         = minLanes(one, minLanes(timeOfExitX, timeOfExitY));
+   MaskLanes  hitSlabs           = (!(parallelToX & outsideOfSlabX)) & (!(parallelToY & outsideOfSlabY)) & (timeOfEntry <= timeOfExit);
+
+   // Rounded corners
+   FloatLanes pointOfEntryX      = startX + relativeDisplacementX * timeOfEntry;
+   FloatLanes pointOfEntryY      = startY + relativeDisplacementY * timeOfEntry;
+   MaskLanes  inCorner           = (absLanes(pointOfEntryX) > halfWidthOfAABB) & (absLanes(pointOfEntryY) > halfHeightOfAABB);
+   FloatLanes cornerX            = selectLanes(pointOfEntryX > zero, halfWidthOfAABB, -halfWidthOfAABB);
+   FloatLanes cornerY            = selectLanes(pointOfEntryY > zero, halfHeightOfAABB, -halfHeightOfAABB);
+   FloatLanes vecFromCornerX     = startX - cornerX;
+   FloatLanes vecFromCornerY     = startY - cornerY;
+   FloatLanes lengthOfMotion     = sqrtLanes(relativeDisplacementX * relativeDisplacementX + relativeDisplacementY * relativeDisplacementY);
+   FloatLanes directionX         = relativeDisplacementX / lengthOfMotion;
+   FloatLanes directionY         = relativeDisplacementY / lengthOfMotion;
+   FloatLanes b                  = vecFromCornerX * directionX + vecFromCornerY * directionY;
+   FloatLanes c                  = (vecFromCornerX * vecFromCornerX + vecFromCornerY * vecFromCornerY) - radius * radius;
+   FloatLanes discriminant       = b * b - c;
+   FloatLanes timeOfEntryCorner  = (-b - sqrtLanes(maxLanes(discriminant, zero))) / lengthOfMotion;
+   MaskLanes  hitCorner          = (lengthOfMotion > zero) & (discriminant >= zero) & (timeOfEntryCorner >= zero) & (timeOfEntryCorner <= one);
+   MaskLanes  hitFace            = (!inCorner) & (timeOfExit > zero);
+
+   MaskLanes  hitDuringMotion    = (!overlapping) & hitSlabs & ((inCorner & hitCorner) | hitFace);
+
+   timeOfEntry                   = selectLanes(inCorner, timeOfEntryCorner, timeOfEntry);
+   pointOfEntryX                 = startX + relativeDisplacementX * timeOfEntry;
+   pointOfEntryY                 = startY + relativeDisplacementY * timeOfEntry;
+
+   timeOfImpact                             = selectLanes(hitAtStart, zero, timeOfEntry);
+   vecFromCenterOfCircleToPointOfCollisionX = selectLanes(hitAtStart, vecToClosestPointX, clampLanes(pointOfEntryX, -halfWidthOfAABB, halfWidthOfAABB) - pointOfEntryX);
+   vecFromCenterOfCircleToPointOfCollisionY = selectLanes(hitAtStart, vecToClosestPointY, clampLanes(pointOfEntryY, -halfHeightOfAABB, halfHeightOfAABB) - pointOfEntryY);
+
+   return hitAtStart | hitDuringMotion;
+}
+
+MaskLanes circleAndAABBCollidedLanes(FloatLanes  centerOfCircleX,
+                                     FloatLanes  centerOfCircleY,
+                                     FloatLanes  radius,
+                                     FloatLanes  centerOfAABBX,
+                                     FloatLanes  centerOfAABBY,
+                                     FloatLanes  halfWidthOfAABB,
+                                     FloatLanes  halfHeightOfAABB,
+                                     FloatLanes& vecFromCenterOfCircleToPointOfCollisionX,
+                                     FloatLanes& vecFromCenterOfCircleToPointOfCollisionY)
+{
+   // Comparing squared lengths is equivalent to comparing lengths, and it saves a square root
+   // Like circleAndAABBCollided (see collision.cpp), everything is calculated relative to the center of the AABB
+   FloatLanes startX = centerOfCircleX - centerOfAABBX;
+   FloatLanes startY = centerOfCircleY - centerOfAABBY;
+
+   vecFromCenterOfCircleToPointOfCollisionX = clampLanes(startX, -halfWidthOfAABB, halfWidthOfAABB) - startX;
+   vecFromCenterOfCircleToPointOfCollisionY = clampLanes(startY, -halfHeightOfAABB, halfHeightOfAABB) - startY;
+
+   return (vecFromCenterOfCircleToPointOfCollisionX * vecFromCenterOfCircleToPointOfCollisionX +
+           vecFromCenterOfCircleToPointOfCollisionY * vecFromCenterOfCircleToPointOfCollisionY) < (radius * radius);
+}
+
+void resolveCollisionBetweenBallAndPaddleLanes(MaskLanes   collided,
+                                               FloatLanes& ballPositionX,
+                                               FloatLanes& ballPositionY,
+                                               FloatLanes& ballVelocityX,
+                                               FloatLanes& ballVelocityY,
+                                               FloatLanes  ballRadius,
+                                               FloatLanes  initialBallVelocityY,
+                                               FloatLanes  paddlePositionY,
+                                               FloatLanes  halfHeightOfPaddle,
+                                               FloatLanes  paddleVelocityY,
+                                               FloatLanes  vecFromCenterOfCircleToPointOfCollisionX,
+                                               FloatLanes  vecFromCenterOfCircleToPointOfCollisionY)
+{
+   // This is a branch-free version of MatchRules::resolveCollisionBetweenBallAndPaddle (see match_simulation.cpp)
+   // determineDirectionOfCollisionBetweenCircleAndAABB picks a horizontal direction when the collision vector is closer to the X axis than to the Y axis
+
+   if (!anyLanes(collided))
+   {
+      return;
+   }
+
+   FloatLanes zero         = broadcastLanes(0.0f);
+   FloatLanes absVecX      = absLanes(vecFromCenterOfCircleToPointOfCollisionX);
+   FloatLanes absVecY      = absLanes(vecFromCenterOfCircleToPointOfCollisionY);
+   MaskLanes  horizontal   = absVecX > absVecY;
+   MaskLanes  fromTheLeft  = vecFromCenterOfCircleToPointOfCollisionX < zero;
+   MaskLanes  fromBelow    = vecFromCenterOfCircleToPointOfCollisionY > zero;
+
+   // Horizontal collision
+   FloatLanes distanceFromCenterOfPaddleInPercent = (ballPositionY - paddlePositionY) / halfHeightOfPaddle;
+   FloatLanes currSpeed    = sqrtLanes(ballVelocityX * ballVelocityX + ballVelocityY * ballVelocityY);
+   FloatLanes newVelocityX = -ballVelocityX;
+   FloatLanes newVelocityY = initialBallVelocityY * distanceFromCenterOfPaddleInPercent;
+   FloatLanes newLength    = sqrtLanes(newVelocityX * newVelocityX + newVelocityY * newVelocityY);
+   FloatLanes scale        = currSpeed / newLength;
+   newVelocityX            = absLanes(newVelocityX * scale);
+   newVelocityX            = selectLanes(fromTheLeft, newVelocityX, -newVelocityX);
+   newVelocityY            = newVelocityY * scale;
+   FloatLanes horizontalPenetration = ballRadius - absVecX;
+   FloatLanes newPositionX = selectLanes(fromTheLeft, ballPositionX + horizontalPenetration, ballPositionX - horizontalPenetration);
+
+   // Vertical collision
+   FloatLanes speedOfApproach     = selectLanes(fromBelow, -paddleVelocityY, paddleVelocityY);
+   FloatLanes currVerticalSpeed   = absLanes(ballVelocityY);
+   FloatLanes newVerticalSpeed    = maxLanes(currVerticalSpeed, minLanes(maxLanes(speedOfApproach, zero), currSpeed));
+   FloatLanes newHorizontalSpeed  = sqrtLanes(maxLanes(currSpeed * currSpeed - newVerticalSpeed * newVerticalSpeed, zero));
+   FloatLanes bouncedVelocityX    = selectLanes(newVerticalSpeed > currVerticalSpeed,
+                                                selectLanes(ballVelocityX < zero, -newHorizontalSpeed, newHorizontalSpeed),
+                                                ballVelocityX);
+   MaskLanes  intoSideOfPaddle    = ((vecFromCenterOfCircleToPointOfCollisionX < zero) & (bouncedVelocityX < zero)) |
+                                    ((vecFromCenterOfCircleToPointOfCollisionX > zero) & (bouncedVelocityX > zero));
+   bouncedVelocityX               = selectLanes(intoSideOfPaddle, -bouncedVelocityX, bouncedVelocityX);
+   FloatLanes bouncedVelocityY    = selectLanes(fromBelow, -newVerticalSpeed, newVerticalSpeed);
+   FloatLanes verticalPenetration = ballRadius - absVecY;
+   FloatLanes newPositionY        = selectLanes(fromBelow, ballPositionY - verticalPenetration, ballPositionY + verticalPenetration);
+
+   MaskLanes  collidedHorizontally = collided & horizontal;
+   MaskLanes  collidedVertically   = collided & !horizontal;
+
+   ballPositionX = selectLanes(collidedHorizontally, newPositionX, ballPositionX);
+   ballVelocityX = selectLanes(collidedHorizontally, newVelocityX, ballVelocityX);
+   ballVelocityY = selectLanes(collidedHorizontally, newVelocityY, ballVelocityY);
+
+   ballPositionY = selectLanes(collidedVertically, newPositionY, ballPositionY);
+   ballVelocityX = selectLanes(collidedVertically, bouncedVelocityX, ballVelocityX);
+   ballVelocityY = selectLanes(collidedVertically, bouncedVelocityY, ballVelocityY);
+}
+
+FloatLanes finishMovingPaddleLanes(MaskLanes  finishing,
+                                   FloatLanes ballPositionX,
+                                   FloatLanes ballPositionY,
+                                   FloatLanes ballRadius,
+                                   FloatLanes paddlePositionX,
+                                   FloatLanes paddlePositionY,
+                                   FloatLanes remainingDisplacementOfPaddle,
+                                   FloatLanes halfWidthOfPaddle,
+                                   FloatLanes halfHeightOfPaddle)
+{
+   // This is a branch-free version of MatchRules::finishMovingPaddle (see match_simulation.cpp)
+
+   if (!anyLanes(finishing))
+   {
+      return paddlePositionY;
+   }
+
+   FloatLanes finishedPositionY = paddlePositionY + remainingDisplacementOfPaddle;
+   FloatLanes vecX, vecY;
+   MaskLanes  blocked           = circleAndAABBCollidedLanes(ballPositionX, ballPositionY, ballRadius,
+                                                             paddlePositionX, finishedPositionY,
+                                                             halfWidthOfPaddle, halfHeightOfPaddle,
+                                                             vecX, vecY);
+
+   return selectLanes(finishing & !blocked, finishedPositionY, paddlePositionY);
+}
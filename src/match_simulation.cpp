@@ -0,0 +1,782 @@
+#include <algorithm>
+#include <array>
+
+#include "collision.h"
+#include "match_simulation.h"
+#include "substep_governor.h"
+
+MatchConfiguration::MatchConfiguration()
+   : initialBall({glm::vec3(0.0f, 0.0f, 1.96875f), // Position
+                  glm::vec3(35.0f, 45.0f, 0.0f),   // Velocity
+                  glm::vec3(35.0f, 45.0f, 0.0f),   // Initial velocity
+                  2.5f,                            // Radius
+                  1000.0f,                         // Spin angular velocity
+                  1000.0f})                        // Spin angular velocity scaled by bounce
+   , initialLeftPaddle({glm::vec3(-45.0f, 0.0f, 0.0f), // Position
+                        glm::vec3(0.0f, 30.0f, 0.0f),  // Velocity
+                        3.5f,                          // Width
+                        7.5f})                         // Height
+   , initialRightPaddle({glm::vec3(45.0f, 0.0f, 0.0f), // Position
+                         glm::vec3(0.0f, 30.0f, 0.0f), // Velocity
+                         3.5f,                         // Width
+                         7.5f})                        // Height
+   , verticalRange(60.0f)
+   , horizontalRange(100.0f)
+   , lengthOfLineTraversedByPaddles(60.0f)
+   , scaleOfHorizontalVelocityInFreeFall(0.25f)
+   , verticalVelocityInFreeFall(-15.0f)
+   , heightBelowWhichSceneIsReset(-45.0f)
+   , maxNumberOfContactsPerStep(8)
+   , pointsNeededToWin(3)
+   , arithmetic(MatchArithmetic::FloatingPoint)
+{
+
+}
+
+template<typename NumericPolicy>
+MatchRules<NumericPolicy>::MatchRules(const MatchConfiguration& configuration)
+   : mMaxNumberOfContactsPerStep(configuration.maxNumberOfContactsPerStep)
+   , mPointsNeededToWin(configuration.pointsNeededToWin)
+   , mInitialRally()
+   , mServeVelocities()
+   , mRadiusOfBall(NumericPolicy::fromFloat(configuration.initialBall.radius))
+   , mInitialVelocityOfBallY(NumericPolicy::fromFloat(configuration.initialBall.initialVelocity.y))
+   , mSpinAngularVelocity(NumericPolicy::fromFloat(configuration.initialBall.spinAngularVelocity))
+   , mLeftPaddle({NumericPolicy::fromFloat(configuration.initialLeftPaddle.position.x),
+                  NumericPolicy::fromFloat(configuration.initialLeftPaddle.width / 2.0f),
+                  NumericPolicy::fromFloat(configuration.initialLeftPaddle.height / 2.0f),
+                  NumericPolicy::fromFloat(configuration.initialLeftPaddle.velocity.y)})
+   , mRightPaddle({NumericPolicy::fromFloat(configuration.initialRightPaddle.position.x),
+                   NumericPolicy::fromFloat(configuration.initialRightPaddle.width / 2.0f),
+                   NumericPolicy::fromFloat(configuration.initialRightPaddle.height / 2.0f),
+                   NumericPolicy::fromFloat(configuration.initialRightPaddle.velocity.y)})
+   , mHalfVerticalRange(NumericPolicy::fromFloat(configuration.verticalRange / 2.0f))
+   , mHalfHorizontalRange(NumericPolicy::fromFloat(configuration.horizontalRange / 2.0f))
+   , mHalfLengthOfLineTraversedByPaddles(NumericPolicy::fromFloat(configuration.lengthOfLineTraversedByPaddles / 2.0f))
+   , mScaleOfHorizontalVelocityInFreeFall(NumericPolicy::fromFloat(configuration.scaleOfHorizontalVelocityInFreeFall))
+   , mVerticalVelocityInFreeFall(NumericPolicy::fromFloat(configuration.verticalVelocityInFreeFall))
+   , mHeightBelowWhichSceneIsReset(NumericPolicy::fromFloat(configuration.heightBelowWhichSceneIsReset))
+{
+   MatchState initialState    = {};
+   initialState.ball          = configuration.initialBall;
+   initialState.leftPaddle    = configuration.initialLeftPaddle;
+   initialState.rightPaddle   = configuration.initialRightPaddle;
+   mInitialRally              = loadRally(initialState);
+
+   Number speedOfServe = NumericPolicy::sqrtOfSumOfSquares(mInitialRally.velocityOfBall.x, mInitialRally.velocityOfBall.y);
+   for (unsigned int serveDirection = 0; serveDirection < mServeVelocities.size(); ++serveDirection)
+   {
+      mServeVelocities[serveDirection] = calculateServeVelocity(speedOfServe, serveDirection);
+   }
+}
+
+template<typename NumericPolicy>
+MatchEvents MatchRules<NumericPolicy>::step(Rally& rally, MatchState& state, const MatchInputs& inputs, float deltaTime, unsigned int numberOfSubsteps) const
+{
+   numberOfSubsteps = std::max(numberOfSubsteps, 1u);
+
+   // Most ticks aren't split, and dividing by one wouldn't change the time step
+   Number      deltaTimeOfSubstep = NumericPolicy::fromFloat(deltaTime);
+   MatchEvents events             = {};
+
+   if (numberOfSubsteps > 1)
+   {
+      deltaTimeOfSubstep = deltaTimeOfSubstep / NumericPolicy::fromInt(static_cast<int>(numberOfSubsteps));
+   }
+
+   for (unsigned int substep = 0; substep < numberOfSubsteps; ++substep)
+   {
+      MatchEvents eventsOfSubstep = stepOnce(rally, state, inputs, deltaTimeOfSubstep);
+
+      if (eventsOfSubstep.ballWasReleased)
+      {
+         events.ballWasReleased = true;
+         events.serveDirection  = eventsOfSubstep.serveDirection;
+      }
+
+      events.ballBouncedOffWall = events.ballBouncedOffWall || eventsOfSubstep.ballBouncedOffWall;
+      events.ballHitLeftPaddle  = events.ballHitLeftPaddle  || eventsOfSubstep.ballHitLeftPaddle;
+      events.ballHitRightPaddle = events.ballHitRightPaddle || eventsOfSubstep.ballHitRightPaddle;
+      events.pointWasScored     = events.pointWasScored     || eventsOfSubstep.pointWasScored;
+      events.sceneWasReset      = events.sceneWasReset      || eventsOfSubstep.sceneWasReset;
+      events.matchIsOver        = events.matchIsOver        || eventsOfSubstep.matchIsOver;
+
+      if (events.sceneWasReset || events.matchIsOver)
+      {
+         break;
+      }
+   }
+
+   storeRally(rally, state);
+
+   return events;
+}
+
+template<typename NumericPolicy>
+MatchEvents MatchRules<NumericPolicy>::stepOnce(Rally& rally, MatchState& state, const MatchInputs& inputs, Number deltaTime) const
+{
+   MatchEvents events = {};
+
+   if (state.matchIsOver)
+   {
+      events.matchIsOver = true;
+      return events;
+   }
+
+   // Release the ball
+   if (!state.ballIsInPlay && inputs.releaseBall)
+   {
+      events.serveDirection  = drawServeDirection(state.randomNumberGeneratorState);
+      rally.velocityOfBall   = mServeVelocities[events.serveDirection];
+      state.ballIsInPlay     = true;
+      events.ballWasReleased = true;
+   }
+
+   // Move the paddles
+   Number positionYOfLeftPaddleBeforeMoving  = rally.positionYOfLeftPaddle;
+   Number positionYOfRightPaddleBeforeMoving = rally.positionYOfRightPaddle;
+
+   movePaddle(rally.positionYOfLeftPaddle, mLeftPaddle, inputs.leftPaddle, deltaTime);
+   movePaddle(rally.positionYOfRightPaddle, mRightPaddle, inputs.rightPaddle, deltaTime);
+
+   if (!state.ballIsInPlay)
+   {
+      return events;
+   }
+
+   bool ballIsOutsideOfHorizontalRange = ((rally.positionOfBall.x + mRadiusOfBall) < -mHalfHorizontalRange) ||
+                                         ((rally.positionOfBall.x - mRadiusOfBall) > mHalfHorizontalRange);
+
+   if (!state.ballIsFalling && ballIsOutsideOfHorizontalRange)
+   {
+      if (rally.positionOfBall.x > NumericPolicy::fromInt(0))
+      {
+         ++state.pointsScoredByLeftPaddle;
+      }
+      else
+      {
+         ++state.pointsScoredByRightPaddle;
+      }
+
+      events.pointWasScored = true;
+
+      rally.velocityOfBall         = rally.velocityOfBall * mScaleOfHorizontalVelocityInFreeFall;
+      rally.verticalVelocityOfBall = mVerticalVelocityInFreeFall;
+      state.ballIsFalling          = true;
+   }
+
+   if (state.ballIsFalling)
+   {
+      rally.positionOfBall = rally.positionOfBall + (rally.velocityOfBall * deltaTime);
+      rally.heightOfBall  += rally.verticalVelocityOfBall * deltaTime;
+
+      if (rally.heightOfBall < mHeightBelowWhichSceneIsReset)
+      {
+         if (state.pointsScoredByLeftPaddle == mPointsNeededToWin || state.pointsScoredByRightPaddle == mPointsNeededToWin)
+         {
+            state.matchIsOver  = true;
+            events.matchIsOver = true;
+         }
+         else
+         {
+            rally                = mInitialRally;
+            state.ballIsInPlay   = false;
+            state.ballIsFalling  = false;
+            events.sceneWasReset = true;
+         }
+      }
+   }
+   else
+   {
+      moveBallAcrossTable(rally, positionYOfLeftPaddleBeforeMoving, positionYOfRightPaddleBeforeMoving, deltaTime, events);
+   }
+
+   return events;
+}
+
+template<typename NumericPolicy>
+void MatchRules<NumericPolicy>::movePaddle(Number& positionY, const PaddleShape& shape, const PaddleInput& input, Number deltaTime) const
+{
+   if (input.moveUp && ((positionY + shape.halfHeight) < mHalfLengthOfLineTraversedByPaddles))
+   {
+      positionY += shape.speed * deltaTime;
+   }
+
+   if (input.moveDown && ((positionY - shape.halfHeight) > -mHalfLengthOfLineTraversedByPaddles))
+   {
+      positionY -= shape.speed * deltaTime;
+   }
+}
+
+template<typename NumericPolicy>
+void MatchRules<NumericPolicy>::moveBallAcrossTable(Rally&       rally,
+                                                    Number       positionYOfLeftPaddleAtStart,
+                                                    Number       positionYOfRightPaddleAtStart,
+                                                    Number       deltaTime,
+                                                    MatchEvents& events) const
+{
+   // Instead of moving the ball and then checking if it overlaps with something, which lets fast balls tunnel through the paddles,
+   // we sweep the ball along its path, stop it at the first wall or paddle that it touches, bounce it, and then sweep it again for the rest of the step
+
+   const Number zero = NumericPolicy::fromInt(0);
+   const Number one  = NumericPolicy::fromInt(1);
+
+   // The paddles have already been moved to where they will be at the end of the step, so we advance copies of them from where they were at the start of it
+   // together with the ball, and move them back to where the copies end up, which is short of where they were moved to if the ball stopped them
+   Vector centerOfLeftPaddle         = {mLeftPaddle.positionX, positionYOfLeftPaddleAtStart};
+   Vector centerOfRightPaddle        = {mRightPaddle.positionX, positionYOfRightPaddleAtStart};
+   Number displacementOfLeftPaddle   = rally.positionYOfLeftPaddle - positionYOfLeftPaddleAtStart;
+   Number displacementOfRightPaddle  = rally.positionYOfRightPaddle - positionYOfRightPaddleAtStart;
+   Vector halfExtentsOfLeftPaddle    = {mLeftPaddle.halfWidth, mLeftPaddle.halfHeight};
+   Vector halfExtentsOfRightPaddle   = {mRightPaddle.halfWidth, mRightPaddle.halfHeight};
+
+   Number topBoundary    =  mHalfVerticalRange;
+   Number bottomBoundary = -topBoundary;
+
+   enum class Contact
+   {
+      None,
+      TopWall,
+      BottomWall,
+      LeftPaddle,
+      RightPaddle
+   };
+
+   // A paddle that moves towards the ball faster than the ball can move away from it without gaining speed pushes the ball along with it for the rest of the step,
+   // and if it pushes the ball against a wall, the ball pins it there, so the ball never ends up inside of a paddle or a wall
+   Contact paddlePushingBall = Contact::None;
+   bool    ballIsPinned      = false;
+
+   Number fractionOfStepLeft = one;
+   for (unsigned int i = 0; i < mMaxNumberOfContactsPerStep && fractionOfStepLeft > zero && !ballIsPinned; ++i)
+   {
+      // Products with a fraction of one don't change anything, and skipping them saves most of the products of a step with fixed-point numbers,
+      // since the whole step is left on the first pass, and most steps end without a contact
+      bool   wholeStepIsLeft                    = (fractionOfStepLeft == one);
+      Vector displacementOfBall                 = rally.velocityOfBall * (wholeStepIsLeft ? deltaTime : deltaTime * fractionOfStepLeft);
+      Number remainingDisplacementOfLeftPaddle  = wholeStepIsLeft ? displacementOfLeftPaddle : displacementOfLeftPaddle * fractionOfStepLeft;
+      Number remainingDisplacementOfRightPaddle = wholeStepIsLeft ? displacementOfRightPaddle : displacementOfRightPaddle * fractionOfStepLeft;
+
+      if (paddlePushingBall == Contact::LeftPaddle)
+      {
+         displacementOfBall.y = remainingDisplacementOfLeftPaddle;
+      }
+      else if (paddlePushingBall == Contact::RightPaddle)
+      {
+         displacementOfBall.y = remainingDisplacementOfRightPaddle;
+      }
+
+      // Find the earliest contact, as a fraction of the remaining displacement
+      Contact contact       = Contact::None;
+      Number  timeOfContact = one;
+      Vector  vecFromCenterOfCircleToPointOfCollision = {zero, zero};
+
+      // Dividing is slow with fixed-point numbers, so a wall that is more than twice as far away as the ball moves is skipped without dividing,
+      // since the time of impact would round to more than one anyway
+      if (displacementOfBall.y > zero)
+      {
+         Number distanceToWall = topBoundary - (rally.positionOfBall.y + mRadiusOfBall);
+         if (distanceToWall <= displacementOfBall.y + displacementOfBall.y)
+         {
+            Number timeOfImpact = distanceToWall / displacementOfBall.y;
+            if (timeOfImpact <= timeOfContact)
+            {
+               contact       = Contact::TopWall;
+               timeOfContact = std::max(timeOfImpact, zero);
+            }
+         }
+      }
+      else if (displacementOfBall.y < zero)
+      {
+         Number distanceToWall = bottomBoundary - (rally.positionOfBall.y - mRadiusOfBall);
+         if (distanceToWall >= displacementOfBall.y + displacementOfBall.y)
+         {
+            Number timeOfImpact = distanceToWall / displacementOfBall.y;
+            if (timeOfImpact <= timeOfContact)
+            {
+               contact       = Contact::BottomWall;
+               timeOfContact = std::max(timeOfImpact, zero);
+            }
+         }
+      }
+
+      // The paddles are swept in their own frames of reference, so the ball is moved relative to them, and a paddle that catches up with the ball hits it
+      Number timeOfImpact;
+      Vector vecAtImpact;
+      if (sweptCircleAndAABBCollided<NumericPolicy>(rally.positionOfBall - centerOfLeftPaddle,
+                                                    mRadiusOfBall,
+                                                    {displacementOfBall.x, displacementOfBall.y - remainingDisplacementOfLeftPaddle},
+                                                    halfExtentsOfLeftPaddle,
+                                                    timeOfImpact,
+                                                    vecAtImpact) && timeOfImpact < timeOfContact)
+      {
+         contact                                 = Contact::LeftPaddle;
+         timeOfContact                           = timeOfImpact;
+         vecFromCenterOfCircleToPointOfCollision = vecAtImpact;
+      }
+
+      if (sweptCircleAndAABBCollided<NumericPolicy>(rally.positionOfBall - centerOfRightPaddle,
+                                                    mRadiusOfBall,
+                                                    {displacementOfBall.x, displacementOfBall.y - remainingDisplacementOfRightPaddle},
+                                                    halfExtentsOfRightPaddle,
+                                                    timeOfImpact,
+                                                    vecAtImpact) && timeOfImpact < timeOfContact)
+      {
+         contact                                 = Contact::RightPaddle;
+         timeOfContact                           = timeOfImpact;
+         vecFromCenterOfCircleToPointOfCollision = vecAtImpact;
+      }
+
+      // Advance everything to the moment of contact, or to the end of the step if there isn't one
+      if (timeOfContact == one)
+      {
+         rally.positionOfBall   = rally.positionOfBall + displacementOfBall;
+         centerOfLeftPaddle.y  += remainingDisplacementOfLeftPaddle;
+         centerOfRightPaddle.y += remainingDisplacementOfRightPaddle;
+         fractionOfStepLeft     = zero;
+      }
+      else
+      {
+         rally.positionOfBall   = rally.positionOfBall + (displacementOfBall * timeOfContact);
+         centerOfLeftPaddle.y  += remainingDisplacementOfLeftPaddle * timeOfContact;
+         centerOfRightPaddle.y += remainingDisplacementOfRightPaddle * timeOfContact;
+         fractionOfStepLeft    *= (one - timeOfContact);
+      }
+
+      if (contact == Contact::None)
+      {
+         break;
+      }
+
+      // The ball touches the paddle without overlapping with it, so it bounces off of it where it is, instead of being pushed out of it,
+      // which would move it by the depth of the rounded corner when it hits a corner of the paddle
+      Vector positionOfBallAfterPushOut = rally.positionOfBall;
+
+      // The velocity of a paddle is only needed when it hits the ball, which saves a division on most steps
+      // Its displacement is still the one that it had at the start of the step, since that only changes when the ball is pinned, which ends the sweep
+      Number displacementOfPaddleHit = (contact == Contact::LeftPaddle) ? displacementOfLeftPaddle : ((contact == Contact::RightPaddle) ? displacementOfRightPaddle : zero);
+      Number velocityYOfPaddleHit    = (displacementOfPaddleHit == zero) ? zero : displacementOfPaddleHit / deltaTime;
+
+      switch (contact)
+      {
+      case Contact::None:
+         break;
+      case Contact::TopWall:
+      case Contact::BottomWall:
+         rally.positionOfBall.y = (contact == Contact::TopWall) ? (topBoundary - mRadiusOfBall) : (bottomBoundary + mRadiusOfBall);
+
+         // A ball that is pushed into a wall can't bounce off of it without moving into the paddle, so it stays against the wall, and the paddle stays against the ball
+         if (paddlePushingBall == Contact::LeftPaddle)
+         {
+            displacementOfLeftPaddle = zero;
+            ballIsPinned             = true;
+         }
+         else if (paddlePushingBall == Contact::RightPaddle)
+         {
+            displacementOfRightPaddle = zero;
+            ballIsPinned              = true;
+         }
+         else
+         {
+            bounceBallOffWall(rally.velocityOfBall, rally.spinAngularVelocityScaledByBounce, mSpinAngularVelocity);
+            events.ballBouncedOffWall = true;
+         }
+         break;
+      case Contact::LeftPaddle:
+         resolveCollisionBetweenBallAndPaddle(positionOfBallAfterPushOut,
+                                              rally.velocityOfBall,
+                                              mRadiusOfBall,
+                                              mInitialVelocityOfBallY,
+                                              centerOfLeftPaddle.y,
+                                              mLeftPaddle.halfHeight,
+                                              velocityYOfPaddleHit,
+                                              vecFromCenterOfCircleToPointOfCollision);
+         events.ballHitLeftPaddle = true;
+         paddlePushingBall        = ballIsMovingIntoPaddle(rally.velocityOfBall, velocityYOfPaddleHit, vecFromCenterOfCircleToPointOfCollision) ? Contact::LeftPaddle : Contact::None;
+         break;
+      case Contact::RightPaddle:
+         resolveCollisionBetweenBallAndPaddle(positionOfBallAfterPushOut,
+                                              rally.velocityOfBall,
+                                              mRadiusOfBall,
+                                              mInitialVelocityOfBallY,
+                                              centerOfRightPaddle.y,
+                                              mRightPaddle.halfHeight,
+                                              velocityYOfPaddleHit,
+                                              vecFromCenterOfCircleToPointOfCollision);
+         events.ballHitRightPaddle = true;
+         paddlePushingBall         = ballIsMovingIntoPaddle(rally.velocityOfBall, velocityYOfPaddleHit, vecFromCenterOfCircleToPointOfCollision) ? Contact::RightPaddle : Contact::None;
+         break;
+      }
+   }
+
+   // If the ball stopped before the end of the step, because it was pinned or because it ran out of contacts (e.g. while wedged between a paddle and a wall),
+   // each paddle finishes its motion unless that would move it into the ball, in which case the ball stops it where it is
+   if (fractionOfStepLeft > zero)
+   {
+      finishMovingPaddle(rally, centerOfLeftPaddle, halfExtentsOfLeftPaddle, displacementOfLeftPaddle * fractionOfStepLeft);
+      finishMovingPaddle(rally, centerOfRightPaddle, halfExtentsOfRightPaddle, displacementOfRightPaddle * fractionOfStepLeft);
+   }
+
+   rally.positionYOfLeftPaddle  = centerOfLeftPaddle.y;
+   rally.positionYOfRightPaddle = centerOfRightPaddle.y;
+}
+
+template<typename NumericPolicy>
+bool MatchRules<NumericPolicy>::ballIsMovingIntoPaddle(Vector velocityOfBall, Number velocityYOfPaddle, Vector vecFromCenterOfCircleToPointOfCollision)
+{
+   return dot(velocityOfBall - Vector{NumericPolicy::fromInt(0), velocityYOfPaddle}, vecFromCenterOfCircleToPointOfCollision) > NumericPolicy::fromInt(0);
+}
+
+template<typename NumericPolicy>
+void MatchRules<NumericPolicy>::finishMovingPaddle(const Rally& rally, Vector& centerOfPaddle, Vector halfExtentsOfPaddle, Number remainingDisplacement) const
+{
+   Vector vecFromCenterOfCircleToPointOfCollision;
+   if (!circleAndAABBCollided<NumericPolicy>(rally.positionOfBall - Vector{centerOfPaddle.x, centerOfPaddle.y + remainingDisplacement},
+                                             mRadiusOfBall,
+                                             halfExtentsOfPaddle,
+                                             vecFromCenterOfCircleToPointOfCollision))
+   {
+      centerOfPaddle.y += remainingDisplacement;
+   }
+}
+
+template<typename NumericPolicy>
+typename MatchRules<NumericPolicy>::Rally MatchRules<NumericPolicy>::loadRally(const MatchState& state) const
+{
+   Rally rally;
+
+   rally.positionOfBall                    = {NumericPolicy::fromFloat(state.ball.position.x), NumericPolicy::fromFloat(state.ball.position.y)};
+   rally.velocityOfBall                    = {NumericPolicy::fromFloat(state.ball.velocity.x), NumericPolicy::fromFloat(state.ball.velocity.y)};
+   rally.heightOfBall                      = NumericPolicy::fromFloat(state.ball.position.z);
+   rally.verticalVelocityOfBall            = NumericPolicy::fromFloat(state.ball.velocity.z);
+   rally.spinAngularVelocityScaledByBounce = NumericPolicy::fromFloat(state.ball.spinAngularVelocityScaledByBounce);
+   rally.positionYOfLeftPaddle             = NumericPolicy::fromFloat(state.leftPaddle.position.y);
+   rally.positionYOfRightPaddle            = NumericPolicy::fromFloat(state.rightPaddle.position.y);
+
+   return rally;
+}
+
+template<typename NumericPolicy>
+void MatchRules<NumericPolicy>::storeRally(const Rally& rally, MatchState& state) const
+{
+   state.ball.position                    = glm::vec3(NumericPolicy::toFloat(rally.positionOfBall.x),
+                                                      NumericPolicy::toFloat(rally.positionOfBall.y),
+                                                      NumericPolicy::toFloat(rally.heightOfBall));
+   state.ball.velocity                    = glm::vec3(NumericPolicy::toFloat(rally.velocityOfBall.x),
+                                                      NumericPolicy::toFloat(rally.velocityOfBall.y),
+                                                      NumericPolicy::toFloat(rally.verticalVelocityOfBall));
+   state.ball.spinAngularVelocityScaledByBounce = NumericPolicy::toFloat(rally.spinAngularVelocityScaledByBounce);
+   state.leftPaddle.position.y            = NumericPolicy::toFloat(rally.positionYOfLeftPaddle);
+   state.rightPaddle.position.y           = NumericPolicy::toFloat(rally.positionYOfRightPaddle);
+}
+
+template<typename NumericPolicy>
+void MatchRules<NumericPolicy>::bounceBallOffWall(Vector& velocityOfBall, Number& spinAngularVelocityScaledByBounce, Number spinAngularVelocity)
+{
+   // The ratio between the vertical speed of the ball and its speed ranges from 0 to 1
+   // It is equal to 0 when the ball moves parallel to the wall (tangent collision)
+   // It is equal to 1 when the ball moves perpendicular to it (direct collision)
+   Number speed = NumericPolicy::sqrtOfSumOfSquares(velocityOfBall.x, velocityOfBall.y);
+   Number ratio = NumericPolicy::abs(velocityOfBall.y) / speed;
+
+   // The ball spins with its maximum angular velocity when a tangent collision occurs
+   // The ball spins with its minimum angular velocity, that is, it doesn't spin, when a direct collision occurs
+   spinAngularVelocityScaledByBounce = spinAngularVelocity * (NumericPolicy::fromInt(1) - ratio);
+
+   velocityOfBall.y = -velocityOfBall.y;
+}
+
+template<typename NumericPolicy>
+void MatchRules<NumericPolicy>::resolveCollisionBetweenBallAndPaddle(Vector& positionOfBall,
+                                                                     Vector& velocityOfBall,
+                                                                     Number  radiusOfBall,
+                                                                     Number  initialVelocityOfBallY,
+                                                                     Number  positionYOfPaddle,
+                                                                     Number  halfHeightOfPaddle,
+                                                                     Number  velocityYOfPaddle,
+                                                                     Vector  vecFromCenterOfCircleToPointOfCollision)
+{
+   const Number zero = NumericPolicy::fromInt(0);
+
+   CollisionDirection collisionDirection = determineDirectionOfCollisionBetweenCircleAndAABB<NumericPolicy>(vecFromCenterOfCircleToPointOfCollision);
+
+   if (collisionDirection == CollisionDirection::Left || collisionDirection == CollisionDirection::Right)
+   {
+      // Horizontal collision
+
+      // The direction in which the ball bounces off of the paddle depends on the distance between the point where it hits the paddle and the center of the paddle
+      // If it hits the center of the paddle, it bounces off completely horizontally
+      // If it hits either end of the paddle, it bounces off with the maximum possible angle
+      // Note that the speed of the ball is always the same; only its direction changes
+
+      Number distanceFromCenterOfPaddleInPercent = (positionOfBall.y - positionYOfPaddle) / halfHeightOfPaddle;
+
+      Number currSpeed = NumericPolicy::sqrtOfSumOfSquares(velocityOfBall.x, velocityOfBall.y);
+      velocityOfBall.x = -velocityOfBall.x;
+      velocityOfBall.y = initialVelocityOfBallY * distanceFromCenterOfPaddleInPercent;
+      velocityOfBall   = velocityOfBall * (currSpeed / NumericPolicy::sqrtOfSumOfSquares(velocityOfBall.x, velocityOfBall.y));
+
+      Number horizontalPenetration = radiusOfBall - NumericPolicy::abs(vecFromCenterOfCircleToPointOfCollision.x);
+
+      if (collisionDirection == CollisionDirection::Left)
+      {
+         // Make sure the ball is moving to the right
+         if (velocityOfBall.x < zero)
+         {
+            velocityOfBall.x = -velocityOfBall.x;
+         }
+
+         // Move the ball to the right so that it doesn't overlap with the paddle
+         positionOfBall.x += horizontalPenetration;
+      }
+      else // CollisionDirection::Right
+      {
+         // Make sure the ball is moving to the left
+         if (velocityOfBall.x > zero)
+         {
+            velocityOfBall.x = -velocityOfBall.x;
+         }
+
+         // Move the ball to the left so that it doesn't overlap with the paddle
+         positionOfBall.x -= horizontalPenetration;
+      }
+   }
+   else
+   {
+      // Vertical collision
+      Number verticalPenetration = radiusOfBall - NumericPolicy::abs(vecFromCenterOfCircleToPointOfCollision.y);
+
+      // A paddle that moves towards the ball pushes it away at least as fast as the paddle moves, otherwise it would hit the ball again on the next step
+      // The ball can't go faster than it already does, and what it gains vertically it loses horizontally, so that its speed is preserved
+      Number currSpeed          = NumericPolicy::sqrtOfSumOfSquares(velocityOfBall.x, velocityOfBall.y);
+      Number speedOfApproach    = (collisionDirection == CollisionDirection::Up) ? -velocityYOfPaddle : velocityYOfPaddle;
+      Number currVerticalSpeed  = NumericPolicy::abs(velocityOfBall.y);
+      Number newVerticalSpeed   = std::max(currVerticalSpeed, std::min(std::max(speedOfApproach, zero), currSpeed));
+
+      if (newVerticalSpeed > currVerticalSpeed)
+      {
+         Number newHorizontalSpeed = NumericPolicy::sqrtOfDifferenceOfSquares(currSpeed, newVerticalSpeed);
+         velocityOfBall.x          = (velocityOfBall.x < zero) ? -newHorizontalSpeed : newHorizontalSpeed;
+      }
+
+      // When the ball hits a corner of the paddle while moving towards its side, it's also bounced back horizontally, otherwise it would hit the side on the next step
+      if ((vecFromCenterOfCircleToPointOfCollision.x < zero && velocityOfBall.x < zero) || (vecFromCenterOfCircleToPointOfCollision.x > zero && velocityOfBall.x > zero))
+      {
+         velocityOfBall.x = -velocityOfBall.x;
+      }
+
+      if (collisionDirection == CollisionDirection::Up)
+      {
+         // Make sure the ball is moving downwards
+         velocityOfBall.y = -newVerticalSpeed;
+
+         // Move the ball downwards so that it doesn't overlap with the paddle
+         positionOfBall.y -= verticalPenetration;
+      }
+      else // CollisionDirection::Down
+      {
+         // Make sure the ball is moving upwards
+         velocityOfBall.y = newVerticalSpeed;
+
+         // Move the ball upwards so that it doesn't overlap with the paddle
+         positionOfBall.y += verticalPenetration;
+      }
+   }
+}
+
+template<typename NumericPolicy>
+typename MatchRules<NumericPolicy>::Vector MatchRules<NumericPolicy>::calculateServeVelocity(Number speedOfServe, unsigned int serveDirection)
+{
+   const Number directionX = NumericPolicy::fromFloat(0.725f);
+   const Number directionY = NumericPolicy::fromInt(1);
+
+   std::array<Vector, 4> initialDirections = {Vector{ directionX,  directionY},  // Upper right diagonal
+                                              Vector{ directionX, -directionY},  // Lower right diagonal
+                                              Vector{-directionX, -directionY},  // Lower left diagonal
+                                              Vector{-directionX,  directionY}}; // Upper left diagonal
+
+   Vector direction = initialDirections[serveDirection];
+   return direction * (speedOfServe / NumericPolicy::sqrtOfSumOfSquares(direction.x, direction.y));
+}
+
+template class MatchRules<FloatNumericPolicy>;
+template class MatchRules<FixedPointNumericPolicy>;
+
+MatchSimulation::MatchSimulation(const MatchConfiguration& configuration, std::uint64_t seed)
+   : mConfiguration(configuration)
+   , mFloatingPointRules(configuration)
+   , mFixedPointRules(configuration)
+   , mState()
+   , mFloatingPointRally()
+   , mFixedPointRally()
+{
+   mState.randomNumberGeneratorState = seed;
+   startNewMatch();
+}
+
+MatchEvents MatchSimulation::step(const MatchInputs& inputs, float deltaTime)
+{
+   return step(inputs, deltaTime, 1);
+}
+
+MatchEvents MatchSimulation::step(const MatchInputs& inputs, float deltaTime, unsigned int numberOfSubsteps)
+{
+   switch (mConfiguration.arithmetic)
+   {
+   case MatchArithmetic::FixedPoint:
+      return mFixedPointRules.step(mFixedPointRally, mState, inputs, deltaTime, numberOfSubsteps);
+   case MatchArithmetic::FloatingPoint:
+   default:
+      return mFloatingPointRules.step(mFloatingPointRally, mState, inputs, deltaTime, numberOfSubsteps);
+   }
+}
+
+void MatchSimulation::startNewMatch()
+{
+   resetScene();
+   mState.matchIsOver               = false;
+   mState.pointsScoredByLeftPaddle  = 0;
+   mState.pointsScoredByRightPaddle = 0;
+}
+
+void MatchSimulation::resetScene()
+{
+   mState.ball        = mConfiguration.initialBall;
+   mState.leftPaddle  = mConfiguration.initialLeftPaddle;
+   mState.rightPaddle = mConfiguration.initialRightPaddle;
+
+   mState.ballIsInPlay  = false;
+   mState.ballIsFalling = false;
+
+   loadRally();
+}
+
+const MatchState& MatchSimulation::getState() const
+{
+   return mState;
+}
+
+void MatchSimulation::setState(const MatchState& state)
+{
+   mState = state;
+   loadRally();
+}
+
+const MatchConfiguration& MatchSimulation::getConfiguration() const
+{
+   return mConfiguration;
+}
+
+unsigned int MatchSimulation::calculateNumberOfSubstepsNeeded(float deltaTime, unsigned int maxNumberOfSubsteps) const
+{
+   switch (mConfiguration.arithmetic)
+   {
+   case MatchArithmetic::FixedPoint:
+      return ::calculateNumberOfSubstepsNeeded<FixedPointNumericPolicy>(mState, deltaTime, maxNumberOfSubsteps);
+   case MatchArithmetic::FloatingPoint:
+   default:
+      return ::calculateNumberOfSubstepsNeeded<FloatNumericPolicy>(mState, deltaTime, maxNumberOfSubsteps);
+   }
+}
+
+void MatchSimulation::loadRally()
+{
+   switch (mConfiguration.arithmetic)
+   {
+   case MatchArithmetic::FixedPoint:
+      mFixedPointRally = mFixedPointRules.loadRally(mState);
+      break;
+   case MatchArithmetic::FloatingPoint:
+   default:
+      mFloatingPointRally = mFloatingPointRules.loadRally(mState);
+      break;
+   }
+}
+
+void bounceBallOffWall(BallState& ball)
+{
+   NumericVector<float> velocity = {ball.velocity.x, ball.velocity.y};
+   MatchRules<FloatNumericPolicy>::bounceBallOffWall(velocity, ball.spinAngularVelocityScaledByBounce, ball.spinAngularVelocity);
+
+   ball.velocity.x = velocity.x;
+   ball.velocity.y = velocity.y;
+}
+
+void resolveCollisionBetweenBallAndPaddle(BallState& ball, const PaddleState& paddle, const glm::vec2& vecFromCenterOfCircleToPointOfCollision)
+{
+   NumericVector<float> position = {ball.position.x, ball.position.y};
+   NumericVector<float> velocity = {ball.velocity.x, ball.velocity.y};
+   MatchRules<FloatNumericPolicy>::resolveCollisionBetweenBallAndPaddle(position,
+                                                                        velocity,
+                                                                        ball.radius,
+                                                                        ball.initialVelocity.y,
+                                                                        paddle.position.y,
+                                                                        paddle.height / 2.0f,
+                                                                        0.0f,
+                                                                        {vecFromCenterOfCircleToPointOfCollision.x, vecFromCenterOfCircleToPointOfCollision.y});
+
+   ball.position.x = position.x;
+   ball.position.y = position.y;
+   ball.velocity.x = velocity.x;
+   ball.velocity.y = velocity.y;
+}
+
+std::uint8_t packMatchInputs(const MatchInputs& inputs)
+{
+   std::uint8_t packedInputs = 0;
+
+   if (inputs.leftPaddle.moveUp)    { packedInputs |= LeftPaddleMovesUp; }
+   if (inputs.leftPaddle.moveDown)  { packedInputs |= LeftPaddleMovesDown; }
+   if (inputs.rightPaddle.moveUp)   { packedInputs |= RightPaddleMovesUp; }
+   if (inputs.rightPaddle.moveDown) { packedInputs |= RightPaddleMovesDown; }
+   if (inputs.releaseBall)          { packedInputs |= BallIsReleased; }
+
+   return packedInputs;
+}
+
+MatchInputs unpackMatchInputs(std::uint8_t packedInputs)
+{
+   MatchInputs inputs;
+
+   inputs.leftPaddle.moveUp    = (packedInputs & LeftPaddleMovesUp) != 0;
+   inputs.leftPaddle.moveDown  = (packedInputs & LeftPaddleMovesDown) != 0;
+   inputs.rightPaddle.moveUp   = (packedInputs & RightPaddleMovesUp) != 0;
+   inputs.rightPaddle.moveDown = (packedInputs & RightPaddleMovesDown) != 0;
+   inputs.releaseBall          = (packedInputs & BallIsReleased) != 0;
+
+   return inputs;
+}
+
+std::uint8_t packNumberOfSubsteps(unsigned int numberOfSubsteps)
+{
+   numberOfSubsteps = glm::clamp(numberOfSubsteps, 1u, maxNumberOfSubstepsPerTick);
+   return static_cast<std::uint8_t>((numberOfSubsteps - 1) << 5);
+}
+
+unsigned int unpackNumberOfSubsteps(std::uint8_t packedInputs)
+{
+   return (packedInputs >> 5) + 1;
+}
+
+std::uint64_t drawRandomNumber(std::uint64_t& randomNumberGeneratorState)
+{
+   // SplitMix64, which is small enough to be stored in the state of a match and fast enough to be used in batch simulations
+   std::uint64_t z = (randomNumberGeneratorState += 0x9E3779B97F4A7C15ull);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+   return z ^ (z >> 31);
+}
+
+unsigned int drawServeDirection(std::uint64_t& randomNumberGeneratorState)
+{
+   // Use the two most significant bits to pick one of the four diagonals
+   return static_cast<unsigned int>(drawRandomNumber(randomNumberGeneratorState) >> 62);
+}
+
+glm::vec3 calculateServeVelocity(const BallState& ball, unsigned int serveDirection)
+{
+   float                speedOfServe = FloatNumericPolicy::sqrtOfSumOfSquares(ball.velocity.x, ball.velocity.y);
+   NumericVector<float> velocity     = MatchRules<FloatNumericPolicy>::calculateServeVelocity(speedOfServe, serveDirection);
+
+   return glm::vec3(velocity.x, velocity.y, 0.0f);
+}
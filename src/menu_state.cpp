@@ -149,7 +149,7 @@ void MenuState::update(float deltaTime)
    }
 }
 
-void MenuState::render()
+void MenuState::render(float /*interpolationFactor*/)
 {
    mWindow->clearAndBindMultisampleFramebuffer();
 
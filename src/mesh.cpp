@@ -8,7 +8,18 @@ Mesh::Mesh(const std::vector<Vertex>&       vertices,
    : mNumIndices(static_cast<unsigned int>(indices.size()))
    , mMaterial(material)
 {
-   configureVAO(vertices, indices);
+   configureVAO(vertices.data(), static_cast<unsigned int>(vertices.size()), indices.data(), mNumIndices);
+}
+
+Mesh::Mesh(const void*         vertices,
+           unsigned int        numVertices,
+           const unsigned int* indices,
+           unsigned int        numIndices,
+           const Material&     material)
+   : mNumIndices(numIndices)
+   , mMaterial(material)
+{
+   configureVAO(vertices, numVertices, indices, numIndices);
 }
 
 Mesh::~Mesh()
@@ -49,7 +60,7 @@ void Mesh::render(const Shader& shader) const
    glBindVertexArray(0);
 }
 
-void Mesh::configureVAO(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+void Mesh::configureVAO(const void* vertices, unsigned int numVertices, const unsigned int* indices, unsigned int numIndices)
 {
    glGenVertexArrays(1, &mVAO);
    glGenBuffers(1, &mVBO);
@@ -61,10 +72,10 @@ void Mesh::configureVAO(const std::vector<Vertex>& vertices, const std::vector<u
 
    // Positions, normals and texture coordinates
    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
-   glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+   glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vertex), vertices, GL_STATIC_DRAW);
    // Indices
    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mEBO);
-   glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+   glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndices * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
    // Set the vertex attribute pointers
 
@@ -0,0 +1,117 @@
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include <array>
+#include <iostream>
+#include <vector>
+
+#include "cooked_mesh.h"
+#include "mesh_cooker.h"
+
+void cookNodeHierarchyRecursively(const aiNode* node, const aiScene* scene, CookedMeshContents& contents)
+{
+   for (unsigned int i = 0; i < node->mNumMeshes; i++)
+   {
+      const aiMesh*   mesh   = scene->mMeshes[node->mMeshes[i]];
+      CookedMeshRange range  = {};
+      range.firstVertex      = static_cast<std::uint32_t>(contents.vertices.size() * sizeof(float) / sizeOfCookedVertex);
+      range.numberOfVertices = mesh->mNumVertices;
+      range.firstIndex       = static_cast<std::uint32_t>(contents.indices.size());
+      range.indexOfMaterial  = mesh->mMaterialIndex;
+
+      for (unsigned int j = 0; j < mesh->mNumVertices; j++)
+      {
+         // Only the first set of texture coordinates is kept, like in ModelLoader::processVertices
+         bool  hasTexCoords = mesh->HasTextureCoords(0);
+         float vertex[]     = {mesh->mVertices[j].x, mesh->mVertices[j].y, mesh->mVertices[j].z,
+                               mesh->mNormals[j].x, mesh->mNormals[j].y, mesh->mNormals[j].z,
+                               hasTexCoords ? mesh->mTextureCoords[0][j].x : 0.0f, hasTexCoords ? mesh->mTextureCoords[0][j].y : 0.0f};
+         contents.vertices.insert(contents.vertices.end(), vertex, vertex + 8);
+      }
+
+      for (unsigned int j = 0; j < mesh->mNumFaces; j++)
+      {
+         const aiFace& face = mesh->mFaces[j];
+         contents.indices.insert(contents.indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+      }
+
+      range.numberOfIndices = static_cast<std::uint32_t>(contents.indices.size()) - range.firstIndex;
+      contents.meshes.push_back(range);
+   }
+
+   for (unsigned int i = 0; i < node->mNumChildren; i++)
+   {
+      cookNodeHierarchyRecursively(node->mChildren[i], scene, contents);
+   }
+}
+
+CookedMaterial cookMaterial(const aiMaterial* material, CookedMeshContents& contents)
+{
+   CookedMaterial cookedMaterial = {};
+
+   // Same types and same rules as ModelLoader::processMaterial, which only uses the first texture of each type
+   std::array<aiTextureType, numberOfCookedTextureTypes> texTypes = {aiTextureType_AMBIENT,
+                                                                      aiTextureType_EMISSIVE,
+                                                                      aiTextureType_DIFFUSE,
+                                                                      aiTextureType_SPECULAR};
+
+   for (unsigned int i = 0; i < numberOfCookedTextureTypes; ++i)
+   {
+      cookedMaterial.textureNames[i] = noCookedTexture;
+
+      if (material->GetTextureCount(texTypes[i]) > 0)
+      {
+         aiString texFilename;
+         material->GetTexture(texTypes[i], 0, &texFilename);
+         cookedMaterial.textureNames[i] = addCookedTextureName(contents, texFilename.C_Str());
+      }
+   }
+
+   // Colors that the material doesn't define are left black, just like in ModelLoader::processMaterial
+   aiColor3D color(0.0f, 0.0f, 0.0f);
+   auto      storeColor = [&color](float* cookedColor)
+   {
+      cookedColor[0] = color.r;
+      cookedColor[1] = color.g;
+      cookedColor[2] = color.b;
+   };
+
+   if (material->Get(AI_MATKEY_COLOR_AMBIENT, color)  == AI_SUCCESS) { storeColor(cookedMaterial.ambientColor); }
+   if (material->Get(AI_MATKEY_COLOR_EMISSIVE, color) == AI_SUCCESS) { storeColor(cookedMaterial.emissiveColor); }
+   if (material->Get(AI_MATKEY_COLOR_DIFFUSE, color)  == AI_SUCCESS) { storeColor(cookedMaterial.diffuseColor); }
+   if (material->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS) { storeColor(cookedMaterial.specularColor); }
+
+   float shininess = 0.0f;
+   if (material->Get(AI_MATKEY_SHININESS, shininess)  == AI_SUCCESS) { cookedMaterial.shininess = shininess; }
+
+   return cookedMaterial;
+}
+
+bool importModel(const std::string& modelFilePath, CookedMeshContents& contents)
+{
+   Assimp::Importer importer;
+   const aiScene* scene = importer.ReadFile(modelFilePath, aiProcess_Triangulate | aiProcess_FlipUVs);
+
+   if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+   {
+      std::cout << "Error - importModel - The error below occurred while importing this model: " << modelFilePath << "\n" << importer.GetErrorString() << "\n";
+      return false;
+   }
+
+   contents = CookedMeshContents();
+   cookNodeHierarchyRecursively(scene->mRootNode, scene, contents);
+
+   for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+   {
+      contents.materials.push_back(cookMaterial(scene->mMaterials[i], contents));
+   }
+
+   return true;
+}
+
+bool cookModel(const std::string& modelFilePath, const std::string& cookedFilePath)
+{
+   CookedMeshContents contents;
+   return importModel(modelFilePath, contents) && writeCookedMeshFile(cookedFilePath, contents);
+}
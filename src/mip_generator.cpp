@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "float_lanes.h"
+#include "mip_generator.h"
+
+// The Kaiser filter covers 3 texels of the next level on each side of the texel being generated, like the one of NVIDIA Texture Tools
+const float kaiserWidth = 3.0f;
+const float kaiserAlpha = 4.0f;
+
+// Rows of each level are split into this many bands per thread, so that threads that finish early can take more work
+const unsigned int bandsPerThread = 4;
+
+// The texels of a source row that a texel of the next level is made of, with the weight of each one
+struct FilterTaps
+{
+   std::vector<int>   indices;
+   std::vector<float> weights;
+};
+
+// Conversions between sRGB and linear values, built once since they are the same for every texture
+struct SRGBTables
+{
+   SRGBTables()
+   {
+      for (unsigned int i = 0; i < 256; ++i)
+      {
+         float value = i / 255.0f;
+         toLinear[i] = (value <= 0.04045f) ? (value / 12.92f) : std::pow((value + 0.055f) / 1.055f, 2.4f);
+      }
+
+      // A linear value is encoded as the sRGB value whose linear value is closest to it
+      for (unsigned int i = 0; i < 255; ++i)
+      {
+         thresholds[i] = 0.5f * (toLinear[i] + toLinear[i + 1]);
+      }
+
+      // Searching the thresholds is slow, so the range of linear values is split into buckets that start the search at most a threshold or two away
+      for (unsigned int i = 0; i < numberOfBuckets; ++i)
+      {
+         firstValueOfBucket[i] = static_cast<unsigned char>(std::upper_bound(thresholds, thresholds + 255, static_cast<float>(i) / numberOfBuckets) - thresholds);
+      }
+   }
+
+   static const unsigned int numberOfBuckets = 4096;
+
+   float         toLinear[256];
+   float         thresholds[255];
+   unsigned char firstValueOfBucket[numberOfBuckets];
+};
+
+const SRGBTables& getSRGBTables()
+{
+   static const SRGBTables tables;
+   return tables;
+}
+
+unsigned char encodeSRGB(const SRGBTables& tables, float linearValue)
+{
+   linearValue = std::min(std::max(linearValue, 0.0f), 1.0f);
+
+   unsigned int value = tables.firstValueOfBucket[std::min(static_cast<unsigned int>(linearValue * SRGBTables::numberOfBuckets), SRGBTables::numberOfBuckets - 1)];
+   while ((value < 255) && (linearValue >= tables.thresholds[value]))
+   {
+      ++value;
+   }
+
+   return static_cast<unsigned char>(value);
+}
+
+unsigned char encodeLinear(float value)
+{
+   return static_cast<unsigned char>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+float sinc(float x)
+{
+   const float pi = 3.14159265358979f;
+   return (std::abs(x) < 1e-5f) ? 1.0f : (std::sin(pi * x) / (pi * x));
+}
+
+// Modified Bessel function of the first kind of order 0, which defines the Kaiser window
+float besselI0(float x)
+{
+   float sum  = 1.0f;
+   float term = 1.0f;
+   for (unsigned int k = 1; k < 20; ++k)
+   {
+      term *= (x / (2.0f * k)) * (x / (2.0f * k));
+      sum  += term;
+   }
+
+   return sum;
+}
+
+float kaiserWindow(float x)
+{
+   return (std::abs(x) > 1.0f) ? 0.0f : (besselI0(kaiserAlpha * std::sqrt(1.0f - x * x)) / besselI0(kaiserAlpha));
+}
+
+// Returns the source texels of texel dstIndex of the next level, before they are clamped to the edges of the source
+FilterTaps computeFilterTaps(unsigned int srcSize, unsigned int dstSize, MipFilter filter, unsigned int dstIndex)
+{
+   float scale   = static_cast<float>(srcSize) / dstSize;
+   float center  = (dstIndex + 0.5f) * scale;
+   float support = (filter == MipFilter::box) ? (0.5f * scale) : (kaiserWidth * scale);
+
+   FilterTaps taps;
+   float      sumOfWeights = 0.0f;
+   for (int s = static_cast<int>(std::floor(center - support)); s < static_cast<int>(std::ceil(center + support)); ++s)
+   {
+      float weight;
+      if (filter == MipFilter::box)
+      {
+         // Area of the source texel that is covered by the footprint of the texel of the next level
+         weight = std::max(0.0f, std::min(s + 1.0f, center + support) - std::max(static_cast<float>(s), center - support));
+      }
+      else
+      {
+         float t = (s + 0.5f - center) / scale;
+         weight  = sinc(t) * kaiserWindow(t / kaiserWidth);
+      }
+
+      if (weight != 0.0f)
+      {
+         taps.indices.push_back(s);
+         taps.weights.push_back(weight);
+         sumOfWeights += weight;
+      }
+   }
+
+   for (float& weight : taps.weights)
+   {
+      weight /= sumOfWeights;
+   }
+
+   return taps;
+}
+
+// Number of floats to allocate for a row of the given number of texels, so that whole FloatLanes can be loaded and stored past its end
+std::size_t getPaddedSize(std::size_t size)
+{
+   return ((size + floatLanesWidth - 1) / floatLanesWidth + 1) * floatLanesWidth;
+}
+
+// Filters a row of a single channel horizontally into the row of the next level
+// When the row is exactly halved, every texel of the next level uses the same weights, so the source is split into its even and odd texels
+// and each tap becomes a contiguous load of FloatLanes; other sizes (odd ones) use the weights of each texel
+void filterRowHorizontally(const float*                   src,
+                           unsigned int                   srcWidth,
+                           float*                         dst,
+                           unsigned int                   dstWidth,
+                           const std::vector<FilterTaps>& tapsOfColumns,
+                           std::vector<float>&            evenTexels,
+                           std::vector<float>&            oddTexels)
+{
+   if (srcWidth == dstWidth)
+   {
+      std::copy(src, src + srcWidth, dst);
+      return;
+   }
+
+   if (srcWidth != 2 * dstWidth)
+   {
+      for (unsigned int x = 0; x < dstWidth; ++x)
+      {
+         const FilterTaps& taps  = tapsOfColumns[x];
+         float             value = 0.0f;
+         for (std::size_t k = 0; k < taps.indices.size(); ++k)
+         {
+            value += taps.weights[k] * src[std::min(std::max(taps.indices[k], 0), static_cast<int>(srcWidth) - 1)];
+         }
+         dst[x] = value;
+      }
+      return;
+   }
+
+   // The taps of texel 0 are relative to texel 2 * x of the source for every other texel x
+   const FilterTaps& taps    = tapsOfColumns[0];
+   int               margin  = (std::max(-taps.indices.front(), taps.indices.back()) + 1) / 2 + 1;
+   std::size_t       padded  = getPaddedSize(dstWidth + 2 * margin);
+   evenTexels.resize(padded);
+   oddTexels.resize(padded);
+   for (int k = 0; k < static_cast<int>(padded); ++k)
+   {
+      int x = k - margin;
+      evenTexels[k] = src[std::min(std::max(2 * x, 0), static_cast<int>(srcWidth) - 1)];
+      oddTexels[k]  = src[std::min(std::max(2 * x + 1, 0), static_cast<int>(srcWidth) - 1)];
+   }
+
+   for (unsigned int x = 0; x < dstWidth; x += floatLanesWidth)
+   {
+      FloatLanes value = broadcastLanes(0.0f);
+      for (std::size_t k = 0; k < taps.indices.size(); ++k)
+      {
+         // Texel 2 * x + j is even texel x + j / 2 when j is even, and odd texel x + (j - 1) / 2 when it's odd
+         int          j       = taps.indices[k];
+         const float* texels  = ((j & 1) == 0) ? evenTexels.data() : oddTexels.data();
+         int          offset  = ((j & 1) == 0) ? (j / 2) : ((j - 1) / 2);
+         value = value + broadcastLanes(taps.weights[k]) * loadLanes(texels + margin + x + offset);
+      }
+      storeLanes(dst + x, value);
+   }
+}
+
+// Generates rows [firstRow, lastRow) of the next level
+void generateRows(const unsigned char*           srcTexels,
+                  unsigned int                   srcWidth,
+                  unsigned int                   srcHeight,
+                  MipLevel&                      dst,
+                  const std::vector<FilterTaps>& tapsOfRows,
+                  const std::vector<FilterTaps>& tapsOfColumns,
+                  TextureColorSpace              colorSpace,
+                  unsigned int                   firstRow,
+                  unsigned int                   lastRow)
+{
+   const SRGBTables& tables    = getSRGBTables();
+   bool              isSRGB    = (colorSpace == TextureColorSpace::sRGB);
+   std::size_t       srcPadded = getPaddedSize(srcWidth);
+   std::size_t       dstPadded = getPaddedSize(dst.width);
+
+   // Each channel is kept in its own row, so that FloatLanes hold the same channel of consecutive texels
+   // Consecutive rows of the next level share most of their source rows, so the source rows are converted to floats once and kept in a ring
+   std::size_t maxNumberOfTaps = 0;
+   for (unsigned int y = firstRow; y < lastRow; ++y)
+   {
+      maxNumberOfTaps = std::max(maxNumberOfTaps, tapsOfRows[y].indices.size());
+   }
+
+   std::size_t        sizeOfRing = maxNumberOfTaps + 2;
+   std::vector<float> linearRows(sizeOfRing * 4 * srcPadded);
+   std::vector<int>   rowsInRing(sizeOfRing, -1);
+   std::vector<float> filteredRow(4 * srcPadded);
+   std::vector<float> dstRow(4 * dstPadded);
+   std::vector<float> evenTexels;
+   std::vector<float> oddTexels;
+
+   for (unsigned int y = firstRow; y < lastRow; ++y)
+   {
+      // Vertical pass: every texel of the row uses the same weights, so whole FloatLanes are accumulated at a time
+      std::fill(filteredRow.begin(), filteredRow.end(), 0.0f);
+      const FilterTaps& taps = tapsOfRows[y];
+      for (std::size_t k = 0; k < taps.indices.size(); ++k)
+      {
+         int         srcY      = std::min(std::max(taps.indices[k], 0), static_cast<int>(srcHeight) - 1);
+         std::size_t slot      = static_cast<std::size_t>(srcY) % sizeOfRing;
+         float*      linearRow = &linearRows[slot * 4 * srcPadded];
+         if (rowsInRing[slot] != srcY)
+         {
+            const unsigned char* texels = srcTexels + 4 * static_cast<std::size_t>(srcY) * srcWidth;
+            for (unsigned int x = 0; x < srcWidth; ++x)
+            {
+               linearRow[0 * srcPadded + x] = isSRGB ? tables.toLinear[texels[4 * x + 0]] : (texels[4 * x + 0] / 255.0f);
+               linearRow[1 * srcPadded + x] = isSRGB ? tables.toLinear[texels[4 * x + 1]] : (texels[4 * x + 1] / 255.0f);
+               linearRow[2 * srcPadded + x] = isSRGB ? tables.toLinear[texels[4 * x + 2]] : (texels[4 * x + 2] / 255.0f);
+               linearRow[3 * srcPadded + x] = texels[4 * x + 3] / 255.0f;
+            }
+            rowsInRing[slot] = srcY;
+         }
+
+         FloatLanes weight = broadcastLanes(taps.weights[k]);
+         for (std::size_t i = 0; i < 4 * srcPadded; i += floatLanesWidth)
+         {
+            storeLanes(&filteredRow[i], loadLanes(&filteredRow[i]) + weight * loadLanes(linearRow + i));
+         }
+      }
+
+      // Horizontal pass
+      for (unsigned int c = 0; c < 4; ++c)
+      {
+         filterRowHorizontally(&filteredRow[c * srcPadded], srcWidth, &dstRow[c * dstPadded], dst.width, tapsOfColumns, evenTexels, oddTexels);
+      }
+
+      // The negative lobes of the Kaiser filter can ring past the range of a channel, so the values are clamped when they are encoded
+      unsigned char* dstTexels = &dst.rgbaTexels[4 * static_cast<std::size_t>(y) * dst.width];
+      for (unsigned int x = 0; x < dst.width; ++x)
+      {
+         dstTexels[4 * x + 0] = isSRGB ? encodeSRGB(tables, dstRow[0 * dstPadded + x]) : encodeLinear(dstRow[0 * dstPadded + x]);
+         dstTexels[4 * x + 1] = isSRGB ? encodeSRGB(tables, dstRow[1 * dstPadded + x]) : encodeLinear(dstRow[1 * dstPadded + x]);
+         dstTexels[4 * x + 2] = isSRGB ? encodeSRGB(tables, dstRow[2 * dstPadded + x]) : encodeLinear(dstRow[2 * dstPadded + x]);
+         dstTexels[4 * x + 3] = encodeLinear(dstRow[3 * dstPadded + x]);
+      }
+   }
+}
+
+std::vector<MipLevel> generateMipChain(const unsigned char* rgbaTexels,
+                                       unsigned int         width,
+                                       unsigned int         height,
+                                       MipFilter            filter,
+                                       TextureColorSpace    colorSpace,
+                                       ThreadPool*          threads)
+{
+   std::vector<MipLevel> levels;
+
+   const unsigned char* srcTexels = rgbaTexels;
+   unsigned int         srcWidth  = width;
+   unsigned int         srcHeight = height;
+   while ((srcWidth > 1) || (srcHeight > 1))
+   {
+      MipLevel dst;
+      dst.width  = std::max(srcWidth / 2, 1u);
+      dst.height = std::max(srcHeight / 2, 1u);
+      dst.rgbaTexels.resize(4 * static_cast<std::size_t>(dst.width) * dst.height);
+
+      std::vector<FilterTaps> tapsOfRows(dst.height);
+      std::vector<FilterTaps> tapsOfColumns(dst.width);
+      for (unsigned int y = 0; y < dst.height; ++y)
+      {
+         tapsOfRows[y] = computeFilterTaps(srcHeight, dst.height, filter, y);
+      }
+      for (unsigned int x = 0; x < dst.width; ++x)
+      {
+         tapsOfColumns[x] = computeFilterTaps(srcWidth, dst.width, filter, x);
+      }
+
+      unsigned int numberOfBands = threads ? std::min(dst.height, threads->getNumberOfThreads() * bandsPerThread) : 1;
+      if (numberOfBands <= 1)
+      {
+         generateRows(srcTexels, srcWidth, srcHeight, dst, tapsOfRows, tapsOfColumns, colorSpace, 0, dst.height);
+      }
+      else
+      {
+         // Each band writes to its own rows of the next level, so the bands don't need to be synchronized
+         for (unsigned int band = 0; band < numberOfBands; ++band)
+         {
+            unsigned int firstRow = static_cast<unsigned int>(static_cast<std::uint64_t>(dst.height) * band / numberOfBands);
+            unsigned int lastRow  = static_cast<unsigned int>(static_cast<std::uint64_t>(dst.height) * (band + 1) / numberOfBands);
+            threads->submit([srcTexels, srcWidth, srcHeight, &dst, &tapsOfRows, &tapsOfColumns, colorSpace, firstRow, lastRow]()
+            {
+               generateRows(srcTexels, srcWidth, srcHeight, dst, tapsOfRows, tapsOfColumns, colorSpace, firstRow, lastRow);
+            });
+         }
+         threads->waitUntilIdle();
+      }
+
+      levels.push_back(std::move(dst));
+      srcTexels = levels.back().rgbaTexels.data();
+      srcWidth  = levels.back().width;
+      srcHeight = levels.back().height;
+   }
+
+   return levels;
+}
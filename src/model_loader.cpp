@@ -1,175 +1,208 @@
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-
-#include <array>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
+#include "mesh_cooker.h"
 #include "model_loader.h"
-#include "texture_loader.h"
+
+// The vertices of a cooked file are given to OpenGL as they are, so they must have the same layout as Vertex
+static_assert(sizeof(Vertex) == sizeOfCookedVertex, "Vertex must have the same layout as the vertices of a cooked mesh file");
+static_assert(sizeof(unsigned int) == sizeof(std::uint32_t), "The indices of a cooked mesh file must be unsigned ints");
 
 std::shared_ptr<Model> ModelLoader::loadResource(const std::string& modelFilePath) const
 {
-   Assimp::Importer importer;
-   const aiScene* scene = importer.ReadFile(modelFilePath, aiProcess_Triangulate | aiProcess_FlipUVs);
-
-   if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+   StagedModel stagedModel;
+   if (!stageResource(modelFilePath, stagedModel))
    {
-      std::cout << "Error - ModelLoader::loadResource - The error below occurred while importing this model: " << modelFilePath << "\n" << importer.GetErrorString() << "\n";
       return nullptr;
    }
 
-   ResourceManager<Texture> texManager;
-   std::vector<Mesh>        meshes;
-   processNodeHierarchyRecursively(scene->mRootNode,
-                                   scene,
-                                   modelFilePath.substr(0, modelFilePath.find_last_of('/')),
-                                   texManager,
-                                   meshes);
+   TextureLoader texLoader;
+   for (StagedTexture& stagedTexture : stagedModel.textures)
+   {
+      texLoader.decodeTexture(stagedTexture.texFilePath, stagedTexture.decodedTexture);
+   }
 
-   return std::make_shared<Model>(std::move(meshes), std::move(texManager));
+   return loadResource(std::move(stagedModel));
 }
 
-void ModelLoader::processNodeHierarchyRecursively(const aiNode*             node,
-                                                  const aiScene*            scene,
-                                                  const std::string&        modelDir,
-                                                  ResourceManager<Texture>& texManager,
-                                                  std::vector<Mesh>&        meshes) const
+std::shared_ptr<Model> ModelLoader::loadResource(StagedModel&& stagedModel) const
 {
-   // Create a Mesh object for each mesh referenced by the current node
-   for (unsigned int i = 0; i < node->mNumMeshes; i++)
+   if (!stagedModel.wasStaged)
    {
-      // Note that nodes do not store meshes directly
-      // All the meshes are stored in the scene struct
-      // Nodes only contain indices that can be used to access meshes from said struct
-      aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-      meshes.emplace_back(processVertices(mesh),                                                           // Vertices
-                          processIndices(mesh),                                                            // Indices
-                          processMaterial(scene->mMaterials[mesh->mMaterialIndex], modelDir, texManager)); // Material textures and constants
+      return nullptr;
    }
 
-   // After we have processed all the meshes referenced by the current node, we recursively process its children
-   for (unsigned int i = 0; i < node->mNumChildren; i++)
+   // Textures that could not be decoded are left out, just like the ones that could not be loaded before staging existed
+   ResourceManager<Texture> texManager;
+   for (const StagedTexture& stagedTexture : stagedModel.textures)
    {
-      processNodeHierarchyRecursively(node->mChildren[i],
-                                      scene,
-                                      modelDir,
-                                      texManager,
-                                      meshes);
+      if (stagedTexture.decodedTexture.hasTexels())
+      {
+         texManager.loadResource<TextureLoader>(stagedTexture.texFilename, stagedTexture.decodedTexture);
+      }
    }
+
+   return createModel(stagedModel, std::move(texManager));
 }
 
-std::vector<Vertex> ModelLoader::processVertices(const aiMesh* mesh) const
+std::shared_ptr<Model> ModelLoader::loadResource(StagedModel&& stagedModel, TextureStreamer& texStreamer) const
 {
-   std::vector<Vertex> vertices;
-   vertices.reserve(mesh->mNumVertices);
+   if (!stagedModel.wasStaged)
+   {
+      return nullptr;
+   }
 
-   // Loop over the vertices of the mesh
-   for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+   ResourceManager<Texture> texManager;
+   for (StagedTexture& stagedTexture : stagedModel.textures)
    {
-      // Store the position, the normal and the texture coordinates of the current vertex
-      // Note that a vertex can contain up to 8 different sets of texture coordinates
-      // We make the assumption that we will only use models that have a single set of texture coordinates per vertex
-      // For this reason, we only check for the existence of the first set
-      vertices.emplace_back(glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z),                                          // Position
-                            glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z),                                             // Normal
-                            mesh->HasTextureCoords(0) ? glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y) : glm::vec2(0.0f)); // Texture coordinates
+      if (stagedTexture.decodedTexture.hasTexels())
+      {
+         texManager.loadResource<TextureLoader>(stagedTexture.texFilename, std::move(stagedTexture.decodedTexture), texStreamer);
+      }
    }
 
-   return vertices;
+   return createModel(stagedModel, std::move(texManager));
 }
 
-std::vector<unsigned int> ModelLoader::processIndices(const aiMesh* mesh) const
+std::shared_ptr<Model> ModelLoader::createModel(StagedModel& stagedModel, ResourceManager<Texture>&& texManager) const
 {
-   // We assume that the mesh is made out of triangles, which is why we multiply the number of faces by 3 when reserving space in the indices vector
-   // This will always be true if the aiProcess_Triangulate flag continues to be used when loading the model
-   std::vector<unsigned int> indices;
-   indices.reserve(mesh->mNumFaces * 3);
-
-   // Loop over the faces of the mesh
-   for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+   // The vertices and indices are uploaded straight from the mapped file, or from the imported contents
+   std::vector<Mesh> meshes;
+   meshes.reserve(stagedModel.meshes.size());
+   for (const StagedMesh& mesh : stagedModel.meshes)
    {
-      aiFace face = mesh->mFaces[i];
-
-      // Store the indices of the current face
-      for (unsigned int j = 0; j < face.mNumIndices; j++)
-      {
-         indices.push_back(face.mIndices[j]);
-      }
+      meshes.emplace_back(mesh.vertices,                           // Vertices
+                          mesh.numVertices,
+                          mesh.indices,                            // Indices
+                          mesh.numIndices,
+                          processStagedMaterial(mesh, texManager)); // Material textures and constants
    }
 
-   return indices;
+   // The model owns copies of everything it needs, so the cooked file can be unmapped and the decoded pixels can be freed
+   stagedModel = StagedModel();
+
+   return std::make_shared<Model>(std::move(meshes), std::move(texManager));
 }
 
-Material ModelLoader::processMaterial(const aiMaterial*         material,
-                                      const std::string&        modelDir,
-                                      ResourceManager<Texture>& texManager) const
+bool ModelLoader::stageResource(const std::string& modelFilePath, StagedModel& stagedModel) const
 {
-   // Load the textures
-   std::vector<MaterialTexture>                                        materialTextures;
-   std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)> materialTextureAvailabilities;
+   auto start = std::chrono::steady_clock::now();
 
-   // The material can consist of many textures and constants of different types
-   // We make the assumption that we will only use models that have ambient, emissive, diffuse and specular textures or constants
-   // A constant is only used during rendering if its corresponding texture is not available
-   std::array<aiTextureType, 4> texTypes = {aiTextureType_AMBIENT,
-                                            aiTextureType_EMISSIVE,
-                                            aiTextureType_DIFFUSE,
-                                            aiTextureType_SPECULAR};
+   stagedModel               = StagedModel();
+   stagedModel.modelFilePath = modelFilePath;
 
-   for (aiTextureType texType : texTypes)
+   std::string cookedFilePath = getPathOfCookedMeshFile(modelFilePath);
+   if (!cookedMeshFileIsUpToDate(cookedFilePath, modelFilePath))
    {
-      // Get the number of textures of the current type
-      unsigned int texCount = material->GetTextureCount(texType);
+      stagedModel.wasCooked = cookModel(modelFilePath, cookedFilePath);
+   }
 
-      if (texCount > 0)
+   stagedModel.cookedFile = std::make_unique<CookedMeshFile>();
+   if (stagedModel.cookedFile->open(cookedFilePath))
+   {
+      const CookedMeshFile& cookedFile = *stagedModel.cookedFile;
+      for (std::uint32_t i = 0; i < cookedFile.getNumberOfMeshes(); ++i)
       {
-         if (texCount > 1)
+         const CookedMeshRange& range = cookedFile.getMesh(i);
+         StagedMesh             mesh;
+         mesh.vertices    = cookedFile.getVertices(range);
+         mesh.numVertices = range.numberOfVertices;
+         mesh.indices     = cookedFile.getIndices(range);
+         mesh.numIndices  = range.numberOfIndices;
+         mesh.material    = cookedFile.getMaterial(range.indexOfMaterial);
+         for (unsigned int j = 0; j < numberOfCookedTextureTypes; ++j)
          {
-            std::cout << "Warning - ModelLoader::processMaterial - Mesh uses more than one texture of the following type: " << texType << ". Only the first texture will be loaded." << "\n";
+            mesh.texFilenames[j] = cookedFile.getTextureName(mesh.material, static_cast<CookedTextureType>(j));
          }
 
-         // Compose the name of the sampler2D uniform that should exist in the shader,
-         // and set the availability of the current texture type to true so that a texture of said type is used during rendering instead of its corresponding constant
-         std::string uniformName;
-         switch (texType)
+         stagedModel.meshes.push_back(std::move(mesh));
+      }
+   }
+   else
+   {
+      std::cout << "Warning - ModelLoader::stageResource - The cooked version of this model could not be loaded, so it will be imported: " << modelFilePath << "\n";
+
+      stagedModel.cookedFile.reset();
+      if (!importModel(modelFilePath, stagedModel.importedContents))
+      {
+         return false;
+      }
+
+      const CookedMeshContents& contents = stagedModel.importedContents;
+      for (const CookedMeshRange& range : contents.meshes)
+      {
+         StagedMesh mesh;
+         mesh.vertices    = contents.vertices.data() + static_cast<std::size_t>(range.firstVertex) * (sizeOfCookedVertex / sizeof(float));
+         mesh.numVertices = range.numberOfVertices;
+         mesh.indices     = contents.indices.data() + range.firstIndex;
+         mesh.numIndices  = range.numberOfIndices;
+         mesh.material    = contents.materials[range.indexOfMaterial];
+         for (unsigned int j = 0; j < numberOfCookedTextureTypes; ++j)
          {
-         case aiTextureType_AMBIENT:
-            uniformName = "ambientTex";
-            materialTextureAvailabilities[static_cast<unsigned int>(MaterialTextureTypes::ambient)] = true;
-            break;
-         case aiTextureType_EMISSIVE:
-            uniformName = "emissiveTex";
-            materialTextureAvailabilities[static_cast<unsigned int>(MaterialTextureTypes::emissive)] = true;
-            break;
-         case aiTextureType_DIFFUSE:
-            uniformName = "diffuseTex";
-            materialTextureAvailabilities[static_cast<unsigned int>(MaterialTextureTypes::diffuse)] = true;
-            break;
-         case aiTextureType_SPECULAR:
-            uniformName = "specularTex";
-            materialTextureAvailabilities[static_cast<unsigned int>(MaterialTextureTypes::specular)] = true;
-            break;
+            if (mesh.material.textureNames[j] != noCookedTexture)
+            {
+               mesh.texFilenames[j] = contents.textureNames.c_str() + mesh.material.textureNames[j];
+            }
          }
 
-         aiString texFilename;
-         material->GetTexture(texType, 0, &texFilename);
+         stagedModel.meshes.push_back(std::move(mesh));
+      }
+   }
 
-         // Note that we assume that the textures are in the same directory as the model
-         materialTextures.emplace_back(texManager.loadResource<TextureLoader>(texFilename.C_Str(), modelDir + '/' + texFilename.C_Str()), uniformName);
+   // List each texture once, even if it's used by several meshes
+   // Note that we assume that the textures are in the same directory as the model
+   std::string modelDir = modelFilePath.substr(0, modelFilePath.find_last_of('/'));
+   for (const StagedMesh& mesh : stagedModel.meshes)
+   {
+      for (const std::string& texFilename : mesh.texFilenames)
+      {
+         bool isListed = std::any_of(stagedModel.textures.cbegin(), stagedModel.textures.cend(),
+                                     [&texFilename](const StagedTexture& stagedTexture) { return stagedTexture.texFilename == texFilename; });
+         if (!texFilename.empty() && !isListed)
+         {
+            StagedTexture stagedTexture;
+            stagedTexture.texFilename = texFilename;
+            stagedTexture.texFilePath = modelDir + '/' + texFilename;
+            stagedModel.textures.push_back(std::move(stagedTexture));
+         }
       }
    }
 
-   // Load the constants
-   aiColor3D color(0.0f, 0.0f, 0.0f);
-   float     shininess = 0.0f;
+   stagedModel.wasStaged                 = true;
+   stagedModel.secondsSpentStagingMeshes = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   return true;
+}
+
+Material ModelLoader::processStagedMaterial(const StagedMesh&         mesh,
+                                            ResourceManager<Texture>& texManager) const
+{
+   std::vector<MaterialTexture>                                        materialTextures;
+   std::bitset<static_cast<unsigned int>(MaterialTextureTypes::count)> materialTextureAvailabilities;
+
+   // The cooked texture types are stored in the same order as MaterialTextureTypes
+   std::array<const char*, numberOfCookedTextureTypes> uniformNames = {"ambientTex",
+                                                                       "emissiveTex",
+                                                                       "diffuseTex",
+                                                                       "specularTex"};
+
+   for (unsigned int i = 0; i < numberOfCookedTextureTypes; ++i)
+   {
+      const std::string& texFilename = mesh.texFilenames[i];
+      if (!texFilename.empty())
+      {
+         materialTextureAvailabilities[i] = true;
+         materialTextures.emplace_back(texManager.containsResource(texFilename) ? texManager.getResource(texFilename) : nullptr, uniformNames[i]);
+      }
+   }
 
-   MaterialConstants materialConstants(((material->Get(AI_MATKEY_COLOR_AMBIENT, color)  == AI_SUCCESS) ? glm::vec3(color.r, color.g, color.b) : glm::vec3(0.0f)),
-                                       ((material->Get(AI_MATKEY_COLOR_EMISSIVE, color) == AI_SUCCESS) ? glm::vec3(color.r, color.g, color.b) : glm::vec3(0.0f)),
-                                       ((material->Get(AI_MATKEY_COLOR_DIFFUSE, color)  == AI_SUCCESS) ? glm::vec3(color.r, color.g, color.b) : glm::vec3(0.0f)),
-                                       ((material->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS) ? glm::vec3(color.r, color.g, color.b) : glm::vec3(0.0f)),
-                                       ((material->Get(AI_MATKEY_SHININESS, shininess)  == AI_SUCCESS) ? shininess : 0.0f));
+   const CookedMaterial& material = mesh.material;
+   MaterialConstants materialConstants(glm::vec3(material.ambientColor[0], material.ambientColor[1], material.ambientColor[2]),
+                                       glm::vec3(material.emissiveColor[0], material.emissiveColor[1], material.emissiveColor[2]),
+                                       glm::vec3(material.diffuseColor[0], material.diffuseColor[1], material.diffuseColor[2]),
+                                       glm::vec3(material.specularColor[0], material.specularColor[1], material.specularColor[2]),
+                                       material.shininess);
 
-   // TODO: Could we take advantage of move semantics here?
    return Material(materialTextures,
                    materialTextureAvailabilities,
                    materialConstants);
@@ -0,0 +1,134 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "multi_ball_simulation.h"
+
+// Simulates tables with thousands of balls and reports how long each step takes, to check that the cost grows linearly with the number of balls
+// The tables grow with the number of balls, so that every table is as crowded as the others
+// Usage: teapong_multi_ball_benchmark [numberOfBalls]...   (defaults to 1000 10000 100000)
+
+// Counts the pairs of balls that overlap by testing every pair, which is only practical for small numbers of balls
+std::size_t countOverlappingBallsByTestingEveryPair(const std::vector<BallState>& balls)
+{
+   std::size_t numberOfOverlappingPairs = 0;
+   for (std::size_t i = 0; i < balls.size(); ++i)
+   {
+      for (std::size_t j = i + 1; j < balls.size(); ++j)
+      {
+         glm::vec2 vecBetweenCenters = glm::vec2(balls[j].position - balls[i].position);
+         float     minDistance       = balls[i].radius + balls[j].radius;
+         if (glm::dot(vecBetweenCenters, vecBetweenCenters) < minDistance * minDistance)
+         {
+            ++numberOfOverlappingPairs;
+         }
+      }
+   }
+
+   return numberOfOverlappingPairs;
+}
+
+std::size_t countOverlappingBallsWithSpatialHash(const std::vector<BallState>& balls, float cellSize)
+{
+   SpatialHash spatialHash(cellSize);
+   for (const BallState& ball : balls)
+   {
+      spatialHash.insert(glm::vec2(ball.position) - glm::vec2(ball.radius), glm::vec2(ball.position) + glm::vec2(ball.radius));
+   }
+
+   std::vector<std::pair<std::uint32_t, std::uint32_t>> candidatePairs;
+   spatialHash.findCandidatePairs(candidatePairs);
+
+   std::size_t numberOfOverlappingPairs = 0;
+   for (const std::pair<std::uint32_t, std::uint32_t>& pair : candidatePairs)
+   {
+      glm::vec2 vecBetweenCenters = glm::vec2(balls[pair.second].position - balls[pair.first].position);
+      float     minDistance       = balls[pair.first].radius + balls[pair.second].radius;
+      if (glm::dot(vecBetweenCenters, vecBetweenCenters) < minDistance * minDistance)
+      {
+         ++numberOfOverlappingPairs;
+      }
+   }
+
+   return numberOfOverlappingPairs;
+}
+
+int main(int argc, char* argv[])
+{
+   std::vector<std::size_t> numbersOfBalls;
+   for (int i = 1; i < argc; ++i)
+   {
+      numbersOfBalls.push_back(std::strtoul(argv[i], nullptr, 10));
+   }
+
+   if (numbersOfBalls.empty())
+   {
+      numbersOfBalls = {1000, 10000, 100000};
+   }
+
+   float radiusOfBalls  = 1.0f;
+   float areaPerBall    = 40.0f;
+   float deltaTime      = 1.0f / 240.0f;
+   int   numberOfSteps  = 240;
+
+   std::cout << std::setw(10) << "Balls" << std::setw(14) << "us/step" << std::setw(14) << "ns/ball" << std::setw(14) << "pairs/step" << std::setw(14) << "contacts/step" << "\n";
+
+   for (std::size_t numberOfBalls : numbersOfBalls)
+   {
+      // Keep the proportions of the table of a match, and put the paddles near the ends of the table
+      MatchConfiguration config;
+      float              areaOfTable = areaPerBall * numberOfBalls;
+      config.verticalRange           = std::sqrt(areaOfTable * 0.6f);
+      config.horizontalRange         = config.verticalRange / 0.6f;
+
+      PaddleState leftPaddle  = config.initialLeftPaddle;
+      PaddleState rightPaddle = config.initialRightPaddle;
+      leftPaddle.position.x   = -config.horizontalRange / 2.0f + 5.0f;
+      rightPaddle.position.x  =  config.horizontalRange / 2.0f - 5.0f;
+
+      MultiBallSimulation simulation(config, radiusOfBalls, numberOfBalls);
+      simulation.spawnBalls(numberOfBalls);
+
+      // Let the balls that were spawned on top of each other separate before timing the steps
+      for (int step = 0; step < 10; ++step)
+      {
+         simulation.step(leftPaddle, rightPaddle, deltaTime);
+      }
+
+      std::uint64_t numberOfCandidatePairs = 0;
+      std::uint64_t numberOfContacts       = 0;
+
+      auto start = std::chrono::steady_clock::now();
+      for (int step = 0; step < numberOfSteps; ++step)
+      {
+         MultiBallEvents events  = simulation.step(leftPaddle, rightPaddle, deltaTime);
+         numberOfCandidatePairs += events.numberOfCandidatePairs;
+         numberOfContacts       += events.numberOfContactsBetweenBalls + events.numberOfContactsBetweenBallsAndPaddles;
+      }
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      std::cout << std::fixed << std::setprecision(1)
+                << std::setw(10) << numberOfBalls
+                << std::setw(14) << (seconds * 1e6 / numberOfSteps)
+                << std::setw(14) << (seconds * 1e9 / numberOfSteps / numberOfBalls)
+                << std::setw(14) << (static_cast<double>(numberOfCandidatePairs) / numberOfSteps)
+                << std::setw(14) << (static_cast<double>(numberOfContacts) / numberOfSteps) << "\n";
+
+      // Make sure that the broad phase doesn't miss any overlapping pairs
+      if (numberOfBalls <= 10000)
+      {
+         std::size_t expected = countOverlappingBallsByTestingEveryPair(simulation.getBalls());
+         std::size_t found    = countOverlappingBallsWithSpatialHash(simulation.getBalls(), 2.0f * radiusOfBalls);
+         if (expected != found)
+         {
+            std::cout << "Error - main - The spatial hash found " << found << " overlapping pairs instead of " << expected << "\n";
+            return -1;
+         }
+      }
+   }
+
+   return 0;
+}
@@ -0,0 +1,190 @@
+#include <cmath>
+
+#include "collision.h"
+#include "multi_ball_simulation.h"
+
+MultiBallSimulation::MultiBallSimulation(const MatchConfiguration& configuration, float radiusOfBalls, std::uint64_t seed)
+   : mConfiguration(configuration)
+   , mRadiusOfBalls(radiusOfBalls)
+   , mSpeedOfBalls(glm::length(configuration.initialBall.initialVelocity))
+   , mRandomNumberGeneratorState(seed)
+   , mBalls()
+   , mBroadPhase(2.0f * radiusOfBalls) // Each ball touches at most four cells
+   , mCandidatePairs()
+{
+
+}
+
+void MultiBallSimulation::spawnBalls(std::size_t numberOfBalls)
+{
+   float halfWidth  = mConfiguration.horizontalRange / 2.0f - mRadiusOfBalls;
+   float halfHeight = mConfiguration.verticalRange / 2.0f - mRadiusOfBalls;
+
+   mBalls.reserve(mBalls.size() + numberOfBalls);
+   for (std::size_t i = 0; i < numberOfBalls; ++i)
+   {
+      float angle = drawUniform(0.0f, 6.2831853f);
+
+      mBalls.push_back(mConfiguration.initialBall);
+      placeBall(mBalls.back(), glm::vec2(drawUniform(-halfWidth, halfWidth), drawUniform(-halfHeight, halfHeight)), glm::vec2(std::cos(angle), std::sin(angle)));
+   }
+}
+
+void MultiBallSimulation::removeBalls()
+{
+   mBalls.clear();
+}
+
+MultiBallEvents MultiBallSimulation::step(const PaddleState& leftPaddle, const PaddleState& rightPaddle, float deltaTime)
+{
+   MultiBallEvents events = {};
+
+   float rightBoundary = mConfiguration.horizontalRange / 2.0f;
+
+   // Move the balls, and serve the ones that left the table again
+   for (BallState& ball : mBalls)
+   {
+      ball.position += glm::vec3(glm::vec2(ball.velocity) * deltaTime, 0.0f);
+
+      if (ball.position.x - mRadiusOfBalls > rightBoundary)
+      {
+         ++events.pointsScoredByLeftPaddle;
+         serveBallFromCenter(ball);
+      }
+      else if (ball.position.x + mRadiusOfBalls < -rightBoundary)
+      {
+         ++events.pointsScoredByRightPaddle;
+         serveBallFromCenter(ball);
+      }
+
+      bounceBallOffWalls(ball);
+   }
+
+   // Broad phase: the paddles are inserted after the balls, so any ID past the last ball belongs to a paddle
+   mBroadPhase.clear();
+   for (const BallState& ball : mBalls)
+   {
+      mBroadPhase.insert(glm::vec2(ball.position) - glm::vec2(mRadiusOfBalls), glm::vec2(ball.position) + glm::vec2(mRadiusOfBalls));
+   }
+
+   std::uint32_t idOfLeftPaddle  = static_cast<std::uint32_t>(mBalls.size());
+   std::uint32_t idOfRightPaddle = idOfLeftPaddle + 1;
+   for (const PaddleState* paddle : {&leftPaddle, &rightPaddle})
+   {
+      glm::vec2 halfExtents(paddle->width / 2.0f, paddle->height / 2.0f);
+      mBroadPhase.insert(glm::vec2(paddle->position) - halfExtents, glm::vec2(paddle->position) + halfExtents);
+   }
+
+   mBroadPhase.findCandidatePairs(mCandidatePairs);
+   events.numberOfCandidatePairs = static_cast<unsigned int>(mCandidatePairs.size());
+
+   // Narrow phase
+   for (const std::pair<std::uint32_t, std::uint32_t>& pair : mCandidatePairs)
+   {
+      if (pair.first >= idOfLeftPaddle)
+      {
+         // The paddles never collide with each other
+         continue;
+      }
+
+      BallState& ball = mBalls[pair.first];
+
+      if (pair.second >= idOfLeftPaddle)
+      {
+         const PaddleState& paddle = (pair.second == idOfRightPaddle) ? rightPaddle : leftPaddle;
+
+         glm::vec2 vecFromCenterOfCircleToPointOfCollision;
+         if (circleAndAABBCollided(ball, paddle, vecFromCenterOfCircleToPointOfCollision))
+         {
+            resolveCollisionBetweenBallAndPaddle(ball, paddle, vecFromCenterOfCircleToPointOfCollision);
+            ++events.numberOfContactsBetweenBallsAndPaddles;
+         }
+      }
+      else
+      {
+         BallState& otherBall = mBalls[pair.second];
+
+         glm::vec2 vecBetweenCenters = glm::vec2(otherBall.position - ball.position);
+         float     minDistance       = 2.0f * mRadiusOfBalls;
+         if (glm::dot(vecBetweenCenters, vecBetweenCenters) < minDistance * minDistance)
+         {
+            resolveCollisionBetweenBalls(ball, otherBall);
+            ++events.numberOfContactsBetweenBalls;
+         }
+      }
+   }
+
+   // Pushing balls apart can push them into the walls
+   if (events.numberOfContactsBetweenBalls != 0)
+   {
+      for (BallState& ball : mBalls)
+      {
+         bounceBallOffWalls(ball);
+      }
+   }
+
+   return events;
+}
+
+const std::vector<BallState>& MultiBallSimulation::getBalls() const
+{
+   return mBalls;
+}
+
+void MultiBallSimulation::serveBallFromCenter(BallState& ball)
+{
+   // Use the same four diagonals as the serves of a match
+   placeBall(ball, glm::vec2(0.0f), glm::vec2(calculateServeVelocity(ball, drawServeDirection(mRandomNumberGeneratorState))));
+}
+
+void MultiBallSimulation::placeBall(BallState& ball, const glm::vec2& position, const glm::vec2& direction) const
+{
+   ball.position = glm::vec3(position, mConfiguration.initialBall.position.z);
+   ball.velocity = glm::vec3(glm::normalize(direction) * mSpeedOfBalls, 0.0f);
+   ball.radius   = mRadiusOfBalls;
+}
+
+float MultiBallSimulation::drawUniform(float minValue, float maxValue)
+{
+   float uniform = static_cast<float>(drawRandomNumber(mRandomNumberGeneratorState) >> 40) / static_cast<float>(1 << 24);
+   return minValue + uniform * (maxValue - minValue);
+}
+
+void MultiBallSimulation::bounceBallOffWalls(BallState& ball) const
+{
+   float topBoundary = mConfiguration.verticalRange / 2.0f - mRadiusOfBalls;
+
+   // Reflect the part of the motion that went past the wall, like the sweep of a match does
+   if (ball.position.y > topBoundary)
+   {
+      ball.position.y = glm::max(2.0f * topBoundary - ball.position.y, -topBoundary);
+      bounceBallOffWall(ball);
+   }
+   else if (ball.position.y < -topBoundary)
+   {
+      ball.position.y = glm::min(-2.0f * topBoundary - ball.position.y, topBoundary);
+      bounceBallOffWall(ball);
+   }
+}
+
+void MultiBallSimulation::resolveCollisionBetweenBalls(BallState& a, BallState& b) const
+{
+   glm::vec2 vecBetweenCenters = glm::vec2(b.position - a.position);
+   float     distance          = glm::length(vecBetweenCenters);
+
+   // Balls that are exactly on top of each other are pushed apart horizontally
+   glm::vec2 normal = (distance > 0.0f) ? (vecBetweenCenters / distance) : glm::vec2(1.0f, 0.0f);
+
+   // The balls have the same mass, so an elastic collision swaps the components of their velocities along the normal
+   float speedAlongNormal = glm::dot(glm::vec2(b.velocity - a.velocity), normal);
+   if (speedAlongNormal < 0.0f)
+   {
+      a.velocity += glm::vec3(normal * speedAlongNormal, 0.0f);
+      b.velocity -= glm::vec3(normal * speedAlongNormal, 0.0f);
+   }
+
+   // Move each ball half of the way out of the other one
+   float halfPenetration = (2.0f * mRadiusOfBalls - distance) / 2.0f;
+   a.position -= glm::vec3(normal * halfPenetration, 0.0f);
+   b.position += glm::vec3(normal * halfPenetration, 0.0f);
+}
@@ -0,0 +1,495 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include "netplay.h"
+
+// Every packet holds, in little-endian order:
+// the magic number, the session identifier, the current frame of the sender, its frame advantage in 1/256ths of a frame,
+// the number of remote inputs it has received, the frame of its first input, the number of inputs, one byte per input,
+// and the frame and checksum of its latest confirmed state (or noChecksum)
+const std::uint32_t netplayMagicNumber             = 0x504E5054; // "TPNP"
+const std::size_t   sizeOfPacketHeader             = 25;
+const std::size_t   sizeOfPacketChecksum           = 12;
+const std::size_t   maxNumberOfInputsPerPacket     = 255;
+const std::size_t   maxSizeOfDatagram              = 1500;
+const std::uint32_t noChecksum                     = 0xFFFFFFFF;
+
+// A checksum is taken every quarter of a second at 240 frames per second, and the latest ones are kept to compare them with the remote ones when they arrive
+const std::uint32_t framesBetweenChecksums         = 60;
+const std::size_t   numberOfChecksumsKept          = 32;
+
+// The frame advantages are averaged because a single packet can be delayed by jitter
+// Waits are only recommended every half a second, so that the average can settle after a wait before the next one is decided
+const float         weightOfNewestFrameAdvantage   = 0.05f;
+const unsigned int  framesBetweenTimeSyncs         = 120;
+const unsigned int  maxNumberOfFramesWaitedAtOnce  = 8;
+
+void appendUint32(std::vector<std::uint8_t>& bytes, std::uint32_t value)
+{
+   for (int i = 0; i < 4; ++i)
+   {
+      bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+   }
+}
+
+void appendUint64(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+{
+   for (int i = 0; i < 8; ++i)
+   {
+      bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+   }
+}
+
+std::uint32_t readUint32(const std::uint8_t* bytes)
+{
+   std::uint32_t value = 0;
+   for (int i = 0; i < 4; ++i)
+   {
+      value |= static_cast<std::uint32_t>(bytes[i]) << (8 * i);
+   }
+
+   return value;
+}
+
+std::uint64_t readUint64(const std::uint8_t* bytes)
+{
+   std::uint64_t value = 0;
+   for (int i = 0; i < 8; ++i)
+   {
+      value |= static_cast<std::uint64_t>(bytes[i]) << (8 * i);
+   }
+
+   return value;
+}
+
+UdpTransport::UdpTransport()
+   : mSocket(-1)
+   , mRemoteAddress()
+   , mSizeOfRemoteAddress(0)
+{
+
+}
+
+UdpTransport::~UdpTransport()
+{
+   if (mSocket >= 0)
+   {
+      close(mSocket);
+   }
+}
+
+bool UdpTransport::open(unsigned short localPort)
+{
+   mSocket = socket(AF_INET, SOCK_DGRAM, 0);
+   if (mSocket < 0)
+   {
+      std::cout << "Error - UdpTransport::open - Failed to create a socket: " << std::strerror(errno) << "\n";
+      return false;
+   }
+
+   sockaddr_in localAddress     = sockaddr_in();
+   localAddress.sin_family      = AF_INET;
+   localAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+   localAddress.sin_port        = htons(localPort);
+
+   if (bind(mSocket, reinterpret_cast<sockaddr*>(&localAddress), sizeof(localAddress)) != 0)
+   {
+      std::cout << "Error - UdpTransport::open - Failed to bind to port " << localPort << ": " << std::strerror(errno) << "\n";
+      return false;
+   }
+
+   // The game can't block while it waits for packets, since it has frames to simulate
+   if (fcntl(mSocket, F_SETFL, fcntl(mSocket, F_GETFL, 0) | O_NONBLOCK) != 0)
+   {
+      std::cout << "Error - UdpTransport::open - Failed to make the socket non-blocking: " << std::strerror(errno) << "\n";
+      return false;
+   }
+
+   return true;
+}
+
+bool UdpTransport::setRemoteAddress(const std::string& host, unsigned short port)
+{
+   addrinfo  hints     = addrinfo();
+   hints.ai_family     = AF_INET;
+   hints.ai_socktype   = SOCK_DGRAM;
+   addrinfo* addresses = nullptr;
+
+   if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 || addresses == nullptr)
+   {
+      std::cout << "Error - UdpTransport::setRemoteAddress - Failed to resolve " << host << "\n";
+      return false;
+   }
+
+   std::memcpy(&mRemoteAddress, addresses->ai_addr, addresses->ai_addrlen);
+   mSizeOfRemoteAddress = addresses->ai_addrlen;
+   freeaddrinfo(addresses);
+
+   return true;
+}
+
+unsigned short UdpTransport::getLocalPort() const
+{
+   sockaddr_in localAddress = sockaddr_in();
+   socklen_t   size         = sizeof(localAddress);
+
+   if (mSocket < 0 || getsockname(mSocket, reinterpret_cast<sockaddr*>(&localAddress), &size) != 0)
+   {
+      return 0;
+   }
+
+   return ntohs(localAddress.sin_port);
+}
+
+bool UdpTransport::send(const std::uint8_t* bytes, std::size_t numberOfBytes)
+{
+   if (mSocket < 0 || mSizeOfRemoteAddress == 0)
+   {
+      return false;
+   }
+
+   // A full send buffer drops the datagram, which the redundancy of the protocol makes up for
+   return sendto(mSocket, bytes, numberOfBytes, 0, reinterpret_cast<const sockaddr*>(&mRemoteAddress), mSizeOfRemoteAddress) == static_cast<ssize_t>(numberOfBytes);
+}
+
+bool UdpTransport::receive(std::vector<std::uint8_t>& bytes)
+{
+   if (mSocket < 0)
+   {
+      return false;
+   }
+
+   bytes.resize(maxSizeOfDatagram);
+
+   while (true)
+   {
+      sockaddr_storage sourceAddress = sockaddr_storage();
+      socklen_t        sizeOfSource  = sizeof(sourceAddress);
+
+      ssize_t numberOfBytes = recvfrom(mSocket, bytes.data(), bytes.size(), 0, reinterpret_cast<sockaddr*>(&sourceAddress), &sizeOfSource);
+      if (numberOfBytes < 0)
+      {
+         return false;
+      }
+
+      const sockaddr_in& source = reinterpret_cast<const sockaddr_in&>(sourceAddress);
+      const sockaddr_in& remote = reinterpret_cast<const sockaddr_in&>(mRemoteAddress);
+
+      if (mSizeOfRemoteAddress != 0 && source.sin_addr.s_addr == remote.sin_addr.s_addr && source.sin_port == remote.sin_port)
+      {
+         bytes.resize(static_cast<std::size_t>(numberOfBytes));
+         return true;
+      }
+   }
+}
+
+ImpairedTransport::ImpairedTransport(DatagramTransport& transport, const NetworkConditions& conditions, std::uint64_t seed)
+   : mTransport(transport)
+   , mConditions(conditions)
+   , mRandomNumberGeneratorState(seed)
+   , mTime(0.0)
+   , mDelayedDatagrams()
+   , mNumberOfDatagramsDropped(0)
+{
+
+}
+
+void ImpairedTransport::setTime(double seconds)
+{
+   mTime = seconds;
+
+   // Datagrams are delivered in the order of their delivery times, so the jitter reorders them like a real network would
+   std::stable_sort(mDelayedDatagrams.begin(), mDelayedDatagrams.end(), [](const DelayedDatagram& a, const DelayedDatagram& b)
+   {
+      return a.timeOfDelivery < b.timeOfDelivery;
+   });
+
+   std::size_t numberOfDatagramsDelivered = 0;
+   while (numberOfDatagramsDelivered < mDelayedDatagrams.size() && mDelayedDatagrams[numberOfDatagramsDelivered].timeOfDelivery <= mTime)
+   {
+      const std::vector<std::uint8_t>& bytes = mDelayedDatagrams[numberOfDatagramsDelivered].bytes;
+      mTransport.send(bytes.data(), bytes.size());
+      ++numberOfDatagramsDelivered;
+   }
+
+   mDelayedDatagrams.erase(mDelayedDatagrams.begin(), mDelayedDatagrams.begin() + numberOfDatagramsDelivered);
+}
+
+bool ImpairedTransport::send(const std::uint8_t* bytes, std::size_t numberOfBytes)
+{
+   if (drawUniformNumber() < mConditions.lossRate)
+   {
+      ++mNumberOfDatagramsDropped;
+      return true;
+   }
+
+   double delay = mConditions.latencyInSeconds + (((2.0 * drawUniformNumber()) - 1.0) * mConditions.jitterInSeconds);
+   mDelayedDatagrams.push_back(DelayedDatagram{mTime + std::max(delay, 0.0), std::vector<std::uint8_t>(bytes, bytes + numberOfBytes)});
+
+   return true;
+}
+
+bool ImpairedTransport::receive(std::vector<std::uint8_t>& bytes)
+{
+   return mTransport.receive(bytes);
+}
+
+std::uint64_t ImpairedTransport::getNumberOfDatagramsDropped() const
+{
+   return mNumberOfDatagramsDropped;
+}
+
+double ImpairedTransport::drawUniformNumber()
+{
+   // The 53 most significant bits fill the mantissa of a double in [0, 1)
+   return static_cast<double>(drawRandomNumber(mRandomNumberGeneratorState) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+NetplayPeer::NetplayPeer(RollbackSession& session, DatagramTransport& transport, std::uint32_t sessionIdentifier)
+   : mSession(session)
+   , mTransport(transport)
+   , mSessionIdentifier(sessionIdentifier)
+   , mNumberOfLocalInputsAcknowledged(session.getInputDelay())
+   , mLatestRemoteFrame(0)
+   , mLocalFrameAdvantage(0.0f)
+   , mRemoteFrameAdvantage(0.0f)
+   , mFramesUntilTimeSync(framesBetweenTimeSyncs)
+   , mFramesLeftToWait(0)
+   , mLocalChecksums()
+   , mNextFrameToChecksum(framesBetweenChecksums)
+   , mFrameOfPendingRemoteChecksum(0)
+   , mPendingRemoteChecksum(0)
+   , mRemoteChecksumIsPending(false)
+   , mLatestFrameCompared(0)
+   , mDesyncWasDetected(false)
+   , mFrameOfDesync(0)
+   , mPacket()
+   , mCounters()
+{
+
+}
+
+void NetplayPeer::receivePackets()
+{
+   std::vector<std::uint8_t> bytes;
+   while (mTransport.receive(bytes))
+   {
+      processPacket(bytes);
+   }
+}
+
+void NetplayPeer::sendPacket()
+{
+   // The advantage is only measured once the remote player has been heard from
+   if (mCounters.packetsReceived > 0)
+   {
+      float frameAdvantage = static_cast<float>(static_cast<std::int64_t>(mSession.getCurrentFrame()) - mLatestRemoteFrame);
+      mLocalFrameAdvantage += weightOfNewestFrameAdvantage * (frameAdvantage - mLocalFrameAdvantage);
+   }
+
+   updateChecksums();
+
+   std::uint32_t firstInput     = mNumberOfLocalInputsAcknowledged;
+   std::uint32_t numberOfInputs = static_cast<std::uint32_t>(std::min<std::size_t>(mSession.getNumberOfLocalInputs() - firstInput, maxNumberOfInputsPerPacket));
+   std::int32_t  frameAdvantage = static_cast<std::int32_t>(std::lround(mLocalFrameAdvantage * 256.0f));
+
+   mPacket.clear();
+   appendUint32(mPacket, netplayMagicNumber);
+   appendUint32(mPacket, mSessionIdentifier);
+   appendUint32(mPacket, mSession.getCurrentFrame());
+   appendUint32(mPacket, static_cast<std::uint32_t>(frameAdvantage));
+   appendUint32(mPacket, mSession.getNumberOfConfirmedFrames());
+   appendUint32(mPacket, firstInput);
+   mPacket.push_back(static_cast<std::uint8_t>(numberOfInputs));
+
+   for (std::uint32_t frame = firstInput; frame < firstInput + numberOfInputs; ++frame)
+   {
+      mPacket.push_back(mSession.getLocalInput(frame));
+   }
+
+   if (mLocalChecksums.empty())
+   {
+      appendUint32(mPacket, noChecksum);
+      appendUint64(mPacket, 0);
+   }
+   else
+   {
+      appendUint32(mPacket, mLocalChecksums.back().first);
+      appendUint64(mPacket, mLocalChecksums.back().second);
+   }
+
+   if (mTransport.send(mPacket.data(), mPacket.size()))
+   {
+      ++mCounters.packetsSent;
+      mCounters.bytesSent += mPacket.size();
+   }
+}
+
+bool NetplayPeer::shouldWaitForRemotePlayer()
+{
+   if (mFramesLeftToWait > 0)
+   {
+      --mFramesLeftToWait;
+      ++mCounters.framesWaitedForTimeSync;
+      return true;
+   }
+
+   if (--mFramesUntilTimeSync > 0)
+   {
+      return false;
+   }
+
+   mFramesUntilTimeSync = framesBetweenTimeSyncs;
+
+   // Both advantages include the time that packets take to arrive, so their difference is twice the number of frames that the local player is ahead by
+   float framesAhead = (mLocalFrameAdvantage - mRemoteFrameAdvantage) / 2.0f;
+   if (framesAhead < 1.0f)
+   {
+      return false;
+   }
+
+   mFramesLeftToWait = std::min(static_cast<unsigned int>(framesAhead), maxNumberOfFramesWaitedAtOnce) - 1;
+   ++mCounters.framesWaitedForTimeSync;
+   return true;
+}
+
+float NetplayPeer::getLocalFrameAdvantage() const
+{
+   return mLocalFrameAdvantage;
+}
+
+float NetplayPeer::getRemoteFrameAdvantage() const
+{
+   return mRemoteFrameAdvantage;
+}
+
+bool NetplayPeer::desyncWasDetected() const
+{
+   return mDesyncWasDetected;
+}
+
+std::uint32_t NetplayPeer::getFrameOfDesync() const
+{
+   return mFrameOfDesync;
+}
+
+const NetplayCounters& NetplayPeer::getCounters() const
+{
+   return mCounters;
+}
+
+void NetplayPeer::processPacket(const std::vector<std::uint8_t>& bytes)
+{
+   if (bytes.size() < sizeOfPacketHeader + sizeOfPacketChecksum ||
+       readUint32(bytes.data()) != netplayMagicNumber ||
+       readUint32(bytes.data() + 4) != mSessionIdentifier ||
+       bytes.size() != sizeOfPacketHeader + bytes[sizeOfPacketHeader - 1] + sizeOfPacketChecksum)
+   {
+      ++mCounters.packetsRejected;
+      return;
+   }
+
+   ++mCounters.packetsReceived;
+   mCounters.bytesReceived += bytes.size();
+
+   std::uint32_t remoteFrame                     = readUint32(bytes.data() + 8);
+   std::int32_t  remoteFrameAdvantage            = static_cast<std::int32_t>(readUint32(bytes.data() + 12));
+   std::uint32_t numberOfLocalInputsAcknowledged = readUint32(bytes.data() + 16);
+   std::uint32_t firstInput                      = readUint32(bytes.data() + 20);
+   std::uint32_t numberOfInputs                  = bytes[24];
+
+   // Packets can arrive out of order, so only the newest information is kept
+   if (remoteFrame >= mLatestRemoteFrame)
+   {
+      mLatestRemoteFrame    = remoteFrame;
+      mRemoteFrameAdvantage = static_cast<float>(remoteFrameAdvantage) / 256.0f;
+   }
+
+   mNumberOfLocalInputsAcknowledged = std::max(mNumberOfLocalInputsAcknowledged, std::min(numberOfLocalInputsAcknowledged, mSession.getNumberOfLocalInputs()));
+
+   for (std::uint32_t i = 0; i < numberOfInputs; ++i)
+   {
+      std::uint32_t frame = firstInput + i;
+      if (frame < mSession.getNumberOfConfirmedFrames())
+      {
+         ++mCounters.redundantInputsReceived;
+      }
+      else if (!mSession.addRemoteInput(frame, bytes[sizeOfPacketHeader + i]))
+      {
+         // The inputs after a gap are sent again until the gap is filled
+         break;
+      }
+   }
+
+   const std::uint8_t* checksum      = bytes.data() + sizeOfPacketHeader + numberOfInputs;
+   std::uint32_t       checksumFrame = readUint32(checksum);
+   if (checksumFrame != noChecksum)
+   {
+      compareChecksums(checksumFrame, readUint64(checksum + 4));
+   }
+}
+
+void NetplayPeer::updateChecksums()
+{
+   // A frame is only checksummed once both players' inputs before it are known, since its state can't change after that
+   MatchState state;
+   while (mSession.getConfirmedState(mNextFrameToChecksum, state))
+   {
+      mLocalChecksums.emplace_back(mNextFrameToChecksum, calculateChecksumOfMatchState(state));
+      if (mLocalChecksums.size() > numberOfChecksumsKept)
+      {
+         mLocalChecksums.pop_front();
+      }
+
+      if (mRemoteChecksumIsPending && mFrameOfPendingRemoteChecksum == mNextFrameToChecksum)
+      {
+         mRemoteChecksumIsPending = false;
+         compareChecksums(mFrameOfPendingRemoteChecksum, mPendingRemoteChecksum);
+      }
+
+      mNextFrameToChecksum += framesBetweenChecksums;
+   }
+}
+
+void NetplayPeer::compareChecksums(std::uint32_t frame, std::uint64_t remoteChecksum)
+{
+   // Every packet repeats the latest checksum of the remote player, which only needs to be compared once
+   if (frame <= mLatestFrameCompared)
+   {
+      return;
+   }
+
+   for (const std::pair<std::uint32_t, std::uint64_t>& localChecksum : mLocalChecksums)
+   {
+      if (localChecksum.first == frame)
+      {
+         ++mCounters.checksumsCompared;
+         mLatestFrameCompared = frame;
+
+         if (localChecksum.second != remoteChecksum && !mDesyncWasDetected)
+         {
+            std::cout << "Error - NetplayPeer::compareChecksums - The states at frame " << frame << " are different on both machines" << "\n";
+            mDesyncWasDetected = true;
+            mFrameOfDesync     = frame;
+         }
+
+         return;
+      }
+   }
+
+   // The remote player can be ahead, in which case the checksum is compared once the local player confirms the same frame
+   if (frame >= mNextFrameToChecksum && !mRemoteChecksumIsPending)
+   {
+      mFrameOfPendingRemoteChecksum = frame;
+      mPendingRemoteChecksum        = remoteChecksum;
+      mRemoteChecksumIsPending      = true;
+   }
+}
@@ -0,0 +1,298 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "netplay.h"
+
+// Plays a match between two computer-controlled players with rollback netplay over UDP
+// Usage: teapong_netplay [--latency MS] [--jitter MS] [--loss PERCENT] [--seconds S] [--rollback FRAMES] [--delay FRAMES] [--late-start FRAMES] [--seed N]
+//                        [--floating-point] [--peer LOCAL_PORT REMOTE_HOST:REMOTE_PORT left|right]
+//   --latency     Delay added to every packet that is sent (defaults to 0)
+//   --jitter      Largest amount by which the delay of a packet varies (defaults to 0)
+//   --loss        Percentage of the packets that are dropped (defaults to 0)
+//   --seconds     Length of the session (defaults to 60)
+//   --rollback    Largest number of frames that can be rolled back (defaults to 32)
+//   --delay       Number of frames that the local inputs are delayed by (defaults to 2)
+//   --late-start  Number of frames by which the right player starts after the left one, to test the time synchronization (defaults to 0)
+//   --seed        Seed of the match, which must be the same for both players (defaults to 1)
+//   --floating-point
+//                 Simulates the match with the floating-point rules instead of the fixed-point ones, which only stay in sync if both players run the same build
+//   --peer        Plays one side of the match in real time against a peer on another machine, started with the same options
+// Without --peer, both players run in this process on a simulated clock and talk through UDP sockets on 127.0.0.1,
+// so the latency, jitter and loss are the only ones that the packets experience, and the confirmed states of both players are compared at the end
+
+const float frameDuration = 1.0f / 240.0f;
+
+struct NetplaySettings
+{
+   NetworkConditions conditions;
+   double            seconds;
+   unsigned int      maxNumberOfFramesRolledBack;
+   unsigned int      inputDelay;
+   unsigned int      framesOfLateStart;
+   std::uint64_t     seed;
+   MatchArithmetic   arithmetic;
+};
+
+MatchConfiguration createConfiguration(const NetplaySettings& settings)
+{
+   MatchConfiguration configuration;
+   configuration.arithmetic = settings.arithmetic;
+   return configuration;
+}
+
+// One side of the match, with the computer pressing the keys
+struct NetplayPlayer
+{
+   NetplayPlayer(const NetplaySettings& settings, PaddleSide side)
+      : session(createConfiguration(settings), settings.seed, side, settings.maxNumberOfFramesRolledBack, settings.inputDelay)
+      , socket()
+      , impairedSocket(socket, settings.conditions, settings.seed ^ ((side == PaddleSide::Left) ? 0x1EF7ull : 0x5187ull))
+      , peer(session, impairedSocket, calculateSessionIdentifier(settings))
+      , controller(Difficulty::Hard)
+   {
+      controller.reset(side, settings.seed);
+   }
+
+   static std::uint32_t calculateSessionIdentifier(const NetplaySettings& settings)
+   {
+      // Players that simulate the match with different rules can't play together, so the arithmetic is part of the identifier
+      std::uint64_t state = settings.seed ^ (static_cast<std::uint64_t>(settings.maxNumberOfFramesRolledBack) << 32) ^ settings.inputDelay ^
+                            (static_cast<std::uint64_t>(settings.arithmetic) << 56);
+      return static_cast<std::uint32_t>(drawRandomNumber(state));
+   }
+
+   void runFrame(double time)
+   {
+      impairedSocket.setTime(time);
+      peer.receivePackets();
+
+      if (!session.canAdvanceFrame())
+      {
+         session.stallFrame();
+      }
+      else if (!peer.shouldWaitForRemotePlayer())
+      {
+         // The controller sees the predicted state, just like a person would see it on the screen, and serves as soon as it can
+         const MatchState& state = session.getState();
+         PaddleInput       input = controller.decide(state, session.getSimulation().getConfiguration(), frameDuration);
+
+         session.setLocalInput(packInputOfPlayer(session.getLocalSide(), input, !state.ballIsInPlay));
+         session.advanceFrame(frameDuration);
+      }
+
+      peer.sendPacket();
+   }
+
+   RollbackSession          session;
+   UdpTransport             socket;
+   ImpairedTransport        impairedSocket;
+   NetplayPeer              peer;
+   ComputerPaddleController controller;
+};
+
+void printSummary(const std::string& name, const NetplayPlayer& player, double seconds)
+{
+   const RollbackCounters& rollbacks = player.session.getCounters();
+   const NetplayCounters&  netplay   = player.peer.getCounters();
+   const MatchState&       state     = player.session.getState();
+
+   std::cout << name << ": frame " << player.session.getCurrentFrame() << ", confirmed " << player.session.getNumberOfConfirmedFrames()
+             << ", score " << state.pointsScoredByLeftPaddle << "-" << state.pointsScoredByRightPaddle << "\n";
+   std::cout << "   rollbacks: " << rollbacks.numberOfRollbacks << ", frames simulated again: " << rollbacks.numberOfFramesSimulatedAgain
+             << ", longest: " << rollbacks.maxNumberOfFramesRolledBack << " frames in " << (rollbacks.maxSecondsSpentByARollback * 1e6) << " us"
+             << ", average: " << ((rollbacks.numberOfRollbacks > 0) ? (rollbacks.secondsSpentRollingBack * 1e6 / rollbacks.numberOfRollbacks) : 0.0) << " us\n";
+   std::cout << "   frames stalled: " << rollbacks.numberOfFramesStalled << ", waited for time sync: " << netplay.framesWaitedForTimeSync
+             << ", frame advantage: " << player.peer.getLocalFrameAdvantage() << " local, " << player.peer.getRemoteFrameAdvantage() << " remote\n";
+   std::cout << "   packets sent: " << netplay.packetsSent << ", received: " << netplay.packetsReceived << ", dropped: " << player.impairedSocket.getNumberOfDatagramsDropped()
+             << ", upload: " << (netplay.bytesSent / seconds) << " bytes/s, redundant inputs received: " << netplay.redundantInputsReceived
+             << ", checksums compared: " << netplay.checksumsCompared << (player.peer.desyncWasDetected() ? ", DESYNC" : "") << "\n";
+}
+
+// Times the worst rollback the session allows, with the ball in play and every frame split into as many sub-steps as a frame can have
+void measureLongestRollback(const NetplaySettings& settings)
+{
+   MatchSimulation simulation(createConfiguration(settings), settings.seed);
+   MatchInputs     inputs = MatchInputs();
+   inputs.releaseBall     = true;
+   simulation.step(inputs, frameDuration);
+
+   MatchState   stateBeforeRollback = simulation.getState();
+   unsigned int numberOfRepetitions = 1000;
+
+   auto start = std::chrono::steady_clock::now();
+   for (unsigned int repetition = 0; repetition < numberOfRepetitions; ++repetition)
+   {
+      simulation.setState(stateBeforeRollback);
+      for (unsigned int frame = 0; frame < settings.maxNumberOfFramesRolledBack; ++frame)
+      {
+         inputs.rightPaddle.moveUp  = (frame % 16) < 8;
+         inputs.leftPaddle.moveDown = (frame % 16) >= 8;
+         simulation.step(inputs, frameDuration, maxNumberOfSubstepsPerTick);
+      }
+   }
+   double secondsPerRollback = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / numberOfRepetitions;
+
+   std::cout << "Rolling back " << settings.maxNumberOfFramesRolledBack << " frames with " << maxNumberOfSubstepsPerTick << " sub-steps each takes "
+             << (secondsPerRollback * 1e6) << " us\n";
+}
+
+int runLoopback(const NetplaySettings& settings)
+{
+   std::unique_ptr<NetplayPlayer> leftPlayer(new NetplayPlayer(settings, PaddleSide::Left));
+   std::unique_ptr<NetplayPlayer> rightPlayer(new NetplayPlayer(settings, PaddleSide::Right));
+
+   if (!leftPlayer->socket.open(0) || !rightPlayer->socket.open(0) ||
+       !leftPlayer->socket.setRemoteAddress("127.0.0.1", rightPlayer->socket.getLocalPort()) ||
+       !rightPlayer->socket.setRemoteAddress("127.0.0.1", leftPlayer->socket.getLocalPort()))
+   {
+      return -1;
+   }
+
+   auto numberOfFrames = static_cast<unsigned int>(settings.seconds / frameDuration);
+   for (unsigned int frame = 0; frame < numberOfFrames; ++frame)
+   {
+      double time = frame * static_cast<double>(frameDuration);
+
+      leftPlayer->runFrame(time);
+      if (frame >= settings.framesOfLateStart)
+      {
+         rightPlayer->runFrame(time);
+      }
+   }
+
+   printSummary("Left player", *leftPlayer, settings.seconds);
+   printSummary("Right player", *rightPlayer, settings.seconds);
+
+   // Both players must have simulated the same match, so their states are compared at the latest frame that both of them have confirmed
+   std::uint32_t frame = std::min(std::min(leftPlayer->session.getCurrentFrame(), rightPlayer->session.getCurrentFrame()),
+                                  std::min(leftPlayer->session.getNumberOfConfirmedFrames(), rightPlayer->session.getNumberOfConfirmedFrames()));
+
+   MatchState leftState;
+   MatchState rightState;
+   if (!leftPlayer->session.getConfirmedState(frame, leftState) || !rightPlayer->session.getConfirmedState(frame, rightState))
+   {
+      std::cout << "Error - runLoopback - The state of frame " << frame << " is no longer available" << "\n";
+      return -1;
+   }
+
+   bool statesMatch = (calculateChecksumOfMatchState(leftState) == calculateChecksumOfMatchState(rightState));
+   std::cout << "States at frame " << frame << (statesMatch ? " match" : " DON'T match") << "\n";
+
+   measureLongestRollback(settings);
+
+   return (statesMatch && !leftPlayer->peer.desyncWasDetected() && !rightPlayer->peer.desyncWasDetected()) ? 0 : -1;
+}
+
+int runPeer(const NetplaySettings& settings, unsigned short localPort, const std::string& remoteAddress, PaddleSide side)
+{
+   std::size_t separator = remoteAddress.rfind(':');
+   if (separator == std::string::npos)
+   {
+      std::cout << "Error - runPeer - The remote address must be HOST:PORT" << "\n";
+      return -1;
+   }
+
+   std::unique_ptr<NetplayPlayer> player(new NetplayPlayer(settings, side));
+   if (!player->socket.open(localPort) ||
+       !player->socket.setRemoteAddress(remoteAddress.substr(0, separator), static_cast<unsigned short>(std::strtoul(remoteAddress.c_str() + separator + 1, nullptr, 10))))
+   {
+      return -1;
+   }
+
+   auto   start           = std::chrono::steady_clock::now();
+   double timeOfNextFrame = 0.0;
+   double time            = 0.0;
+
+   while (time < settings.seconds)
+   {
+      time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      // Like the game, frames that are late are caught up on, so that the clock of the match keeps up with the clock of the machine
+      while (timeOfNextFrame <= time)
+      {
+         player->runFrame(time);
+         timeOfNextFrame += frameDuration;
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   }
+
+   printSummary((side == PaddleSide::Left) ? "Left player" : "Right player", *player, settings.seconds);
+
+   return player->peer.desyncWasDetected() ? -1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+   NetplaySettings settings = {{0.0, 0.0, 0.0}, 60.0, 32, 2, 0, 1, MatchArithmetic::FixedPoint};
+
+   bool           isPeer    = false;
+   unsigned short localPort = 0;
+   std::string    remoteAddress;
+   PaddleSide     side      = PaddleSide::Left;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      bool hasValue = (i + 1 < argc);
+
+      if (std::strcmp(argv[i], "--latency") == 0 && hasValue)
+      {
+         settings.conditions.latencyInSeconds = std::strtod(argv[++i], nullptr) / 1000.0;
+      }
+      else if (std::strcmp(argv[i], "--jitter") == 0 && hasValue)
+      {
+         settings.conditions.jitterInSeconds = std::strtod(argv[++i], nullptr) / 1000.0;
+      }
+      else if (std::strcmp(argv[i], "--loss") == 0 && hasValue)
+      {
+         settings.conditions.lossRate = std::strtod(argv[++i], nullptr) / 100.0;
+      }
+      else if (std::strcmp(argv[i], "--seconds") == 0 && hasValue)
+      {
+         settings.seconds = std::strtod(argv[++i], nullptr);
+      }
+      else if (std::strcmp(argv[i], "--rollback") == 0 && hasValue)
+      {
+         settings.maxNumberOfFramesRolledBack = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--delay") == 0 && hasValue)
+      {
+         settings.inputDelay = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--late-start") == 0 && hasValue)
+      {
+         settings.framesOfLateStart = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+      {
+         settings.seed = std::strtoull(argv[++i], nullptr, 10);
+      }
+      else if (std::strcmp(argv[i], "--floating-point") == 0)
+      {
+         settings.arithmetic = MatchArithmetic::FloatingPoint;
+      }
+      else if (std::strcmp(argv[i], "--peer") == 0 && i + 3 < argc)
+      {
+         isPeer        = true;
+         localPort     = static_cast<unsigned short>(std::strtoul(argv[++i], nullptr, 10));
+         remoteAddress = argv[++i];
+         side          = (std::strcmp(argv[++i], "right") == 0) ? PaddleSide::Right : PaddleSide::Left;
+      }
+      else
+      {
+         std::cout << "Error - main - Unknown argument: " << argv[i] << "\n";
+         return -1;
+      }
+   }
+
+   std::cout << "Latency: " << (settings.conditions.latencyInSeconds * 1000.0) << " ms, jitter: " << (settings.conditions.jitterInSeconds * 1000.0)
+             << " ms, loss: " << (settings.conditions.lossRate * 100.0) << "%, rollback: " << settings.maxNumberOfFramesRolledBack
+             << " frames, input delay: " << settings.inputDelay << " frames, arithmetic: "
+             << ((settings.arithmetic == MatchArithmetic::FixedPoint) ? "fixed point" : "floating point") << "\n";
+
+   return isPeer ? runPeer(settings, localPort, remoteAddress, side) : runLoopback(settings);
+}
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "observation_rasterizer.h"
+
+struct PixelMapping
+{
+   float        pixelsPerUnitX;
+   float        pixelsPerUnitY;
+   float        halfHorizontalRange;
+   float        halfVerticalRange;
+   unsigned int width;
+   unsigned int height;
+};
+
+void fillRectangle(const PixelMapping& mapping, const glm::vec2& center, const glm::vec2& halfExtents, std::uint8_t intensity, std::uint8_t* pixels)
+{
+   // Rows grow downwards, so the top of the rectangle is its first row
+   float left   = (center.x - halfExtents.x + mapping.halfHorizontalRange) * mapping.pixelsPerUnitX;
+   float right  = (center.x + halfExtents.x + mapping.halfHorizontalRange) * mapping.pixelsPerUnitX;
+   float top    = (mapping.halfVerticalRange - (center.y + halfExtents.y)) * mapping.pixelsPerUnitY;
+   float bottom = (mapping.halfVerticalRange - (center.y - halfExtents.y)) * mapping.pixelsPerUnitY;
+
+   // Clamp before converting to integers, so that objects that are far off the table can't overflow them
+   float maxX        = static_cast<float>(mapping.width);
+   float maxY        = static_cast<float>(mapping.height);
+   int   firstColumn = static_cast<int>(std::floor(glm::clamp(left, 0.0f, maxX)));
+   int   endColumn   = static_cast<int>(std::ceil(glm::clamp(right, 0.0f, maxX)));
+   int   firstRow    = static_cast<int>(std::floor(glm::clamp(top, 0.0f, maxY)));
+   int   endRow      = static_cast<int>(std::ceil(glm::clamp(bottom, 0.0f, maxY)));
+
+   if (firstColumn >= endColumn)
+   {
+      return;
+   }
+
+   for (int row = firstRow; row < endRow; ++row)
+   {
+      std::memset(pixels + (static_cast<std::size_t>(row) * mapping.width) + firstColumn, intensity, static_cast<std::size_t>(endColumn - firstColumn));
+   }
+}
+
+void rasterizeObservation(const MatchState& state, const MatchConfiguration& configuration, unsigned int width, unsigned int height, std::uint8_t* pixels)
+{
+   PixelMapping mapping;
+   mapping.pixelsPerUnitX      = width / configuration.horizontalRange;
+   mapping.pixelsPerUnitY      = height / configuration.verticalRange;
+   mapping.halfHorizontalRange = configuration.horizontalRange / 2.0f;
+   mapping.halfVerticalRange   = configuration.verticalRange / 2.0f;
+   mapping.width               = width;
+   mapping.height              = height;
+
+   std::memset(pixels, intensityOfTable, static_cast<std::size_t>(width) * height);
+
+   fillRectangle(mapping, glm::vec2(state.leftPaddle.position),  glm::vec2(state.leftPaddle.width, state.leftPaddle.height) / 2.0f,   intensityOfLeftPaddle,  pixels);
+   fillRectangle(mapping, glm::vec2(state.rightPaddle.position), glm::vec2(state.rightPaddle.width, state.rightPaddle.height) / 2.0f, intensityOfRightPaddle, pixels);
+
+   // The ball is drawn on top of the paddles, and it's dimmer while it falls so that agents can tell that the rally is over
+   fillRectangle(mapping, glm::vec2(state.ball.position), glm::vec2(state.ball.radius), state.ballIsFalling ? intensityOfFallingBall : intensityOfBallInPlay, pixels);
+}
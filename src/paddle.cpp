@@ -36,25 +36,6 @@ Paddle& Paddle::operator=(Paddle&& rhs) noexcept
    return *this;
 }
 
-void Paddle::moveAlongLine(float deltaTime, float lineLength, MovementDirection direction)
-{
-   switch (direction)
-   {
-   case MovementDirection::Up:
-      if ((this->getPosition().y + (mHeight / 2.0f)) < (lineLength / 2.0f))
-      {
-         this->translate(this->getVelocity() * deltaTime);
-      }
-      break;
-   case MovementDirection::Down:
-      if ((this->getPosition().y - (mHeight / 2.0f)) > -(lineLength / 2.0f))
-      {
-         this->translate(-this->getVelocity() * deltaTime);
-      }
-      break;
-   }
-}
-
 float Paddle::getWidth() const
 {
    return mWidth;
@@ -0,0 +1,265 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <utility>
+
+#include "paddle_controller.h"
+#include "trajectory.h"
+
+const PaddleState& getPaddleOnSide(const MatchState& state, PaddleSide side)
+{
+   return (side == PaddleSide::Left) ? state.leftPaddle : state.rightPaddle;
+}
+
+PaddleInput movePaddleTowards(float currentPositionY, float targetPositionY, float deadZone)
+{
+   PaddleInput input = {};
+
+   if (targetPositionY > currentPositionY + deadZone)
+   {
+      input.moveUp = true;
+   }
+   else if (targetPositionY < currentPositionY - deadZone)
+   {
+      input.moveDown = true;
+   }
+
+   return input;
+}
+
+ScriptedPaddleController::ScriptedPaddleController()
+   : mSide(PaddleSide::Left)
+   , mIsMovingUp(true)
+{
+
+}
+
+void ScriptedPaddleController::reset(PaddleSide side, std::uint64_t seed)
+{
+   mSide       = side;
+   mIsMovingUp = (seed & 1) != 0;
+}
+
+PaddleInput ScriptedPaddleController::decide(const MatchState& state, const MatchConfiguration& configuration, float /*deltaTime*/)
+{
+   const PaddleState& paddle      = getPaddleOnSide(state, mSide);
+   float              halfLine    = configuration.lengthOfLineTraversedByPaddles / 2.0f;
+   float              halfHeight  = paddle.height / 2.0f;
+
+   // Turn around at the ends of the line
+   if (mIsMovingUp && (paddle.position.y + halfHeight >= halfLine))
+   {
+      mIsMovingUp = false;
+   }
+   else if (!mIsMovingUp && (paddle.position.y - halfHeight <= -halfLine))
+   {
+      mIsMovingUp = true;
+   }
+
+   PaddleInput input = {};
+   input.moveUp      = mIsMovingUp;
+   input.moveDown    = !mIsMovingUp;
+   return input;
+}
+
+TrackingPaddleController::TrackingPaddleController(float deadZone)
+   : mSide(PaddleSide::Left)
+   , mDeadZone(deadZone)
+   , mAimOffset(0.0f)
+   , mBallWasApproaching(false)
+   , mRandomNumberGeneratorState(0)
+{
+
+}
+
+void TrackingPaddleController::reset(PaddleSide side, std::uint64_t seed)
+{
+   mSide                       = side;
+   mAimOffset                  = 0.0f;
+   mBallWasApproaching         = false;
+   mRandomNumberGeneratorState = seed;
+}
+
+PaddleInput TrackingPaddleController::decide(const MatchState& state, const MatchConfiguration& /*configuration*/, float /*deltaTime*/)
+{
+   const PaddleState& paddle = getPaddleOnSide(state, mSide);
+
+   bool ballIsApproaching = state.ballIsInPlay && !state.ballIsFalling &&
+                            ((mSide == PaddleSide::Left) ? (state.ball.velocity.x < 0.0f) : (state.ball.velocity.x > 0.0f));
+
+   // Pick a new point along the face of the paddle every time the ball starts approaching it
+   if (ballIsApproaching && !mBallWasApproaching)
+   {
+      float uniform = static_cast<float>(drawRandomNumber(mRandomNumberGeneratorState) >> 40) / static_cast<float>(1 << 24);
+      mAimOffset    = (uniform - 0.5f) * paddle.height;
+   }
+   mBallWasApproaching = ballIsApproaching;
+
+   if (ballIsApproaching)
+   {
+      return movePaddleTowards(paddle.position.y + mAimOffset, state.ball.position.y, mDeadZone);
+   }
+
+   return movePaddleTowards(paddle.position.y, 0.0f, mDeadZone);
+}
+
+ComputerPaddleController::ComputerPaddleController(Difficulty difficulty)
+   : mSide(PaddleSide::Left)
+   , mDifficulty(difficulty)
+   , mReactionDelay(0.0f)
+   , mAimError(0.0f)
+   , mAimErrorPerBounce(0.0f)
+   , mCurrentTargetPositionY(0.0f)
+   , mPlannedTargetPositionY(0.0f)
+   , mTimeUntilReaction(0.0f)
+   , mLastSeenVelocityOfBall(0.0f)
+   , mBallWasOnTable(false)
+   , mRandomNumberGeneratorState(0)
+{
+   setDifficulty(difficulty);
+}
+
+void ComputerPaddleController::reset(PaddleSide side, std::uint64_t seed)
+{
+   mSide                       = side;
+   mCurrentTargetPositionY     = 0.0f;
+   mPlannedTargetPositionY     = 0.0f;
+   mTimeUntilReaction          = 0.0f;
+   mLastSeenVelocityOfBall     = glm::vec2(0.0f);
+   mBallWasOnTable             = false;
+   mRandomNumberGeneratorState = seed;
+}
+
+PaddleInput ComputerPaddleController::decide(const MatchState& state, const MatchConfiguration& configuration, float deltaTime)
+{
+   bool      ballIsOnTable  = state.ballIsInPlay && !state.ballIsFalling;
+   glm::vec2 velocityOfBall = glm::vec2(state.ball.velocity);
+
+   // The path of the ball only changes when it's served, when it bounces off a wall or a paddle, or when it falls off the table
+   if ((ballIsOnTable != mBallWasOnTable) || (velocityOfBall != mLastSeenVelocityOfBall))
+   {
+      // Wall bounces don't move the point where the ball will reach the paddle, so only the other changes make the controller react again
+      bool directionOfBallChanged = (ballIsOnTable != mBallWasOnTable) || ((velocityOfBall.x < 0.0f) != (mLastSeenVelocityOfBall.x < 0.0f));
+
+      mBallWasOnTable         = ballIsOnTable;
+      mLastSeenVelocityOfBall = velocityOfBall;
+
+      if (directionOfBallChanged)
+      {
+         planInterception(state, configuration);
+         mTimeUntilReaction = mReactionDelay;
+      }
+   }
+
+   if (mTimeUntilReaction > 0.0f)
+   {
+      mTimeUntilReaction -= deltaTime;
+   }
+   else
+   {
+      mCurrentTargetPositionY = mPlannedTargetPositionY;
+   }
+
+   // A dead zone smaller than the distance that the paddle moves in one step would make it jitter around its target
+   const PaddleState& paddle = getPaddleOnSide(state, mSide);
+   return movePaddleTowards(paddle.position.y, mCurrentTargetPositionY, glm::length(paddle.velocity) * deltaTime);
+}
+
+Difficulty ComputerPaddleController::getDifficulty() const
+{
+   return mDifficulty;
+}
+
+void ComputerPaddleController::setDifficulty(Difficulty difficulty)
+{
+   mDifficulty = difficulty;
+
+   switch (difficulty)
+   {
+   case Difficulty::Easy:
+      mReactionDelay     = 0.5f;
+      mAimError          = 7.0f;
+      mAimErrorPerBounce = 3.0f;
+      break;
+   case Difficulty::Medium:
+      mReactionDelay     = 0.3f;
+      mAimError          = 5.5f;
+      mAimErrorPerBounce = 1.5f;
+      break;
+   case Difficulty::Hard:
+      mReactionDelay     = 0.15f;
+      mAimError          = 4.5f;
+      mAimErrorPerBounce = 1.0f;
+      break;
+   }
+}
+
+void ComputerPaddleController::planInterception(const MatchState& state, const MatchConfiguration& configuration)
+{
+   // Wait in the center of the line while the ball isn't coming towards the paddle, since that's where the next ball is most easily reached
+   mPlannedTargetPositionY = 0.0f;
+
+   if (!state.ballIsInPlay || state.ballIsFalling)
+   {
+      return;
+   }
+
+   const PaddleState& paddle       = getPaddleOnSide(state, mSide);
+   Interception       interception = predictInterceptionByPaddle(state.ball, paddle, configuration.verticalRange);
+
+   bool ballIsApproaching = (mSide == PaddleSide::Left) ? (state.ball.velocity.x < 0.0f) : (state.ball.velocity.x > 0.0f);
+   if (ballIsApproaching && interception.willIntercept)
+   {
+      // Balls that bounce more often are harder to read
+      float uniform           = static_cast<float>(drawRandomNumber(mRandomNumberGeneratorState) >> 40) / static_cast<float>(1 << 24);
+      float aimError          = mAimError + mAimErrorPerBounce * interception.numberOfBouncesOffWalls;
+      mPlannedTargetPositionY = interception.positionY + (uniform * 2.0f - 1.0f) * aimError;
+   }
+}
+
+ReplayedPaddleController::ReplayedPaddleController(std::shared_ptr<const std::vector<PaddleInput>> recordedInputs)
+   : mRecordedInputs(std::move(recordedInputs))
+   , mIndexOfNextInput(0)
+{
+
+}
+
+void ReplayedPaddleController::reset(PaddleSide /*side*/, std::uint64_t seed)
+{
+   // Start each match at a different point of the recording so that the matches aren't all the same
+   mIndexOfNextInput = mRecordedInputs->empty() ? 0 : static_cast<std::size_t>(seed % mRecordedInputs->size());
+}
+
+PaddleInput ReplayedPaddleController::decide(const MatchState& /*state*/, const MatchConfiguration& /*configuration*/, float /*deltaTime*/)
+{
+   if (mRecordedInputs->empty())
+   {
+      return PaddleInput{};
+   }
+
+   PaddleInput input = (*mRecordedInputs)[mIndexOfNextInput];
+   mIndexOfNextInput = (mIndexOfNextInput + 1) % mRecordedInputs->size();
+   return input;
+}
+
+std::shared_ptr<const std::vector<PaddleInput>> loadRecordedPaddleInputs(const std::string& filePath, PaddleSide recordedSide)
+{
+   auto recordedInputs = std::make_shared<std::vector<PaddleInput>>();
+
+   std::ifstream file(filePath, std::ios::binary);
+   if (!file)
+   {
+      std::cout << "Error - loadRecordedPaddleInputs - The following file could not be opened: " << filePath << "\n";
+      return recordedInputs;
+   }
+
+   std::vector<char> packedInputs((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+   recordedInputs->reserve(packedInputs.size());
+   for (char packedInput : packedInputs)
+   {
+      MatchInputs inputs = unpackMatchInputs(static_cast<std::uint8_t>(packedInput));
+      recordedInputs->push_back((recordedSide == PaddleSide::Left) ? inputs.leftPaddle : inputs.rightPaddle);
+   }
+
+   return recordedInputs;
+}
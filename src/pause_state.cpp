@@ -167,7 +167,7 @@ void PauseState::update(float /*deltaTime*/)
 
 }
 
-void PauseState::render()
+void PauseState::render(float /*interpolationFactor*/)
 {
    mWindow->clearAndBindMultisampleFramebuffer();
 
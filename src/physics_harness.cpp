@@ -0,0 +1,363 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "collision.h"
+#include "match_simulation.h"
+
+// Simulates rallies that start from random states with a grid of time steps and speeds of the ball, checks that the rules never break the invariants below,
+// and reports how many times each invariant was broken and how long each step took
+// Usage: teapong_physics_harness [--states N] [--seconds S] [--seed N]
+//   --states   Number of random states simulated for each time step and speed (defaults to 20000)
+//   --seconds  Simulated time of each rally, unless a point is scored first (defaults to 0.5)
+//   --seed     Seed of the random states and inputs (defaults to 1)
+
+enum Invariant
+{
+   // The ball doesn't overlap with a paddle at the end of a step
+   NoPenetration,
+   // Bounces change the direction of the ball, but not its speed
+   SpeedIsPreserved,
+   // The ball stays between the walls
+   BallIsInsideWalls,
+   // After hitting a paddle, the ball moves away from it, otherwise it hits it again on the next step
+   BallLeavesPaddleAfterHit,
+   // The same, but for balls that are squeezed between a paddle and a wall, or pushed by a paddle that is faster than them
+   // Those balls can't move away without gaining speed, so the largest safe time step is reported both with and without them
+   BallLeavesPaddleAfterSqueeze,
+   NumberOfInvariants
+};
+
+const std::array<const char*, NumberOfInvariants> namesOfInvariants = {"penetration", "speed", "walls", "double hit", "squeeze"};
+
+const float toleranceOfPenetration = 1e-3f;
+const float toleranceOfSpeed       = 1e-4f; // Relative to the speed of the ball
+const float toleranceOfWalls       = 1e-3f;
+
+struct Violation
+{
+   std::uint64_t state;
+   unsigned int  step;
+   BallState     ball;
+};
+
+struct Cell
+{
+   float                                       deltaTime;
+   float                                       speed;
+   std::uint64_t                               numberOfSteps;
+   double                                      secondsPerStep;
+   std::array<std::uint64_t, NumberOfInvariants> numberOfViolations;
+   std::array<bool, NumberOfInvariants>          hasExample;
+   std::array<Violation, NumberOfInvariants>     examples;
+};
+
+float drawUniform(std::uint64_t& randomNumberGeneratorState, float minValue, float maxValue)
+{
+   float uniform = static_cast<float>(drawRandomNumber(randomNumberGeneratorState) >> 40) / static_cast<float>(1 << 24);
+   return minValue + uniform * (maxValue - minValue);
+}
+
+MatchInputs drawInputs(std::uint64_t& randomNumberGeneratorState)
+{
+   // Each paddle moves up, moves down or stands still
+   unsigned int bits   = static_cast<unsigned int>(drawRandomNumber(randomNumberGeneratorState) >> 60);
+   MatchInputs  inputs = {};
+   inputs.leftPaddle.moveUp    = (bits & 3) == 1;
+   inputs.leftPaddle.moveDown  = (bits & 3) == 2;
+   inputs.rightPaddle.moveUp   = (bits >> 2) == 1;
+   inputs.rightPaddle.moveDown = (bits >> 2) == 2;
+   return inputs;
+}
+
+float calculatePenetration(const BallState& ball, const PaddleState& paddle)
+{
+   glm::vec2 halfExtents(paddle.width / 2.0f, paddle.height / 2.0f);
+   glm::vec2 vecFromCenterOfPaddleToCenterOfBall = glm::vec2(ball.position - paddle.position);
+   glm::vec2 closest                             = glm::clamp(vecFromCenterOfPaddleToCenterOfBall, -halfExtents, halfExtents);
+   return ball.radius - glm::length(vecFromCenterOfPaddleToCenterOfBall - closest);
+}
+
+// Places the ball and the paddles at random positions that don't overlap, and sends the ball in a random direction at the given speed
+MatchState drawInitialState(const MatchConfiguration& config, float speed, std::uint64_t& randomNumberGeneratorState)
+{
+   MatchState state          = {};
+   state.ball                = config.initialBall;
+   state.leftPaddle          = config.initialLeftPaddle;
+   state.rightPaddle         = config.initialRightPaddle;
+   state.ballIsInPlay        = true;
+   state.randomNumberGeneratorState = randomNumberGeneratorState;
+
+   float rangeOfPaddles = (config.lengthOfLineTraversedByPaddles - state.leftPaddle.height) / 2.0f;
+   float rangeOfBallX   = config.horizontalRange / 2.0f - state.ball.radius;
+   float rangeOfBallY   = config.verticalRange / 2.0f - state.ball.radius;
+
+   do
+   {
+      state.leftPaddle.position.y  = drawUniform(randomNumberGeneratorState, -rangeOfPaddles, rangeOfPaddles);
+      state.rightPaddle.position.y = drawUniform(randomNumberGeneratorState, -rangeOfPaddles, rangeOfPaddles);
+      state.ball.position.x        = drawUniform(randomNumberGeneratorState, -rangeOfBallX, rangeOfBallX);
+      state.ball.position.y        = drawUniform(randomNumberGeneratorState, -rangeOfBallY, rangeOfBallY);
+   }
+   while (calculatePenetration(state.ball, state.leftPaddle) > 0.0f || calculatePenetration(state.ball, state.rightPaddle) > 0.0f);
+
+   float angle          = drawUniform(randomNumberGeneratorState, 0.0f, 6.2831853f);
+   state.ball.velocity  = glm::vec3(std::cos(angle) * speed, std::sin(angle) * speed, 0.0f);
+   return state;
+}
+
+// Returns true if the ball is moving into the paddle that it hit during the last step
+bool ballIsMovingIntoPaddle(const BallState& ball, const PaddleState& paddle, const glm::vec2& velocityOfPaddle)
+{
+   glm::vec2 halfExtents(paddle.width / 2.0f, paddle.height / 2.0f);
+   glm::vec2 vecFromCenterOfPaddleToCenterOfBall = glm::vec2(ball.position - paddle.position);
+   glm::vec2 vecFromPaddleToBall                 = vecFromCenterOfPaddleToCenterOfBall - glm::clamp(vecFromCenterOfPaddleToCenterOfBall, -halfExtents, halfExtents);
+   float     distance                            = glm::length(vecFromPaddleToBall);
+   if (distance == 0.0f)
+   {
+      // The center of the ball is inside of the paddle, which is already reported as a penetration
+      return false;
+   }
+
+   glm::vec2 relativeVelocity = glm::vec2(ball.velocity) - velocityOfPaddle;
+   return glm::dot(relativeVelocity, vecFromPaddleToBall / distance) < -toleranceOfSpeed * glm::length(glm::vec2(ball.velocity));
+}
+
+// Returns true if the ball that hit the paddle during the last step touches a wall, or if the paddle moves towards it and is at least as fast as the ball
+bool ballIsSqueezedByPaddle(const BallState& ball, const PaddleState& paddle, const glm::vec2& velocityOfPaddle, const MatchEvents& events, float topBoundary)
+{
+   if (events.ballBouncedOffWall || glm::abs(ball.position.y) + ball.radius > topBoundary - toleranceOfWalls)
+   {
+      return true;
+   }
+
+   glm::vec2 halfExtents(paddle.width / 2.0f, paddle.height / 2.0f);
+   glm::vec2 vecFromCenterOfPaddleToCenterOfBall = glm::vec2(ball.position - paddle.position);
+   glm::vec2 vecFromPaddleToBall                 = vecFromCenterOfPaddleToCenterOfBall - glm::clamp(vecFromCenterOfPaddleToCenterOfBall, -halfExtents, halfExtents);
+   float     distance                            = glm::length(vecFromPaddleToBall);
+   if (distance == 0.0f)
+   {
+      return false;
+   }
+
+   return glm::dot(velocityOfPaddle, vecFromPaddleToBall / distance) > 0.0f && glm::length(velocityOfPaddle) >= (1.0f - toleranceOfSpeed) * glm::length(glm::vec2(ball.velocity));
+}
+
+// Formats a time step as a fraction of a second, or as "none" if it's 0
+std::string formatDeltaTime(float deltaTime)
+{
+   return (deltaTime > 0.0f) ? ("1/" + std::to_string(static_cast<unsigned int>(1.0f / deltaTime + 0.5f))) : std::string("none");
+}
+
+void recordViolation(Cell& cell, Invariant invariant, std::uint64_t state, unsigned int step, const BallState& ball)
+{
+   if (cell.numberOfViolations[invariant]++ == 0)
+   {
+      cell.hasExample[invariant] = true;
+      cell.examples[invariant]   = Violation{state, step, ball};
+   }
+}
+
+void runCell(const MatchConfiguration& config, std::uint64_t numberOfStates, float secondsPerState, std::uint64_t seed, Cell& cell)
+{
+   unsigned int  maxNumberOfSteps = static_cast<unsigned int>(secondsPerState / cell.deltaTime + 0.5f);
+   float         topBoundary      = config.verticalRange / 2.0f;
+   MatchSimulation simulation(config, 0);
+
+   // Time the steps without checking the invariants, so that the checks don't inflate the times
+   std::uint64_t randomNumberGeneratorState = seed;
+   auto start = std::chrono::steady_clock::now();
+   for (std::uint64_t state = 0; state < numberOfStates; ++state)
+   {
+      simulation.setState(drawInitialState(config, cell.speed, randomNumberGeneratorState));
+      for (unsigned int step = 0; step < maxNumberOfSteps; ++step)
+      {
+         if (simulation.step(drawInputs(randomNumberGeneratorState), cell.deltaTime).pointWasScored)
+         {
+            break;
+         }
+
+         ++cell.numberOfSteps;
+      }
+   }
+   double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   cell.secondsPerStep = (cell.numberOfSteps > 0) ? (seconds / cell.numberOfSteps) : 0.0;
+
+   // Simulate the same rallies again, this time checking the invariants after every step
+   randomNumberGeneratorState = seed;
+   for (std::uint64_t state = 0; state < numberOfStates; ++state)
+   {
+      simulation.setState(drawInitialState(config, cell.speed, randomNumberGeneratorState));
+      for (unsigned int step = 0; step < maxNumberOfSteps; ++step)
+      {
+         MatchState  stateBeforeStep = simulation.getState();
+         MatchEvents events          = simulation.step(drawInputs(randomNumberGeneratorState), cell.deltaTime);
+         if (events.pointWasScored)
+         {
+            break;
+         }
+
+         const MatchState& stateAfterStep = simulation.getState();
+         const BallState&  ball           = stateAfterStep.ball;
+
+         if (calculatePenetration(ball, stateAfterStep.leftPaddle) > toleranceOfPenetration ||
+             calculatePenetration(ball, stateAfterStep.rightPaddle) > toleranceOfPenetration)
+         {
+            recordViolation(cell, NoPenetration, state, step, ball);
+         }
+
+         if (glm::abs(glm::length(glm::vec2(ball.velocity)) - cell.speed) > toleranceOfSpeed * cell.speed)
+         {
+            recordViolation(cell, SpeedIsPreserved, state, step, ball);
+         }
+
+         if (glm::abs(ball.position.y) + ball.radius > topBoundary + toleranceOfWalls)
+         {
+            recordViolation(cell, BallIsInsideWalls, state, step, ball);
+         }
+
+         glm::vec2 velocityOfLeftPaddle  = glm::vec2(stateAfterStep.leftPaddle.position - stateBeforeStep.leftPaddle.position) / cell.deltaTime;
+         glm::vec2 velocityOfRightPaddle = glm::vec2(stateAfterStep.rightPaddle.position - stateBeforeStep.rightPaddle.position) / cell.deltaTime;
+         bool      hitLeftPaddleAgain    = events.ballHitLeftPaddle && ballIsMovingIntoPaddle(ball, stateAfterStep.leftPaddle, velocityOfLeftPaddle);
+         bool      hitRightPaddleAgain   = events.ballHitRightPaddle && ballIsMovingIntoPaddle(ball, stateAfterStep.rightPaddle, velocityOfRightPaddle);
+         if (hitLeftPaddleAgain || hitRightPaddleAgain)
+         {
+            bool squeezed = (hitLeftPaddleAgain && ballIsSqueezedByPaddle(ball, stateAfterStep.leftPaddle, velocityOfLeftPaddle, events, topBoundary)) ||
+                            (hitRightPaddleAgain && ballIsSqueezedByPaddle(ball, stateAfterStep.rightPaddle, velocityOfRightPaddle, events, topBoundary));
+            recordViolation(cell, squeezed ? BallLeavesPaddleAfterSqueeze : BallLeavesPaddleAfterHit, state, step, ball);
+         }
+      }
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   std::uint64_t numberOfStates  = 20000;
+   float         secondsPerState = 0.5f;
+   std::uint64_t seed            = 1;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      bool hasValue = (i + 1 < argc);
+
+      if (std::strcmp(argv[i], "--states") == 0 && hasValue)
+      {
+         numberOfStates = std::strtoull(argv[++i], nullptr, 10);
+      }
+      else if (std::strcmp(argv[i], "--seconds") == 0 && hasValue)
+      {
+         secondsPerState = static_cast<float>(std::strtod(argv[++i], nullptr));
+      }
+      else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+      {
+         seed = std::strtoull(argv[++i], nullptr, 10);
+      }
+      else
+      {
+         std::cout << "Error - main - Unknown argument: " << argv[i] << "\n";
+         return -1;
+      }
+   }
+
+   MatchConfiguration config;
+   float              speedOfServe = glm::length(glm::vec2(config.initialBall.initialVelocity));
+
+   const std::array<unsigned int, 6> stepsPerSecond    = {30, 60, 120, 240, 500, 1000};
+   const std::array<float, 5>        multiplesOfSpeed  = {0.5f, 1.0f, 2.0f, 4.0f, 8.0f};
+
+   std::vector<Cell> cells;
+   for (float multipleOfSpeed : multiplesOfSpeed)
+   {
+      for (unsigned int steps : stepsPerSecond)
+      {
+         Cell cell      = {};
+         cell.deltaTime = 1.0f / steps;
+         cell.speed     = speedOfServe * multipleOfSpeed;
+         runCell(config, numberOfStates, secondsPerState, seed, cell);
+         cells.push_back(cell);
+      }
+   }
+
+   std::cout << std::fixed;
+   std::cout << "States per cell: " << numberOfStates << ", seconds per state: " << secondsPerState << ", seed: " << seed << "\n";
+   std::cout << std::setw(8) << "dt" << std::setw(10) << "speed" << std::setw(12) << "steps" << std::setw(10) << "ns/step";
+   for (const char* name : namesOfInvariants)
+   {
+      std::cout << std::setw(13) << name;
+   }
+   std::cout << "\n";
+
+   for (const Cell& cell : cells)
+   {
+      std::cout << std::setw(8) << formatDeltaTime(cell.deltaTime)
+                << std::setw(10) << std::setprecision(1) << cell.speed
+                << std::setw(12) << cell.numberOfSteps
+                << std::setw(10) << (cell.secondsPerStep * 1e9);
+      for (std::uint64_t numberOfViolations : cell.numberOfViolations)
+      {
+         std::cout << std::setw(13) << numberOfViolations;
+      }
+      std::cout << "\n";
+   }
+
+   // The first violation of each kind can be reproduced by simulating the same state with the same seed
+   std::cout << "First violations" << "\n";
+   for (const Cell& cell : cells)
+   {
+      for (unsigned int invariant = 0; invariant < NumberOfInvariants; ++invariant)
+      {
+         if (cell.hasExample[invariant])
+         {
+            const Violation& violation = cell.examples[invariant];
+            std::cout << "  dt 1/" << static_cast<unsigned int>(1.0f / cell.deltaTime + 0.5f) << ", speed " << std::setprecision(1) << cell.speed << ", " << namesOfInvariants[invariant]
+                      << ": state " << violation.state << ", step " << violation.step << std::setprecision(3)
+                      << ", ball at (" << violation.ball.position.x << ", " << violation.ball.position.y << ")"
+                      << " moving at (" << violation.ball.velocity.x << ", " << violation.ball.velocity.y << ")" << "\n";
+         }
+      }
+   }
+
+   // The largest safe time step for each speed is the largest one for which no invariant was broken
+   // It is reported both apart from the squeezes, which most time steps break at least once, and with them, and "none" means that every time step broke one
+   std::cout << "Largest safe time step" << "\n";
+   std::cout << std::setw(10) << "speed" << std::setw(22) << "apart from squeezes" << std::setw(18) << "every invariant" << "\n";
+   for (float multipleOfSpeed : multiplesOfSpeed)
+   {
+      float largestSafeDeltaTime             = 0.0f;
+      float largestSafeDeltaTimeWithSqueezes = 0.0f;
+      for (const Cell& cell : cells)
+      {
+         if (cell.speed != speedOfServe * multipleOfSpeed)
+         {
+            continue;
+         }
+
+         bool brokeInvariants = false;
+         for (unsigned int invariant = 0; invariant < NumberOfInvariants; ++invariant)
+         {
+            brokeInvariants = brokeInvariants || (invariant != BallLeavesPaddleAfterSqueeze && cell.numberOfViolations[invariant] != 0);
+         }
+
+         if (!brokeInvariants)
+         {
+            largestSafeDeltaTime = glm::max(largestSafeDeltaTime, cell.deltaTime);
+
+            if (cell.numberOfViolations[BallLeavesPaddleAfterSqueeze] == 0)
+            {
+               largestSafeDeltaTimeWithSqueezes = glm::max(largestSafeDeltaTimeWithSqueezes, cell.deltaTime);
+            }
+         }
+      }
+
+      std::cout << std::setw(10) << std::setprecision(1) << (speedOfServe * multipleOfSpeed)
+                << std::setw(22) << formatDeltaTime(largestSafeDeltaTime)
+                << std::setw(18) << formatDeltaTime(largestSafeDeltaTimeWithSqueezes) << "\n";
+   }
+
+   return 0;
+}
@@ -1,10 +1,11 @@
+#include <algorithm>
 #include <array>
+#include <limits>
 #include <random>
 
-#include "collision.h"
 #include "play_state.h"
 
-void resolveCollisionBetweenBallAndPaddle(Ball& ball, const Paddle& paddle, const glm::vec2& vecFromCenterOfCircleToPointOfCollision);
+const std::size_t numberOfExtraBalls = 4;
 
 PlayState::PlayState(const std::shared_ptr<FiniteStateMachine>&     finiteStateMachine,
                      const std::shared_ptr<Window>&                 window,
@@ -15,7 +16,8 @@ PlayState::PlayState(const std::shared_ptr<FiniteStateMachine>&     finiteStateM
                      const std::shared_ptr<Paddle>&                 leftPaddle,
                      const std::shared_ptr<Paddle>&                 rightPaddle,
                      const std::shared_ptr<Ball>&                   ball,
-                     const std::shared_ptr<GameObject3D>&           point)
+                     const std::shared_ptr<GameObject3D>&           point,
+                     const std::shared_ptr<SharedStateChannel>&     stateChannel)
    : mFSM(finiteStateMachine)
    , mWindow(window)
    , mSoundEngine(soundEngine)
@@ -26,10 +28,26 @@ PlayState::PlayState(const std::shared_ptr<FiniteStateMachine>&     finiteStateM
    , mRightPaddle(rightPaddle)
    , mBall(ball)
    , mPoint(point)
-   , mBallIsInPlay(false)
-   , mBallIsFalling(false)
-   , mPointsScoredByLeftPaddle(0)
-   , mPointsScoredByRightPaddle(0)
+   , mSimulation(MatchConfiguration(), std::random_device()())
+   , mInputs()
+   , mTimeWhenSoundOfCollisionWasLastPlayed(0.0)
+   , mFrameNumber(0)
+   , mHistory(960) // 4 seconds at the default update rate
+   , mRewind(false)
+   , mRecorder(5.0f)
+   , mSubstepGovernor(0.001, maxNumberOfSubstepsPerTick) // 1 ms, which is about a quarter of an update at the default update rate
+   , mSecondsLeftInFrame(std::numeric_limits<double>::max())
+   , mNumberOfUpdatesLeftInFrame(1)
+   , mComputerOpponent(Difficulty::Easy)
+   , mComputerControlsLeftPaddle(false)
+   , mExtraBalls(mSimulation.getConfiguration(), mSimulation.getConfiguration().initialBall.radius, std::random_device()())
+   , mExtraBallsAreEnabled(false)
+   , mMatchWasPlayedWithExtraBalls(false)
+   , mStateChannel(stateChannel)
+   , mCommandedInputs()
+   , mLeftPaddleIsCommanded(false)
+   , mRightPaddleIsCommanded(false)
+   , mSequenceNumberOfLastCommandApplied(0)
    , mPositionsOfPointsScoredByLeftPaddle({glm::vec3(-47.5f, -34.0f, 0.0f),
                                            glm::vec3(-43.5f, -34.0f, 0.0f),
                                            glm::vec3(-39.5f, -34.0f, 0.0f)})
@@ -45,10 +63,28 @@ void PlayState::enter()
    if (mFSM->getPreviousStateID() != "pause")
    {
       resetCamera();
-      resetScene();
-      mPointsScoredByLeftPaddle  = 0;
-      mPointsScoredByRightPaddle = 0;
+      mSimulation.startNewMatch();
+      mBall->reset();
+      synchronizeSceneWithSimulation();
+      mFrameNumber = 0;
+      mHistory.clear();
+      mRecorder.start(1.0f / 240.0f, mSimulation.getConfiguration().arithmetic);
+      mSubstepGovernor.resetCounters();
+      mComputerOpponent.reset(PaddleSide::Left, std::random_device()());
+
+      // Extra balls stay enabled from one match to the next, but they start over
+      mExtraBalls.removeBalls();
+      if (mExtraBallsAreEnabled)
+      {
+         mExtraBalls.spawnBalls(numberOfExtraBalls);
+      }
+      mMatchWasPlayedWithExtraBalls = mExtraBallsAreEnabled;
    }
+
+   savePreviousTransformsOfScene();
+
+   mInputs = MatchInputs();
+   mRewind = false;
 }
 
 void PlayState::processInput(float deltaTime)
@@ -122,13 +158,54 @@ void PlayState::processInput(float deltaTime)
       mFSM->changeState("pause");
    }
 
-   // Release the ball
-   if (!mBallIsInPlay && mWindow->keyIsPressed(GLFW_KEY_SPACE))
+   // Let the computer control the left paddle, cycling through off, easy, medium and hard
+   if (mWindow->keyIsPressed(GLFW_KEY_O) && !mWindow->keyHasBeenProcessed(GLFW_KEY_O))
+   {
+      mWindow->setKeyAsProcessed(GLFW_KEY_O);
+
+      if (!mComputerControlsLeftPaddle)
+      {
+         mComputerControlsLeftPaddle = true;
+         mComputerOpponent.setDifficulty(Difficulty::Easy);
+         mComputerOpponent.reset(PaddleSide::Left, std::random_device()());
+      }
+      else if (mComputerOpponent.getDifficulty() == Difficulty::Easy)
+      {
+         mComputerOpponent.setDifficulty(Difficulty::Medium);
+      }
+      else if (mComputerOpponent.getDifficulty() == Difficulty::Medium)
+      {
+         mComputerOpponent.setDifficulty(Difficulty::Hard);
+      }
+      else
+      {
+         mComputerControlsLeftPaddle = false;
+      }
+   }
+
+   // Throw extra balls into the match, or take them out
+   if (mWindow->keyIsPressed(GLFW_KEY_M) && !mWindow->keyHasBeenProcessed(GLFW_KEY_M))
    {
-      calculateInitialDirectionOfBall();
-      mBallIsInPlay = true;
+      mWindow->setKeyAsProcessed(GLFW_KEY_M);
+
+      mExtraBallsAreEnabled = !mExtraBallsAreEnabled;
+      if (mExtraBallsAreEnabled)
+      {
+         mExtraBalls.spawnBalls(numberOfExtraBalls);
+         mMatchWasPlayedWithExtraBalls = true;
+      }
+      else
+      {
+         mExtraBalls.removeBalls();
+      }
    }
 
+   // Release the ball
+   mInputs.releaseBall = mWindow->keyIsPressed(GLFW_KEY_SPACE);
+
+   // Rewind the match, unless extra balls are in play, since they aren't part of the snapshots
+   mRewind = mWindow->keyIsPressed(GLFW_KEY_BACKSPACE) && !mExtraBallsAreEnabled;
+
    // Reset the camera
    if (mWindow->keyIsPressed(GLFW_KEY_R)) { resetCamera(); }
 
@@ -180,67 +257,130 @@ void PlayState::processInput(float deltaTime)
    }
 
    // Move the paddles
-   if (mWindow->keyIsPressed(GLFW_KEY_G)) { mLeftPaddle->moveAlongLine(deltaTime, 60.0f, Paddle::MovementDirection::Up); }
-   if (mWindow->keyIsPressed(GLFW_KEY_B)) { mLeftPaddle->moveAlongLine(deltaTime, 60.0f, Paddle::MovementDirection::Down); }
-   if (mWindow->keyIsPressed(GLFW_KEY_UP)) { mRightPaddle->moveAlongLine(deltaTime, 60.0f, Paddle::MovementDirection::Up); }
-   if (mWindow->keyIsPressed(GLFW_KEY_DOWN)) { mRightPaddle->moveAlongLine(deltaTime, 60.0f, Paddle::MovementDirection::Down); }
+   mInputs.leftPaddle.moveUp    = mWindow->keyIsPressed(GLFW_KEY_G);
+   mInputs.leftPaddle.moveDown  = mWindow->keyIsPressed(GLFW_KEY_B);
+   mInputs.rightPaddle.moveUp   = mWindow->keyIsPressed(GLFW_KEY_UP);
+   mInputs.rightPaddle.moveDown = mWindow->keyIsPressed(GLFW_KEY_DOWN);
 }
 
 void PlayState::update(float deltaTime)
 {
-   if (!mBallIsInPlay)
+   // Commands are received every update rather than every frame, so that they take effect as soon as possible
+   receivePaddleCommands();
+
+   if (mRewind)
    {
+      // Go back one frame per update, so that the match is rewound at the same speed at which it was played
+      GameStateSnapshot snapshot;
+      if (mHistory.pop(snapshot))
+      {
+         restoreSnapshot(snapshot);
+
+         // The ticks that were rewound are no longer part of the match
+         mRecorder.rewind(static_cast<std::uint32_t>(mFrameNumber));
+      }
+
       return;
    }
 
-   if (!mBallIsFalling && ballIsOutsideOfHorizontalRange())
+   double timeWhenUpdateStarted = glfwGetTime();
+
+   // The snapshot is taken before stepping, so that the first update of a rewind goes back one frame instead of restoring the current one
+   mHistory.push(captureSnapshot());
+
+   savePreviousTransformsOfScene();
+
+   if (mRecorder.getNumberOfTicks() == 0)
    {
-      updateScore();
+      mRecorder.start(deltaTime, mSimulation.getConfiguration().arithmetic);
+   }
 
-      glm::vec3 currVelocity     = mBall->getVelocity();
-      glm::vec3 freeFallVelocity = glm::vec3(currVelocity.x * 0.25, currVelocity.y * 0.25, -15.0f);
-      mBall->setVelocity(freeFallVelocity);
+   MatchState  stateBeforeTick = mSimulation.getState();
 
-      mBallIsFalling = true;
+   // The computer decides once per update, so that its reaction delay doesn't depend on the frame rate
+   if (mComputerControlsLeftPaddle)
+   {
+      mInputs.leftPaddle = mComputerOpponent.decide(stateBeforeTick, mSimulation.getConfiguration(), deltaTime);
    }
 
-   if (mBallIsFalling)
+   if (mLeftPaddleIsCommanded)  { mInputs.leftPaddle  = mCommandedInputs.leftPaddle; }
+   if (mRightPaddleIsCommanded) { mInputs.rightPaddle = mCommandedInputs.rightPaddle; }
+
+   // A command releases the ball during a single update, while the keyboard releases it for as long as Space is held
+   bool ballIsReleasedByCommand = mCommandedInputs.releaseBall && !mInputs.releaseBall;
+   mCommandedInputs.releaseBall = false;
+   if (ballIsReleasedByCommand) { mInputs.releaseBall = true; }
+
+   // Fast rallies get more sub-steps than serves, but never more than what's left of the budget of the update
+   unsigned int numberOfSubstepsNeeded  = mSimulation.calculateNumberOfSubstepsNeeded(deltaTime, mSubstepGovernor.getMaxNumberOfSubsteps());
+   unsigned int numberOfSubsteps        = mSubstepGovernor.chooseNumberOfSubsteps(numberOfSubstepsNeeded,
+                                                                                  glfwGetTime() - timeWhenUpdateStarted,
+                                                                                  mSecondsLeftInFrame,
+                                                                                  mNumberOfUpdatesLeftInFrame);
+   double       timeWhenSubstepsStarted = glfwGetTime();
+
+   MatchEvents events = mSimulation.step(mInputs, deltaTime, numberOfSubsteps);
+   mSubstepGovernor.recordUpdate(numberOfSubstepsNeeded, numberOfSubsteps, glfwGetTime() - timeWhenSubstepsStarted);
+   mRecorder.recordTick(stateBeforeTick, mInputs, events, numberOfSubsteps);
+
+   if (ballIsReleasedByCommand) { mInputs.releaseBall = false; }
+
+   // The extra balls only move while the teapot is in play, so that they wait for the serve after every point
+   if (mExtraBallsAreEnabled && stateBeforeTick.ballIsInPlay && !stateBeforeTick.ballIsFalling && !events.matchIsOver)
    {
-      mBall->moveInFreeFall(deltaTime);
+      const MatchState& stateAfterTick  = mSimulation.getState();
+      MultiBallEvents   extraBallEvents = mExtraBalls.step(stateAfterTick.leftPaddle, stateAfterTick.rightPaddle, deltaTime);
 
-      if (mBall->getPosition().z < -45.0f)
+      if (extraBallEvents.numberOfContactsBetweenBallsAndPaddles > 0)
       {
-         if (mPointsScoredByLeftPaddle == 3 || mPointsScoredByRightPaddle == 3)
-         {
-            mFSM->changeState("win");
-            return;
-         }
-         else
-         {
-            resetScene();
-         }
+         playSoundOfCollision();
       }
+
+      addPointsScoredWithExtraBalls(extraBallEvents, events);
+   }
+
+   if (events.ballHitLeftPaddle || events.ballHitRightPaddle)
+   {
+      playSoundOfCollision();
+   }
+
+   const MatchState& state = mSimulation.getState();
+
+   if (events.sceneWasReset)
+   {
+      mBall->reset();
    }
-   else
+   else if (state.ballIsInPlay)
    {
-      mBall->moveWithinVerticalRange(deltaTime, 60.0f);
+      // Spin the ball around the Z axis while it's on the table, and around its direction of motion while it's falling
+      glm::vec3 axisOfRot = state.ballIsFalling ? glm::vec3(state.ball.velocity.x, state.ball.velocity.y, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+      mBall->rotate(state.ball.spinAngularVelocityScaledByBounce * deltaTime, axisOfRot);
+   }
 
-      glm::vec2 vecFromCenterOfCircleToPointOfCollision;
+   synchronizeSceneWithSimulation();
 
-      if (circleAndAABBCollided(*mBall, *mLeftPaddle, vecFromCenterOfCircleToPointOfCollision))
-      {
-         playSoundOfCollision();
-         resolveCollisionBetweenBallAndPaddle(*mBall, *mLeftPaddle, vecFromCenterOfCircleToPointOfCollision);
-      }
-      else if (circleAndAABBCollided(*mBall, *mRightPaddle, vecFromCenterOfCircleToPointOfCollision))
+   if (events.sceneWasReset)
+   {
+      // Don't interpolate between the position where the ball landed and the center of the table
+      savePreviousTransformsOfScene();
+   }
+
+   ++mFrameNumber;
+
+   if (events.matchIsOver)
+   {
+      // The replay of the last match can be inspected with teapong_replay
+      // The replays only contain the teapot, so the matches that were played with extra balls aren't saved
+      if (!mMatchWasPlayedWithExtraBalls)
       {
-         playSoundOfCollision();
-         resolveCollisionBetweenBallAndPaddle(*mBall, *mRightPaddle, vecFromCenterOfCircleToPointOfCollision);
+         saveReplay("last_match.tprp", mRecorder.getReplay());
       }
+
+      mFSM->changeState("win");
    }
 }
 
-void PlayState::render()
+void PlayState::render(float interpolationFactor)
 {
    mWindow->clearAndBindMultisampleFramebuffer();
 
@@ -253,12 +393,13 @@ void PlayState::render()
 
    mTable->render(*mGameObject3DShader);
 
-   mLeftPaddle->render(*mGameObject3DShader);
-   mRightPaddle->render(*mGameObject3DShader);
+   mLeftPaddle->render(*mGameObject3DShader, interpolationFactor);
+   mRightPaddle->render(*mGameObject3DShader, interpolationFactor);
 
    // Disable face culling so that we render the inside of the teapot
    glDisable(GL_CULL_FACE);
-   mBall->render(*mGameObject3DShader);
+   mBall->render(*mGameObject3DShader, interpolationFactor);
+   renderExtraBalls();
    glEnable(GL_CULL_FACE);
 
    displayScore();
@@ -287,66 +428,112 @@ void PlayState::exit()
 
 unsigned int PlayState::getPointsScoredByLeftPaddle() const
 {
-   return mPointsScoredByLeftPaddle;
+   return mSimulation.getState().pointsScoredByLeftPaddle;
 }
 
 unsigned int PlayState::getPointsScoredByRightPaddle() const
 {
-   return mPointsScoredByRightPaddle;
+   return mSimulation.getState().pointsScoredByRightPaddle;
 }
 
-void PlayState::calculateInitialDirectionOfBall()
+GameStateSnapshot PlayState::captureSnapshot() const
 {
-   std::array<glm::vec3, 4> initialDirections = {glm::vec3( 0.725f,  1.0f, 0.0f),  // Upper right diagonal
-                                                 glm::vec3( 0.725f, -1.0f, 0.0f),  // Lower right diagonal
-                                                 glm::vec3(-0.725f, -1.0f, 0.0f),  // Lower left diagonal
-                                                 glm::vec3(-0.725f,  1.0f, 0.0f)}; // Upper left diagonal
-
-   std::random_device              randomDevice;
-   std::mt19937                    randomNumberGenerator(randomDevice());
-   std::uniform_int_distribution<> uniformIntDistribution(0, 3);
+   GameStateSnapshot snapshot;
 
-   int randomIndex = uniformIntDistribution(randomNumberGenerator);
+   snapshot.match                                 = mSimulation.getState();
+   snapshot.ballRotationMatrix                    = mBall->getRotationMatrix();
+   snapshot.timeWhenSoundOfCollisionWasLastPlayed = mTimeWhenSoundOfCollisionWasLastPlayed;
+   snapshot.frameNumber                           = mFrameNumber;
 
-   mBall->setVelocity(glm::length(mBall->getVelocity()) * glm::normalize(initialDirections[randomIndex]));
+   return snapshot;
 }
 
-bool PlayState::ballIsOutsideOfHorizontalRange()
+void PlayState::restoreSnapshot(const GameStateSnapshot& snapshot)
 {
-   glm::vec3 currentPosition = mBall->getPosition();
-   float     radius          = mBall->getRadius();
+   mSimulation.setState(snapshot.match);
+   mBall->setRotationMatrix(snapshot.ballRotationMatrix);
+   mTimeWhenSoundOfCollisionWasLastPlayed = snapshot.timeWhenSoundOfCollisionWasLastPlayed;
+   mFrameNumber                           = snapshot.frameNumber;
 
-   if ((currentPosition.x + radius < -50.0f) || (currentPosition.x - radius > 50.0f))
-   {
-      return true;
-   }
+   synchronizeSceneWithSimulation();
 
-   return false;
+   // Jump to the restored frame instead of interpolating towards it
+   savePreviousTransformsOfScene();
 }
 
-void PlayState::updateScore()
+PublishedState PlayState::createPublishedState() const
 {
-   glm::vec3 currPos = mBall->getPosition();
-
-   if (currPos.x > 0.0f)
+   const MatchState& match = mSimulation.getState();
+
+   PublishedState state                     = {};
+   state.frameOfMatch                       = mFrameNumber;
+   state.sequenceNumberOfLastCommandApplied = mSequenceNumberOfLastCommandApplied;
+   state.gameState                          = GameStateIsUnknown;
+   state.flags                              = (match.ballIsInPlay      ? BallIsInPlay                      : 0) |
+                                              (match.ballIsFalling     ? BallIsFalling                     : 0) |
+                                              (match.matchIsOver       ? MatchIsOver                       : 0) |
+                                              (mLeftPaddleIsCommanded  ? LeftPaddleIsControlledByCommands  : 0) |
+                                              (mRightPaddleIsCommanded ? RightPaddleIsControlledByCommands : 0);
+
+   for (int i = 0; i < 3; ++i)
    {
-      ++mPointsScoredByLeftPaddle;
+      state.ballPosition[i] = match.ball.position[i];
+      state.ballVelocity[i] = match.ball.velocity[i];
    }
-   else
+
+   for (int i = 0; i < 2; ++i)
    {
-      ++mPointsScoredByRightPaddle;
+      state.leftPaddlePosition[i]  = match.leftPaddle.position[i];
+      state.rightPaddlePosition[i] = match.rightPaddle.position[i];
    }
+
+   state.pointsScoredByLeftPaddle  = match.pointsScoredByLeftPaddle;
+   state.pointsScoredByRightPaddle = match.pointsScoredByRightPaddle;
+   return state;
+}
+
+const SubstepCounters& PlayState::getSubstepCounters() const
+{
+   return mSubstepGovernor.getCounters();
+}
+
+void PlayState::setTimeLeftInFrame(double secondsLeftInFrame, unsigned int numberOfUpdatesLeftInFrame)
+{
+   mSecondsLeftInFrame         = secondsLeftInFrame;
+   mNumberOfUpdatesLeftInFrame = numberOfUpdatesLeftInFrame;
 }
 
 void PlayState::resetScene()
 {
+   mSimulation.resetScene();
+
    mBall->reset();
 
-   mLeftPaddle->setPosition(glm::vec3(-45.0f, 0.0f, 0.0f));
-   mRightPaddle->setPosition(glm::vec3(45.0f, 0.0f, 0.0f));
+   synchronizeSceneWithSimulation();
+   savePreviousTransformsOfScene();
+
+   mFrameNumber = 0;
+   mHistory.clear();
+   mRecorder.start(1.0f / 240.0f, mSimulation.getConfiguration().arithmetic);
+}
+
+void PlayState::synchronizeSceneWithSimulation()
+{
+   const MatchState& state = mSimulation.getState();
+
+   mBall->setPosition(state.ball.position);
+   mBall->setVelocity(state.ball.velocity);
+   mBall->setSpinAngularVelocityScaledByBounce(state.ball.spinAngularVelocityScaledByBounce);
 
-   mBallIsInPlay  = false;
-   mBallIsFalling = false;
+   mLeftPaddle->setPosition(state.leftPaddle.position);
+   mRightPaddle->setPosition(state.rightPaddle.position);
+}
+
+void PlayState::savePreviousTransformsOfScene()
+{
+   mBall->savePreviousTransform();
+   mLeftPaddle->savePreviousTransform();
+   mRightPaddle->savePreviousTransform();
 }
 
 void PlayState::resetCamera()
@@ -360,110 +547,98 @@ void PlayState::resetCamera()
 
 void PlayState::playSoundOfCollision()
 {
-   static double lastPlayed = 0;
-
-   if (glfwGetTime() > lastPlayed + 1)
+   if (glfwGetTime() > mTimeWhenSoundOfCollisionWasLastPlayed + 1)
    {
       mSoundEngine->play2D("resources/sounds/ping_pong_hit.wav", false);
-      lastPlayed = glfwGetTime();
+      mTimeWhenSoundOfCollisionWasLastPlayed = glfwGetTime();
    }
 }
 
-void PlayState::displayScore()
+void PlayState::addPointsScoredWithExtraBalls(const MultiBallEvents& events, MatchEvents& eventsOfMatch)
 {
-   for (unsigned int i = 0; i < mPointsScoredByLeftPaddle; ++i)
+   if (events.pointsScoredByLeftPaddle == 0 && events.pointsScoredByRightPaddle == 0)
    {
-      mPoint->setPosition(mPositionsOfPointsScoredByLeftPaddle[i]);
-      mPoint->render(*mGameObject3DShader);
+      return;
    }
 
-   for (unsigned int i = 0; i < mPointsScoredByRightPaddle; ++i)
+   MatchState   state             = mSimulation.getState();
+   unsigned int pointsNeededToWin = mSimulation.getConfiguration().pointsNeededToWin;
+
+   state.pointsScoredByLeftPaddle  = std::min(state.pointsScoredByLeftPaddle + events.pointsScoredByLeftPaddle, pointsNeededToWin);
+   state.pointsScoredByRightPaddle = std::min(state.pointsScoredByRightPaddle + events.pointsScoredByRightPaddle, pointsNeededToWin);
+
+   // A point scored with an extra ball can win the match, in which case the match ends right away instead of waiting for the teapot to land
+   if (state.pointsScoredByLeftPaddle == pointsNeededToWin || state.pointsScoredByRightPaddle == pointsNeededToWin)
    {
-      mPoint->setPosition(mPositionsOfPointsScoredByRightPaddle[i]);
-      mPoint->render(*mGameObject3DShader);
+      state.matchIsOver         = true;
+      eventsOfMatch.matchIsOver = true;
    }
+
+   mSimulation.setState(state);
 }
 
-void resolveCollisionBetweenBallAndPaddle(Ball& ball, const Paddle& paddle, const glm::vec2& vecFromCenterOfCircleToPointOfCollision)
+void PlayState::renderExtraBalls()
 {
-   glm::vec3 currVelocity = ball.getVelocity();
-   glm::vec3 currPos      = ball.getPosition();
+   // The extra balls are drawn with the model of the teapot, at their current positions
+   glm::vec3 positionOfTeapot = mBall->getPosition();
 
-   CollisionDirection collisionDirection = determineDirectionOfCollisionBetweenCircleAndAABB(vecFromCenterOfCircleToPointOfCollision);
-
-   if (collisionDirection == CollisionDirection::Left || collisionDirection == CollisionDirection::Right)
+   for (const BallState& ball : mExtraBalls.getBalls())
    {
-      // Horizontal collision
-
-      // The direction in which the ball bounces off of the paddle depends on the distance between the point where it hits the paddle and the center of the paddle
-      // If it hits the center of the paddle, it bounces off completely horizontally
-      // If it hits either end of the paddle, it bounces off with the maximum possible angle
-      // Note that the speed of the ball is always the same; only its direction changes
+      mBall->setPosition(ball.position);
+      mBall->render(*mGameObject3DShader);
+   }
 
-      float distanceBetweenCenters              = ball.getPosition().y - paddle.getPosition().y;
-      float distanceFromCenterOfPaddleInPercent = distanceBetweenCenters / (paddle.getHeight() / 2.0f);
+   mBall->setPosition(positionOfTeapot);
+}
 
-      float currSpeed = glm::length(currVelocity);
-      currVelocity.x  = -currVelocity.x;
-      currVelocity.y  = ball.getInitialVelocity().y * distanceFromCenterOfPaddleInPercent;
-      currVelocity    = glm::normalize(currVelocity) * currSpeed;
+void PlayState::receivePaddleCommands()
+{
+   if (!mStateChannel->isOpen())
+   {
+      return;
+   }
 
-      float horizontalPenetration = ball.getRadius() - glm::abs(vecFromCenterOfCircleToPointOfCollision.x);
+   PaddleCommand command;
+   while (mStateChannel->receiveCommand(command))
+   {
+      bool         commandIsForLeftPaddle = (command.side == CommandedPaddleIsLeft);
+      bool&        paddleIsCommanded      = commandIsForLeftPaddle ? mLeftPaddleIsCommanded : mRightPaddleIsCommanded;
+      PaddleInput& input                  = commandIsForLeftPaddle ? mCommandedInputs.leftPaddle : mCommandedInputs.rightPaddle;
 
-      if (collisionDirection == CollisionDirection::Left)
+      if (command.returnControl)
       {
-         // Make sure the ball is moving to the right
-         if (currVelocity.x < 0.0f)
-         {
-            currVelocity.x = -1 * currVelocity.x;
-         }
-
-         // Move the ball to the right so that it doesn't overlap with the paddle
-         currPos.x += horizontalPenetration;
+         paddleIsCommanded = false;
+         input             = PaddleInput();
       }
-      else // CollisionDirection::Right
+      else
       {
-         // Make sure the ball is moving to the left
-         if (currVelocity.x > 0.0f)
+         paddleIsCommanded = true;
+         input.moveUp      = (command.moveUp != 0);
+         input.moveDown    = (command.moveDown != 0);
+
+         if (command.releaseBall)
          {
-            currVelocity.x = -1 * currVelocity.x;
+            mCommandedInputs.releaseBall = true;
          }
-
-         // Move the ball to the left so that it doesn't overlap with the paddle
-         currPos.x -= horizontalPenetration;
       }
-   }
-   else
-   {
-      // Vertical collision
-      currVelocity.y = -currVelocity.y;
 
-      float verticalPenetration = ball.getRadius() - glm::abs(vecFromCenterOfCircleToPointOfCollision.y);
-
-      if (collisionDirection == CollisionDirection::Up)
-      {
-         // Make sure the ball is moving downwards
-         if (currVelocity.y > 0.0f)
-         {
-            currVelocity.y = -1 * currVelocity.y;
-         }
+      mSequenceNumberOfLastCommandApplied = command.sequenceNumber;
+   }
+}
 
-         // Move the ball downwards so that it doesn't overlap with the paddle
-         currPos.y -= verticalPenetration;
-      }
-      else // CollisionDirection::Down
-      {
-         // Make sure the ball is moving upwards
-         if (currVelocity.y < 0.0f)
-         {
-            currVelocity.y = -1 * currVelocity.y;
-         }
+void PlayState::displayScore()
+{
+   const MatchState& state = mSimulation.getState();
 
-         // Move the ball upwards so that it doesn't overlap with the paddle
-         currPos.y += verticalPenetration;
-      }
+   for (unsigned int i = 0; i < state.pointsScoredByLeftPaddle; ++i)
+   {
+      mPoint->setPosition(mPositionsOfPointsScoredByLeftPaddle[i]);
+      mPoint->render(*mGameObject3DShader);
    }
 
-   ball.setVelocity(currVelocity);
-   ball.setPosition(currPos);
+   for (unsigned int i = 0; i < state.pointsScoredByRightPaddle; ++i)
+   {
+      mPoint->setPosition(mPositionsOfPointsScoredByRightPaddle[i]);
+      mPoint->render(*mGameObject3DShader);
+   }
 }
@@ -0,0 +1,520 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "replay.h"
+
+const std::uint8_t  replayMagicNumber[4]           = {'T', 'P', 'R', 'P'};
+const std::uint8_t  replayVersion                  = 3;
+
+// The length of a run is stored in the bits above the input
+// Version 1 only stored the 5 bits of the inputs, because every tick was simulated in a single step
+const unsigned int  numberOfBitsPerInput           = 8;
+const unsigned int  numberOfBitsPerInputInVersion1 = 5;
+
+// Versions 1 and 2 don't store the arithmetic of the rules, because every match was simulated with floats
+const std::uint8_t  firstVersionWithArithmetic     = 3;
+
+void writeVarint(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+{
+   // 7 bits per byte, with the most significant bit set on every byte except the last one
+   while (value >= 0x80)
+   {
+      bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+      value >>= 7;
+   }
+
+   bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+bool readVarint(const std::uint8_t*& cursor, const std::uint8_t* end, std::uint64_t& value)
+{
+   value = 0;
+   for (unsigned int shift = 0; shift < 64; shift += 7)
+   {
+      if (cursor == end)
+      {
+         return false;
+      }
+
+      std::uint8_t byte = *cursor++;
+      value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+void writeFloat(std::vector<std::uint8_t>& bytes, float value)
+{
+   // Floats are stored bit for bit, since the simulation must continue from exactly the same state
+   std::uint32_t bits;
+   std::memcpy(&bits, &value, sizeof(bits));
+   for (unsigned int i = 0; i < 4; ++i)
+   {
+      bytes.push_back(static_cast<std::uint8_t>(bits >> (8 * i)));
+   }
+}
+
+bool readFloat(const std::uint8_t*& cursor, const std::uint8_t* end, float& value)
+{
+   if (end - cursor < 4)
+   {
+      return false;
+   }
+
+   std::uint32_t bits = 0;
+   for (unsigned int i = 0; i < 4; ++i)
+   {
+      bits |= static_cast<std::uint32_t>(*cursor++) << (8 * i);
+   }
+
+   std::memcpy(&value, &bits, sizeof(value));
+   return true;
+}
+
+void writeUInt64(std::vector<std::uint8_t>& bytes, std::uint64_t value)
+{
+   for (unsigned int i = 0; i < 8; ++i)
+   {
+      bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+   }
+}
+
+bool readUInt64(const std::uint8_t*& cursor, const std::uint8_t* end, std::uint64_t& value)
+{
+   if (end - cursor < 8)
+   {
+      return false;
+   }
+
+   value = 0;
+   for (unsigned int i = 0; i < 8; ++i)
+   {
+      value |= static_cast<std::uint64_t>(*cursor++) << (8 * i);
+   }
+
+   return true;
+}
+
+void writeKeyframe(std::vector<std::uint8_t>& bytes, const MatchState& state)
+{
+   writeFloat(bytes, state.ball.position.x);
+   writeFloat(bytes, state.ball.position.y);
+   writeFloat(bytes, state.ball.position.z);
+   writeFloat(bytes, state.ball.velocity.x);
+   writeFloat(bytes, state.ball.velocity.y);
+   writeFloat(bytes, state.ball.velocity.z);
+   writeFloat(bytes, state.ball.spinAngularVelocityScaledByBounce);
+   writeFloat(bytes, state.leftPaddle.position.y);
+   writeFloat(bytes, state.rightPaddle.position.y);
+
+   bytes.push_back(static_cast<std::uint8_t>((state.ballIsInPlay  ? 1 : 0) |
+                                             (state.ballIsFalling ? 2 : 0) |
+                                             (state.matchIsOver   ? 4 : 0)));
+   writeVarint(bytes, state.pointsScoredByLeftPaddle);
+   writeVarint(bytes, state.pointsScoredByRightPaddle);
+   writeUInt64(bytes, state.randomNumberGeneratorState);
+}
+
+bool readKeyframe(const std::uint8_t*& cursor, const std::uint8_t* end, const MatchConfiguration& configuration, MatchState& state)
+{
+   // Everything that isn't stored in the keyframe comes from the configuration
+   state             = MatchState();
+   state.ball        = configuration.initialBall;
+   state.leftPaddle  = configuration.initialLeftPaddle;
+   state.rightPaddle = configuration.initialRightPaddle;
+
+   std::uint64_t pointsScoredByLeftPaddle;
+   std::uint64_t pointsScoredByRightPaddle;
+
+   bool valid = readFloat(cursor, end, state.ball.position.x) &&
+                readFloat(cursor, end, state.ball.position.y) &&
+                readFloat(cursor, end, state.ball.position.z) &&
+                readFloat(cursor, end, state.ball.velocity.x) &&
+                readFloat(cursor, end, state.ball.velocity.y) &&
+                readFloat(cursor, end, state.ball.velocity.z) &&
+                readFloat(cursor, end, state.ball.spinAngularVelocityScaledByBounce) &&
+                readFloat(cursor, end, state.leftPaddle.position.y) &&
+                readFloat(cursor, end, state.rightPaddle.position.y) &&
+                (cursor != end);
+   if (!valid)
+   {
+      return false;
+   }
+
+   std::uint8_t flags  = *cursor++;
+   state.ballIsInPlay  = (flags & 1) != 0;
+   state.ballIsFalling = (flags & 2) != 0;
+   state.matchIsOver   = (flags & 4) != 0;
+
+   valid = readVarint(cursor, end, pointsScoredByLeftPaddle) &&
+           readVarint(cursor, end, pointsScoredByRightPaddle) &&
+           readUInt64(cursor, end, state.randomNumberGeneratorState);
+   if (!valid)
+   {
+      return false;
+   }
+
+   state.pointsScoredByLeftPaddle  = static_cast<unsigned int>(pointsScoredByLeftPaddle);
+   state.pointsScoredByRightPaddle = static_cast<unsigned int>(pointsScoredByRightPaddle);
+   return true;
+}
+
+MatchConfiguration configureArithmetic(MatchConfiguration configuration, MatchArithmetic arithmetic)
+{
+   configuration.arithmetic = arithmetic;
+   return configuration;
+}
+
+ReplayRecorder::ReplayRecorder(float secondsPerKeyframe)
+   : mSecondsPerKeyframe(secondsPerKeyframe)
+   , mReplay()
+{
+   start(1.0f / 240.0f);
+}
+
+void ReplayRecorder::start(float deltaTime, MatchArithmetic arithmetic)
+{
+   mReplay.deltaTime        = deltaTime;
+   mReplay.arithmetic       = arithmetic;
+   mReplay.ticksPerKeyframe = std::max(static_cast<std::uint32_t>(std::round(mSecondsPerKeyframe / deltaTime)), 1u);
+   mReplay.inputs.clear();
+   mReplay.serves.clear();
+   mReplay.keyframes.clear();
+}
+
+void ReplayRecorder::recordTick(const MatchState& stateBeforeTick, const MatchInputs& inputs, const MatchEvents& events, unsigned int numberOfSubsteps)
+{
+   std::uint32_t tick = static_cast<std::uint32_t>(mReplay.inputs.size());
+
+   if (tick % mReplay.ticksPerKeyframe == 0)
+   {
+      mReplay.keyframes.push_back(ReplayKeyframe{tick, stateBeforeTick});
+   }
+
+   mReplay.inputs.push_back(packMatchInputs(inputs) | packNumberOfSubsteps(numberOfSubsteps));
+
+   if (events.ballWasReleased)
+   {
+      mReplay.serves.push_back(ReplayServe{tick, static_cast<std::uint8_t>(events.serveDirection)});
+   }
+}
+
+void ReplayRecorder::rewind(std::uint32_t numberOfTicks)
+{
+   if (numberOfTicks >= mReplay.inputs.size())
+   {
+      return;
+   }
+
+   mReplay.inputs.resize(numberOfTicks);
+
+   while (!mReplay.serves.empty() && mReplay.serves.back().tick >= numberOfTicks)
+   {
+      mReplay.serves.pop_back();
+   }
+
+   while (!mReplay.keyframes.empty() && mReplay.keyframes.back().tick >= numberOfTicks)
+   {
+      mReplay.keyframes.pop_back();
+   }
+}
+
+std::uint32_t ReplayRecorder::getNumberOfTicks() const
+{
+   return static_cast<std::uint32_t>(mReplay.inputs.size());
+}
+
+const Replay& ReplayRecorder::getReplay() const
+{
+   return mReplay;
+}
+
+ReplayPlayer::ReplayPlayer(const MatchConfiguration& configuration, const std::shared_ptr<const Replay>& replay)
+   : mReplay(replay)
+   , mSimulation(configureArithmetic(configuration, replay->arithmetic), 0)
+   , mTick(0)
+   , mIndexOfNextServe(0)
+   , mHasDiverged(false)
+{
+   if (!mReplay->keyframes.empty())
+   {
+      mSimulation.setState(mReplay->keyframes[0].state);
+   }
+}
+
+void ReplayPlayer::seek(std::uint32_t tick)
+{
+   if (mReplay->keyframes.empty())
+   {
+      return;
+   }
+
+   tick = std::min(tick, getNumberOfTicks());
+
+   // The keyframes are evenly spaced, so the closest one can be found with a division
+   std::size_t indexOfKeyframe = std::min(static_cast<std::size_t>(tick / mReplay->ticksPerKeyframe), mReplay->keyframes.size() - 1);
+   const ReplayKeyframe& keyframe = mReplay->keyframes[indexOfKeyframe];
+
+   // Restore the keyframe unless the tick is ahead of us and we are already past the keyframe
+   if (tick < mTick || keyframe.tick > mTick)
+   {
+      mSimulation.setState(keyframe.state);
+      mTick = keyframe.tick;
+
+      // Find the first serve at or after the keyframe
+      mIndexOfNextServe = 0;
+      while (mIndexOfNextServe < mReplay->serves.size() && mReplay->serves[mIndexOfNextServe].tick < mTick)
+      {
+         ++mIndexOfNextServe;
+      }
+   }
+
+   fastForward(tick - mTick);
+}
+
+MatchEvents ReplayPlayer::step()
+{
+   if (isAtEnd())
+   {
+      return MatchEvents{};
+   }
+
+   std::uint8_t packedInputs = mReplay->inputs[mTick];
+   MatchEvents  events       = mSimulation.step(unpackMatchInputs(packedInputs), mReplay->deltaTime, unpackNumberOfSubsteps(packedInputs));
+
+   if (events.ballWasReleased)
+   {
+      if (mIndexOfNextServe >= mReplay->serves.size() ||
+          mReplay->serves[mIndexOfNextServe].tick != mTick ||
+          mReplay->serves[mIndexOfNextServe].direction != events.serveDirection)
+      {
+         mHasDiverged = true;
+      }
+
+      ++mIndexOfNextServe;
+   }
+
+   ++mTick;
+   return events;
+}
+
+void ReplayPlayer::fastForward(std::uint32_t numberOfTicks)
+{
+   for (std::uint32_t i = 0; i < numberOfTicks && !isAtEnd(); ++i)
+   {
+      step();
+   }
+}
+
+bool ReplayPlayer::isAtEnd() const
+{
+   return mTick >= getNumberOfTicks();
+}
+
+std::uint32_t ReplayPlayer::getTick() const
+{
+   return mTick;
+}
+
+std::uint32_t ReplayPlayer::getNumberOfTicks() const
+{
+   return static_cast<std::uint32_t>(mReplay->inputs.size());
+}
+
+const MatchState& ReplayPlayer::getState() const
+{
+   return mSimulation.getState();
+}
+
+bool ReplayPlayer::hasDiverged() const
+{
+   return mHasDiverged;
+}
+
+std::vector<std::uint8_t> serializeReplay(const Replay& replay)
+{
+   std::vector<std::uint8_t> bytes(std::begin(replayMagicNumber), std::end(replayMagicNumber));
+   bytes.push_back(replayVersion);
+
+   writeFloat(bytes, replay.deltaTime);
+   bytes.push_back(static_cast<std::uint8_t>(replay.arithmetic));
+   writeVarint(bytes, replay.ticksPerKeyframe);
+   writeVarint(bytes, replay.inputs.size());
+
+   // Inputs, as runs of identical inputs
+   // Players hold keys for many ticks in a row, so most matches only need a few runs per second
+   std::size_t i = 0;
+   while (i < replay.inputs.size())
+   {
+      std::size_t lengthOfRun = 1;
+      while (i + lengthOfRun < replay.inputs.size() && replay.inputs[i + lengthOfRun] == replay.inputs[i])
+      {
+         ++lengthOfRun;
+      }
+
+      writeVarint(bytes, (static_cast<std::uint64_t>(lengthOfRun - 1) << numberOfBitsPerInput) | replay.inputs[i]);
+      i += lengthOfRun;
+   }
+
+   // Serves, as the number of ticks since the previous serve followed by the direction in the lowest 2 bits
+   writeVarint(bytes, replay.serves.size());
+   std::uint32_t tickOfPreviousServe = 0;
+   for (const ReplayServe& serve : replay.serves)
+   {
+      writeVarint(bytes, (static_cast<std::uint64_t>(serve.tick - tickOfPreviousServe) << 2) | (serve.direction & 3));
+      tickOfPreviousServe = serve.tick;
+   }
+
+   // Keyframes, whose ticks are multiples of ticksPerKeyframe
+   writeVarint(bytes, replay.keyframes.size());
+   for (const ReplayKeyframe& keyframe : replay.keyframes)
+   {
+      writeKeyframe(bytes, keyframe.state);
+   }
+
+   return bytes;
+}
+
+bool deserializeReplay(const std::vector<std::uint8_t>& bytes, const MatchConfiguration& configuration, Replay& replay)
+{
+   const std::uint8_t* cursor = bytes.data();
+   const std::uint8_t* end    = bytes.data() + bytes.size();
+
+   if (bytes.size() < 5 || std::memcmp(cursor, replayMagicNumber, 4) != 0 || cursor[4] < 1 || cursor[4] > replayVersion)
+   {
+      return false;
+   }
+
+   std::uint8_t  version              = cursor[4];
+   unsigned int  numberOfBitsOfInputs = (version == 1) ? numberOfBitsPerInputInVersion1 : numberOfBitsPerInput;
+   std::uint64_t maskOfInputs         = (1u << numberOfBitsOfInputs) - 1;
+   cursor += 5;
+
+   if (!readFloat(cursor, end, replay.deltaTime))
+   {
+      return false;
+   }
+
+   replay.arithmetic = MatchArithmetic::FloatingPoint;
+   if (version >= firstVersionWithArithmetic)
+   {
+      if (cursor == end || *cursor > static_cast<std::uint8_t>(MatchArithmetic::FixedPoint))
+      {
+         return false;
+      }
+
+      replay.arithmetic = static_cast<MatchArithmetic>(*cursor++);
+   }
+
+   std::uint64_t ticksPerKeyframe;
+   std::uint64_t numberOfTicks;
+   if (!readVarint(cursor, end, ticksPerKeyframe) ||
+       !readVarint(cursor, end, numberOfTicks) ||
+       ticksPerKeyframe == 0)
+   {
+      return false;
+   }
+   replay.ticksPerKeyframe = static_cast<std::uint32_t>(ticksPerKeyframe);
+
+   // Inputs
+   replay.inputs.clear();
+   replay.inputs.reserve(numberOfTicks);
+   while (replay.inputs.size() < numberOfTicks)
+   {
+      std::uint64_t run;
+      if (!readVarint(cursor, end, run))
+      {
+         return false;
+      }
+
+      std::uint64_t lengthOfRun = (run >> numberOfBitsOfInputs) + 1;
+      if (lengthOfRun > numberOfTicks - replay.inputs.size())
+      {
+         return false;
+      }
+
+      replay.inputs.insert(replay.inputs.end(), static_cast<std::size_t>(lengthOfRun), static_cast<std::uint8_t>(run & maskOfInputs));
+   }
+
+   // Serves
+   std::uint64_t numberOfServes;
+   if (!readVarint(cursor, end, numberOfServes) || numberOfServes > static_cast<std::uint64_t>(end - cursor))
+   {
+      return false;
+   }
+
+   replay.serves.resize(static_cast<std::size_t>(numberOfServes));
+   std::uint64_t tickOfPreviousServe = 0;
+   for (ReplayServe& serve : replay.serves)
+   {
+      std::uint64_t packedServe;
+      if (!readVarint(cursor, end, packedServe))
+      {
+         return false;
+      }
+
+      tickOfPreviousServe += packedServe >> 2;
+      serve.tick           = static_cast<std::uint32_t>(tickOfPreviousServe);
+      serve.direction      = static_cast<std::uint8_t>(packedServe & 3);
+   }
+
+   // Keyframes
+   std::uint64_t numberOfKeyframes;
+   if (!readVarint(cursor, end, numberOfKeyframes) || numberOfKeyframes == 0)
+   {
+      return false;
+   }
+
+   replay.keyframes.resize(static_cast<std::size_t>(numberOfKeyframes));
+   for (std::size_t j = 0; j < replay.keyframes.size(); ++j)
+   {
+      replay.keyframes[j].tick = static_cast<std::uint32_t>(j * replay.ticksPerKeyframe);
+      if (!readKeyframe(cursor, end, configuration, replay.keyframes[j].state))
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool saveReplay(const std::string& filePath, const Replay& replay)
+{
+   std::ofstream file(filePath, std::ios::binary);
+   if (!file)
+   {
+      std::cout << "Error - saveReplay - The following file could not be opened: " << filePath << "\n";
+      return false;
+   }
+
+   std::vector<std::uint8_t> bytes = serializeReplay(replay);
+   file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+   return static_cast<bool>(file);
+}
+
+bool loadReplay(const std::string& filePath, const MatchConfiguration& configuration, Replay& replay)
+{
+   std::ifstream file(filePath, std::ios::binary);
+   if (!file)
+   {
+      std::cout << "Error - loadReplay - The following file could not be opened: " << filePath << "\n";
+      return false;
+   }
+
+   std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+   if (!deserializeReplay(bytes, configuration, replay))
+   {
+      std::cout << "Error - loadReplay - The following file is not a valid replay: " << filePath << "\n";
+      return false;
+   }
+
+   return true;
+}
@@ -0,0 +1,122 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "paddle_controller.h"
+#include "replay.h"
+
+// Records and inspects replays without a window
+// Usage:
+//   teapong_replay record FILE [SEED] [--fixed-point]  Plays a match between two computer-controlled paddles and saves its replay
+//                                                      With --fixed-point, the match is simulated with the fixed-point rules, so the replay plays back identically on every build
+//   teapong_replay info FILE                           Plays a replay back as fast as possible and measures how long it takes to seek within it
+
+int recordReplay(const std::string& filePath, std::uint64_t seed, MatchArithmetic arithmetic)
+{
+   MatchConfiguration config;
+   float              deltaTime = 1.0f / 240.0f;
+   config.arithmetic            = arithmetic;
+
+   MatchSimulation          simulation(config, seed);
+   TrackingPaddleController leftController(0.5f);
+   TrackingPaddleController rightController(0.5f);
+   leftController.reset(PaddleSide::Left, drawRandomNumber(seed));
+   rightController.reset(PaddleSide::Right, drawRandomNumber(seed));
+
+   ReplayRecorder recorder(5.0f);
+   recorder.start(deltaTime, arithmetic);
+
+   // Stop after 10 minutes in case neither paddle can win
+   for (unsigned int tick = 0; tick < 600 * 240 && !simulation.getState().matchIsOver; ++tick)
+   {
+      MatchState  stateBeforeTick = simulation.getState();
+      MatchInputs inputs;
+      inputs.leftPaddle  = leftController.decide(stateBeforeTick, config, deltaTime);
+      inputs.rightPaddle = rightController.decide(stateBeforeTick, config, deltaTime);
+      inputs.releaseBall = !stateBeforeTick.ballIsInPlay;
+
+      recorder.recordTick(stateBeforeTick, inputs, simulation.step(inputs, deltaTime));
+   }
+
+   if (!saveReplay(filePath, recorder.getReplay()))
+   {
+      return -1;
+   }
+
+   const MatchState& state = simulation.getState();
+   std::cout << "Recorded " << recorder.getNumberOfTicks() << " ticks (" << recorder.getNumberOfTicks() * deltaTime << " s), final score "
+             << state.pointsScoredByLeftPaddle << " - " << state.pointsScoredByRightPaddle << ", "
+             << serializeReplay(recorder.getReplay()).size() << " bytes" << "\n";
+   return 0;
+}
+
+int inspectReplay(const std::string& filePath)
+{
+   MatchConfiguration      config;
+   std::shared_ptr<Replay> replay = std::make_shared<Replay>();
+   if (!loadReplay(filePath, config, *replay))
+   {
+      return -1;
+   }
+
+   ReplayPlayer  player(config, replay);
+   std::uint32_t numberOfTicks = player.getNumberOfTicks();
+   double        durationOfMatch = numberOfTicks * replay->deltaTime;
+
+   std::cout << "Arithmetic: " << ((replay->arithmetic == MatchArithmetic::FixedPoint) ? "fixed point" : "floating point") << "\n";
+   std::cout << "Ticks: " << numberOfTicks << " (" << durationOfMatch << " s at " << (1.0f / replay->deltaTime) << " ticks/s)" << "\n";
+   std::cout << "Size: " << serializeReplay(*replay).size() << " bytes, " << replay->keyframes.size() << " keyframes, " << replay->serves.size() << " serves" << "\n";
+
+   // Fast-forward through the whole match
+   auto start = std::chrono::steady_clock::now();
+   player.fastForward(numberOfTicks);
+   double secondsSpentFastForwarding = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   const MatchState& state = player.getState();
+   std::cout << "Final score: " << state.pointsScoredByLeftPaddle << " - " << state.pointsScoredByRightPaddle << (player.hasDiverged() ? " (diverged from the recording)" : "") << "\n";
+   std::cout << "Fast-forward: " << secondsSpentFastForwarding * 1e3 << " ms, " << (durationOfMatch / secondsSpentFastForwarding) << "x real time" << "\n";
+
+   // Seek to ticks spread over the whole match, in a shuffled order
+   unsigned int  numberOfSeeks = 1000;
+   std::uint64_t randomNumberGeneratorState = 0;
+   start = std::chrono::steady_clock::now();
+   for (unsigned int i = 0; i < numberOfSeeks; ++i)
+   {
+      player.seek(static_cast<std::uint32_t>(drawRandomNumber(randomNumberGeneratorState) % (numberOfTicks + 1)));
+   }
+   double secondsSpentSeeking = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   std::cout << "Seek: " << (secondsSpentSeeking / numberOfSeeks) * 1e6 << " us on average" << "\n";
+
+   return player.hasDiverged() ? -1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+   if (argc >= 3 && std::strcmp(argv[1], "record") == 0)
+   {
+      std::uint64_t   seed       = 1;
+      MatchArithmetic arithmetic = MatchArithmetic::FloatingPoint;
+      for (int i = 3; i < argc; ++i)
+      {
+         if (std::strcmp(argv[i], "--fixed-point") == 0)
+         {
+            arithmetic = MatchArithmetic::FixedPoint;
+         }
+         else
+         {
+            seed = std::strtoull(argv[i], nullptr, 10);
+         }
+      }
+
+      return recordReplay(argv[2], seed, arithmetic);
+   }
+   else if (argc >= 3 && std::strcmp(argv[1], "info") == 0)
+   {
+      return inspectReplay(argv[2]);
+   }
+
+   std::cout << "Usage: teapong_replay record FILE [SEED] [--fixed-point]" << "\n";
+   std::cout << "       teapong_replay info FILE" << "\n";
+   return -1;
+}
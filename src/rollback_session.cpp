@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "rollback_session.h"
+
+RollbackSession::RollbackSession(const MatchConfiguration& configuration,
+                                 std::uint64_t             seed,
+                                 PaddleSide                localSide,
+                                 unsigned int              maxNumberOfFramesRolledBack,
+                                 unsigned int              inputDelay)
+   : mSimulation(configuration, seed)
+   , mLocalSide(localSide)
+   , mMaxNumberOfFramesRolledBack(std::max(maxNumberOfFramesRolledBack, 1u))
+   , mInputDelay(inputDelay)
+   , mFrames()
+   , mCurrentFrame(0)
+   , mNumberOfConfirmedFrames(inputDelay)
+   , mNumberOfLocalInputs(inputDelay)
+   , mFirstMispredictedFrame(0)
+   , mPredictionWasWrong(false)
+   , mCounters()
+{
+   // The remote player can be up to a full rollback and both input delays ahead of the local one,
+   // so the ring must hold that many frames in addition to the ones that can be rolled back
+   mFrames.resize(mMaxNumberOfFramesRolledBack + (2 * mInputDelay) + 2, Frame());
+
+   // Nobody can press anything during the frames covered by the input delay
+   for (std::uint32_t frame = 0; frame < mInputDelay; ++frame)
+   {
+      getFrame(frame).localInput  = 0;
+      getFrame(frame).remoteInput = 0;
+   }
+}
+
+bool RollbackSession::canAdvanceFrame() const
+{
+   return mCurrentFrame < mNumberOfConfirmedFrames + mMaxNumberOfFramesRolledBack;
+}
+
+void RollbackSession::stallFrame()
+{
+   ++mCounters.numberOfFramesStalled;
+}
+
+void RollbackSession::setLocalInput(std::uint8_t packedInput)
+{
+   if (mNumberOfLocalInputs > mCurrentFrame + mInputDelay)
+   {
+      std::cout << "Error - RollbackSession::setLocalInput - The local inputs of frame " << mNumberOfLocalInputs << " can't be set before frame " << mCurrentFrame << " is simulated" << "\n";
+      return;
+   }
+
+   getFrame(mNumberOfLocalInputs).localInput = packedInput;
+   ++mNumberOfLocalInputs;
+}
+
+bool RollbackSession::addRemoteInput(std::uint32_t frame, std::uint8_t packedInput)
+{
+   // Frames beyond the ring would overwrite frames that are still needed, so they are dropped and sent again later
+   std::uint32_t oldestFrameInUse = std::min(mCurrentFrame, mNumberOfConfirmedFrames);
+   if (frame != mNumberOfConfirmedFrames || frame >= oldestFrameInUse + mFrames.size() - 1)
+   {
+      return false;
+   }
+
+   Frame& confirmedFrame      = getFrame(frame);
+   confirmedFrame.remoteInput = packedInput;
+   ++mNumberOfConfirmedFrames;
+
+   if (frame < mCurrentFrame && confirmedFrame.simulatedRemoteInput != packedInput && !mPredictionWasWrong)
+   {
+      mFirstMispredictedFrame = frame;
+      mPredictionWasWrong     = true;
+   }
+
+   return true;
+}
+
+MatchEvents RollbackSession::advanceFrame(float deltaTime)
+{
+   if (mNumberOfLocalInputs <= mCurrentFrame)
+   {
+      std::cout << "Error - RollbackSession::advanceFrame - The local inputs of frame " << mCurrentFrame << " haven't been set" << "\n";
+      return MatchEvents();
+   }
+
+   if (mPredictionWasWrong)
+   {
+      auto start = std::chrono::steady_clock::now();
+
+      mSimulation.setState(getFrame(mFirstMispredictedFrame).state);
+      for (std::uint32_t frame = mFirstMispredictedFrame; frame < mCurrentFrame; ++frame)
+      {
+         simulateFrame(frame, deltaTime);
+      }
+
+      double       secondsSpent             = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      unsigned int numberOfFramesRolledBack = mCurrentFrame - mFirstMispredictedFrame;
+
+      ++mCounters.numberOfRollbacks;
+      mCounters.numberOfFramesSimulatedAgain += numberOfFramesRolledBack;
+      mCounters.maxNumberOfFramesRolledBack   = std::max(mCounters.maxNumberOfFramesRolledBack, numberOfFramesRolledBack);
+      mCounters.secondsSpentRollingBack      += secondsSpent;
+      mCounters.maxSecondsSpentByARollback    = std::max(mCounters.maxSecondsSpentByARollback, secondsSpent);
+
+      mPredictionWasWrong = false;
+   }
+
+   MatchEvents events = simulateFrame(mCurrentFrame, deltaTime);
+   ++mCurrentFrame;
+
+   return events;
+}
+
+std::uint32_t RollbackSession::getCurrentFrame() const
+{
+   return mCurrentFrame;
+}
+
+std::uint32_t RollbackSession::getNumberOfConfirmedFrames() const
+{
+   return mNumberOfConfirmedFrames;
+}
+
+std::uint32_t RollbackSession::getNumberOfLocalInputs() const
+{
+   return mNumberOfLocalInputs;
+}
+
+std::uint8_t RollbackSession::getLocalInput(std::uint32_t frame) const
+{
+   return getFrame(frame).localInput;
+}
+
+bool RollbackSession::getConfirmedState(std::uint32_t frame, MatchState& state) const
+{
+   // The state at the start of the current frame is the state of the simulation, which hasn't been saved yet
+   if (frame > mCurrentFrame || frame > mNumberOfConfirmedFrames || frame + mFrames.size() <= mCurrentFrame)
+   {
+      return false;
+   }
+
+   state = (frame == mCurrentFrame) ? mSimulation.getState() : getFrame(frame).state;
+   return true;
+}
+
+const MatchState& RollbackSession::getState() const
+{
+   return mSimulation.getState();
+}
+
+const MatchSimulation& RollbackSession::getSimulation() const
+{
+   return mSimulation;
+}
+
+PaddleSide RollbackSession::getLocalSide() const
+{
+   return mLocalSide;
+}
+
+unsigned int RollbackSession::getInputDelay() const
+{
+   return mInputDelay;
+}
+
+unsigned int RollbackSession::getMaxNumberOfFramesRolledBack() const
+{
+   return mMaxNumberOfFramesRolledBack;
+}
+
+const RollbackCounters& RollbackSession::getCounters() const
+{
+   return mCounters;
+}
+
+RollbackSession::Frame& RollbackSession::getFrame(std::uint32_t frame)
+{
+   return mFrames[frame % mFrames.size()];
+}
+
+const RollbackSession::Frame& RollbackSession::getFrame(std::uint32_t frame) const
+{
+   return mFrames[frame % mFrames.size()];
+}
+
+std::uint8_t RollbackSession::predictRemoteInput(std::uint32_t frame) const
+{
+   if (frame < mNumberOfConfirmedFrames)
+   {
+      return getFrame(frame).remoteInput;
+   }
+
+   // The remote player is assumed to keep holding the keys they were last seen holding
+   // Releasing the ball is a single press, so it isn't repeated
+   if (mNumberOfConfirmedFrames == 0)
+   {
+      return 0;
+   }
+
+   return getFrame(mNumberOfConfirmedFrames - 1).remoteInput & ~BallIsReleased;
+}
+
+MatchEvents RollbackSession::simulateFrame(std::uint32_t frame, float deltaTime)
+{
+   Frame& simulatedFrame               = getFrame(frame);
+   simulatedFrame.state                = mSimulation.getState();
+   simulatedFrame.simulatedRemoteInput = predictRemoteInput(frame);
+
+   MatchInputs inputs = (mLocalSide == PaddleSide::Left) ? combineInputsOfPlayers(simulatedFrame.localInput, simulatedFrame.simulatedRemoteInput)
+                                                         : combineInputsOfPlayers(simulatedFrame.simulatedRemoteInput, simulatedFrame.localInput);
+
+   // The sub-steps are derived from the state rather than from a time budget, and with the numbers of the rules, so that both machines split the frame in the same way
+   unsigned int numberOfSubsteps = mSimulation.calculateNumberOfSubstepsNeeded(deltaTime, maxNumberOfSubstepsPerTick);
+
+   return mSimulation.step(inputs, deltaTime, numberOfSubsteps);
+}
+
+MatchInputs combineInputsOfPlayers(std::uint8_t packedInputOfLeftPlayer, std::uint8_t packedInputOfRightPlayer)
+{
+   std::uint8_t leftBits  = LeftPaddleMovesUp | LeftPaddleMovesDown | BallIsReleased;
+   std::uint8_t rightBits = RightPaddleMovesUp | RightPaddleMovesDown | BallIsReleased;
+
+   return unpackMatchInputs((packedInputOfLeftPlayer & leftBits) | (packedInputOfRightPlayer & rightBits));
+}
+
+std::uint8_t packInputOfPlayer(PaddleSide side, const PaddleInput& input, bool releaseBall)
+{
+   MatchInputs inputs = MatchInputs();
+   inputs.releaseBall = releaseBall;
+
+   if (side == PaddleSide::Left)
+   {
+      inputs.leftPaddle = input;
+   }
+   else
+   {
+      inputs.rightPaddle = input;
+   }
+
+   return packMatchInputs(inputs);
+}
+
+std::uint64_t calculateChecksumOfMatchState(const MatchState& state)
+{
+   // FNV-1a
+   std::uint64_t checksum = 0xCBF29CE484222325ull;
+   auto          addBytes = [&checksum](const void* bytes, std::size_t numberOfBytes)
+   {
+      for (std::size_t i = 0; i < numberOfBytes; ++i)
+      {
+         checksum = (checksum ^ static_cast<const std::uint8_t*>(bytes)[i]) * 0x100000001B3ull;
+      }
+   };
+
+   auto addVector = [&addBytes](const glm::vec3& vector)
+   {
+      addBytes(&vector.x, sizeof(float));
+      addBytes(&vector.y, sizeof(float));
+      addBytes(&vector.z, sizeof(float));
+   };
+
+   auto addPaddle = [&addBytes, &addVector](const PaddleState& paddle)
+   {
+      addVector(paddle.position);
+      addVector(paddle.velocity);
+      addBytes(&paddle.width, sizeof(paddle.width));
+      addBytes(&paddle.height, sizeof(paddle.height));
+   };
+
+   addVector(state.ball.position);
+   addVector(state.ball.velocity);
+   addVector(state.ball.initialVelocity);
+   addBytes(&state.ball.radius, sizeof(state.ball.radius));
+   addBytes(&state.ball.spinAngularVelocity, sizeof(state.ball.spinAngularVelocity));
+   addBytes(&state.ball.spinAngularVelocityScaledByBounce, sizeof(state.ball.spinAngularVelocityScaledByBounce));
+
+   addPaddle(state.leftPaddle);
+   addPaddle(state.rightPaddle);
+
+   std::uint8_t flags = (state.ballIsInPlay ? 1 : 0) | (state.ballIsFalling ? 2 : 0) | (state.matchIsOver ? 4 : 0);
+   addBytes(&flags, sizeof(flags));
+   addBytes(&state.pointsScoredByLeftPaddle, sizeof(state.pointsScoredByLeftPaddle));
+   addBytes(&state.pointsScoredByRightPaddle, sizeof(state.pointsScoredByRightPaddle));
+   addBytes(&state.randomNumberGeneratorState, sizeof(state.randomNumberGeneratorState));
+
+   return checksum;
+}
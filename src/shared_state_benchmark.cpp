@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shared_state_channel.h"
+
+// Measures the cost and the latency of the shared state channel
+// Usage: teapong_shared_state_benchmark [--seconds S] [--rate HZ]
+//   --seconds  Length of the latency test (defaults to 5)
+//   --rate     Number of states published per second during the latency test, like the updates of the game (defaults to 240, 0 publishes as fast as possible)
+// The cost of each operation is measured first in a single process
+// The latency is then measured with a child process that plays the role of a bot: it spins until a new state is published, and sends a command every few states,
+// while the parent plays the role of the game: it publishes the states at the given rate and applies the commands it receives before publishing the next state
+// Both processes spin, so the latency is only representative when the machine has a core for each of them
+
+const unsigned int  numberOfOperationsTimed = 1000000;
+const std::uint64_t statesBetweenCommands   = 16;
+
+std::uint64_t getTimeInNanoseconds()
+{
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void printPercentiles(const std::string& name, std::vector<std::uint64_t>& nanoseconds)
+{
+   if (nanoseconds.empty())
+   {
+      std::cout << name << ": no samples" << "\n";
+      return;
+   }
+
+   std::sort(nanoseconds.begin(), nanoseconds.end());
+
+   auto percentile = [&nanoseconds](double fraction)
+   {
+      return nanoseconds[std::min(nanoseconds.size() - 1, static_cast<std::size_t>(fraction * nanoseconds.size()))] / 1000.0;
+   };
+
+   std::cout << name << " (" << nanoseconds.size() << " samples): "
+             << percentile(0.5) << " us median, " << percentile(0.99) << " us 99th percentile, " << percentile(0.999) << " us 99.9th percentile, "
+             << (nanoseconds.back() / 1000.0) << " us at most" << "\n";
+}
+
+void measureCostOfOperations(const std::string& channelName)
+{
+   SharedStateChannel game;
+   SharedStateChannel client;
+   if (!game.create(channelName) || !client.open(channelName))
+   {
+      return;
+   }
+
+   PublishedState state = {};
+   auto start = std::chrono::steady_clock::now();
+   for (unsigned int i = 0; i < numberOfOperationsTimed; ++i)
+   {
+      state.frameOfMatch = i;
+      game.publishState(state);
+   }
+   double publishSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   std::uint64_t checksum = 0;
+   start = std::chrono::steady_clock::now();
+   for (unsigned int i = 0; i < numberOfOperationsTimed; ++i)
+   {
+      client.readLatestState(state);
+      checksum += state.frameOfMatch;
+   }
+   double readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   PaddleCommand command = {};
+   start = std::chrono::steady_clock::now();
+   for (unsigned int i = 0; i < numberOfOperationsTimed; ++i)
+   {
+      command.sequenceNumber = i;
+      client.sendCommand(command);
+      game.receiveCommand(command);
+      checksum += command.sequenceNumber;
+   }
+   double commandSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   std::cout << "Publishing a state takes " << (publishSeconds * 1e9 / numberOfOperationsTimed) << " ns, reading the newest one takes "
+             << (readSeconds * 1e9 / numberOfOperationsTimed) << " ns, sending and receiving a command takes " << (commandSeconds * 1e9 / numberOfOperationsTimed)
+             << " ns (checksum " << checksum << ")" << "\n";
+}
+
+// The bot reads every state as soon as it's published, and measures how long each one took to reach it and how long its commands took to be applied
+int runBot(const std::string& channelName, double seconds)
+{
+   SharedStateChannel channel;
+   if (!channel.open(channelName))
+   {
+      return -1;
+   }
+
+   std::vector<std::uint64_t> latencyOfStates;
+   std::vector<std::uint64_t> latencyOfCommands;
+   std::uint64_t              numberOfStatesMissed   = 0;
+   std::uint64_t              nextTickToRead         = channel.getNumberOfStatesPublished();
+   std::uint64_t              sequenceNumberInFlight = 0;
+   std::uint64_t              timeWhenCommandWasSent = 0;
+   std::uint64_t              timeWhenStarted        = getTimeInNanoseconds();
+
+   PublishedState state;
+   while (getTimeInNanoseconds() - timeWhenStarted < seconds * 1e9)
+   {
+      if (nextTickToRead == channel.getNumberOfStatesPublished())
+      {
+         continue;
+      }
+
+      if (!channel.readState(nextTickToRead, state))
+      {
+         // The game published more states than the ring holds since the last one that was read, so the bot jumps to the newest one
+         std::uint64_t tickOfNewestState = channel.getNumberOfStatesPublished() - 1;
+         numberOfStatesMissed += tickOfNewestState - nextTickToRead;
+         nextTickToRead        = tickOfNewestState;
+         continue;
+      }
+
+      std::uint64_t now = getTimeInNanoseconds();
+      latencyOfStates.push_back(now - state.timeWhenPublishedInNanoseconds);
+      ++nextTickToRead;
+
+      if ((sequenceNumberInFlight != 0) && (state.sequenceNumberOfLastCommandApplied == sequenceNumberInFlight))
+      {
+         // From sending the command to seeing the state in which it was applied, which is what a bot that reacts to the game experiences
+         latencyOfCommands.push_back(now - timeWhenCommandWasSent);
+         sequenceNumberInFlight = 0;
+      }
+
+      if ((sequenceNumberInFlight == 0) && (state.tick % statesBetweenCommands == 0))
+      {
+         PaddleCommand command  = {};
+         command.sequenceNumber = state.tick + 1;
+         command.moveUp         = 1;
+         timeWhenCommandWasSent = getTimeInNanoseconds();
+         if (channel.sendCommand(command))
+         {
+            sequenceNumberInFlight = command.sequenceNumber;
+         }
+      }
+   }
+
+   printPercentiles("From publishing a state to reading it", latencyOfStates);
+   printPercentiles("From sending a command to reading the state in which it was applied", latencyOfCommands);
+   std::cout << "States that were overwritten before they could be read: " << numberOfStatesMissed << "\n";
+   return 0;
+}
+
+int main(int argc, char* argv[])
+{
+   double seconds = 5.0;
+   double rate    = 240.0;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      bool hasValue = (i + 1 < argc);
+
+      if (std::strcmp(argv[i], "--seconds") == 0 && hasValue)
+      {
+         seconds = std::strtod(argv[++i], nullptr);
+      }
+      else if (std::strcmp(argv[i], "--rate") == 0 && hasValue)
+      {
+         rate = std::strtod(argv[++i], nullptr);
+      }
+      else
+      {
+         std::cout << "Error - main - Unknown argument: " << argv[i] << "\n";
+         return -1;
+      }
+   }
+
+   std::string channelName = "/teapong_benchmark_" + std::to_string(getpid());
+
+   measureCostOfOperations(channelName);
+
+   if (std::thread::hardware_concurrency() < 2)
+   {
+      std::cout << "This machine has a single core, so the game and the bot take turns and the latencies below include the time slices of the scheduler" << "\n";
+   }
+
+   // The channel is created before the bot is started, so that the bot can open it right away
+   SharedStateChannel game;
+   if (!game.create(channelName))
+   {
+      return -1;
+   }
+
+   // Anything left in the buffer of std::cout would be printed by both processes
+   std::cout.flush();
+
+   pid_t bot = fork();
+   if (bot == -1)
+   {
+      std::cout << "Error - main - Failed to start the bot" << "\n";
+      return -1;
+   }
+
+   if (bot == 0)
+   {
+      std::exit(runBot(channelName, seconds));
+   }
+
+   std::uint64_t  nanosecondsBetweenStates    = (rate > 0.0) ? static_cast<std::uint64_t>(1e9 / rate) : 0;
+   std::uint64_t  timeOfNextState             = getTimeInNanoseconds();
+   std::uint64_t  sequenceNumberOfLastCommand = 0;
+   std::uint64_t  numberOfStatesPublished     = 0;
+   PublishedState state                       = {};
+   PaddleCommand  command;
+
+   while (true)
+   {
+      // Checking on the bot is a system call, so it's only done every few states when the states are published as fast as possible
+      if ((rate > 0.0) || (numberOfStatesPublished % 4096 == 0))
+      {
+         int status;
+         if (waitpid(bot, &status, WNOHANG) == bot)
+         {
+            break;
+         }
+      }
+
+      while (getTimeInNanoseconds() < timeOfNextState)
+      {
+      }
+      timeOfNextState += nanosecondsBetweenStates;
+
+      while (game.receiveCommand(command))
+      {
+         sequenceNumberOfLastCommand = command.sequenceNumber;
+      }
+
+      state.frameOfMatch                       = numberOfStatesPublished;
+      state.sequenceNumberOfLastCommandApplied = sequenceNumberOfLastCommand;
+      state.timeWhenPublishedInNanoseconds     = getTimeInNanoseconds();
+      game.publishState(state);
+      ++numberOfStatesPublished;
+   }
+
+   std::cout << "States published: " << numberOfStatesPublished << "\n";
+   return 0;
+}
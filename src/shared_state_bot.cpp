@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include "shared_state_channel.h"
+
+// Sample client of the shared state channel, which plays one side of the game that is running on the same machine
+// Usage: teapong_bot [--channel NAME] [--side left|right] [--seconds S] [--poll-interval US]
+//   --channel        Name of the channel created by the game (defaults to /teapong)
+//   --side           Paddle that the bot controls (defaults to right)
+//   --seconds        Time after which the bot gives the paddle back (defaults to playing until the game is closed)
+//   --poll-interval  Time that the bot sleeps when there is no new state (defaults to 0, which makes the bot spin and react as soon as a state is published)
+// Every 5 seconds, the bot prints how long the states took to reach it and how long its commands took to be applied by the game
+
+// The paddle only moves when the ball is further than this from its center, so that it doesn't jitter around the ball
+const float       deadZone                   = 1.0f;
+
+// The bot serves a second after the ball is put back on the table
+const float       secondsBeforeServing       = 1.0f;
+
+const float       secondsBetweenSummaries    = 5.0f;
+
+// Commands whose sending time is remembered to measure how long they take to be applied
+const std::size_t numberOfCommandsRemembered = 64;
+
+std::uint64_t getTimeInNanoseconds()
+{
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct LatencyStatistics
+{
+   LatencyStatistics()
+      : count(0)
+      , sum(0)
+      , max(0)
+   {
+
+   }
+
+   void add(std::uint64_t nanoseconds)
+   {
+      ++count;
+      sum += nanoseconds;
+      max  = std::max(max, nanoseconds);
+   }
+
+   double getAverageInMicroseconds() const
+   {
+      return (count > 0) ? (static_cast<double>(sum) / count / 1000.0) : 0.0;
+   }
+
+   double getMaxInMicroseconds() const
+   {
+      return max / 1000.0;
+   }
+
+   std::uint64_t count;
+   std::uint64_t sum;
+   std::uint64_t max;
+};
+
+int main(int argc, char* argv[])
+{
+   std::string  channelName          = "/teapong";
+   bool         controlsLeftPaddle   = false;
+   double       seconds              = 0.0;
+   unsigned int pollIntervalInMicros = 0;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      bool hasValue = (i + 1 < argc);
+
+      if (std::strcmp(argv[i], "--channel") == 0 && hasValue)
+      {
+         channelName = argv[++i];
+      }
+      else if (std::strcmp(argv[i], "--side") == 0 && hasValue)
+      {
+         controlsLeftPaddle = (std::strcmp(argv[++i], "left") == 0);
+      }
+      else if (std::strcmp(argv[i], "--seconds") == 0 && hasValue)
+      {
+         seconds = std::strtod(argv[++i], nullptr);
+      }
+      else if (std::strcmp(argv[i], "--poll-interval") == 0 && hasValue)
+      {
+         pollIntervalInMicros = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else
+      {
+         std::cout << "Error - main - Unknown argument: " << argv[i] << "\n";
+         return -1;
+      }
+   }
+
+   SharedStateChannel channel;
+   if (!channel.open(channelName))
+   {
+      std::cout << "Start the game before the bot" << "\n";
+      return -1;
+   }
+
+   std::uint8_t  side                     = controlsLeftPaddle ? CommandedPaddleIsLeft : CommandedPaddleIsRight;
+   std::uint32_t flagOfControlledPaddle   = controlsLeftPaddle ? LeftPaddleIsControlledByCommands : RightPaddleIsControlledByCommands;
+
+   std::uint64_t timeWhenStarted          = getTimeInNanoseconds();
+   std::uint64_t timeOfLastSummary        = timeWhenStarted;
+   std::uint64_t timeWhenBallWasReset     = timeWhenStarted;
+   bool          ballWasInPlay            = false;
+
+   std::uint64_t nextTickToRead           = channel.getNumberOfStatesPublished();
+   std::uint64_t numberOfStatesRead       = 0;
+   std::uint64_t numberOfStatesMissed     = 0;
+
+   // The game remembers the last command of the previous client, so the sequence numbers continue from it
+   PublishedState state;
+   std::uint64_t  latestSequenceNumberSeen = channel.readLatestState(state) ? state.sequenceNumberOfLastCommandApplied : 0;
+   std::uint64_t  nextSequenceNumber       = latestSequenceNumberSeen + 1;
+   std::uint64_t  timesWhenCommandsWereSent[numberOfCommandsRemembered] = {};
+   PaddleCommand  lastCommandSent          = {};
+
+   LatencyStatistics latencyOfStates;
+   LatencyStatistics latencyOfCommands;
+
+   while (channel.isPublisherAlive())
+   {
+      std::uint64_t numberOfStatesPublished = channel.getNumberOfStatesPublished();
+      if (nextTickToRead == numberOfStatesPublished)
+      {
+         if (pollIntervalInMicros > 0)
+         {
+            std::this_thread::sleep_for(std::chrono::microseconds(pollIntervalInMicros));
+         }
+
+         continue;
+      }
+
+      // Only the newest state matters to the bot, so the ones that were published since the last one it read are skipped
+      if (!channel.readLatestState(state))
+      {
+         continue;
+      }
+
+      std::uint64_t now = getTimeInNanoseconds();
+      latencyOfStates.add(now - state.timeWhenPublishedInNanoseconds);
+      numberOfStatesMissed += state.tick - nextTickToRead;
+      nextTickToRead        = state.tick + 1;
+      ++numberOfStatesRead;
+
+      if (state.sequenceNumberOfLastCommandApplied > latestSequenceNumberSeen)
+      {
+         latestSequenceNumberSeen = state.sequenceNumberOfLastCommandApplied;
+         if (nextSequenceNumber - latestSequenceNumberSeen <= numberOfCommandsRemembered)
+         {
+            latencyOfCommands.add(state.timeWhenPublishedInNanoseconds - timesWhenCommandsWereSent[latestSequenceNumberSeen % numberOfCommandsRemembered]);
+         }
+      }
+
+      if ((seconds > 0.0) && (now - timeWhenStarted > seconds * 1e9))
+      {
+         break;
+      }
+
+      if (now - timeOfLastSummary > secondsBetweenSummaries * 1e9)
+      {
+         std::cout << "States: " << numberOfStatesRead << " read, " << numberOfStatesMissed << " skipped, "
+                   << latencyOfStates.getAverageInMicroseconds() << " us on average from publishing to reading, " << latencyOfStates.getMaxInMicroseconds() << " us at most" << "\n";
+         std::cout << "Commands: " << latencyOfCommands.count << " applied, "
+                   << latencyOfCommands.getAverageInMicroseconds() << " us on average from sending to publishing, " << latencyOfCommands.getMaxInMicroseconds() << " us at most" << "\n";
+         timeOfLastSummary = now;
+         latencyOfStates   = LatencyStatistics();
+         latencyOfCommands = LatencyStatistics();
+      }
+
+      if (state.gameState != GameStateIsPlay)
+      {
+         continue;
+      }
+
+      bool ballIsInPlay = (state.flags & BallIsInPlay) != 0;
+      if (ballWasInPlay && !ballIsInPlay)
+      {
+         timeWhenBallWasReset = now;
+      }
+      ballWasInPlay = ballIsInPlay;
+
+      // Follow the ball while it approaches, and go back to the center of the line otherwise
+      const float* paddlePosition    = controlsLeftPaddle ? state.leftPaddlePosition : state.rightPaddlePosition;
+      bool         ballIsApproaching = ballIsInPlay && ((state.flags & BallIsFalling) == 0) &&
+                                       (controlsLeftPaddle ? (state.ballVelocity[0] < 0.0f) : (state.ballVelocity[0] > 0.0f));
+      float        targetPositionY   = ballIsApproaching ? state.ballPosition[1] : 0.0f;
+
+      PaddleCommand command = {};
+      command.side          = side;
+      command.moveUp        = (targetPositionY > paddlePosition[1] + deadZone) ? 1 : 0;
+      command.moveDown      = (targetPositionY < paddlePosition[1] - deadZone) ? 1 : 0;
+      command.releaseBall   = (!ballIsInPlay && (now - timeWhenBallWasReset > secondsBeforeServing * 1e9)) ? 1 : 0;
+
+      // Only one command is in flight at a time, and a new one is only sent when the bot changes its mind
+      bool gameHasAppliedLastCommand = (latestSequenceNumberSeen + 1 == nextSequenceNumber);
+      bool paddleIsControlled        = (state.flags & flagOfControlledPaddle) != 0;
+      if (!gameHasAppliedLastCommand ||
+          (paddleIsControlled && !command.releaseBall && (command.moveUp == lastCommandSent.moveUp) && (command.moveDown == lastCommandSent.moveDown)))
+      {
+         continue;
+      }
+
+      command.sequenceNumber = nextSequenceNumber;
+      timesWhenCommandsWereSent[nextSequenceNumber % numberOfCommandsRemembered] = getTimeInNanoseconds();
+      if (channel.sendCommand(command))
+      {
+         lastCommandSent = command;
+         ++nextSequenceNumber;
+      }
+   }
+
+   if (channel.isPublisherAlive())
+   {
+      PaddleCommand command  = {};
+      command.sequenceNumber = nextSequenceNumber;
+      command.side           = side;
+      command.returnControl  = 1;
+      channel.sendCommand(command);
+   }
+
+   return 0;
+}
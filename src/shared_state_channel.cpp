@@ -0,0 +1,345 @@
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "shared_state_channel.h"
+
+// The shared memory holds a header, the ring of states and the queue of commands
+// The indices that are written by different processes are kept on different cache lines, so that writing one doesn't slow down the reads of the other
+const std::uint32_t channelMagicNumber      = 0x43535054; // "TPSC"
+const std::uint32_t channelVersion          = 1;
+const std::size_t   numberOfStateSlots      = 64;
+const std::size_t   numberOfCommandSlots    = 256;
+const std::size_t   sizeOfCacheLine         = 64;
+const std::size_t   numberOfWordsPerState   = sizeof(PublishedState) / sizeof(std::uint64_t);
+
+// A reader gives up on a slot after this many attempts, which only happens if the game stopped in the middle of writing it
+const unsigned int  maxNumberOfReadAttempts = 1024;
+
+// Atomics that aren't lock-free are implemented with locks that live in each process, so they wouldn't work across processes
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "The shared state channel needs lock-free atomics");
+
+// The state is copied word by word with relaxed atomics, so that a reader that races with the game reads a torn state instead of causing undefined behaviour
+// The sequence is odd while the game is writing the slot, and readers only keep a copy if the sequence was even and didn't change while they copied it
+struct alignas(sizeOfCacheLine) StateSlot
+{
+   std::atomic<std::uint32_t> sequence;
+   std::atomic<std::uint64_t> words[numberOfWordsPerState];
+};
+
+struct SharedStateChannel::Layout
+{
+   std::atomic<std::uint32_t>                         magicNumber;
+   std::uint32_t                                      version;
+   std::uint32_t                                      sizeOfLayout;
+   std::atomic<std::uint32_t>                         publisherIsAlive;
+
+   alignas(sizeOfCacheLine) std::atomic<std::uint64_t> numberOfStatesPublished;
+   StateSlot                                          stateSlots[numberOfStateSlots];
+
+   // Only written by the client
+   alignas(sizeOfCacheLine) std::atomic<std::uint64_t> numberOfCommandsSent;
+
+   // Only written by the game
+   alignas(sizeOfCacheLine) std::atomic<std::uint64_t> numberOfCommandsReceived;
+
+   alignas(sizeOfCacheLine) PaddleCommand              commands[numberOfCommandSlots];
+};
+
+SharedStateChannel::SharedStateChannel()
+   : mLayout(nullptr)
+   , mName()
+   , mIsCreator(false)
+   , mNextTickToPublish(0)
+   , mNumberOfCommandsSent(0)
+   , mNumberOfCommandsReceived(0)
+   , mCachedNumberOfCommandsSent(0)
+   , mCachedNumberOfCommandsReceived(0)
+{
+
+}
+
+SharedStateChannel::~SharedStateChannel()
+{
+   close();
+}
+
+#ifndef _WIN32
+
+bool SharedStateChannel::create(const std::string& name)
+{
+   close();
+
+   // Remove the channel of a game that crashed, so that clients that still have it mapped don't see the new one get initialized under them
+   shm_unlink(name.c_str());
+
+   int fileDescriptor = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+   if (fileDescriptor == -1)
+   {
+      std::cout << "Error - SharedStateChannel::create - Failed to create " << name << ": " << std::strerror(errno) << "\n";
+      return false;
+   }
+
+   if (ftruncate(fileDescriptor, sizeof(Layout)) == -1)
+   {
+      std::cout << "Error - SharedStateChannel::create - Failed to resize " << name << ": " << std::strerror(errno) << "\n";
+      ::close(fileDescriptor);
+      shm_unlink(name.c_str());
+      return false;
+   }
+
+   void* memory = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+   ::close(fileDescriptor);
+   if (memory == MAP_FAILED)
+   {
+      std::cout << "Error - SharedStateChannel::create - Failed to map " << name << ": " << std::strerror(errno) << "\n";
+      shm_unlink(name.c_str());
+      return false;
+   }
+
+   // The memory of a new shared memory object is filled with zeros, which is what every index and sequence starts at
+   mLayout                           = new (memory) Layout();
+   mLayout->version                  = channelVersion;
+   mLayout->sizeOfLayout             = sizeof(Layout);
+   mLayout->publisherIsAlive.store(1, std::memory_order_relaxed);
+   mLayout->magicNumber.store(channelMagicNumber, std::memory_order_release);
+
+   mName                             = name;
+   mIsCreator                        = true;
+   mNextTickToPublish                = 0;
+   mNumberOfCommandsReceived         = 0;
+   mCachedNumberOfCommandsSent       = 0;
+   return true;
+}
+
+bool SharedStateChannel::open(const std::string& name)
+{
+   close();
+
+   int fileDescriptor = shm_open(name.c_str(), O_RDWR, 0);
+   if (fileDescriptor == -1)
+   {
+      std::cout << "Error - SharedStateChannel::open - Failed to open " << name << ": " << std::strerror(errno) << "\n";
+      return false;
+   }
+
+   struct stat status;
+   if ((fstat(fileDescriptor, &status) == -1) || (static_cast<std::size_t>(status.st_size) < sizeof(Layout)))
+   {
+      std::cout << "Error - SharedStateChannel::open - " << name << " is too small to be a channel" << "\n";
+      ::close(fileDescriptor);
+      return false;
+   }
+
+   void* memory = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+   ::close(fileDescriptor);
+   if (memory == MAP_FAILED)
+   {
+      std::cout << "Error - SharedStateChannel::open - Failed to map " << name << ": " << std::strerror(errno) << "\n";
+      return false;
+   }
+
+   Layout* layout = static_cast<Layout*>(memory);
+   if ((layout->magicNumber.load(std::memory_order_acquire) != channelMagicNumber) ||
+       (layout->version != channelVersion) ||
+       (layout->sizeOfLayout != sizeof(Layout)))
+   {
+      std::cout << "Error - SharedStateChannel::open - " << name << " was created by a different version of the game" << "\n";
+      munmap(memory, sizeof(Layout));
+      return false;
+   }
+
+   mLayout                         = layout;
+   mName                           = name;
+   mIsCreator                      = false;
+   mNumberOfCommandsSent           = mLayout->numberOfCommandsSent.load(std::memory_order_relaxed);
+   mCachedNumberOfCommandsReceived = mLayout->numberOfCommandsReceived.load(std::memory_order_acquire);
+   return true;
+}
+
+void SharedStateChannel::close()
+{
+   if (mLayout == nullptr)
+   {
+      return;
+   }
+
+   if (mIsCreator)
+   {
+      mLayout->publisherIsAlive.store(0, std::memory_order_release);
+   }
+
+   munmap(mLayout, sizeof(Layout));
+   mLayout = nullptr;
+
+   if (mIsCreator)
+   {
+      shm_unlink(mName.c_str());
+   }
+}
+
+#else
+
+bool SharedStateChannel::create(const std::string& name)
+{
+   std::cout << "Error - SharedStateChannel::create - Shared memory channels are only supported on POSIX systems" << "\n";
+   return false;
+}
+
+bool SharedStateChannel::open(const std::string& name)
+{
+   std::cout << "Error - SharedStateChannel::open - Shared memory channels are only supported on POSIX systems" << "\n";
+   return false;
+}
+
+void SharedStateChannel::close()
+{
+
+}
+
+#endif
+
+bool SharedStateChannel::isOpen() const
+{
+   return mLayout != nullptr;
+}
+
+bool SharedStateChannel::isPublisherAlive() const
+{
+   return (mLayout != nullptr) && (mLayout->publisherIsAlive.load(std::memory_order_acquire) != 0);
+}
+
+void SharedStateChannel::publishState(const PublishedState& state)
+{
+   std::uint64_t words[numberOfWordsPerState];
+   std::memcpy(words, &state, sizeof(PublishedState));
+
+   // The tick is what tells readers which lap of the ring a slot belongs to, so it's always set here
+   std::uint64_t tick = mNextTickToPublish++;
+   std::memcpy(words, &tick, sizeof(tick));
+
+   StateSlot&    slot     = mLayout->stateSlots[tick % numberOfStateSlots];
+   std::uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+   slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+
+   for (std::size_t i = 0; i < numberOfWordsPerState; ++i)
+   {
+      slot.words[i].store(words[i], std::memory_order_relaxed);
+   }
+
+   slot.sequence.store(sequence + 2, std::memory_order_release);
+   mLayout->numberOfStatesPublished.store(tick + 1, std::memory_order_release);
+}
+
+bool SharedStateChannel::receiveCommand(PaddleCommand& command)
+{
+   if (mNumberOfCommandsReceived == mCachedNumberOfCommandsSent)
+   {
+      mCachedNumberOfCommandsSent = mLayout->numberOfCommandsSent.load(std::memory_order_acquire);
+      if (mNumberOfCommandsReceived == mCachedNumberOfCommandsSent)
+      {
+         return false;
+      }
+   }
+
+   command = mLayout->commands[mNumberOfCommandsReceived % numberOfCommandSlots];
+   ++mNumberOfCommandsReceived;
+
+   // The client can only reuse the slot after this store, so the command must have been copied before it
+   mLayout->numberOfCommandsReceived.store(mNumberOfCommandsReceived, std::memory_order_release);
+   return true;
+}
+
+std::uint64_t SharedStateChannel::getNumberOfStatesPublished() const
+{
+   return mLayout->numberOfStatesPublished.load(std::memory_order_acquire);
+}
+
+bool SharedStateChannel::readLatestState(PublishedState& state) const
+{
+   for (unsigned int attempt = 0; attempt < maxNumberOfReadAttempts; ++attempt)
+   {
+      std::uint64_t numberOfStatesPublished = getNumberOfStatesPublished();
+      if (numberOfStatesPublished == 0)
+      {
+         return false;
+      }
+
+      // The game can lap the slot while it's being read, in which case the state that is now the newest is read instead
+      if (readState(numberOfStatesPublished - 1, state))
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool SharedStateChannel::readState(std::uint64_t tick, PublishedState& state) const
+{
+   if (tick >= getNumberOfStatesPublished())
+   {
+      return false;
+   }
+
+   const StateSlot& slot = mLayout->stateSlots[tick % numberOfStateSlots];
+   std::uint64_t    words[numberOfWordsPerState];
+
+   for (unsigned int attempt = 0; attempt < maxNumberOfReadAttempts; ++attempt)
+   {
+      std::uint32_t sequenceBeforeCopy = slot.sequence.load(std::memory_order_acquire);
+      if ((sequenceBeforeCopy & 1) != 0)
+      {
+         continue;
+      }
+
+      for (std::size_t i = 0; i < numberOfWordsPerState; ++i)
+      {
+         words[i] = slot.words[i].load(std::memory_order_relaxed);
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      std::uint32_t sequenceAfterCopy = slot.sequence.load(std::memory_order_relaxed);
+      if (sequenceBeforeCopy != sequenceAfterCopy)
+      {
+         continue;
+      }
+
+      std::memcpy(&state, words, sizeof(PublishedState));
+
+      // A slot that holds a later lap means that the requested state was overwritten
+      return state.tick == tick;
+   }
+
+   return false;
+}
+
+bool SharedStateChannel::sendCommand(const PaddleCommand& command)
+{
+   if (mNumberOfCommandsSent - mCachedNumberOfCommandsReceived == numberOfCommandSlots)
+   {
+      mCachedNumberOfCommandsReceived = mLayout->numberOfCommandsReceived.load(std::memory_order_acquire);
+      if (mNumberOfCommandsSent - mCachedNumberOfCommandsReceived == numberOfCommandSlots)
+      {
+         return false;
+      }
+   }
+
+   mLayout->commands[mNumberOfCommandsSent % numberOfCommandSlots] = command;
+   ++mNumberOfCommandsSent;
+
+   // The game can only read the command after this store, so the command must have been written before it
+   mLayout->numberOfCommandsSent.store(mNumberOfCommandsSent, std::memory_order_release);
+   return true;
+}
@@ -0,0 +1,290 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "paddle_controller.h"
+#include "snapshot_codec.h"
+
+// Streams matches between computer players to simulated spectators and reports how many bytes the snapshots take and how long they take to encode
+// Usage: teapong_snapshot_benchmark [--seconds S] [--spectators N] [--rate HZ] [--loss PERCENT] [--latency SNAPSHOTS]
+//   --seconds     Length of the stream (defaults to 300)
+//   --spectators  Number of spectators (defaults to 1000)
+//   --rate        Number of snapshots sent per second (defaults to 10)
+//   --loss        Percentage of the snapshots and acknowledgements that are lost (defaults to 5)
+//   --latency     Number of snapshots that are sent before an acknowledgement arrives, which varies from 1 to this for every spectator (defaults to 3)
+
+const float deltaTime = 1.0f / 240.0f;
+
+struct Acknowledgement
+{
+   std::uint32_t frame;
+   std::uint64_t indexOfSnapshotOfArrival;
+};
+
+struct Spectator
+{
+   SnapshotDecoder             decoder;
+   bool                        hasAcknowledgedSnapshot;
+   std::uint32_t               frameOfAcknowledgedSnapshot;
+   unsigned int                latency;
+   std::deque<Acknowledgement> acknowledgementsInFlight;
+};
+
+// Rotates the ball the same way PlayState does, so that the stream carries the rotations that a spectator would see
+void rotateBall(glm::mat4& rotationMatrix, const MatchState& state, bool sceneWasReset)
+{
+   if (sceneWasReset)
+   {
+      rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+   }
+   else if (state.ballIsInPlay)
+   {
+      glm::vec3 axisOfRot = state.ballIsFalling ? glm::vec3(state.ball.velocity.x, state.ball.velocity.y, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+      if (axisOfRot != glm::vec3(0.0f))
+      {
+         rotationMatrix = glm::rotate(glm::mat4(1.0f), glm::radians(state.ball.spinAngularVelocityScaledByBounce * deltaTime), axisOfRot) * rotationMatrix;
+      }
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   double       seconds            = 300.0;
+   std::size_t  numberOfSpectators = 1000;
+   unsigned int snapshotsPerSecond = 10;
+   double       lossRate           = 0.05;
+   unsigned int maxLatency         = 3;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      bool hasValue = (i + 1 < argc);
+
+      if (std::strcmp(argv[i], "--seconds") == 0 && hasValue)
+      {
+         seconds = std::strtod(argv[++i], nullptr);
+      }
+      else if (std::strcmp(argv[i], "--spectators") == 0 && hasValue)
+      {
+         numberOfSpectators = std::strtoul(argv[++i], nullptr, 10);
+      }
+      else if (std::strcmp(argv[i], "--rate") == 0 && hasValue)
+      {
+         snapshotsPerSecond = std::max(static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)), 1u);
+      }
+      else if (std::strcmp(argv[i], "--loss") == 0 && hasValue)
+      {
+         lossRate = std::strtod(argv[++i], nullptr) / 100.0;
+      }
+      else if (std::strcmp(argv[i], "--latency") == 0 && hasValue)
+      {
+         maxLatency = std::max(static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)), 1u);
+      }
+      else
+      {
+         std::cout << "Error - main - Unknown argument: " << argv[i] << "\n";
+         return -1;
+      }
+   }
+
+   SnapshotPrecision    precision;
+   SnapshotEncoder      encoder(precision);
+   SnapshotInterpolator interpolator(deltaTime);
+
+   std::uint64_t randomNumberGeneratorState = 7;
+   auto          drawProbability            = [&randomNumberGeneratorState]() { return static_cast<double>(drawRandomNumber(randomNumberGeneratorState) >> 11) * (1.0 / 9007199254740992.0); };
+
+   std::vector<Spectator> spectators;
+   for (std::size_t i = 0; i < numberOfSpectators; ++i)
+   {
+      spectators.push_back(Spectator{SnapshotDecoder(precision), false, 0, 1 + static_cast<unsigned int>(drawRandomNumber(randomNumberGeneratorState) % maxLatency), {}});
+   }
+
+   MatchConfiguration       configuration;
+   MatchSimulation          simulation(configuration, 1);
+   ComputerPaddleController leftController(Difficulty::Medium);
+   ComputerPaddleController rightController(Difficulty::Hard);
+   leftController.reset(PaddleSide::Left, 1);
+   rightController.reset(PaddleSide::Right, 2);
+
+   GameStateSnapshot gameState  = GameStateSnapshot();
+   gameState.ballRotationMatrix = glm::mat4(1.0f);
+   rotateBall(gameState.ballRotationMatrix, simulation.getState(), true);
+
+   std::vector<const std::vector<std::uint8_t>*> encodings(numberOfSpectators);
+   std::vector<bool>                             arrived(numberOfSpectators);
+   std::vector<bool>                             decoded(numberOfSpectators);
+   std::vector<SpectatorSnapshot>                decodedSnapshots(numberOfSpectators);
+
+   // The positions of the ball on every frame, to measure how far the view of the first spectator is from the real match
+   std::vector<glm::vec3> positionsOfBall;
+
+   unsigned int  framesPerSnapshot          = std::max(240u / snapshotsPerSecond, 1u);
+   auto          numberOfFrames             = static_cast<std::uint64_t>(seconds * 240.0);
+   std::uint64_t numberOfSnapshots          = 0;
+   std::uint64_t bytesSent                  = 0;
+   std::uint64_t snapshotsSent              = 0;
+   std::uint64_t fullSnapshotsSent          = 0;
+   std::uint64_t snapshotsDecoded           = 0;
+   std::uint64_t snapshotsNotDecoded        = 0;
+   double        secondsSpentEncoding       = 0.0;
+   double        secondsSpentDecoding       = 0.0;
+   float         largestPositionError       = 0.0f;
+   float         largestRotationError       = 0.0f;
+   double        sumOfInterpolationErrors   = 0.0;
+   std::uint64_t framesWithinHalfAUnit      = 0;
+   std::uint64_t numberOfInterpolatedFrames = 0;
+
+   // Spectators render a few snapshots behind the newest one, so that the snapshots on both sides of the frame that they render have arrived
+   double        framesOfRenderDelay        = static_cast<double>(framesPerSnapshot) * (maxLatency + 1);
+
+   for (std::uint64_t frame = 1; frame <= numberOfFrames; ++frame)
+   {
+      const MatchState& stateBeforeStep = simulation.getState();
+
+      MatchInputs inputs;
+      inputs.leftPaddle  = leftController.decide(stateBeforeStep, configuration, deltaTime);
+      inputs.rightPaddle = rightController.decide(stateBeforeStep, configuration, deltaTime);
+      inputs.releaseBall = true;
+
+      MatchEvents events = simulation.step(inputs, deltaTime);
+      if (events.matchIsOver)
+      {
+         simulation.startNewMatch();
+         events.sceneWasReset = true;
+      }
+
+      rotateBall(gameState.ballRotationMatrix, simulation.getState(), events.sceneWasReset);
+      gameState.match       = simulation.getState();
+      gameState.frameNumber = frame;
+      positionsOfBall.push_back(gameState.match.ball.position);
+
+      if (frame % framesPerSnapshot != 0)
+      {
+         continue;
+      }
+
+      SpectatorSnapshot snapshot = createSpectatorSnapshot(gameState);
+      encoder.addSnapshot(snapshot);
+      ++numberOfSnapshots;
+
+      // The encodings are timed apart from the acknowledgements and the decoding, which a server wouldn't do on the same core
+      for (Spectator& spectator : spectators)
+      {
+         while (!spectator.acknowledgementsInFlight.empty() && spectator.acknowledgementsInFlight.front().indexOfSnapshotOfArrival <= numberOfSnapshots)
+         {
+            spectator.hasAcknowledgedSnapshot     = true;
+            spectator.frameOfAcknowledgedSnapshot = spectator.acknowledgementsInFlight.front().frame;
+            spectator.acknowledgementsInFlight.pop_front();
+         }
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < numberOfSpectators; ++i)
+      {
+         encodings[i] = &encoder.encodeForSpectator(spectators[i].hasAcknowledgedSnapshot, spectators[i].frameOfAcknowledgedSnapshot);
+      }
+      secondsSpentEncoding += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      for (std::size_t i = 0; i < numberOfSpectators; ++i)
+      {
+         bytesSent += encodings[i]->size();
+         ++snapshotsSent;
+         fullSnapshotsSent += ((*encodings[i])[0] & 1) ? 0 : 1;
+         arrived[i]         = (drawProbability() >= lossRate);
+      }
+
+      start = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < numberOfSpectators; ++i)
+      {
+         if (arrived[i])
+         {
+            decoded[i] = spectators[i].decoder.decode(encodings[i]->data(), encodings[i]->size(), decodedSnapshots[i]);
+         }
+      }
+      secondsSpentDecoding += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      for (std::size_t i = 0; i < numberOfSpectators; ++i)
+      {
+         if (!arrived[i])
+         {
+            continue;
+         }
+
+         ++snapshotsDecoded;
+         if (!decoded[i])
+         {
+            ++snapshotsNotDecoded;
+            continue;
+         }
+
+         if (i == 0)
+         {
+            float positionError  = glm::length(decodedSnapshots[i].ballPosition - snapshot.ballPosition);
+            float rotationError  = 2.0f * std::acos(std::min(std::abs(glm::dot(decodedSnapshots[i].ballRotation, snapshot.ballRotation)), 1.0f));
+            largestPositionError = std::max(largestPositionError, positionError);
+            largestRotationError = std::max(largestRotationError, rotationError);
+            interpolator.addSnapshot(decodedSnapshots[i]);
+         }
+
+         if (drawProbability() >= lossRate)
+         {
+            spectators[i].acknowledgementsInFlight.push_back(Acknowledgement{decodedSnapshots[i].frameNumber, numberOfSnapshots + spectators[i].latency});
+         }
+      }
+
+      // The first spectator renders every frame since the last snapshot, which is compared with the position of the ball on that frame
+      for (std::uint64_t renderedFrame = frame - framesPerSnapshot + 1; renderedFrame <= frame; ++renderedFrame)
+      {
+         double frameInMatch = static_cast<double>(renderedFrame) - framesOfRenderDelay;
+         if (frameInMatch < 1.0 || interpolator.isEmpty())
+         {
+            continue;
+         }
+
+         SpectatorSnapshot view  = interpolator.sample(frameInMatch);
+         float             error = glm::length(view.ballPosition - positionsOfBall[static_cast<std::size_t>(frameInMatch) - 1]);
+         sumOfInterpolationErrors  += error;
+         framesWithinHalfAUnit     += (error <= 0.5f) ? 1 : 0;
+         ++numberOfInterpolatedFrames;
+      }
+   }
+
+   // The time to encode a snapshot from scratch, without the cache that lets spectators with the same baseline share an encoding
+   QuantizedSnapshot newest = quantizeSnapshot(createSpectatorSnapshot(gameState), precision);
+   gameState.match.ball.position += glm::vec3(3.0f, -2.0f, 0.0f);
+   QuantizedSnapshot baseline = quantizeSnapshot(createSpectatorSnapshot(gameState), precision);
+   baseline.frameNumber -= framesPerSnapshot;
+
+   std::vector<std::uint8_t> encoding;
+   unsigned int              repetitions = 1000000;
+
+   auto start = std::chrono::steady_clock::now();
+   for (unsigned int repetition = 0; repetition < repetitions; ++repetition)
+   {
+      baseline.fields[BallSpin] = static_cast<std::int32_t>(repetition & 0xFF);
+      encodeSnapshot(newest, &baseline, encoding);
+   }
+   double secondsPerEncoding = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repetitions;
+
+   double averageBytesPerSnapshot = static_cast<double>(bytesSent) / snapshotsSent;
+
+   std::cout << "Spectators: " << numberOfSpectators << ", snapshots: " << numberOfSnapshots << " at " << snapshotsPerSecond << " Hz"
+             << ", loss: " << (lossRate * 100.0) << "%, acknowledgements arrive after 1 to " << maxLatency << " snapshots\n";
+   std::cout << "Bytes per snapshot: " << averageBytesPerSnapshot << " (" << fullSnapshotsSent << " full snapshots of " << snapshotsSent << ")"
+             << ", bytes per second per spectator: " << (averageBytesPerSnapshot * snapshotsPerSecond) << "\n";
+   std::cout << "Encoding: " << (secondsPerEncoding * 1e9) << " ns per snapshot from scratch, "
+             << (secondsSpentEncoding * 1e9 / snapshotsSent) << " ns per spectator with shared encodings, "
+             << (numberOfSpectators * snapshotsPerSecond * secondsSpentEncoding / snapshotsSent * 100.0) << "% of a core at this rate\n";
+   std::cout << "Decoding: " << (secondsSpentDecoding * 1e9 / std::max(snapshotsDecoded, std::uint64_t(1))) << " ns per snapshot, "
+             << snapshotsNotDecoded << " snapshots whose baseline was lost\n";
+   std::cout << "Largest quantization error: " << largestPositionError << " units of position, " << glm::degrees(largestRotationError) << " degrees of rotation\n";
+   std::cout << "Interpolated position of the ball, " << framesOfRenderDelay << " frames behind: "
+             << (sumOfInterpolationErrors / std::max(numberOfInterpolatedFrames, std::uint64_t(1))) << " units from the real one on average, "
+             << (100.0 * framesWithinHalfAUnit / std::max(numberOfInterpolatedFrames, std::uint64_t(1))) << "% of the frames within half a unit\n";
+
+   return 0;
+}
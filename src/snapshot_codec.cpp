@@ -0,0 +1,566 @@
+#include <algorithm>
+#include <cmath>
+
+#include "snapshot_codec.h"
+
+// At 10 snapshots per second, spectators can take up to 3 seconds to acknowledge a snapshot before they receive a full one again
+const std::size_t  numberOfKeptSnapshots         = 32;
+const std::size_t  numberOfInterpolatedSnapshots = 16;
+
+const std::int32_t minQuantizedValue             = -32768;
+const std::int32_t maxQuantizedValue             = 32767;
+
+// Values are written with a 2-bit prefix that selects how many bits follow, so small differences take 6 bits
+const unsigned int bitsOfVariableLengthValues[4] = {4, 8, 12, 32};
+
+const float        largestSmallestComponent      = 0.70710678f; // 1 / sqrt(2)
+
+enum SnapshotFlag : std::int32_t
+{
+   BallIsInPlayFlag  = 1 << 0,
+   BallIsFallingFlag = 1 << 1,
+   MatchIsOverFlag   = 1 << 2
+};
+
+class BitWriter
+{
+public:
+
+   explicit BitWriter(std::vector<std::uint8_t>& bytes)
+      : mBytes(bytes)
+      , mBits(0)
+      , mNumberOfBits(0)
+   {
+
+   }
+
+   ~BitWriter() = default;
+
+   BitWriter(const BitWriter&) = delete;
+   BitWriter& operator=(const BitWriter&) = delete;
+
+   BitWriter(BitWriter&&) = delete;
+   BitWriter& operator=(BitWriter&&) = delete;
+
+   void write(std::uint32_t value, unsigned int numberOfBits)
+   {
+      if (numberOfBits < 32)
+      {
+         value &= (1u << numberOfBits) - 1;
+      }
+
+      mBits         |= static_cast<std::uint64_t>(value) << mNumberOfBits;
+      mNumberOfBits += numberOfBits;
+
+      while (mNumberOfBits >= 8)
+      {
+         mBytes.push_back(static_cast<std::uint8_t>(mBits));
+         mBits         >>= 8;
+         mNumberOfBits  -= 8;
+      }
+   }
+
+   void flush()
+   {
+      if (mNumberOfBits > 0)
+      {
+         mBytes.push_back(static_cast<std::uint8_t>(mBits));
+         mBits         = 0;
+         mNumberOfBits = 0;
+      }
+   }
+
+private:
+
+   std::vector<std::uint8_t>& mBytes;
+   std::uint64_t              mBits;
+   unsigned int               mNumberOfBits;
+};
+
+class BitReader
+{
+public:
+
+   BitReader(const std::uint8_t* bytes, std::size_t numberOfBytes)
+      : mBytes(bytes)
+      , mNumberOfBytes(numberOfBytes)
+      , mIndexOfNextByte(0)
+      , mBits(0)
+      , mNumberOfBits(0)
+   {
+
+   }
+
+   ~BitReader() = default;
+
+   BitReader(const BitReader&) = delete;
+   BitReader& operator=(const BitReader&) = delete;
+
+   BitReader(BitReader&&) = delete;
+   BitReader& operator=(BitReader&&) = delete;
+
+   // Returns false if the bytes run out
+   bool read(unsigned int numberOfBits, std::uint32_t& value)
+   {
+      while (mNumberOfBits < numberOfBits)
+      {
+         if (mIndexOfNextByte == mNumberOfBytes)
+         {
+            return false;
+         }
+
+         mBits         |= static_cast<std::uint64_t>(mBytes[mIndexOfNextByte++]) << mNumberOfBits;
+         mNumberOfBits += 8;
+      }
+
+      value           = static_cast<std::uint32_t>(mBits & ((1ull << numberOfBits) - 1));
+      mBits         >>= numberOfBits;
+      mNumberOfBits  -= numberOfBits;
+      return true;
+   }
+
+private:
+
+   const std::uint8_t* mBytes;
+   std::size_t         mNumberOfBytes;
+   std::size_t         mIndexOfNextByte;
+   std::uint64_t       mBits;
+   unsigned int        mNumberOfBits;
+};
+
+void writeVariableLengthValue(BitWriter& writer, std::uint32_t value)
+{
+   std::uint32_t prefix = 0;
+   while (prefix < 3 && (value >> bitsOfVariableLengthValues[prefix]) != 0)
+   {
+      ++prefix;
+   }
+
+   writer.write(prefix, 2);
+   writer.write(value, bitsOfVariableLengthValues[prefix]);
+}
+
+bool readVariableLengthValue(BitReader& reader, std::uint32_t& value)
+{
+   std::uint32_t prefix;
+   return reader.read(2, prefix) && reader.read(bitsOfVariableLengthValues[prefix], value);
+}
+
+std::int32_t quantizeValue(float value, float step)
+{
+   float quantizedValue = std::round(value / step);
+   return static_cast<std::int32_t>(glm::clamp(quantizedValue, static_cast<float>(minQuantizedValue), static_cast<float>(maxQuantizedValue)));
+}
+
+SpectatorSnapshot createSpectatorSnapshot(const GameStateSnapshot& snapshot)
+{
+   const MatchState& match = snapshot.match;
+
+   SpectatorSnapshot spectatorSnapshot;
+
+   spectatorSnapshot.frameNumber               = static_cast<std::uint32_t>(snapshot.frameNumber);
+   spectatorSnapshot.ballPosition              = match.ball.position;
+   spectatorSnapshot.ballVelocity              = match.ball.velocity;
+   spectatorSnapshot.ballRotation              = glm::normalize(glm::quat_cast(glm::mat3(snapshot.ballRotationMatrix)));
+   spectatorSnapshot.ballSpin                  = match.ball.spinAngularVelocityScaledByBounce;
+   spectatorSnapshot.leftPaddlePosition        = glm::vec2(match.leftPaddle.position);
+   spectatorSnapshot.rightPaddlePosition       = glm::vec2(match.rightPaddle.position);
+   spectatorSnapshot.pointsScoredByLeftPaddle  = match.pointsScoredByLeftPaddle;
+   spectatorSnapshot.pointsScoredByRightPaddle = match.pointsScoredByRightPaddle;
+   spectatorSnapshot.ballIsInPlay              = match.ballIsInPlay;
+   spectatorSnapshot.ballIsFalling             = match.ballIsFalling;
+   spectatorSnapshot.matchIsOver               = match.matchIsOver;
+
+   return spectatorSnapshot;
+}
+
+SnapshotPrecision::SnapshotPrecision()
+   : positionStep(1.0f / 32.0f)
+   , velocityStep(1.0f / 8.0f)
+   , spinStep(1.0f / 4.0f)
+   , bitsPerRotationComponent(10)
+{
+
+}
+
+QuantizedSnapshot quantizeSnapshot(const SpectatorSnapshot& snapshot, const SnapshotPrecision& precision)
+{
+   QuantizedSnapshot quantizedSnapshot;
+   std::int32_t*     fields = quantizedSnapshot.fields;
+
+   quantizedSnapshot.frameNumber = snapshot.frameNumber;
+
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      fields[BallPositionX + axis] = quantizeValue(snapshot.ballPosition[axis], precision.positionStep);
+      fields[BallVelocityX + axis] = quantizeValue(snapshot.ballVelocity[axis], precision.velocityStep);
+   }
+
+   // The largest component of a unit quaternion can be calculated from the other three, which are all within +/-1/sqrt(2)
+   // q and -q represent the same rotation, so the largest component is made positive to be able to drop its sign
+   glm::quat rotation                = glm::normalize(snapshot.ballRotation);
+   int       indexOfLargestComponent = 0;
+   for (int i = 1; i < 4; ++i)
+   {
+      if (std::abs(rotation[i]) > std::abs(rotation[indexOfLargestComponent]))
+      {
+         indexOfLargestComponent = i;
+      }
+   }
+
+   if (rotation[indexOfLargestComponent] < 0.0f)
+   {
+      rotation = -rotation;
+   }
+
+   float rotationStep = largestSmallestComponent / static_cast<float>((1 << (precision.bitsPerRotationComponent - 1)) - 1);
+   fields[BallRotationLargestComponent] = indexOfLargestComponent;
+   for (int i = 0, field = BallRotationA; i < 4; ++i)
+   {
+      if (i != indexOfLargestComponent)
+      {
+         fields[field++] = quantizeValue(rotation[i], rotationStep);
+      }
+   }
+
+   fields[BallSpin]                  = quantizeValue(snapshot.ballSpin, precision.spinStep);
+   fields[LeftPaddlePositionX]       = quantizeValue(snapshot.leftPaddlePosition.x, precision.positionStep);
+   fields[LeftPaddlePositionY]       = quantizeValue(snapshot.leftPaddlePosition.y, precision.positionStep);
+   fields[RightPaddlePositionX]      = quantizeValue(snapshot.rightPaddlePosition.x, precision.positionStep);
+   fields[RightPaddlePositionY]      = quantizeValue(snapshot.rightPaddlePosition.y, precision.positionStep);
+   fields[PointsScoredByLeftPaddle]  = static_cast<std::int32_t>(std::min(snapshot.pointsScoredByLeftPaddle, static_cast<unsigned int>(maxQuantizedValue)));
+   fields[PointsScoredByRightPaddle] = static_cast<std::int32_t>(std::min(snapshot.pointsScoredByRightPaddle, static_cast<unsigned int>(maxQuantizedValue)));
+   fields[SnapshotFlags]             = (snapshot.ballIsInPlay ? BallIsInPlayFlag : 0) | (snapshot.ballIsFalling ? BallIsFallingFlag : 0) | (snapshot.matchIsOver ? MatchIsOverFlag : 0);
+
+   return quantizedSnapshot;
+}
+
+SpectatorSnapshot dequantizeSnapshot(const QuantizedSnapshot& snapshot, const SnapshotPrecision& precision)
+{
+   const std::int32_t* fields = snapshot.fields;
+
+   SpectatorSnapshot spectatorSnapshot;
+
+   spectatorSnapshot.frameNumber = snapshot.frameNumber;
+
+   for (int axis = 0; axis < 3; ++axis)
+   {
+      spectatorSnapshot.ballPosition[axis] = fields[BallPositionX + axis] * precision.positionStep;
+      spectatorSnapshot.ballVelocity[axis] = fields[BallVelocityX + axis] * precision.velocityStep;
+   }
+
+   float rotationStep            = largestSmallestComponent / static_cast<float>((1 << (precision.bitsPerRotationComponent - 1)) - 1);
+   int   indexOfLargestComponent = fields[BallRotationLargestComponent] & 3;
+   float sumOfSquares            = 0.0f;
+
+   for (int i = 0, field = BallRotationA; i < 4; ++i)
+   {
+      if (i != indexOfLargestComponent)
+      {
+         float component                    = fields[field++] * rotationStep;
+         spectatorSnapshot.ballRotation[i]  = component;
+         sumOfSquares                      += component * component;
+      }
+   }
+
+   spectatorSnapshot.ballRotation[indexOfLargestComponent] = std::sqrt(std::max(1.0f - sumOfSquares, 0.0f));
+   spectatorSnapshot.ballRotation                          = glm::normalize(spectatorSnapshot.ballRotation);
+
+   spectatorSnapshot.ballSpin                  = fields[BallSpin] * precision.spinStep;
+   spectatorSnapshot.leftPaddlePosition        = glm::vec2(fields[LeftPaddlePositionX], fields[LeftPaddlePositionY]) * precision.positionStep;
+   spectatorSnapshot.rightPaddlePosition       = glm::vec2(fields[RightPaddlePositionX], fields[RightPaddlePositionY]) * precision.positionStep;
+   spectatorSnapshot.pointsScoredByLeftPaddle  = static_cast<unsigned int>(fields[PointsScoredByLeftPaddle]);
+   spectatorSnapshot.pointsScoredByRightPaddle = static_cast<unsigned int>(fields[PointsScoredByRightPaddle]);
+   spectatorSnapshot.ballIsInPlay              = (fields[SnapshotFlags] & BallIsInPlayFlag) != 0;
+   spectatorSnapshot.ballIsFalling             = (fields[SnapshotFlags] & BallIsFallingFlag) != 0;
+   spectatorSnapshot.matchIsOver               = (fields[SnapshotFlags] & MatchIsOverFlag) != 0;
+
+   return spectatorSnapshot;
+}
+
+// An encoded snapshot starts with a bit that says whether it has a baseline
+// Full snapshots continue with their 32-bit frame, and the others with the 16 least significant bits of their frame
+// and the number of frames between them and their baseline, which the decoder uses to find the baseline
+// Every field follows, as a 0 bit if it's the same as in the baseline, or as a 1 bit and the zigzag-encoded difference
+void encodeSnapshot(const QuantizedSnapshot& snapshot, const QuantizedSnapshot* baseline, std::vector<std::uint8_t>& bytes)
+{
+   bytes.clear();
+   BitWriter writer(bytes);
+
+   if (baseline)
+   {
+      writer.write(1, 1);
+      writer.write(snapshot.frameNumber, 16);
+      writeVariableLengthValue(writer, snapshot.frameNumber - baseline->frameNumber);
+   }
+   else
+   {
+      writer.write(0, 1);
+      writer.write(snapshot.frameNumber, 32);
+   }
+
+   for (int field = 0; field < numberOfSnapshotFields; ++field)
+   {
+      std::int32_t difference = snapshot.fields[field] - (baseline ? baseline->fields[field] : 0);
+      if (difference == 0)
+      {
+         writer.write(0, 1);
+      }
+      else
+      {
+         writer.write(1, 1);
+         writeVariableLengthValue(writer, (static_cast<std::uint32_t>(difference) << 1) ^ static_cast<std::uint32_t>(difference >> 31));
+      }
+   }
+
+   writer.flush();
+}
+
+SnapshotEncoder::SnapshotEncoder(const SnapshotPrecision& precision)
+   : mPrecision(precision)
+   , mKeptSnapshots(numberOfKeptSnapshots)
+   , mIndexOfNewestSnapshot(0)
+   , mNumberOfSnapshots(0)
+   , mFullEncoding()
+   , mFullEncodingIsValid(false)
+{
+   for (KeptSnapshot& keptSnapshot : mKeptSnapshots)
+   {
+      keptSnapshot.isValid         = false;
+      keptSnapshot.encodingIsValid = false;
+   }
+}
+
+void SnapshotEncoder::addSnapshot(const SpectatorSnapshot& snapshot)
+{
+   mIndexOfNewestSnapshot = (mIndexOfNewestSnapshot + 1) % mKeptSnapshots.size();
+   ++mNumberOfSnapshots;
+
+   KeptSnapshot& newestSnapshot = mKeptSnapshots[mIndexOfNewestSnapshot];
+   newestSnapshot.snapshot      = quantizeSnapshot(snapshot, mPrecision);
+   newestSnapshot.isValid       = true;
+
+   // The encodings were made for the previous snapshot
+   for (KeptSnapshot& keptSnapshot : mKeptSnapshots)
+   {
+      keptSnapshot.encodingIsValid = false;
+   }
+
+   mFullEncodingIsValid = false;
+}
+
+const std::vector<std::uint8_t>& SnapshotEncoder::encodeForSpectator(bool hasAcknowledgedSnapshot, std::uint32_t frameOfAcknowledgedSnapshot)
+{
+   const QuantizedSnapshot& newestSnapshot = mKeptSnapshots[mIndexOfNewestSnapshot].snapshot;
+
+   if (hasAcknowledgedSnapshot && mNumberOfSnapshots > 0)
+   {
+      for (KeptSnapshot& baseline : mKeptSnapshots)
+      {
+         if (baseline.isValid && baseline.snapshot.frameNumber == frameOfAcknowledgedSnapshot)
+         {
+            if (!baseline.encodingIsValid)
+            {
+               encodeSnapshot(newestSnapshot, &baseline.snapshot, baseline.encoding);
+               baseline.encodingIsValid = true;
+            }
+
+            return baseline.encoding;
+         }
+      }
+   }
+
+   if (!mFullEncodingIsValid)
+   {
+      encodeSnapshot(newestSnapshot, nullptr, mFullEncoding);
+      mFullEncodingIsValid = true;
+   }
+
+   return mFullEncoding;
+}
+
+const SnapshotPrecision& SnapshotEncoder::getPrecision() const
+{
+   return mPrecision;
+}
+
+SnapshotDecoder::SnapshotDecoder(const SnapshotPrecision& precision)
+   : mPrecision(precision)
+   , mKeptSnapshots(numberOfKeptSnapshots)
+   , mKeptSnapshotIsValid(numberOfKeptSnapshots, false)
+   , mIndexOfNewestSnapshot(0)
+   , mHasReceivedSnapshot(false)
+{
+
+}
+
+bool SnapshotDecoder::decode(const std::uint8_t* bytes, std::size_t numberOfBytes, SpectatorSnapshot& snapshot)
+{
+   BitReader reader(bytes, numberOfBytes);
+
+   std::uint32_t            hasBaseline;
+   QuantizedSnapshot        decodedSnapshot;
+   const QuantizedSnapshot* baseline = nullptr;
+
+   if (!reader.read(1, hasBaseline))
+   {
+      return false;
+   }
+
+   if (hasBaseline)
+   {
+      std::uint32_t leastSignificantBitsOfFrame;
+      std::uint32_t framesSinceBaseline;
+      if (!mHasReceivedSnapshot || !reader.read(16, leastSignificantBitsOfFrame) || !readVariableLengthValue(reader, framesSinceBaseline))
+      {
+         return false;
+      }
+
+      // The frame is the one closest to the newest frame received with the same 16 least significant bits
+      std::uint32_t newestFrame   = mKeptSnapshots[mIndexOfNewestSnapshot].frameNumber;
+      auto          difference    = static_cast<std::int16_t>(static_cast<std::uint16_t>(leastSignificantBitsOfFrame - newestFrame));
+      decodedSnapshot.frameNumber = newestFrame + static_cast<std::uint32_t>(static_cast<std::int32_t>(difference));
+
+      std::uint32_t frameOfBaseline = decodedSnapshot.frameNumber - framesSinceBaseline;
+      for (std::size_t i = 0; i < mKeptSnapshots.size(); ++i)
+      {
+         if (mKeptSnapshotIsValid[i] && mKeptSnapshots[i].frameNumber == frameOfBaseline)
+         {
+            baseline = &mKeptSnapshots[i];
+            break;
+         }
+      }
+
+      if (!baseline)
+      {
+         return false;
+      }
+   }
+   else if (!reader.read(32, decodedSnapshot.frameNumber))
+   {
+      return false;
+   }
+
+   if (mHasReceivedSnapshot && static_cast<std::int32_t>(decodedSnapshot.frameNumber - mKeptSnapshots[mIndexOfNewestSnapshot].frameNumber) <= 0)
+   {
+      return false;
+   }
+
+   for (int field = 0; field < numberOfSnapshotFields; ++field)
+   {
+      std::uint32_t hasChanged;
+      std::uint32_t encodedDifference = 0;
+      if (!reader.read(1, hasChanged) || (hasChanged && !readVariableLengthValue(reader, encodedDifference)))
+      {
+         return false;
+      }
+
+      auto difference = static_cast<std::int32_t>((encodedDifference >> 1) ^ (0u - (encodedDifference & 1)));
+      decodedSnapshot.fields[field] = (baseline ? baseline->fields[field] : 0) + difference;
+   }
+
+   mIndexOfNewestSnapshot                       = (mIndexOfNewestSnapshot + 1) % mKeptSnapshots.size();
+   mKeptSnapshots[mIndexOfNewestSnapshot]       = decodedSnapshot;
+   mKeptSnapshotIsValid[mIndexOfNewestSnapshot] = true;
+   mHasReceivedSnapshot                         = true;
+
+   snapshot = dequantizeSnapshot(decodedSnapshot, mPrecision);
+   return true;
+}
+
+bool SnapshotDecoder::hasReceivedSnapshot() const
+{
+   return mHasReceivedSnapshot;
+}
+
+std::uint32_t SnapshotDecoder::getFrameOfNewestSnapshot() const
+{
+   return mKeptSnapshots[mIndexOfNewestSnapshot].frameNumber;
+}
+
+SnapshotInterpolator::SnapshotInterpolator(float secondsPerFrame)
+   : mSecondsPerFrame(secondsPerFrame)
+   , mSnapshots()
+{
+
+}
+
+void SnapshotInterpolator::addSnapshot(const SpectatorSnapshot& snapshot)
+{
+   if (!mSnapshots.empty() && static_cast<std::int32_t>(snapshot.frameNumber - mSnapshots.back().frameNumber) <= 0)
+   {
+      return;
+   }
+
+   if (mSnapshots.size() == numberOfInterpolatedSnapshots)
+   {
+      mSnapshots.erase(mSnapshots.begin());
+   }
+
+   mSnapshots.push_back(snapshot);
+}
+
+bool SnapshotInterpolator::isEmpty() const
+{
+   return mSnapshots.empty();
+}
+
+SpectatorSnapshot SnapshotInterpolator::sample(double frame) const
+{
+   if (mSnapshots.empty())
+   {
+      return SpectatorSnapshot();
+   }
+
+   if (frame <= mSnapshots.front().frameNumber)
+   {
+      return mSnapshots.front();
+   }
+
+   if (frame >= mSnapshots.back().frameNumber)
+   {
+      return mSnapshots.back();
+   }
+
+   std::size_t indexOfNewer = 1;
+   while (mSnapshots[indexOfNewer].frameNumber < frame)
+   {
+      ++indexOfNewer;
+   }
+
+   const SpectatorSnapshot& older = mSnapshots[indexOfNewer - 1];
+   const SpectatorSnapshot& newer = mSnapshots[indexOfNewer];
+
+   double framesBetweenSnapshots = static_cast<double>(newer.frameNumber - older.frameNumber);
+   float  t                      = static_cast<float>((frame - older.frameNumber) / framesBetweenSnapshots);
+
+   SpectatorSnapshot snapshot   = older;
+   snapshot.frameNumber         = static_cast<std::uint32_t>(frame);
+   snapshot.leftPaddlePosition  = glm::mix(older.leftPaddlePosition, newer.leftPaddlePosition, t);
+   snapshot.rightPaddlePosition = glm::mix(older.rightPaddlePosition, newer.rightPaddlePosition, t);
+   snapshot.ballRotation        = glm::slerp(older.ballRotation, newer.ballRotation, t);
+   snapshot.ballSpin            = glm::mix(older.ballSpin, newer.ballSpin, t);
+
+   // A ball that was served, scored or reset between the snapshots jumps, so it stays where it was until the newer snapshot
+   bool ballMovedContinuously = (older.ballIsInPlay == newer.ballIsInPlay) &&
+                                (older.pointsScoredByLeftPaddle == newer.pointsScoredByLeftPaddle) &&
+                                (older.pointsScoredByRightPaddle == newer.pointsScoredByRightPaddle);
+
+   if (ballMovedContinuously)
+   {
+      // Cubic Hermite curve, which follows a bounce off a wall between the snapshots instead of cutting across it
+      float     duration       = static_cast<float>(framesBetweenSnapshots) * mSecondsPerFrame;
+      float     t2             = t * t;
+      float     t3             = t2 * t;
+      glm::vec3 tangentOfOlder = older.ballVelocity * duration;
+      glm::vec3 tangentOfNewer = newer.ballVelocity * duration;
+
+      snapshot.ballPosition = (((2.0f * t3) - (3.0f * t2) + 1.0f) * older.ballPosition) +
+                              ((t3 - (2.0f * t2) + t) * tangentOfOlder) +
+                              ((-2.0f * t3) + (3.0f * t2)) * newer.ballPosition +
+                              ((t3 - t2) * tangentOfNewer);
+      snapshot.ballVelocity = glm::mix(older.ballVelocity, newer.ballVelocity, t);
+   }
+
+   return snapshot;
+}
@@ -0,0 +1,137 @@
+#include <cmath>
+
+#include "spatial_hash.h"
+
+SpatialHash::SpatialHash(float cellSize)
+   : mCellSize(cellSize)
+   , mInverseCellSize(1.0f / cellSize)
+   , mMinCorners()
+   , mMaxCorners()
+   , mEntries()
+   , mSortedEntries()
+   , mStartsOfBuckets()
+   , mNextPositionsInBuckets()
+   , mBucketMask(0)
+{
+
+}
+
+void SpatialHash::clear()
+{
+   mMinCorners.clear();
+   mMaxCorners.clear();
+}
+
+std::uint32_t SpatialHash::insert(const glm::vec2& minCorner, const glm::vec2& maxCorner)
+{
+   mMinCorners.push_back(minCorner);
+   mMaxCorners.push_back(maxCorner);
+   return static_cast<std::uint32_t>(mMinCorners.size() - 1);
+}
+
+void SpatialHash::findCandidatePairs(std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs)
+{
+   pairs.clear();
+
+   // Add one entry per cell touched by each box
+   mEntries.clear();
+   for (std::uint32_t box = 0; box < mMinCorners.size(); ++box)
+   {
+      std::int32_t minCellX = calculateCellCoordinate(mMinCorners[box].x);
+      std::int32_t minCellY = calculateCellCoordinate(mMinCorners[box].y);
+      std::int32_t maxCellX = calculateCellCoordinate(mMaxCorners[box].x);
+      std::int32_t maxCellY = calculateCellCoordinate(mMaxCorners[box].y);
+
+      for (std::int32_t cellY = minCellY; cellY <= maxCellY; ++cellY)
+      {
+         for (std::int32_t cellX = minCellX; cellX <= maxCellX; ++cellX)
+         {
+            mEntries.push_back(Entry{cellX, cellY, box});
+         }
+      }
+   }
+
+   // Use at least twice as many buckets as entries, so that few cells share a bucket
+   std::uint32_t numberOfBuckets = 1;
+   while (numberOfBuckets < 2 * mEntries.size())
+   {
+      numberOfBuckets *= 2;
+   }
+   mBucketMask = numberOfBuckets - 1;
+
+   // Counting sort: count the entries of each bucket, turn the counts into the positions where the buckets start, and then scatter the entries
+   mStartsOfBuckets.assign(numberOfBuckets + 1, 0);
+   for (const Entry& entry : mEntries)
+   {
+      ++mStartsOfBuckets[hashCell(entry.cellX, entry.cellY) + 1];
+   }
+
+   for (std::uint32_t bucket = 0; bucket < numberOfBuckets; ++bucket)
+   {
+      mStartsOfBuckets[bucket + 1] += mStartsOfBuckets[bucket];
+   }
+
+   mSortedEntries.resize(mEntries.size());
+   mNextPositionsInBuckets.assign(mStartsOfBuckets.begin(), mStartsOfBuckets.end() - 1);
+   for (const Entry& entry : mEntries)
+   {
+      mSortedEntries[mNextPositionsInBuckets[hashCell(entry.cellX, entry.cellY)]++] = entry;
+   }
+
+   // Test the boxes that share a cell
+   for (std::uint32_t bucket = 0; bucket < numberOfBuckets; ++bucket)
+   {
+      std::uint32_t endOfBucket = mStartsOfBuckets[bucket + 1];
+      for (std::uint32_t i = mStartsOfBuckets[bucket]; i < endOfBucket; ++i)
+      {
+         const Entry& a = mSortedEntries[i];
+         for (std::uint32_t j = i + 1; j < endOfBucket; ++j)
+         {
+            const Entry& b = mSortedEntries[j];
+
+            // Different cells can share a bucket
+            if (a.cellX != b.cellX || a.cellY != b.cellY)
+            {
+               continue;
+            }
+
+            glm::vec2 minCornerOfOverlap = glm::max(mMinCorners[a.box], mMinCorners[b.box]);
+            glm::vec2 maxCornerOfOverlap = glm::min(mMaxCorners[a.box], mMaxCorners[b.box]);
+            if (minCornerOfOverlap.x > maxCornerOfOverlap.x || minCornerOfOverlap.y > maxCornerOfOverlap.y)
+            {
+               continue;
+            }
+
+            // Boxes that share many cells are only reported by the cell that contains the min corner of their overlap
+            if (calculateCellCoordinate(minCornerOfOverlap.x) != a.cellX || calculateCellCoordinate(minCornerOfOverlap.y) != a.cellY)
+            {
+               continue;
+            }
+
+            pairs.emplace_back(glm::min(a.box, b.box), glm::max(a.box, b.box));
+         }
+      }
+   }
+}
+
+std::size_t SpatialHash::getNumberOfBoxes() const
+{
+   return mMinCorners.size();
+}
+
+float SpatialHash::getCellSize() const
+{
+   return mCellSize;
+}
+
+std::int32_t SpatialHash::calculateCellCoordinate(float coordinate) const
+{
+   return static_cast<std::int32_t>(std::floor(coordinate * mInverseCellSize));
+}
+
+std::uint32_t SpatialHash::hashCell(std::int32_t cellX, std::int32_t cellY) const
+{
+   // Multiplying by large odd constants spreads neighboring cells across the whole table
+   std::uint32_t hash = (static_cast<std::uint32_t>(cellX) * 0x9E3779B1u) ^ (static_cast<std::uint32_t>(cellY) * 0x85EBCA77u);
+   return (hash ^ (hash >> 16)) & mBucketMask;
+}
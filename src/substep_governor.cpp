@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cmath>
+
+#include "substep_governor.h"
+
+// How far the ball may move in a sub-step, as a fraction of the smaller of its radius and the width of the paddles
+const float  fractionOfSizeTraversedPerSubstep = 1.0f / 16.0f;
+
+// Weight of the newest measurement in the moving average of the cost of a sub-step
+const double weightOfNewestCostOfSubstep       = 0.1;
+
+unsigned int calculateNumberOfSubstepsNeeded(const MatchState& state, float deltaTime, unsigned int maxNumberOfSubsteps)
+{
+   return calculateNumberOfSubstepsNeeded<FloatNumericPolicy>(state, deltaTime, maxNumberOfSubsteps);
+}
+
+template<typename NumericPolicy>
+unsigned int calculateNumberOfSubstepsNeeded(const MatchState& state, float deltaTime, unsigned int maxNumberOfSubsteps)
+{
+   using Number = typename NumericPolicy::Number;
+
+   // A ball that is waiting to be served or falling off the table can't hit anything
+   if (!state.ballIsInPlay || state.ballIsFalling)
+   {
+      return 1;
+   }
+
+   Number distanceTraversedByBall = NumericPolicy::sqrtOfSumOfSquares(NumericPolicy::fromFloat(state.ball.velocity.x), NumericPolicy::fromFloat(state.ball.velocity.y)) *
+                                    NumericPolicy::fromFloat(deltaTime);
+   Number smallestSize            = NumericPolicy::fromFloat(std::min(state.ball.radius, std::min(state.leftPaddle.width, state.rightPaddle.width)));
+   Number maxDistancePerSubstep   = NumericPolicy::fromFloat(fractionOfSizeTraversedPerSubstep) * smallestSize;
+
+   // Same as rounding the distance divided by the max distance per sub-step up, but without converting a number of the policy into an integer
+   unsigned int numberOfSubstepsNeeded = 1;
+   while (numberOfSubstepsNeeded < maxNumberOfSubsteps && distanceTraversedByBall > (maxDistancePerSubstep * NumericPolicy::fromInt(static_cast<int>(numberOfSubstepsNeeded))))
+   {
+      ++numberOfSubstepsNeeded;
+   }
+
+   return numberOfSubstepsNeeded;
+}
+
+template unsigned int calculateNumberOfSubstepsNeeded<FloatNumericPolicy>(const MatchState& state, float deltaTime, unsigned int maxNumberOfSubsteps);
+template unsigned int calculateNumberOfSubstepsNeeded<FixedPointNumericPolicy>(const MatchState& state, float deltaTime, unsigned int maxNumberOfSubsteps);
+
+SubstepGovernor::SubstepGovernor(double budgetPerUpdateInSeconds, unsigned int maxNumberOfSubsteps)
+   : mBudgetPerUpdate(budgetPerUpdateInSeconds)
+   , mMaxNumberOfSubsteps(std::max(maxNumberOfSubsteps, 1u))
+   , mCounters()
+{
+
+}
+
+unsigned int SubstepGovernor::chooseNumberOfSubsteps(unsigned int numberOfSubstepsNeeded,
+                                                     double       secondsAlreadySpentByUpdate,
+                                                     double       secondsLeftInFrame,
+                                                     unsigned int numberOfUpdatesLeftInFrame)
+{
+   unsigned int numberOfSubsteps = std::min(std::max(numberOfSubstepsNeeded, 1u), mMaxNumberOfSubsteps);
+
+   // Until the first sub-step has been measured, assume that every sub-step fits in the budget
+   if (numberOfSubsteps == 1 || mCounters.averageSecondsPerSubstep <= 0.0)
+   {
+      return numberOfSubsteps;
+   }
+
+   // The first sub-step is always simulated, even if the budget has already been spent, so that the game keeps moving
+   double budgetOfUpdate      = std::min(mBudgetPerUpdate, secondsLeftInFrame / std::max(numberOfUpdatesLeftInFrame, 1u));
+   double secondsLeftInBudget = budgetOfUpdate - secondsAlreadySpentByUpdate;
+   double affordableSubsteps  = std::floor(secondsLeftInBudget / mCounters.averageSecondsPerSubstep);
+
+   if (affordableSubsteps < static_cast<double>(numberOfSubsteps))
+   {
+      numberOfSubsteps = (affordableSubsteps >= 1.0) ? static_cast<unsigned int>(affordableSubsteps) : 1;
+   }
+
+   return numberOfSubsteps;
+}
+
+void SubstepGovernor::recordUpdate(unsigned int numberOfSubstepsNeeded, unsigned int numberOfSubsteps, double secondsSpent)
+{
+   numberOfSubstepsNeeded = std::min(std::max(numberOfSubstepsNeeded, 1u), mMaxNumberOfSubsteps);
+   numberOfSubsteps       = std::max(numberOfSubsteps, 1u);
+
+   double secondsPerSubstep = secondsSpent / numberOfSubsteps;
+   if (mCounters.averageSecondsPerSubstep <= 0.0)
+   {
+      mCounters.averageSecondsPerSubstep = secondsPerSubstep;
+   }
+   else
+   {
+      mCounters.averageSecondsPerSubstep += weightOfNewestCostOfSubstep * (secondsPerSubstep - mCounters.averageSecondsPerSubstep);
+   }
+
+   mCounters.numberOfSubstepsOfLastUpdate       = numberOfSubsteps;
+   mCounters.numberOfSubstepsNeededByLastUpdate = numberOfSubstepsNeeded;
+   mCounters.secondsSpentByLastUpdate           = secondsSpent;
+   mCounters.maxSecondsSpentByAnUpdate          = std::max(mCounters.maxSecondsSpentByAnUpdate, secondsSpent);
+
+   ++mCounters.numberOfUpdates;
+   mCounters.numberOfSubsteps += numberOfSubsteps;
+   mCounters.secondsSpent     += secondsSpent;
+
+   if (numberOfSubsteps < numberOfSubstepsNeeded)
+   {
+      ++mCounters.numberOfUpdatesLimitedByBudget;
+   }
+}
+
+void SubstepGovernor::resetCounters()
+{
+   // Keep the cost of a sub-step, since it's still the best prediction of the cost of the next one
+   double averageSecondsPerSubstep    = mCounters.averageSecondsPerSubstep;
+   mCounters                          = SubstepCounters();
+   mCounters.averageSecondsPerSubstep = averageSecondsPerSubstep;
+}
+
+double SubstepGovernor::getBudgetPerUpdate() const
+{
+   return mBudgetPerUpdate;
+}
+
+void SubstepGovernor::setBudgetPerUpdate(double budgetPerUpdateInSeconds)
+{
+   mBudgetPerUpdate = budgetPerUpdateInSeconds;
+}
+
+unsigned int SubstepGovernor::getMaxNumberOfSubsteps() const
+{
+   return mMaxNumberOfSubsteps;
+}
+
+const SubstepCounters& SubstepGovernor::getCounters() const
+{
+   return mCounters;
+}
@@ -0,0 +1,132 @@
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "block_compression.h"
+#include "texture_cooker.h"
+
+// Compresses a level in bands of rows of blocks, each one of which is a smaller image whose blocks are contiguous in the output
+void compressLevel(const unsigned char* rgbaTexels, unsigned int width, unsigned int height, CookedTextureFormat format, unsigned char* blocks, ThreadPool* threads)
+{
+   unsigned int numberOfBlockRows = (height + 3) / 4;
+   unsigned int numberOfBands     = threads ? std::min(numberOfBlockRows, 4 * threads->getNumberOfThreads()) : 1;
+   if (numberOfBands <= 1)
+   {
+      compressTextureLevel(rgbaTexels, width, height, format, blocks);
+      return;
+   }
+
+   std::uint64_t sizeOfBlockRow = getSizeOfCookedTextureLevel(format, width, 4);
+   for (unsigned int band = 0; band < numberOfBands; ++band)
+   {
+      unsigned int firstBlockRow = numberOfBlockRows * band / numberOfBands;
+      unsigned int lastBlockRow  = numberOfBlockRows * (band + 1) / numberOfBands;
+      unsigned int firstRow      = 4 * firstBlockRow;
+      unsigned int lastRow       = std::min(4 * lastBlockRow, height);
+      threads->submit([=]()
+      {
+         compressTextureLevel(rgbaTexels + 4 * static_cast<std::size_t>(firstRow) * width,
+                              width,
+                              lastRow - firstRow,
+                              format,
+                              blocks + sizeOfBlockRow * firstBlockRow);
+      });
+   }
+
+   threads->waitUntilIdle();
+}
+
+TextureColorSpace getColorSpaceOfTexture(const std::string& texFilePath)
+{
+   std::size_t positionOfLastSlash = texFilePath.find_last_of("/\\");
+   std::string fileName            = texFilePath.substr((positionOfLastSlash == std::string::npos) ? 0 : (positionOfLastSlash + 1));
+   std::transform(fileName.begin(), fileName.end(), fileName.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+   const char* namesOfDataMaps[] = {"specular", "normal", "roughness", "metallic", "gloss", "height", "bump", "displacement"};
+   for (const char* nameOfDataMap : namesOfDataMaps)
+   {
+      if (fileName.find(nameOfDataMap) != std::string::npos)
+      {
+         return TextureColorSpace::linear;
+      }
+   }
+
+   return TextureColorSpace::sRGB;
+}
+
+bool bakeTexture(const std::string& texFilePath, CookedTextureContents& contents, TextureColorSpace colorSpace, TextureCompression compression, MipFilter mipFilter, ThreadPool* threads)
+{
+   // Every texture is decoded as RGBA, so that the mip generator and the compressor only have to deal with one layout
+   int width;
+   int height;
+   int numComponents;
+   std::unique_ptr<unsigned char, void(*)(void*)> texData(stbi_load(texFilePath.c_str(), &width, &height, &numComponents, 4), stbi_image_free);
+   if (!texData)
+   {
+      std::cout << "Error - bakeTexture - The following texture could not be loaded: " << texFilePath << "\n";
+      return false;
+   }
+
+   std::size_t sizeOfFirstLevel = static_cast<std::size_t>(width) * height * 4;
+
+   bool hasAlpha = false;
+   for (std::size_t i = 3; i < sizeOfFirstLevel; i += 4)
+   {
+      if (texData.get()[i] != 255)
+      {
+         hasAlpha = true;
+         break;
+      }
+   }
+
+   contents        = CookedTextureContents();
+   contents.format = (compression == TextureCompression::none) ? CookedTextureRGBA8 :
+                     ((compression == TextureCompression::bptc) ? CookedTextureBC7 : (hasAlpha ? CookedTextureBC3 : CookedTextureBC1));
+   contents.width  = static_cast<std::uint32_t>(width);
+   contents.height = static_cast<std::uint32_t>(height);
+
+   // Every level down to 1x1 is stored, just like glGenerateMipmap would create
+   std::vector<MipLevel> mipChain = generateMipChain(texData.get(), contents.width, contents.height, mipFilter, colorSpace, threads);
+
+   std::uint64_t sizeOfData = 0;
+   for (std::size_t i = 0; i <= mipChain.size(); ++i)
+   {
+      CookedTextureLevel level;
+      level.width  = (i == 0) ? contents.width : mipChain[i - 1].width;
+      level.height = (i == 0) ? contents.height : mipChain[i - 1].height;
+      level.offset = sizeOfData;
+      level.size   = getSizeOfCookedTextureLevel(contents.format, level.width, level.height);
+      contents.levels.push_back(level);
+      sizeOfData  += level.size;
+   }
+
+   contents.data.resize(static_cast<std::size_t>(sizeOfData));
+   for (std::size_t i = 0; i < contents.levels.size(); ++i)
+   {
+      const CookedTextureLevel& level       = contents.levels[i];
+      const unsigned char*      rgbaTexels  = (i == 0) ? texData.get() : mipChain[i - 1].rgbaTexels.data();
+      unsigned char*            destination = &contents.data[static_cast<std::size_t>(level.offset)];
+
+      if (contents.format == CookedTextureRGBA8)
+      {
+         std::memcpy(destination, rgbaTexels, static_cast<std::size_t>(level.size));
+      }
+      else
+      {
+         compressLevel(rgbaTexels, level.width, level.height, static_cast<CookedTextureFormat>(contents.format), destination, threads);
+      }
+   }
+
+   return true;
+}
+
+bool cookTexture(const std::string& texFilePath, const std::string& cookedFilePath, TextureColorSpace colorSpace, TextureCompression compression, MipFilter mipFilter, ThreadPool* threads)
+{
+   CookedTextureContents contents;
+   return bakeTexture(texFilePath, contents, colorSpace, compression, mipFilter, threads) && writeCookedTextureFile(cookedFilePath, contents);
+}
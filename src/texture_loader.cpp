@@ -1,8 +1,14 @@
-#include <stb_image.h>
-
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
+#include "block_compression.h"
+#include "texture_cooker.h"
 #include "texture_loader.h"
+#include "texture_streamer.h"
 
 std::shared_ptr<Texture> TextureLoader::loadResource(const std::string& texFilePath,
                                                      unsigned int       wrapS,
@@ -11,51 +17,195 @@ std::shared_ptr<Texture> TextureLoader::loadResource(const std::string& texFileP
                                                      unsigned int       magFilter,
                                                      bool               genMipmap) const
 {
-   int width, height, numComponents;
-   std::unique_ptr<unsigned char, void(*)(void*)> texData(stbi_load(texFilePath.c_str(), &width, &height, &numComponents, 0), stbi_image_free);
+   DecodedTexture decodedTexture;
+   if (!decodeTexture(texFilePath, decodedTexture))
+   {
+      return nullptr;
+   }
 
-   if (!texData)
+   return loadResource(decodedTexture, wrapS, wrapT, minFilter, magFilter, genMipmap);
+}
+
+std::shared_ptr<Texture> TextureLoader::loadResource(const DecodedTexture& decodedTexture,
+                                                     unsigned int          wrapS,
+                                                     unsigned int          wrapT,
+                                                     unsigned int          minFilter,
+                                                     unsigned int          magFilter,
+                                                     bool                  genMipmap) const
+{
+   if (!decodedTexture.hasTexels())
    {
-      std::cout << "Error - TextureLoader::loadResource - The following texture could not be loaded: " << texFilePath << "\n";
       return nullptr;
    }
 
-   unsigned int texID = generateTexture(texData, width, height, numComponents, wrapS, wrapT, minFilter, magFilter, genMipmap);
+   unsigned int texID = generateTexture(decodedTexture.cookedContents, wrapS, wrapT, minFilter, magFilter, genMipmap);
+
+   return (texID != 0) ? std::make_shared<Texture>(texID) : nullptr;
+}
+
+std::shared_ptr<Texture> TextureLoader::loadResource(const std::string& texFilePath,
+                                                     TextureStreamer&   texStreamer,
+                                                     unsigned int       wrapS,
+                                                     unsigned int       wrapT,
+                                                     unsigned int       minFilter,
+                                                     unsigned int       magFilter,
+                                                     bool               genMipmap) const
+{
+   return texStreamer.streamTexture(texFilePath, wrapS, wrapT, minFilter, magFilter, genMipmap);
+}
+
+std::shared_ptr<Texture> TextureLoader::loadResource(DecodedTexture&& decodedTexture,
+                                                     TextureStreamer& texStreamer,
+                                                     unsigned int     wrapS,
+                                                     unsigned int     wrapT,
+                                                     unsigned int     minFilter,
+                                                     unsigned int     magFilter,
+                                                     bool             genMipmap) const
+{
+   return texStreamer.streamTexture(std::move(decodedTexture), wrapS, wrapT, minFilter, magFilter, genMipmap);
+}
+
+bool TextureLoader::decodeTexture(const std::string& texFilePath, DecodedTexture& decodedTexture) const
+{
+   auto start = std::chrono::steady_clock::now();
+
+   std::string cookedFilePath = getPathOfCookedTextureFile(texFilePath);
+   if (!cookedTextureFileIsUpToDate(cookedFilePath, texFilePath))
+   {
+      // The texture is baked in memory and then written, so it doesn't have to be read back, and a cooked file that can't be written only costs the next launch
+      if (!bakeTexture(texFilePath, decodedTexture.cookedContents, getColorSpaceOfTexture(texFilePath)))
+      {
+         return false;
+      }
+
+      if (!writeCookedTextureFile(cookedFilePath, decodedTexture.cookedContents))
+      {
+         std::cout << "Warning - TextureLoader::decodeTexture - The cooked version of this texture could not be saved, so it will be cooked again next time: " << texFilePath << "\n";
+      }
+   }
+   else if (!readCookedTextureFile(cookedFilePath, decodedTexture.cookedContents))
+   {
+      std::cout << "Warning - TextureLoader::decodeTexture - The cooked version of this texture could not be read, so it will be cooked again: " << texFilePath << "\n";
+      if (!bakeTexture(texFilePath, decodedTexture.cookedContents, getColorSpaceOfTexture(texFilePath)))
+      {
+         return false;
+      }
+   }
+
+   decodedTexture.secondsSpentDecoding = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   return true;
+}
+
+bool TextureLoader::compressedFormatIsSupported(unsigned int format) const
+{
+   // S3TC and BPTC are extensions, so some drivers list them among their extensions without listing their formats, and the other way around
+   int numFormats = 0;
+   glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &numFormats);
+
+   std::vector<int> formats(static_cast<std::size_t>(std::max(numFormats, 0)));
+   if (!formats.empty())
+   {
+      glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+   }
 
-   return std::make_shared<Texture>(texID);
+   if (std::find(formats.cbegin(), formats.cend(), static_cast<int>(format)) != formats.cend())
+   {
+      return true;
+   }
+
+   const char* nameOfExtension = (format == GL_COMPRESSED_RGBA_BPTC_UNORM_ARB) ? "GL_ARB_texture_compression_bptc" : "GL_EXT_texture_compression_s3tc";
+
+   int numExtensions = 0;
+   glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+   for (int i = 0; i < numExtensions; ++i)
+   {
+      const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+      if ((extension != nullptr) && (std::strcmp(extension, nameOfExtension) == 0))
+      {
+         return true;
+      }
+   }
+
+   return false;
 }
 
-unsigned int TextureLoader::generateTexture(const std::unique_ptr<unsigned char, void(*)(void*)>& texData,
-                                            int          width,
-                                            int          height,
-                                            int          numComponents,
-                                            unsigned int wrapS,
-                                            unsigned int wrapT,
-                                            unsigned int minFilter,
-                                            unsigned int magFilter,
-                                            bool         genMipmap) const
+bool TextureLoader::cookedFormatIsSupported(std::uint32_t cookedFormat) const
 {
-   GLenum format;
-   switch (numComponents)
+   GLenum format = getFormatOfCookedTexture(cookedFormat);
+   return (format == GL_RGBA8) || compressedFormatIsSupported(format);
+}
+
+unsigned int TextureLoader::getFormatOfCookedTexture(std::uint32_t cookedFormat) const
+{
+   switch (cookedFormat)
    {
-   case 3:
-      format = GL_RGB;
-      break;
-   case 4:
-      format = GL_RGBA;
-      break;
+   case CookedTextureBC1:
+      return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+   case CookedTextureBC3:
+      return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+   case CookedTextureBC7:
+      return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
    default:
-      std::cout << "Error - TextureLoader::generateTexture - The texture has an invalid number of components: " << numComponents << "\n";
+      return GL_RGBA8;
+   }
+}
+
+bool TextureLoader::uploadCookedLevels(const CookedTextureContents& cookedContents, const unsigned char* texels, bool genMipmap) const
+{
+   GLenum format         = getFormatOfCookedTexture(cookedContents.format);
+   bool   mustDecompress = (format != GL_RGBA8) && !compressedFormatIsSupported(format);
+   if (mustDecompress && (texels == nullptr))
+   {
+      std::cout << "Error - TextureLoader::uploadCookedLevels - The driver doesn't support the format of a cooked texture, which can't be decompressed from a pixel buffer: "
+                << getNameOfCookedTextureFormat(cookedContents.format) << "\n";
+      return false;
    }
 
+   // Each level is decompressed right before it's uploaded, so only one of them is held in RGBA8 at a time
+   std::vector<unsigned char> decompressedTexels;
+
+   GLsizei numLevels = genMipmap ? static_cast<GLsizei>(cookedContents.levels.size()) : 1;
+   for (GLsizei i = 0; i < numLevels; ++i)
+   {
+      // With a pixel buffer bound, the pointer is read as an offset into the buffer
+      const CookedTextureLevel& level       = cookedContents.levels[i];
+      const void*               levelTexels = reinterpret_cast<const void*>(reinterpret_cast<std::uintptr_t>(texels) + static_cast<std::uintptr_t>(level.offset));
+      if (mustDecompress)
+      {
+         decompressedTexels.resize(static_cast<std::size_t>(getSizeOfCookedTextureLevel(CookedTextureRGBA8, level.width, level.height)));
+         decompressTextureLevel(static_cast<const unsigned char*>(levelTexels), level.width, level.height, static_cast<CookedTextureFormat>(cookedContents.format), decompressedTexels.data());
+         glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, decompressedTexels.data());
+      }
+      else if (format == GL_RGBA8)
+      {
+         glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, levelTexels);
+      }
+      else
+      {
+         glCompressedTexImage2D(GL_TEXTURE_2D, i, format, level.width, level.height, 0, static_cast<GLsizei>(level.size), levelTexels);
+      }
+   }
+
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+   return true;
+}
+
+unsigned int TextureLoader::generateTexture(const CookedTextureContents& cookedContents,
+                                            unsigned int                 wrapS,
+                                            unsigned int                 wrapT,
+                                            unsigned int                 minFilter,
+                                            unsigned int                 magFilter,
+                                            bool                         genMipmap) const
+{
    unsigned int texID;
    glGenTextures(1, &texID);
    glBindTexture(GL_TEXTURE_2D, texID);
-   glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, texData.get());
 
-   if (genMipmap)
+   if (!uploadCookedLevels(cookedContents, cookedContents.data.data(), genMipmap))
    {
-      glGenerateMipmap(GL_TEXTURE_2D);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      glDeleteTextures(1, &texID);
+      return 0;
    }
 
    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
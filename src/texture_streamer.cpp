@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "block_compression.h"
+#include "texture_streamer.h"
+
+// Mid grey, so that a model doesn't flash black or white while its textures are streamed
+const unsigned char placeholderPixel[4] = {128, 128, 128, 255};
+
+TextureStreamer::TextureStreamer(unsigned int numberOfPixelBuffers, std::size_t maxBytesUploadedPerUpdate, unsigned int numberOfDecodingThreads)
+   : mPixelBuffers(numberOfPixelBuffers)
+   , mMaxBytesUploadedPerUpdate(maxBytesUploadedPerUpdate)
+   , mRequestsWaitingForUpload()
+   , mNumberOfTexturesPending(0)
+   , mUnsupportedCookedFormats()
+   , mDecodedRequests()
+   , mDecodedRequestsMutex()
+   , mDecodingThreads(numberOfDecodingThreads)
+{
+   // The buffers are only allocated when they are first used, with the size of the texture that uses them
+   for (PixelBuffer& pixelBuffer : mPixelBuffers)
+   {
+      glGenBuffers(1, &pixelBuffer.bufferID);
+      pixelBuffer.size  = 0;
+      pixelBuffer.fence = nullptr;
+   }
+
+   TextureLoader texLoader;
+   for (std::uint32_t cookedFormat : {CookedTextureBC1, CookedTextureBC3, CookedTextureBC7})
+   {
+      if (!texLoader.cookedFormatIsSupported(cookedFormat))
+      {
+         std::cout << "Warning - TextureStreamer::TextureStreamer - The driver doesn't support " << getNameOfCookedTextureFormat(cookedFormat)
+                   << ", so the textures cooked with it will be decompressed into RGBA8" << "\n";
+         mUnsupportedCookedFormats.push_back(cookedFormat);
+      }
+   }
+}
+
+TextureStreamer::~TextureStreamer()
+{
+   for (PixelBuffer& pixelBuffer : mPixelBuffers)
+   {
+      if (pixelBuffer.fence)
+      {
+         glDeleteSync(pixelBuffer.fence);
+      }
+
+      glDeleteBuffers(1, &pixelBuffer.bufferID);
+   }
+}
+
+std::shared_ptr<Texture> TextureStreamer::streamTexture(const std::string& texFilePath,
+                                                        unsigned int       wrapS,
+                                                        unsigned int       wrapT,
+                                                        unsigned int       minFilter,
+                                                        unsigned int       magFilter,
+                                                        bool               genMipmap)
+{
+   std::shared_ptr<TextureRequest> request = createRequest(wrapS, wrapT, minFilter, magFilter, genMipmap);
+
+   mDecodingThreads.submit([this, request, texFilePath]()
+   {
+      // A texture that can't be decoded keeps its placeholder, and decodeTexture prints the error
+      TextureLoader{}.decodeTexture(texFilePath, request->decodedTexture);
+      decompressIfUnsupported(request->decodedTexture);
+
+      std::lock_guard<std::mutex> lock(mDecodedRequestsMutex);
+      mDecodedRequests.push_back(request);
+   });
+
+   return request->texture;
+}
+
+std::shared_ptr<Texture> TextureStreamer::streamTexture(DecodedTexture&& decodedTexture,
+                                                        unsigned int     wrapS,
+                                                        unsigned int     wrapT,
+                                                        unsigned int     minFilter,
+                                                        unsigned int     magFilter,
+                                                        bool             genMipmap)
+{
+   std::shared_ptr<TextureRequest> request = createRequest(wrapS, wrapT, minFilter, magFilter, genMipmap);
+   request->decodedTexture = std::move(decodedTexture);
+   decompressIfUnsupported(request->decodedTexture);
+   mRequestsWaitingForUpload.push_back(request);
+
+   return request->texture;
+}
+
+void TextureStreamer::update()
+{
+   finishUploads();
+
+   {
+      std::lock_guard<std::mutex> lock(mDecodedRequestsMutex);
+      mRequestsWaitingForUpload.insert(mRequestsWaitingForUpload.end(), mDecodedRequests.begin(), mDecodedRequests.end());
+      mDecodedRequests.clear();
+   }
+
+   // At least one texture is uploaded per update, even if it's bigger than the budget, so that big textures aren't starved
+   std::size_t bytesUploaded = 0;
+   for (PixelBuffer& pixelBuffer : mPixelBuffers)
+   {
+      if (pixelBuffer.request)
+      {
+         continue;
+      }
+
+      while (!mRequestsWaitingForUpload.empty())
+      {
+         std::shared_ptr<TextureRequest> request = mRequestsWaitingForUpload.front();
+         std::size_t                     size    = request->decodedTexture.getSizeInBytes();
+
+         if ((bytesUploaded > 0) && (bytesUploaded + size > mMaxBytesUploadedPerUpdate))
+         {
+            return;
+         }
+
+         mRequestsWaitingForUpload.pop_front();
+         if (startUpload(pixelBuffer, request))
+         {
+            bytesUploaded += size;
+            break;
+         }
+
+         --mNumberOfTexturesPending;
+      }
+   }
+}
+
+unsigned int TextureStreamer::getNumberOfTexturesPending() const
+{
+   return mNumberOfTexturesPending;
+}
+
+void TextureStreamer::decompressIfUnsupported(DecodedTexture& decodedTexture) const
+{
+   std::uint32_t cookedFormat = decodedTexture.cookedContents.format;
+   if (std::find(mUnsupportedCookedFormats.cbegin(), mUnsupportedCookedFormats.cend(), cookedFormat) != mUnsupportedCookedFormats.cend())
+   {
+      decompressCookedTexture(decodedTexture.cookedContents);
+   }
+}
+
+std::shared_ptr<TextureStreamer::TextureRequest> TextureStreamer::createRequest(unsigned int wrapS,
+                                                                                unsigned int wrapT,
+                                                                                unsigned int minFilter,
+                                                                                unsigned int magFilter,
+                                                                                bool         genMipmap)
+{
+   // The placeholder is stored in the texture that will hold the real pixels, so whoever holds the texture sees them as soon as they are resident
+   // It doesn't have mipmaps, so it's sampled linearly until the real mipmaps are uploaded
+   unsigned int texID;
+   glGenTextures(1, &texID);
+   glBindTexture(GL_TEXTURE_2D, texID);
+   glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholderPixel);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+   glBindTexture(GL_TEXTURE_2D, 0);
+
+   std::shared_ptr<TextureRequest> request = std::make_shared<TextureRequest>();
+   request->texture   = std::make_shared<Texture>(texID);
+   request->minFilter = minFilter;
+   request->genMipmap = genMipmap;
+
+   ++mNumberOfTexturesPending;
+   return request;
+}
+
+void TextureStreamer::finishUploads()
+{
+   for (PixelBuffer& pixelBuffer : mPixelBuffers)
+   {
+      if (!pixelBuffer.fence)
+      {
+         continue;
+      }
+
+      // A timeout of 0 only checks the fence, without waiting for it
+      GLenum result = glClientWaitSync(pixelBuffer.fence, 0, 0);
+      if (result == GL_TIMEOUT_EXPIRED)
+      {
+         continue;
+      }
+
+      glDeleteSync(pixelBuffer.fence);
+      pixelBuffer.fence = nullptr;
+
+      TextureRequest& request = *pixelBuffer.request;
+      request.texture->bind();
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, request.minFilter);
+      glBindTexture(GL_TEXTURE_2D, 0);
+
+      pixelBuffer.request.reset();
+      --mNumberOfTexturesPending;
+   }
+}
+
+bool TextureStreamer::startUpload(PixelBuffer& pixelBuffer, const std::shared_ptr<TextureRequest>& request)
+{
+   const DecodedTexture& pixels = request->decodedTexture;
+   if (!pixels.hasTexels())
+   {
+      return false;
+   }
+
+   std::size_t size = pixels.getSizeInBytes();
+
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer.bufferID);
+   if (pixelBuffer.size < size)
+   {
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+      pixelBuffer.size = size;
+   }
+
+   // The fence of the previous upload from this buffer has been signaled, so the buffer can be written without waiting for the GPU
+   void* mappedBuffer = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+   bool  wasCopied    = false;
+   if (mappedBuffer)
+   {
+      std::memcpy(mappedBuffer, pixels.cookedContents.data.data(), size);
+      wasCopied = (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE);
+   }
+
+   // The cooker generated the mipmaps, so every level is read from its offset in the bound pixel buffer, and none are generated once the fence is signaled
+   TextureLoader texLoader;
+   bool          wasUploaded = false;
+   if (!wasCopied)
+   {
+      std::cout << "Error - TextureStreamer::startUpload - Failed to copy a texture into a pixel buffer" << "\n";
+   }
+   else
+   {
+      request->texture->bind();
+      wasUploaded = texLoader.uploadCookedLevels(pixels.cookedContents, nullptr, request->genMipmap);
+   }
+
+   // Every other upload in the game reads from client memory, which it couldn't do while a pixel buffer is bound
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   glBindTexture(GL_TEXTURE_2D, 0);
+
+   if (!wasUploaded)
+   {
+      return false;
+   }
+
+   pixelBuffer.fence   = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+   pixelBuffer.request = request;
+
+   // The pixels are in the pixel buffer now
+   request->decodedTexture = DecodedTexture();
+   return true;
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(unsigned int numberOfThreads)
+   : mThreads()
+   , mTasks()
+   , mMutex()
+   , mTaskIsReady()
+   , mPoolIsIdle()
+   , mNumberOfTasksRunning(0)
+   , mThreadsShouldStop(false)
+{
+   if (numberOfThreads == 0)
+   {
+      numberOfThreads = std::max(std::thread::hardware_concurrency(), 1u);
+   }
+
+   for (unsigned int i = 0; i < numberOfThreads; ++i)
+   {
+      mThreads.emplace_back(&ThreadPool::work, this);
+   }
+}
+
+ThreadPool::~ThreadPool()
+{
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mThreadsShouldStop = true;
+   }
+   mTaskIsReady.notify_all();
+
+   for (std::thread& thread : mThreads)
+   {
+      thread.join();
+   }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mTasks.push_back(std::move(task));
+   }
+   mTaskIsReady.notify_one();
+}
+
+void ThreadPool::waitUntilIdle()
+{
+   std::unique_lock<std::mutex> lock(mMutex);
+   mPoolIsIdle.wait(lock, [this]() { return mTasks.empty() && (mNumberOfTasksRunning == 0); });
+}
+
+unsigned int ThreadPool::getNumberOfThreads() const
+{
+   return static_cast<unsigned int>(mThreads.size());
+}
+
+void ThreadPool::work()
+{
+   while (true)
+   {
+      std::function<void()> task;
+      {
+         std::unique_lock<std::mutex> lock(mMutex);
+         mTaskIsReady.wait(lock, [this]() { return mThreadsShouldStop || !mTasks.empty(); });
+
+         // The remaining tasks are dropped when the pool is destroyed
+         if (mThreadsShouldStop)
+         {
+            return;
+         }
+
+         task = std::move(mTasks.front());
+         mTasks.pop_front();
+         ++mNumberOfTasksRunning;
+      }
+
+      task();
+
+      bool poolIsIdle = false;
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         --mNumberOfTasksRunning;
+         poolIsIdle = mTasks.empty() && (mNumberOfTasksRunning == 0);
+      }
+
+      if (poolIsIdle)
+      {
+         mPoolIsIdle.notify_all();
+      }
+   }
+}
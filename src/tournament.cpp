@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "tournament.h"
+
+// Workers split the ranges that they take until they are this small, so that there is always something left to steal
+const std::uint32_t matchesPerGrain = 4;
+
+const std::size_t   capacityOfDeques = 1024;
+
+const unsigned int TournamentResults::maxRallyLength;
+
+TournamentResults::TournamentResults(std::size_t numberOfPairings)
+   : pairings(numberOfPairings, PairingResults{0, 0, 0})
+   , rallyLengths()
+   , serveDirections()
+   , numberOfMatches(0)
+   , numberOfPoints(0)
+   , numberOfSteps(0)
+{
+
+}
+
+void TournamentResults::merge(const TournamentResults& other)
+{
+   for (std::size_t i = 0; i < pairings.size(); ++i)
+   {
+      pairings[i].winsOfLeftEntrant  += other.pairings[i].winsOfLeftEntrant;
+      pairings[i].winsOfRightEntrant += other.pairings[i].winsOfRightEntrant;
+      pairings[i].draws              += other.pairings[i].draws;
+   }
+
+   for (std::size_t i = 0; i < rallyLengths.size(); ++i)
+   {
+      rallyLengths[i] += other.rallyLengths[i];
+   }
+
+   for (std::size_t i = 0; i < serveDirections.size(); ++i)
+   {
+      serveDirections[i] += other.serveDirections[i];
+   }
+
+   numberOfMatches += other.numberOfMatches;
+   numberOfPoints  += other.numberOfPoints;
+   numberOfSteps   += other.numberOfSteps;
+}
+
+Tournament::Tournament(const MatchConfiguration&             configuration,
+                       const std::vector<TournamentEntrant>& entrants,
+                       unsigned int                          matchesPerPairing,
+                       float                                 deltaTime,
+                       float                                 maxDurationOfMatch,
+                       std::uint64_t                         seed)
+   : mConfiguration(configuration)
+   , mEntrants(entrants)
+   , mPairings()
+   , mMatchesPerPairing(matchesPerPairing)
+   , mDeltaTime(deltaTime)
+   , mMaxNumberOfStepsPerMatch(static_cast<unsigned int>(maxDurationOfMatch / deltaTime))
+   , mSeed(seed)
+   , mDeques()
+   , mNumberOfMatchesLeft(0)
+   , mResultsOfWorkers()
+   , mResults(0)
+   , mWorkerReports()
+   , mSecondsSpentRunning(0.0)
+{
+   for (std::size_t left = 0; left < mEntrants.size(); ++left)
+   {
+      for (std::size_t right = 0; right < mEntrants.size(); ++right)
+      {
+         // An entrant only plays against itself when it is the only one
+         if (left != right || mEntrants.size() == 1)
+         {
+            mPairings.emplace_back(left, right);
+         }
+      }
+   }
+
+   mResults = TournamentResults(mPairings.size());
+}
+
+void Tournament::run(unsigned int numberOfWorkers)
+{
+   numberOfWorkers = std::max(numberOfWorkers, 1u);
+
+   std::uint32_t numberOfMatches = static_cast<std::uint32_t>(mPairings.size() * mMatchesPerPairing);
+
+   // Give each worker an equal share of the matches to start with
+   mDeques.clear();
+   for (unsigned int i = 0; i < numberOfWorkers; ++i)
+   {
+      mDeques.push_back(std::unique_ptr<WorkStealingDeque<MatchRange>>(new WorkStealingDeque<MatchRange>(capacityOfDeques)));
+
+      MatchRange share = {static_cast<std::uint32_t>((static_cast<std::uint64_t>(numberOfMatches) * i) / numberOfWorkers),
+                          static_cast<std::uint32_t>((static_cast<std::uint64_t>(numberOfMatches) * (i + 1)) / numberOfWorkers)};
+      if (share.end > share.begin)
+      {
+         mDeques.back()->push(share);
+      }
+   }
+
+   mNumberOfMatchesLeft.store(numberOfMatches);
+   mResultsOfWorkers.assign(numberOfWorkers, TournamentResults(mPairings.size()));
+   mWorkerReports.assign(numberOfWorkers, WorkerReport{0, 0, 0.0});
+
+   auto start = std::chrono::steady_clock::now();
+
+   std::vector<std::thread> workers;
+   for (unsigned int i = 0; i < numberOfWorkers; ++i)
+   {
+      workers.emplace_back(&Tournament::work, this, i);
+   }
+
+   for (std::thread& worker : workers)
+   {
+      worker.join();
+   }
+
+   mSecondsSpentRunning = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   mResults = TournamentResults(mPairings.size());
+   for (const TournamentResults& resultsOfWorker : mResultsOfWorkers)
+   {
+      mResults.merge(resultsOfWorker);
+   }
+}
+
+const std::vector<TournamentEntrant>& Tournament::getEntrants() const
+{
+   return mEntrants;
+}
+
+TournamentResults Tournament::playMatches(std::uint32_t begin, std::uint32_t end) const
+{
+   TournamentResults results(mPairings.size());
+
+   std::vector<std::unique_ptr<PaddleController>> leftControllers;
+   std::vector<std::unique_ptr<PaddleController>> rightControllers;
+   for (const TournamentEntrant& entrant : mEntrants)
+   {
+      leftControllers.push_back(entrant.createController());
+      rightControllers.push_back(entrant.createController());
+   }
+
+   for (std::uint32_t matchIndex = begin; matchIndex < std::min(end, getNumberOfMatches()); ++matchIndex)
+   {
+      const std::pair<std::size_t, std::size_t>& pairing = mPairings[matchIndex / mMatchesPerPairing];
+      playMatch(matchIndex, *leftControllers[pairing.first], *rightControllers[pairing.second], results);
+   }
+
+   return results;
+}
+
+std::uint32_t Tournament::getNumberOfMatches() const
+{
+   return static_cast<std::uint32_t>(mPairings.size() * mMatchesPerPairing);
+}
+
+unsigned int Tournament::getMatchesPerPairing() const
+{
+   return mMatchesPerPairing;
+}
+
+std::uint64_t Tournament::getSeed() const
+{
+   return mSeed;
+}
+
+const MatchConfiguration& Tournament::getConfiguration() const
+{
+   return mConfiguration;
+}
+
+float Tournament::getDeltaTime() const
+{
+   return mDeltaTime;
+}
+
+unsigned int Tournament::getMaxNumberOfStepsPerMatch() const
+{
+   return mMaxNumberOfStepsPerMatch;
+}
+
+std::size_t Tournament::getNumberOfPairings() const
+{
+   return mPairings.size();
+}
+
+std::size_t Tournament::getLeftEntrantOfPairing(std::size_t pairingIndex) const
+{
+   return mPairings[pairingIndex].first;
+}
+
+std::size_t Tournament::getRightEntrantOfPairing(std::size_t pairingIndex) const
+{
+   return mPairings[pairingIndex].second;
+}
+
+const TournamentResults& Tournament::getResults() const
+{
+   return mResults;
+}
+
+const std::vector<WorkerReport>& Tournament::getWorkerReports() const
+{
+   return mWorkerReports;
+}
+
+double Tournament::getSecondsSpentRunning() const
+{
+   return mSecondsSpentRunning;
+}
+
+void Tournament::work(unsigned int workerIndex)
+{
+   auto start = std::chrono::steady_clock::now();
+
+   // The results are accumulated in local variables, so that the workers don't write to the same cache lines while they play
+   TournamentResults results(mPairings.size());
+   WorkerReport      report = {0, 0, 0.0};
+
+   std::vector<std::unique_ptr<PaddleController>> leftControllers;
+   std::vector<std::unique_ptr<PaddleController>> rightControllers;
+   for (const TournamentEntrant& entrant : mEntrants)
+   {
+      leftControllers.push_back(entrant.createController());
+      rightControllers.push_back(entrant.createController());
+   }
+
+   WorkStealingDeque<MatchRange>& deque = *mDeques[workerIndex];
+   unsigned int numberOfWorkers         = static_cast<unsigned int>(mDeques.size());
+
+   // This stream is only used to pick the workers that we steal from, so it doesn't affect the results
+   std::uint64_t randomNumberGeneratorState = mSeed + workerIndex;
+
+   while (mNumberOfMatchesLeft.load(std::memory_order_acquire) > 0)
+   {
+      MatchRange range;
+      if (!deque.pop(range))
+      {
+         unsigned int victimIndex = static_cast<unsigned int>(drawRandomNumber(randomNumberGeneratorState) % numberOfWorkers);
+         if (victimIndex == workerIndex || !mDeques[victimIndex]->steal(range))
+         {
+            std::this_thread::yield();
+            continue;
+         }
+
+         ++report.rangesStolen;
+      }
+
+      // Keep the first half of the range and put the second half back where it can be stolen
+      while (range.end - range.begin > matchesPerGrain)
+      {
+         std::uint32_t middle = range.begin + ((range.end - range.begin) / 2);
+         if (!deque.push(MatchRange{middle, range.end}))
+         {
+            break;
+         }
+
+         range.end = middle;
+      }
+
+      for (std::uint32_t matchIndex = range.begin; matchIndex < range.end; ++matchIndex)
+      {
+         const std::pair<std::size_t, std::size_t>& pairing = mPairings[matchIndex / mMatchesPerPairing];
+         playMatch(matchIndex, *leftControllers[pairing.first], *rightControllers[pairing.second], results);
+      }
+
+      report.matchesPlayed += range.end - range.begin;
+      mNumberOfMatchesLeft.fetch_sub(range.end - range.begin, std::memory_order_release);
+   }
+
+   report.secondsSpentWorking = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+   mResultsOfWorkers[workerIndex] = std::move(results);
+   mWorkerReports[workerIndex]    = report;
+}
+
+void Tournament::playMatch(std::uint32_t      matchIndex,
+                           PaddleController&  leftController,
+                           PaddleController&  rightController,
+                           TournamentResults& results) const
+{
+   std::uint64_t randomNumberGeneratorState = mSeed ^ (static_cast<std::uint64_t>(matchIndex) * 0xD1B54A32D192ED03ull);
+
+   MatchSimulation simulation(mConfiguration, drawRandomNumber(randomNumberGeneratorState));
+   leftController.reset(PaddleSide::Left, drawRandomNumber(randomNumberGeneratorState));
+   rightController.reset(PaddleSide::Right, drawRandomNumber(randomNumberGeneratorState));
+
+   unsigned int numberOfHitsInRally = 0;
+   for (unsigned int i = 0; i < mMaxNumberOfStepsPerMatch; ++i)
+   {
+      const MatchState& state = simulation.getState();
+
+      // Serve as soon as possible
+      MatchInputs inputs;
+      inputs.leftPaddle  = leftController.decide(state, mConfiguration, mDeltaTime);
+      inputs.rightPaddle = rightController.decide(state, mConfiguration, mDeltaTime);
+      inputs.releaseBall = !state.ballIsInPlay;
+
+      MatchEvents events = simulation.step(inputs, mDeltaTime);
+      ++results.numberOfSteps;
+
+      if (events.ballWasReleased)
+      {
+         ++results.serveDirections[events.serveDirection];
+      }
+
+      if (events.ballHitLeftPaddle)  { ++numberOfHitsInRally; }
+      if (events.ballHitRightPaddle) { ++numberOfHitsInRally; }
+
+      if (events.pointWasScored)
+      {
+         ++results.rallyLengths[std::min(numberOfHitsInRally, TournamentResults::maxRallyLength)];
+         ++results.numberOfPoints;
+         numberOfHitsInRally = 0;
+      }
+
+      if (events.matchIsOver)
+      {
+         break;
+      }
+   }
+
+   const MatchState& finalState = simulation.getState();
+   PairingResults&   pairing    = results.pairings[matchIndex / mMatchesPerPairing];
+   if (!finalState.matchIsOver)
+   {
+      ++pairing.draws;
+   }
+   else if (finalState.pointsScoredByLeftPaddle > finalState.pointsScoredByRightPaddle)
+   {
+      ++pairing.winsOfLeftEntrant;
+   }
+   else
+   {
+      ++pairing.winsOfRightEntrant;
+   }
+
+   ++results.numberOfMatches;
+}
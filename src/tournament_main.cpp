@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include <unistd.h>
+
+#include "distributed_tournament.h"
+
+// Plays a round-robin tournament between paddle controllers on all the cores of the machine
+// Usage: teapong_tournament [--workers N] [--matches N] [--seed N] [--replay FILE]... [--processes N] [--listen ADDRESS] [--matches-per-job N] [--job-deadline SECONDS] [--worker ADDRESS]
+//   --workers          Number of worker threads (defaults to the number of cores)
+//   --matches          Number of matches played by each pairing of entrants, on each side of the table (defaults to 1000)
+//   --seed             Seed of the tournament (defaults to 1)
+//   --replay           Adds an entrant that replays the inputs of the left paddle stored in FILE (one PackedMatchInput byte per step)
+//   --processes        Plays the matches in N worker processes instead of threads, coordinated over a socket (see distributed_tournament.h)
+//   --listen           Address on which the coordinator waits for workers, "unix:PATH" or "tcp:HOST:PORT" (defaults to a Unix domain socket in /tmp)
+//                      Use --processes 0 to only use workers that are started separately, e.g. on other machines
+//   --matches-per-job  Number of matches that the coordinator sends to a worker at a time (defaults to 64)
+//   --job-deadline     Seconds after which a job that a worker hasn't finished is also given to another worker, or 0 to never do that (defaults to 30)
+//   --worker           Connects to the coordinator at ADDRESS and plays the matches that it sends, which requires the same --matches, --seed and --replay arguments
+
+int main(int argc, char* argv[])
+{
+   unsigned int  numberOfWorkers   = std::max(std::thread::hardware_concurrency(), 1u);
+   unsigned int  matchesPerPairing = 1000;
+   std::uint64_t seed              = 1;
+
+   // Each worker process keeps 2 jobs queued, so that it starts the next one as soon as it sends the results of the previous one
+   // A job takes well under a second at the default size, so a worker that takes 30 seconds is stuck or much slower than the rest
+   bool                useProcesses        = false;
+   std::string         workerAddress;
+   CoordinatorSettings coordinatorSettings = {"unix:/tmp/teapong_tournament_" + std::to_string(getpid()) + ".sock", 0, 64, 2, 30.0};
+
+   std::vector<TournamentEntrant> entrants;
+   entrants.push_back({"scripted",        []() { return std::unique_ptr<PaddleController>(new ScriptedPaddleController()); }});
+   entrants.push_back({"tracking",        []() { return std::unique_ptr<PaddleController>(new TrackingPaddleController(0.5f)); }});
+   entrants.push_back({"tracking-sloppy", []() { return std::unique_ptr<PaddleController>(new TrackingPaddleController(4.0f)); }});
+   entrants.push_back({"computer-easy",   []() { return std::unique_ptr<PaddleController>(new ComputerPaddleController(Difficulty::Easy)); }});
+   entrants.push_back({"computer-medium", []() { return std::unique_ptr<PaddleController>(new ComputerPaddleController(Difficulty::Medium)); }});
+   entrants.push_back({"computer-hard",   []() { return std::unique_ptr<PaddleController>(new ComputerPaddleController(Difficulty::Hard)); }});
+
+   for (int i = 1; i < argc; ++i)
+   {
+      bool hasValue = (i + 1 < argc);
+
+      if (std::strcmp(argv[i], "--workers") == 0 && hasValue)
+      {
+         numberOfWorkers = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--matches") == 0 && hasValue)
+      {
+         matchesPerPairing = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+      {
+         seed = std::strtoull(argv[++i], nullptr, 10);
+      }
+      else if (std::strcmp(argv[i], "--replay") == 0 && hasValue)
+      {
+         std::string                                     filePath       = argv[++i];
+         std::shared_ptr<const std::vector<PaddleInput>> recordedInputs = loadRecordedPaddleInputs(filePath, PaddleSide::Left);
+         entrants.push_back({"replay:" + filePath, [recordedInputs]() { return std::unique_ptr<PaddleController>(new ReplayedPaddleController(recordedInputs)); }});
+      }
+      else if (std::strcmp(argv[i], "--processes") == 0 && hasValue)
+      {
+         useProcesses                             = true;
+         coordinatorSettings.numberOfLocalWorkers = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--listen") == 0 && hasValue)
+      {
+         useProcesses                = true;
+         coordinatorSettings.address = argv[++i];
+      }
+      else if (std::strcmp(argv[i], "--matches-per-job") == 0 && hasValue)
+      {
+         coordinatorSettings.matchesPerJob = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--job-deadline") == 0 && hasValue)
+      {
+         coordinatorSettings.secondsBeforeJobIsReassigned = std::strtod(argv[++i], nullptr);
+      }
+      else if (std::strcmp(argv[i], "--worker") == 0 && hasValue)
+      {
+         workerAddress = argv[++i];
+      }
+      else
+      {
+         std::cout << "Error - main - Unknown argument: " << argv[i] << "\n";
+         return -1;
+      }
+   }
+
+   MatchConfiguration config;
+   float              deltaTime          = 1.0f / 240.0f;
+   float              maxDurationOfMatch = 600.0f;
+
+   Tournament tournament(config, entrants, matchesPerPairing, deltaTime, maxDurationOfMatch, seed);
+
+   if (!workerAddress.empty())
+   {
+      return runTournamentWorker(tournament, workerAddress) ? 0 : -1;
+   }
+
+   std::unique_ptr<TournamentCoordinator> coordinator;
+   if (useProcesses)
+   {
+      coordinator.reset(new TournamentCoordinator(tournament, coordinatorSettings));
+      if (!coordinator->run())
+      {
+         return -1;
+      }
+   }
+   else
+   {
+      tournament.run(numberOfWorkers);
+   }
+
+   const TournamentResults& results = coordinator ? coordinator->getResults() : tournament.getResults();
+
+   std::cout << std::fixed << std::setprecision(3);
+
+   std::cout << "Pairings (left vs right: wins of left / wins of right / draws)" << "\n";
+   for (std::size_t i = 0; i < tournament.getNumberOfPairings(); ++i)
+   {
+      const PairingResults& pairing = results.pairings[i];
+      std::cout << "  " << entrants[tournament.getLeftEntrantOfPairing(i)].name << " vs " << entrants[tournament.getRightEntrantOfPairing(i)].name << ": "
+                << pairing.winsOfLeftEntrant << " / " << pairing.winsOfRightEntrant << " / " << pairing.draws << "\n";
+   }
+
+   std::cout << "Win rates" << "\n";
+   for (std::size_t entrant = 0; entrant < entrants.size(); ++entrant)
+   {
+      std::uint64_t wins    = 0;
+      std::uint64_t matches = 0;
+      for (std::size_t i = 0; i < tournament.getNumberOfPairings(); ++i)
+      {
+         const PairingResults& pairing = results.pairings[i];
+         std::uint64_t         played  = pairing.winsOfLeftEntrant + pairing.winsOfRightEntrant + pairing.draws;
+         if (tournament.getLeftEntrantOfPairing(i) == entrant)  { wins += pairing.winsOfLeftEntrant;  matches += played; }
+         if (tournament.getRightEntrantOfPairing(i) == entrant) { wins += pairing.winsOfRightEntrant; matches += played; }
+      }
+
+      std::cout << "  " << entrants[entrant].name << ": " << (matches > 0 ? static_cast<double>(wins) / matches : 0.0) << "\n";
+   }
+
+   std::uint64_t numberOfRallies = 0;
+   std::uint64_t numberOfHits    = 0;
+   for (unsigned int length = 0; length <= TournamentResults::maxRallyLength; ++length)
+   {
+      numberOfRallies += results.rallyLengths[length];
+      numberOfHits    += results.rallyLengths[length] * length;
+   }
+
+   std::cout << "Rally lengths (paddle hits per point)" << "\n";
+   std::cout << "  Mean: " << (numberOfRallies > 0 ? static_cast<double>(numberOfHits) / numberOfRallies : 0.0) << "\n";
+   for (unsigned int length = 0; length <= TournamentResults::maxRallyLength; ++length)
+   {
+      if (results.rallyLengths[length] > 0)
+      {
+         std::cout << "  " << length << ((length == TournamentResults::maxRallyLength) ? "+" : "") << ": " << results.rallyLengths[length] << "\n";
+      }
+   }
+
+   std::cout << "Serve directions (upper right / lower right / lower left / upper left)" << "\n";
+   std::cout << "  " << results.serveDirections[0] << " / " << results.serveDirections[1] << " / " << results.serveDirections[2] << " / " << results.serveDirections[3] << "\n";
+
+   if (coordinator)
+   {
+      const CoordinatorReport& report = coordinator->getReport();
+      std::cout << "Coordinator" << "\n";
+      std::cout << "  " << report.numberOfJobs << " jobs, " << report.workersConnected << " workers connected, " << report.workersLost << " lost, "
+                << report.workersRejected << " rejected, " << report.jobsReassigned << " jobs reassigned, " << report.jobsPastTheirDeadline << " jobs past their deadline, "
+                << report.jobsPlayedByCoordinator << " jobs played by the coordinator" << "\n";
+      std::cout << "Total: " << results.numberOfMatches << " matches, " << results.numberOfSteps << " steps in " << report.secondsSpentRunning << " s, "
+                << (results.numberOfMatches / report.secondsSpentRunning) << " matches/s" << "\n";
+
+      return 0;
+   }
+
+   std::cout << "Workers" << "\n";
+   const std::vector<WorkerReport>& reports = tournament.getWorkerReports();
+   for (std::size_t i = 0; i < reports.size(); ++i)
+   {
+      std::cout << "  " << i << ": " << reports[i].matchesPlayed << " matches, " << reports[i].rangesStolen << " ranges stolen, "
+                << (reports[i].matchesPlayed / reports[i].secondsSpentWorking) << " matches/s" << "\n";
+   }
+
+   std::cout << "Total: " << results.numberOfMatches << " matches, " << results.numberOfSteps << " steps in " << tournament.getSecondsSpentRunning() << " s, "
+             << (results.numberOfMatches / tournament.getSecondsSpentRunning()) << " matches/s" << "\n";
+
+   return 0;
+}
@@ -0,0 +1,53 @@
+#include <cmath>
+
+#include "trajectory.h"
+
+Interception predictInterception(const BallState& ball, float paddleX, float verticalRange)
+{
+   Interception interception = {};
+
+   float timeUntilInterception = (paddleX - ball.position.x) / ball.velocity.x;
+   if (ball.velocity.x == 0.0f || !(timeUntilInterception >= 0.0f))
+   {
+      return interception;
+   }
+
+   // The walls stop the center of the ball one radius away from them
+   double lowestPositionY  = -verticalRange / 2.0 + ball.radius;
+   double highestPositionY =  verticalRange / 2.0 - ball.radius;
+   double rangeOfPositionY = highestPositionY - lowestPositionY;
+
+   interception.willIntercept         = true;
+   interception.timeUntilInterception = timeUntilInterception;
+
+   if (rangeOfPositionY <= 0.0)
+   {
+      // The ball is as tall as the table, so it can only move horizontally
+      interception.positionY = static_cast<float>((lowestPositionY + highestPositionY) / 2.0);
+      return interception;
+   }
+
+   // Unfold the reflections: on the unfolded line the ball never bounces, and each time it crosses a multiple of the range it would have bounced once
+   // Doubles are used so that long predictions don't lose precision
+   double unfoldedDistanceFromLowestPosition = (ball.position.y + static_cast<double>(ball.velocity.y) * timeUntilInterception) - lowestPositionY;
+   double numberOfRangesCrossed              = std::floor(unfoldedDistanceFromLowestPosition / rangeOfPositionY);
+   double distanceIntoLastRange              = unfoldedDistanceFromLowestPosition - numberOfRangesCrossed * rangeOfPositionY;
+
+   // The ball travels upwards through even ranges and downwards through odd ones, relative to its original direction
+   bool   isReflected = std::fmod(std::abs(numberOfRangesCrossed), 2.0) == 1.0;
+
+   interception.positionY               = static_cast<float>(isReflected ? (highestPositionY - distanceIntoLastRange) : (lowestPositionY + distanceIntoLastRange));
+   interception.velocityY               = isReflected ? -ball.velocity.y : ball.velocity.y;
+   interception.numberOfBouncesOffWalls = static_cast<unsigned int>(std::abs(numberOfRangesCrossed));
+
+   return interception;
+}
+
+Interception predictInterceptionByPaddle(const BallState& ball, const PaddleState& paddle, float verticalRange)
+{
+   float distanceBetweenCentersWhenTouching = (paddle.width / 2.0f) + ball.radius;
+   float paddleX                            = (ball.position.x < paddle.position.x) ? (paddle.position.x - distanceBetweenCentersWhenTouching)
+                                                                                    : (paddle.position.x + distanceBetweenCentersWhenTouching);
+
+   return predictInterception(ball, paddleX, verticalRange);
+}
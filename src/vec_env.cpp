@@ -0,0 +1,284 @@
+#include <algorithm>
+
+#include "float_lanes.h"
+#include "observation_rasterizer.h"
+#include "vec_env.h"
+
+VecEnvSettings::VecEnvSettings()
+   : deltaTime(1.0f / 240.0f) // The update rate of the game
+   , ticksPerStep(4)
+   , maxNumberOfStepsPerEpisode(0)
+   , numberOfThreads(0)
+   , createOpponent([]() { return std::unique_ptr<PaddleController>(new TrackingPaddleController(0.5f)); })
+{
+
+}
+
+PaddleInput convertActionToInput(std::uint8_t action)
+{
+   PaddleInput input;
+   input.moveUp   = (action == PaddleMovesUp);
+   input.moveDown = (action == PaddleMovesDown);
+   return input;
+}
+
+VecEnv::VecEnv(const MatchConfiguration& configuration, const VecEnvSettings& settings, std::size_t numberOfEnvironments, std::uint64_t seed)
+   : mConfiguration(configuration)
+   , mSettings(settings)
+   , mNumberOfEnvironments(numberOfEnvironments)
+   , mShards()
+   , mStepsInEpisode(numberOfEnvironments, 0)
+   , mPointsScoredByLeftPaddle(numberOfEnvironments, 0)
+   , mPointsScoredByRightPaddle(numberOfEnvironments, 0)
+   , mRandomNumberGeneratorStates(numberOfEnvironments)
+   , mWorkers()
+   , mMutex()
+   , mTaskIsReady()
+   , mTaskIsDone()
+   , mTask(nullptr)
+   , mGeneration(0)
+   , mNumberOfShardsLeft(0)
+   , mWorkersShouldStop(false)
+{
+   unsigned int numberOfThreads = (mSettings.numberOfThreads != 0) ? mSettings.numberOfThreads : std::max(std::thread::hardware_concurrency(), 1u);
+
+   // Shards hold a multiple of the SIMD width, so that only the last one simulates padding
+   std::size_t environmentsPerShard = (numberOfEnvironments + numberOfThreads - 1) / numberOfThreads;
+   environmentsPerShard             = std::max(((environmentsPerShard + floatLanesWidth - 1) / floatLanesWidth) * floatLanesWidth, static_cast<std::size_t>(floatLanesWidth));
+
+   for (std::size_t first = 0; first < numberOfEnvironments; first += environmentsPerShard)
+   {
+      std::size_t numberOfEnvironmentsInShard = std::min(environmentsPerShard, numberOfEnvironments - first);
+
+      // MatchBatch gives match i the stream seed + (i * 0xD1B54A32D192ED03), so offsetting the seed of each shard by the index of its first environment
+      // gives every environment the same serves regardless of the number of shards
+      std::unique_ptr<Shard> shard(new Shard{first,
+                                             numberOfEnvironmentsInShard,
+                                             MatchBatch(mConfiguration, numberOfEnvironmentsInShard, seed + (first * 0xD1B54A32D192ED03ull)),
+                                             std::vector<std::uint8_t>(environmentsPerShard, 0),
+                                             std::vector<std::unique_ptr<PaddleController>>()});
+
+      for (std::size_t i = 0; i < numberOfEnvironmentsInShard; ++i)
+      {
+         shard->opponents.push_back(mSettings.createOpponent());
+      }
+
+      mShards.push_back(std::move(shard));
+   }
+
+   // The opponents draw their random numbers from a stream that is separate from the serves
+   std::uint64_t randomNumberGeneratorState = seed ^ 0x0BB0E175ull;
+   for (std::uint64_t& state : mRandomNumberGeneratorStates)
+   {
+      state = drawRandomNumber(randomNumberGeneratorState);
+   }
+
+   for (std::size_t shardIndex = 1; shardIndex < mShards.size(); ++shardIndex)
+   {
+      mWorkers.emplace_back(&VecEnv::work, this, shardIndex);
+   }
+
+   reset(nullptr);
+}
+
+VecEnv::~VecEnv()
+{
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mWorkersShouldStop = true;
+   }
+   mTaskIsReady.notify_all();
+
+   for (std::thread& worker : mWorkers)
+   {
+      worker.join();
+   }
+}
+
+void VecEnv::reset(std::uint8_t* observations)
+{
+   runOnEveryShard([this, observations](Shard& shard) { resetShard(shard, observations); });
+}
+
+void VecEnv::step(const std::uint8_t* actionsOfRightPaddles,
+                  const std::uint8_t* actionsOfLeftPaddles,
+                  float*              rewards,
+                  std::uint8_t*       dones,
+                  std::uint8_t*       observations)
+{
+   StepArguments arguments = {actionsOfRightPaddles, actionsOfLeftPaddles, rewards, dones, observations};
+   runOnEveryShard([this, &arguments](Shard& shard) { stepShard(shard, arguments); });
+}
+
+std::size_t VecEnv::getNumberOfEnvironments() const
+{
+   return mNumberOfEnvironments;
+}
+
+unsigned int VecEnv::getNumberOfThreads() const
+{
+   return static_cast<unsigned int>(mShards.size());
+}
+
+std::size_t VecEnv::getObservationSize() const
+{
+   return static_cast<std::size_t>(observationWidth) * observationHeight;
+}
+
+MatchState VecEnv::getState(std::size_t environmentIndex) const
+{
+   for (const std::unique_ptr<Shard>& shard : mShards)
+   {
+      if (environmentIndex < shard->firstEnvironment + shard->numberOfEnvironments)
+      {
+         return shard->batch.getState(environmentIndex - shard->firstEnvironment);
+      }
+   }
+
+   return MatchState();
+}
+
+void VecEnv::resetShard(Shard& shard, std::uint8_t* observations)
+{
+   for (std::size_t i = 0; i < shard.numberOfEnvironments; ++i)
+   {
+      startNewEpisode(shard, i);
+
+      if (observations)
+      {
+         std::size_t environmentIndex = shard.firstEnvironment + i;
+         rasterizeObservation(shard.batch.getState(i), mConfiguration, observationWidth, observationHeight, observations + (environmentIndex * getObservationSize()));
+      }
+   }
+}
+
+void VecEnv::stepShard(Shard& shard, const StepArguments& arguments)
+{
+   float deltaTimeOfStep = mSettings.deltaTime * mSettings.ticksPerStep;
+
+   // The actions are repeated for every tick of the step, so the opponents only decide once per step too
+   for (std::size_t i = 0; i < shard.numberOfEnvironments; ++i)
+   {
+      std::size_t environmentIndex = shard.firstEnvironment + i;
+
+      MatchInputs inputs;
+      inputs.rightPaddle = convertActionToInput(arguments.actionsOfRightPaddles[environmentIndex]);
+      inputs.leftPaddle  = arguments.actionsOfLeftPaddles ? convertActionToInput(arguments.actionsOfLeftPaddles[environmentIndex])
+                                                          : shard.opponents[i]->decide(shard.batch.getState(i), mConfiguration, deltaTimeOfStep);
+      inputs.releaseBall = true;
+
+      shard.packedInputs[i] = packMatchInputs(inputs);
+   }
+
+   for (unsigned int tick = 0; tick < mSettings.ticksPerStep; ++tick)
+   {
+      shard.batch.step(shard.packedInputs.data(), mSettings.deltaTime, nullptr);
+   }
+
+   for (std::size_t i = 0; i < shard.numberOfEnvironments; ++i)
+   {
+      std::size_t environmentIndex = shard.firstEnvironment + i;
+      MatchState  state            = shard.batch.getState(i);
+
+      // Matches that are over stand still, so comparing the scores before and after the step finds every point that was scored during it
+      int pointsScoredByLeftPaddle  = static_cast<int>(state.pointsScoredByLeftPaddle) - mPointsScoredByLeftPaddle[environmentIndex];
+      int pointsScoredByRightPaddle = static_cast<int>(state.pointsScoredByRightPaddle) - mPointsScoredByRightPaddle[environmentIndex];
+      mPointsScoredByLeftPaddle[environmentIndex]  = static_cast<std::uint8_t>(state.pointsScoredByLeftPaddle);
+      mPointsScoredByRightPaddle[environmentIndex] = static_cast<std::uint8_t>(state.pointsScoredByRightPaddle);
+      ++mStepsInEpisode[environmentIndex];
+
+      std::uint8_t status = EpisodeContinues;
+      if (state.matchIsOver)
+      {
+         status = EpisodeWasWon;
+      }
+      else if (mSettings.maxNumberOfStepsPerEpisode != 0 && mStepsInEpisode[environmentIndex] >= mSettings.maxNumberOfStepsPerEpisode)
+      {
+         status = EpisodeTimedOut;
+      }
+
+      if (status != EpisodeContinues)
+      {
+         startNewEpisode(shard, i);
+         state = shard.batch.getState(i);
+      }
+
+      arguments.rewards[environmentIndex] = static_cast<float>(pointsScoredByRightPaddle - pointsScoredByLeftPaddle);
+      arguments.dones[environmentIndex]   = status;
+
+      if (arguments.observations)
+      {
+         rasterizeObservation(state, mConfiguration, observationWidth, observationHeight, arguments.observations + (environmentIndex * getObservationSize()));
+      }
+   }
+}
+
+void VecEnv::startNewEpisode(Shard& shard, std::size_t indexInShard)
+{
+   std::size_t environmentIndex = shard.firstEnvironment + indexInShard;
+
+   shard.batch.startNewMatch(indexInShard);
+   shard.opponents[indexInShard]->reset(PaddleSide::Left, drawRandomNumber(mRandomNumberGeneratorStates[environmentIndex]));
+
+   mStepsInEpisode[environmentIndex]            = 0;
+   mPointsScoredByLeftPaddle[environmentIndex]  = 0;
+   mPointsScoredByRightPaddle[environmentIndex] = 0;
+}
+
+void VecEnv::runOnEveryShard(const std::function<void(Shard&)>& task)
+{
+   if (mShards.empty())
+   {
+      return;
+   }
+
+   if (mWorkers.empty())
+   {
+      task(*mShards[0]);
+      return;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mTask               = &task;
+      mNumberOfShardsLeft = mWorkers.size();
+      ++mGeneration;
+   }
+   mTaskIsReady.notify_all();
+
+   task(*mShards[0]);
+
+   std::unique_lock<std::mutex> lock(mMutex);
+   mTaskIsDone.wait(lock, [this]() { return mNumberOfShardsLeft == 0; });
+   mTask = nullptr;
+}
+
+void VecEnv::work(std::size_t shardIndex)
+{
+   std::uint64_t generation = 0;
+
+   while (true)
+   {
+      const std::function<void(Shard&)>* task = nullptr;
+      {
+         std::unique_lock<std::mutex> lock(mMutex);
+         mTaskIsReady.wait(lock, [this, generation]() { return mWorkersShouldStop || mGeneration != generation; });
+
+         if (mWorkersShouldStop)
+         {
+            return;
+         }
+
+         generation = mGeneration;
+         task       = mTask;
+      }
+
+      (*task)(*mShards[shardIndex]);
+
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         --mNumberOfShardsLeft;
+      }
+      mTaskIsDone.notify_one();
+   }
+}
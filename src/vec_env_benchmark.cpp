@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "observation_rasterizer.h"
+#include "vec_env.h"
+
+// Steps a VecEnv with random actions and reports how many environment steps it simulates per second, with and without observations
+// Usage: teapong_vec_env_benchmark [--environments N] [--threads N] [--steps N] [--observation FILE]
+//   --environments  Number of environments (defaults to 4096)
+//   --threads       Number of threads (defaults to the number of cores)
+//   --steps         Number of steps that are timed (defaults to 1000)
+//   --observation   Saves the observation of the first environment after the last step as a PGM image
+
+bool saveObservationAsPGM(const std::string& filePath, const std::uint8_t* pixels)
+{
+   std::ofstream file(filePath, std::ios::binary);
+   if (!file)
+   {
+      std::cout << "Error - saveObservationAsPGM - Failed to open " << filePath << "\n";
+      return false;
+   }
+
+   file << "P5\n" << observationWidth << " " << observationHeight << "\n255\n";
+   file.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(observationWidth) * observationHeight);
+   return static_cast<bool>(file);
+}
+
+int main(int argc, char* argv[])
+{
+   std::size_t  numberOfEnvironments = 4096;
+   unsigned int numberOfSteps        = 1000;
+   std::string  observationFilePath;
+
+   VecEnvSettings settings;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      bool hasValue = (i + 1 < argc);
+
+      if (std::strcmp(argv[i], "--environments") == 0 && hasValue)
+      {
+         numberOfEnvironments = std::strtoul(argv[++i], nullptr, 10);
+      }
+      else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+      {
+         settings.numberOfThreads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--steps") == 0 && hasValue)
+      {
+         numberOfSteps = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--observation") == 0 && hasValue)
+      {
+         observationFilePath = argv[++i];
+      }
+      else
+      {
+         std::cout << "Error - main - Unknown argument: " << argv[i] << "\n";
+         return -1;
+      }
+   }
+
+   MatchConfiguration config;
+   VecEnv             env(config, settings, numberOfEnvironments, 1);
+
+   std::vector<std::uint8_t> actions(numberOfEnvironments);
+   std::vector<float>        rewards(numberOfEnvironments);
+   std::vector<std::uint8_t> dones(numberOfEnvironments);
+   std::vector<std::uint8_t> observations(numberOfEnvironments * env.getObservationSize());
+
+   std::uint64_t randomNumberGeneratorState = 42;
+
+   std::cout << "Environments: " << numberOfEnvironments << ", threads: " << env.getNumberOfThreads()
+             << ", ticks per step: " << settings.ticksPerStep << ", observations: " << observationWidth << "x" << observationHeight << "\n";
+
+   for (bool renderObservations : {false, true})
+   {
+      env.reset(renderObservations ? observations.data() : nullptr);
+
+      double        totalReward          = 0.0;
+      std::uint64_t numberOfEpisodes     = 0;
+      double        secondsSpentStepping = 0.0;
+
+      for (unsigned int step = 0; step < numberOfSteps; ++step)
+      {
+         // The actions are drawn before the timer starts, since a real agent would produce them outside of the environment
+         for (std::uint8_t& action : actions)
+         {
+            action = static_cast<std::uint8_t>(drawRandomNumber(randomNumberGeneratorState) % numberOfPaddleActions);
+         }
+
+         auto start = std::chrono::steady_clock::now();
+         env.step(actions.data(), nullptr, rewards.data(), dones.data(), renderObservations ? observations.data() : nullptr);
+         secondsSpentStepping += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+         for (std::size_t i = 0; i < numberOfEnvironments; ++i)
+         {
+            totalReward      += rewards[i];
+            numberOfEpisodes += (dones[i] != EpisodeContinues) ? 1 : 0;
+         }
+      }
+
+      double environmentSteps = static_cast<double>(numberOfEnvironments) * numberOfSteps;
+      std::cout << (renderObservations ? "With observations:    " : "Without observations: ")
+                << (environmentSteps / secondsSpentStepping / 1e6) << " M steps/s, "
+                << (secondsSpentStepping * 1e9 / environmentSteps) << " ns/step, "
+                << numberOfEpisodes << " episodes, average reward of the random agent per step " << (totalReward / environmentSteps) << "\n";
+   }
+
+   if (!observationFilePath.empty() && !saveObservationAsPGM(observationFilePath, observations.data()))
+   {
+      return -1;
+   }
+
+   return 0;
+}
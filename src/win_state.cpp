@@ -127,7 +127,8 @@ void WinState::update(float deltaTime)
 
    if (mExplode)
    {
-      mSpeedOfExplodingFragments += 0.025f;
+      // Accelerate the fragments at 1.5 units/s^2, which is the 0.025 units per second that they gained every frame at 60 Hz
+      mSpeedOfExplodingFragments += 1.5f * deltaTime;
       mDistanceTravelledByExplodingFragments += mSpeedOfExplodingFragments * deltaTime;
    }
    else
@@ -144,7 +145,7 @@ void WinState::update(float deltaTime)
    }
 }
 
-void WinState::render()
+void WinState::render(float /*interpolationFactor*/)
 {
    mWindow->clearAndBindMultisampleFramebuffer();
 